@@ -6,12 +6,44 @@
 
 enum
 {
-	ANTIBOT_ABI_VERSION = 4,
+	ANTIBOT_ABI_VERSION = 5,
 
 	ANTIBOT_MSGFLAG_NONVITAL = 1,
 	ANTIBOT_MSGFLAG_FLUSH = 2,
 
 	ANTIBOT_MAX_CLIENTS = 64,
+
+	// Set by the module in `AntibotInit` to receive the game hooks in
+	// batches through `AntibotOnEvents` instead of one call per hook.
+	ANTIBOT_MODULEFLAG_BATCH_EVENTS = 1,
+
+	// Maximum number of events in one batch, a full buffer is handed over
+	// before the end of the tick.
+	ANTIBOT_MAX_EVENTS = 1024,
+};
+
+enum
+{
+	ANTIBOT_EVENT_PLAYER_INIT,
+	ANTIBOT_EVENT_PLAYER_DESTROY,
+	ANTIBOT_EVENT_SPAWN,
+	ANTIBOT_EVENT_HAMMER_FIRE_RELOADING,
+	ANTIBOT_EVENT_HAMMER_FIRE,
+	ANTIBOT_EVENT_HAMMER_HIT,
+	ANTIBOT_EVENT_DIRECT_INPUT,
+	ANTIBOT_EVENT_CHARACTER_TICK,
+	// `m_Arg` is 1 if a player was hooked, 0 otherwise.
+	ANTIBOT_EVENT_HOOK_ATTACH,
+};
+
+// One game hook in a batch. The round data is updated once before the
+// batch is handed over, i.e. it reflects the state after the last event.
+struct CAntibotEvent
+{
+	int m_Type;
+	int m_ClientID;
+	int m_Tick;
+	int m_Arg;
 };
 
 struct CAntibotMapData
@@ -62,6 +94,7 @@ struct CAntibotVersion
 	int m_SizeInputData;
 	int m_SizeMapData;
 	int m_SizeRoundData;
+	int m_SizeEvent;
 };
 
 #define ANTIBOT_VERSION \
@@ -73,6 +106,7 @@ struct CAntibotVersion
 			sizeof(CAntibotInputData), \
 			sizeof(CAntibotMapData), \
 			sizeof(CAntibotRoundData), \
+			sizeof(CAntibotEvent), \
 	}
 
 struct CAntibotData
@@ -85,6 +119,9 @@ struct CAntibotData
 	void (*m_pfnReport)(int ClientID, const char *pMessage, void *pUser);
 	void (*m_pfnSend)(int ClientID, const void *pData, int DataSize, int Flags, void *pUser);
 	void *m_pUser;
+
+	// ANTIBOT_MODULEFLAG_*, set by the module
+	int m_ModuleFlags;
 };
 struct CAntibotRoundData
 {
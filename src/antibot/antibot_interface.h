@@ -26,6 +26,9 @@ ANTIBOTAPI void AntibotOnHammerHit(int ClientID);
 ANTIBOTAPI void AntibotOnDirectInput(int ClientID);
 ANTIBOTAPI void AntibotOnCharacterTick(int ClientID);
 ANTIBOTAPI void AntibotOnHookAttach(int ClientID, bool Player);
+// Only called if the module set ANTIBOT_MODULEFLAG_BATCH_EVENTS, replaces
+// the game hooks above.
+ANTIBOTAPI void AntibotOnEvents(const CAntibotEvent *pEvents, int NumEvents);
 ANTIBOTAPI void AntibotOnEngineTick(void);
 ANTIBOTAPI void AntibotOnEngineClientJoin(int ClientID, bool Sixup);
 ANTIBOTAPI void AntibotOnEngineClientDrop(int ClientID, const char *pReason);
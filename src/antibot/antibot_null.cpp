@@ -2,7 +2,11 @@
 
 #include "antibot_data.h"
 
+#include <stdio.h>
+
 static CAntibotData *g_pData;
+static int64_t g_NumEvents;
+static int64_t g_NumBatches;
 
 extern "C" {
 
@@ -13,6 +17,9 @@ int AntibotAbiVersion()
 void AntibotInit(CAntibotData *pData)
 {
 	g_pData = pData;
+	g_pData->m_ModuleFlags |= ANTIBOT_MODULEFLAG_BATCH_EVENTS;
+	g_NumEvents = 0;
+	g_NumBatches = 0;
 	g_pData->m_pfnLog("null antibot initialized", g_pData->m_pUser);
 }
 void AntibotRoundStart(CAntibotRoundData *pRoundData){};
@@ -21,7 +28,9 @@ void AntibotUpdateData(void) {}
 void AntibotDestroy(void) { g_pData = 0; }
 void AntibotDump(void)
 {
-	g_pData->m_pfnLog("null antibot", g_pData->m_pUser);
+	char aBuf[128];
+	snprintf(aBuf, sizeof(aBuf), "null antibot, %lld events in %lld batches", (long long)g_NumEvents, (long long)g_NumBatches);
+	g_pData->m_pfnLog(aBuf, g_pData->m_pUser);
 }
 void AntibotOnPlayerInit(int /*ClientID*/) {}
 void AntibotOnPlayerDestroy(int /*ClientID*/) {}
@@ -32,6 +41,11 @@ void AntibotOnHammerHit(int /*ClientID*/) {}
 void AntibotOnDirectInput(int /*ClientID*/) {}
 void AntibotOnCharacterTick(int /*ClientID*/) {}
 void AntibotOnHookAttach(int /*ClientID*/, bool /*Player*/) {}
+void AntibotOnEvents(const CAntibotEvent * /*pEvents*/, int NumEvents)
+{
+	g_NumEvents += NumEvents;
+	g_NumBatches++;
+}
 void AntibotOnEngineTick(void) {}
 void AntibotOnEngineClientJoin(int /*ClientID*/, bool /*Sixup*/) {}
 void AntibotOnEngineClientDrop(int /*ClientID*/, const char * /*pReason*/) {}
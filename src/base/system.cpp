@@ -15,7 +15,9 @@
 #include <sys/stat.h>
 #include <sys/types.h>
 
+#include <atomic>
 #include <chrono>
+#include <thread>
 
 #include <cinttypes>
 
@@ -79,6 +81,15 @@
 #include <sys/filio.h>
 #endif
 
+#if defined(CONF_PLATFORM_LINUX)
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#endif
+
+#if !defined(MSG_NOSIGNAL)
+#define MSG_NOSIGNAL 0
+#endif
+
 extern "C" {
 
 IOHANDLE io_stdin()
@@ -99,6 +110,10 @@ static DBG_LOGGER_DATA loggers[16];
 static int has_stdout_logger = 0;
 static int num_loggers = 0;
 
+static std::atomic<DBG_FLUSH> flush_hook(nullptr);
+static void *flush_hook_user = 0;
+static std::thread::id flush_hook_thread;
+
 #ifndef CONF_FAMILY_WINDOWS
 static DBG_LOGGER_DATA stdout_nonewline_logger;
 #endif
@@ -136,6 +151,10 @@ void dbg_msg(const char *sys, const char *fmt, ...)
 	char str[1024 * 4];
 	int i;
 
+	DBG_FLUSH flush = flush_hook.load();
+	if(flush && std::this_thread::get_id() == flush_hook_thread)
+		flush(flush_hook_user);
+
 	char timestr[80];
 	str_timestamp_format(timestr, sizeof(timestr), FORMAT_SPACE);
 
@@ -263,6 +282,21 @@ void dbg_logger(DBG_LOGGER logger, DBG_LOGGER_FINISH finish, void *user)
 	num_loggers++;
 }
 
+int dbg_flush_hook(DBG_FLUSH flush, void *user)
+{
+	if(!flush)
+	{
+		flush_hook.store(nullptr);
+		return 1;
+	}
+	if(flush_hook.load())
+		return 0;
+	flush_hook_user = user;
+	flush_hook_thread = std::this_thread::get_id();
+	flush_hook.store(flush);
+	return 1;
+}
+
 void dbg_logger_stdout()
 {
 #if defined(CONF_FAMILY_WINDOWS)
@@ -1038,6 +1072,11 @@ int64_t time_get_microseconds()
 	return time_get_impl() / (time_freq() / 1000 / 1000);
 }
 
+int64_t time_get_nanoseconds()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - tw_start_time).count();
+}
+
 /* -----  network ----- */
 static void netaddr_to_sockaddr_in(const NETADDR *src, struct sockaddr_in *dest)
 {
@@ -1898,6 +1937,17 @@ int net_tcp_listen(NETSOCKET sock, int backlog)
 	return err;
 }
 
+int net_tcp_local_addr(NETSOCKET sock, NETADDR *addr)
+{
+	struct sockaddr_storage sa;
+	socklen_t sa_len = sizeof(sa);
+	int s = sock.ipv4sock >= 0 ? sock.ipv4sock : sock.ipv6sock;
+	if(s < 0 || getsockname(s, (struct sockaddr *)&sa, &sa_len) != 0)
+		return -1;
+	sockaddr_to_netaddr((struct sockaddr *)&sa, addr);
+	return 0;
+}
+
 int net_tcp_accept(NETSOCKET sock, NETSOCKET *new_sock, NETADDR *a)
 {
 	int s;
@@ -1975,9 +2025,9 @@ int net_tcp_send(NETSOCKET sock, const void *data, int size)
 	int bytes = -1;
 
 	if(sock.ipv4sock >= 0)
-		bytes = send((int)sock.ipv4sock, (const char *)data, size, 0);
+		bytes = send((int)sock.ipv4sock, (const char *)data, size, MSG_NOSIGNAL);
 	if(sock.ipv6sock >= 0)
-		bytes = send((int)sock.ipv6sock, (const char *)data, size, 0);
+		bytes = send((int)sock.ipv6sock, (const char *)data, size, MSG_NOSIGNAL);
 
 	return bytes;
 }
@@ -2489,6 +2539,321 @@ int net_socket_read_wait(NETSOCKET sock, int time)
 	return 0;
 }
 
+#if defined(CONF_PLATFORM_LINUX)
+struct NETPOLL_INTERNAL
+{
+	int epoll_fd;
+	int wake_fd;
+};
+
+static int priv_net_poll_ctl(NETPOLL *poll, int op, int fd, int id, int events)
+{
+	struct epoll_event ev;
+	mem_zero(&ev, sizeof(ev));
+	if(events & NETPOLL_READ)
+		ev.events |= EPOLLIN;
+	if(events & NETPOLL_WRITE)
+		ev.events |= EPOLLOUT;
+	/* the wake fd is the only entry without the upper bit */
+	ev.data.u64 = (1ull << 32) | (unsigned)id;
+	return epoll_ctl(poll->epoll_fd, op, fd, &ev);
+}
+
+NETPOLL *net_poll_create()
+{
+	NETPOLL *poll = (NETPOLL *)malloc(sizeof(NETPOLL));
+	poll->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+	poll->wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if(poll->epoll_fd < 0 || poll->wake_fd < 0)
+	{
+		net_poll_destroy(poll);
+		return 0;
+	}
+
+	struct epoll_event ev;
+	mem_zero(&ev, sizeof(ev));
+	ev.events = EPOLLIN;
+	ev.data.u64 = 0;
+	if(epoll_ctl(poll->epoll_fd, EPOLL_CTL_ADD, poll->wake_fd, &ev) < 0)
+	{
+		net_poll_destroy(poll);
+		return 0;
+	}
+	return poll;
+}
+
+void net_poll_destroy(NETPOLL *poll)
+{
+	if(poll->epoll_fd >= 0)
+		close(poll->epoll_fd);
+	if(poll->wake_fd >= 0)
+		close(poll->wake_fd);
+	free(poll);
+}
+
+int net_poll_add(NETPOLL *poll, NETSOCKET sock, int id, int events)
+{
+	if(sock.ipv4sock >= 0 && priv_net_poll_ctl(poll, EPOLL_CTL_ADD, sock.ipv4sock, id, events) < 0)
+		return -1;
+	if(sock.ipv6sock >= 0 && priv_net_poll_ctl(poll, EPOLL_CTL_ADD, sock.ipv6sock, id, events) < 0)
+		return -1;
+	return 0;
+}
+
+int net_poll_modify(NETPOLL *poll, NETSOCKET sock, int id, int events)
+{
+	if(sock.ipv4sock >= 0 && priv_net_poll_ctl(poll, EPOLL_CTL_MOD, sock.ipv4sock, id, events) < 0)
+		return -1;
+	if(sock.ipv6sock >= 0 && priv_net_poll_ctl(poll, EPOLL_CTL_MOD, sock.ipv6sock, id, events) < 0)
+		return -1;
+	return 0;
+}
+
+void net_poll_remove(NETPOLL *poll, NETSOCKET sock)
+{
+	if(sock.ipv4sock >= 0)
+		epoll_ctl(poll->epoll_fd, EPOLL_CTL_DEL, sock.ipv4sock, 0);
+	if(sock.ipv6sock >= 0)
+		epoll_ctl(poll->epoll_fd, EPOLL_CTL_DEL, sock.ipv6sock, 0);
+}
+
+int net_poll_wait(NETPOLL *poll, NETPOLLEVENT *events, int max_events, int timeout)
+{
+	struct epoll_event aev[64];
+	int num;
+	int i;
+	int count = 0;
+
+	if(max_events > 64)
+		max_events = 64;
+	num = epoll_wait(poll->epoll_fd, aev, max_events, timeout);
+	if(num < 0)
+		return errno == EINTR ? 0 : -1;
+
+	for(i = 0; i < num; i++)
+	{
+		if(aev[i].data.u64 == 0)
+		{
+			uint64_t value;
+			if(read(poll->wake_fd, &value, sizeof(value)) < 0)
+			{
+				/* already drained */
+			}
+			continue;
+		}
+
+		events[count].id = (int)(unsigned)aev[i].data.u64;
+		events[count].events = 0;
+		if(aev[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+			events[count].events |= NETPOLL_READ;
+		if(aev[i].events & EPOLLOUT)
+			events[count].events |= NETPOLL_WRITE;
+		if(aev[i].events & (EPOLLHUP | EPOLLERR))
+			events[count].events |= NETPOLL_ERROR;
+		count++;
+	}
+	return count;
+}
+
+void net_poll_wake(NETPOLL *poll)
+{
+	uint64_t value = 1;
+	if(write(poll->wake_fd, &value, sizeof(value)) < 0)
+	{
+		/* the counter is already set */
+	}
+}
+#else
+typedef struct
+{
+	int sock;
+	int id;
+	int events;
+} NETPOLL_ENTRY;
+
+struct NETPOLL_INTERNAL
+{
+	NETPOLL_ENTRY *entries;
+	int num_entries;
+	int max_entries;
+#if defined(CONF_FAMILY_UNIX)
+	int wake_pipe[2];
+#endif
+};
+
+NETPOLL *net_poll_create()
+{
+	NETPOLL *poll = (NETPOLL *)malloc(sizeof(NETPOLL));
+	poll->entries = 0;
+	poll->num_entries = 0;
+	poll->max_entries = 0;
+#if defined(CONF_FAMILY_UNIX)
+	if(pipe(poll->wake_pipe) < 0)
+	{
+		free(poll);
+		return 0;
+	}
+	fcntl(poll->wake_pipe[0], F_SETFL, O_NONBLOCK);
+	fcntl(poll->wake_pipe[1], F_SETFL, O_NONBLOCK);
+#endif
+	return poll;
+}
+
+void net_poll_destroy(NETPOLL *poll)
+{
+#if defined(CONF_FAMILY_UNIX)
+	close(poll->wake_pipe[0]);
+	close(poll->wake_pipe[1]);
+#endif
+	free(poll->entries);
+	free(poll);
+}
+
+static int priv_net_poll_set(NETPOLL *poll, int sock, int id, int events)
+{
+	int i;
+	for(i = 0; i < poll->num_entries; i++)
+	{
+		if(poll->entries[i].sock == sock)
+		{
+			poll->entries[i].id = id;
+			poll->entries[i].events = events;
+			return 0;
+		}
+	}
+
+	// FD_SET can't hold more, it would write out of bounds
+#if defined(CONF_FAMILY_UNIX)
+	if(sock >= FD_SETSIZE)
+		return -1;
+#else
+	if(poll->num_entries >= FD_SETSIZE)
+		return -1;
+#endif
+
+	if(poll->num_entries == poll->max_entries)
+	{
+		poll->max_entries = poll->max_entries ? poll->max_entries * 2 : 16;
+		poll->entries = (NETPOLL_ENTRY *)realloc(poll->entries, poll->max_entries * sizeof(NETPOLL_ENTRY));
+	}
+	poll->entries[poll->num_entries].sock = sock;
+	poll->entries[poll->num_entries].id = id;
+	poll->entries[poll->num_entries].events = events;
+	poll->num_entries++;
+	return 0;
+}
+
+int net_poll_add(NETPOLL *poll, NETSOCKET sock, int id, int events)
+{
+	if(sock.ipv4sock >= 0 && priv_net_poll_set(poll, sock.ipv4sock, id, events) < 0)
+		return -1;
+	if(sock.ipv6sock >= 0 && priv_net_poll_set(poll, sock.ipv6sock, id, events) < 0)
+	{
+		net_poll_remove(poll, sock);
+		return -1;
+	}
+	return 0;
+}
+
+int net_poll_modify(NETPOLL *poll, NETSOCKET sock, int id, int events)
+{
+	return net_poll_add(poll, sock, id, events);
+}
+
+void net_poll_remove(NETPOLL *poll, NETSOCKET sock)
+{
+	int i;
+	for(i = 0; i < poll->num_entries; i++)
+	{
+		if(poll->entries[i].sock == sock.ipv4sock || poll->entries[i].sock == sock.ipv6sock)
+		{
+			poll->entries[i] = poll->entries[poll->num_entries - 1];
+			poll->num_entries--;
+			i--;
+		}
+	}
+}
+
+int net_poll_wait(NETPOLL *poll, NETPOLLEVENT *events, int max_events, int timeout)
+{
+	fd_set readfds;
+	fd_set writefds;
+	struct timeval tv;
+	int maxfd = -1;
+	int num;
+	int i;
+	int count = 0;
+
+	FD_ZERO(&readfds);
+	FD_ZERO(&writefds);
+	for(i = 0; i < poll->num_entries; i++)
+	{
+		if(poll->entries[i].events & NETPOLL_READ)
+			FD_SET(poll->entries[i].sock, &readfds);
+		if(poll->entries[i].events & NETPOLL_WRITE)
+			FD_SET(poll->entries[i].sock, &writefds);
+		if(poll->entries[i].sock > maxfd)
+			maxfd = poll->entries[i].sock;
+	}
+#if defined(CONF_FAMILY_UNIX)
+	FD_SET(poll->wake_pipe[0], &readfds);
+	if(poll->wake_pipe[0] > maxfd)
+		maxfd = poll->wake_pipe[0];
+#else
+	if(timeout < 0 || timeout > 10)
+		timeout = 10;
+	if(poll->num_entries == 0)
+	{
+		Sleep(timeout);
+		return 0;
+	}
+#endif
+
+	tv.tv_sec = timeout / 1000;
+	tv.tv_usec = (timeout % 1000) * 1000;
+	num = select(maxfd + 1, &readfds, &writefds, NULL, timeout < 0 ? NULL : &tv);
+	if(num < 0)
+		return net_errno() == EINTR ? 0 : -1;
+
+#if defined(CONF_FAMILY_UNIX)
+	if(FD_ISSET(poll->wake_pipe[0], &readfds))
+	{
+		char buf[64];
+		while(read(poll->wake_pipe[0], buf, sizeof(buf)) > 0)
+		{
+		}
+	}
+#endif
+
+	for(i = 0; i < poll->num_entries && count < max_events; i++)
+	{
+		int ready = 0;
+		if(FD_ISSET(poll->entries[i].sock, &readfds))
+			ready |= NETPOLL_READ;
+		if(FD_ISSET(poll->entries[i].sock, &writefds))
+			ready |= NETPOLL_WRITE;
+		if(ready)
+		{
+			events[count].id = poll->entries[i].id;
+			events[count].events = ready;
+			count++;
+		}
+	}
+	return count;
+}
+
+void net_poll_wake(NETPOLL *poll)
+{
+#if defined(CONF_FAMILY_UNIX)
+	char c = 0;
+	if(write(poll->wake_pipe[1], &c, 1) < 0)
+	{
+		/* the pipe is full, a wake is pending anyway */
+	}
+#endif
+}
+#endif
+
 int time_timestamp()
 {
 	return time(0);
@@ -3210,6 +3575,24 @@ const char *str_utf8_find_nocase(const char *haystack, const char *needle)
 	return 0;
 }
 
+void str_utf8_lowercase(const char *str, char *buffer, int buffer_size)
+{
+	int length = 0;
+	while(*str)
+	{
+		int code = str_utf8_decode(&str);
+		if(code < 0)
+			code = 0xFFFD;
+		char encoded[4];
+		int size = str_utf8_encode(encoded, str_utf8_tolower(code));
+		if(length + size >= buffer_size)
+			break;
+		mem_copy(buffer + length, encoded, size);
+		length += size;
+	}
+	buffer[length] = 0;
+}
+
 int str_utf8_isspace(int code)
 {
 	return code <= 0x0020 || code == 0x0085 || code == 0x00A0 || code == 0x034F ||
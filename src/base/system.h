@@ -709,6 +709,16 @@ Current value of the timer in microseconds.
 */
 int64_t time_get_microseconds();
 
+/*
+Function: time_get_nanoseconds
+Fetches a sample from a high resolution timer and converts it in nanoseconds.
+Unlike <time_get>, this is never cached per tick.
+
+Returns:
+Current value of the timer in nanoseconds.
+*/
+int64_t time_get_nanoseconds();
+
 /* Group: Network General */
 typedef struct
 {
@@ -915,6 +925,20 @@ int net_udp_close(NETSOCKET sock);
 */
 NETSOCKET net_tcp_create(NETADDR bindaddr);
 
+/*
+	Function: net_tcp_local_addr
+		Gets the address a TCP socket is bound to, e.g. the port the
+		system picked when binding to port 0.
+
+	Parameters:
+		sock - Socket to query, the IPv4 socket is preferred.
+		addr - Receives the address.
+
+	Returns:
+		0 on success. Negative value on failure.
+*/
+int net_tcp_local_addr(NETSOCKET sock, NETADDR *addr);
+
 /*
 	Function: net_tcp_listen
 		Makes the socket start listening for new connections.
@@ -1818,6 +1842,98 @@ int net_would_block();
 
 int net_socket_read_wait(NETSOCKET sock, int time);
 
+/* Group: Network Poll */
+enum
+{
+	NETPOLL_READ = 1,
+	NETPOLL_WRITE = 2,
+	NETPOLL_ERROR = 4,
+};
+
+typedef struct
+{
+	int id;
+	int events;
+} NETPOLLEVENT;
+
+typedef struct NETPOLL_INTERNAL NETPOLL;
+
+/*
+	Function: net_poll_create
+		Creates a set of sockets that can be waited on together. Uses
+		epoll on Linux and select everywhere else.
+
+	Returns:
+		The poll set, 0 on failure.
+*/
+NETPOLL *net_poll_create();
+
+/*
+	Function: net_poll_destroy
+		Destroys a poll set. The sockets in it are not closed.
+*/
+void net_poll_destroy(NETPOLL *poll);
+
+/*
+	Function: net_poll_add
+		Adds a socket to a poll set.
+
+	Parameters:
+		poll - Poll set.
+		sock - Socket to add, both address families are added.
+		id - Identifier reported back by <net_poll_wait>, must not be
+			negative except for -1.
+		events - Combination of NETPOLL_READ and NETPOLL_WRITE.
+
+	Returns:
+		0 on success. Negative value on failure.
+*/
+int net_poll_add(NETPOLL *poll, NETSOCKET sock, int id, int events);
+
+/*
+	Function: net_poll_modify
+		Changes the events a socket in a poll set is waited for.
+
+	Returns:
+		0 on success. Negative value on failure.
+*/
+int net_poll_modify(NETPOLL *poll, NETSOCKET sock, int id, int events);
+
+/*
+	Function: net_poll_remove
+		Removes a socket from a poll set, must be called before the
+		socket is closed.
+*/
+void net_poll_remove(NETPOLL *poll, NETSOCKET sock);
+
+/*
+	Function: net_poll_wait
+		Waits until a socket in the poll set is ready, the timeout
+		passed or <net_poll_wake> was called.
+
+	Parameters:
+		poll - Poll set.
+		events - Array receiving the ready sockets.
+		max_events - Size of the array.
+		timeout - Maximum time to wait in milliseconds, negative to
+			wait forever.
+
+	Returns:
+		Number of entries written to events, negative value on failure.
+
+	Remarks:
+		On Windows the wait can't be interrupted, the timeout is capped
+		at 10 milliseconds instead.
+*/
+int net_poll_wait(NETPOLL *poll, NETPOLLEVENT *events, int max_events, int timeout);
+
+/*
+	Function: net_poll_wake
+		Interrupts a <net_poll_wait> on the poll set. Can be called
+		from any thread.
+*/
+void net_poll_wake(NETPOLL *poll);
+
 /*
 	Function: open_link
 		Opens a link in the browser.
@@ -1839,6 +1955,23 @@ typedef void (*DBG_LOGGER)(const char *line, void *user);
 typedef void (*DBG_LOGGER_FINISH)(void *user);
 void dbg_logger(DBG_LOGGER logger, DBG_LOGGER_FINISH finish, void *user);
 
+/*
+	Function: dbg_flush_hook
+		Sets a function that dbg_msg calls before it writes a line, but only
+		on the thread that set it. It is used to write out lines that were
+		queued on that thread first, so nothing gets reordered or lost when
+		an assert ends the process.
+
+	Parameters:
+		flush - The function, 0 removes the hook again.
+		user - Passed to the function.
+
+	Returns:
+		Returns 1 on success, 0 if a hook is already set.
+*/
+typedef void (*DBG_FLUSH)(void *user);
+int dbg_flush_hook(DBG_FLUSH flush, void *user);
+
 void dbg_logger_stdout();
 void dbg_logger_debugger();
 void dbg_logger_file(const char *filename);
@@ -1941,6 +2074,25 @@ int str_utf8_comp_nocase_num(const char *a, const char *b, int num);
 */
 const char *str_utf8_find_nocase(const char *haystack, const char *needle);
 
+/*
+	Function: str_utf8_lowercase
+		Converts a utf8 string to lowercase (locale insensitive).
+
+	Parameters:
+		str - String to convert.
+		buffer - Buffer that will receive the lowercase string.
+		buffer_size - Size of the buffer.
+
+	Remarks:
+		- Searching the lowercase needle in a lowercase haystack with
+		  str_find gives the same result as str_utf8_find_nocase, but
+		  the haystack only has to be converted once.
+		- Invalid sequences are replaced by U+FFFD.
+		- The result is truncated at a codepoint if it doesn't fit.
+		- Guarantees that buffer string will contain zero-termination.
+*/
+void str_utf8_lowercase(const char *str, char *buffer, int buffer_size);
+
 /*
 	Function: str_utf8_isspace
 		Checks whether the given Unicode codepoint renders as space.
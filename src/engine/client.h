@@ -262,6 +262,8 @@ public:
 	virtual void Echo(const char *pString) = 0;
 	virtual bool CanDisplayWarning() = 0;
 	virtual bool IsDisplayingWarning() = 0;
+	// false if the last frame left out map layers whose images weren't loaded yet
+	virtual bool MapLayersComplete() = 0;
 };
 
 void SnapshotRemoveExtraProjectileInfo(unsigned char *pData);
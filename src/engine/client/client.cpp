@@ -269,7 +269,7 @@ CClient::CClient() :
 	m_DemoPlayer(&m_SnapshotDelta, [&]() { UpdateDemoIntraTimers(); })
 {
 	for(auto &DemoRecorder : m_DemoRecorder)
-		DemoRecorder = CDemoRecorder(&m_SnapshotDelta);
+		DemoRecorder.Init(&m_SnapshotDelta);
 
 	m_pEditor = 0;
 	m_pInput = 0;
@@ -370,6 +370,8 @@ CClient::CClient() :
 		m_LastDummyConnectTime = 0;
 
 	m_ReconnectTime = 0;
+	m_ConnectStartTime = 0;
+	m_FirstFrameRendered = false;
 
 	m_GenerateTimeoutSeed = true;
 
@@ -727,6 +729,8 @@ void CClient::Connect(const char *pAddress, const char *pPassword)
 
 	str_format(aBuf, sizeof(aBuf), "connecting to '%s'", m_aServerAddressStr);
 	m_pConsole->Print(IConsole::OUTPUT_LEVEL_STANDARD, "client", aBuf, ClientNetworkPrintColor);
+	m_ConnectStartTime = time_get();
+	m_FirstFrameRendered = false;
 	bool is_websocket = false;
 	if(strncmp(m_aServerAddressStr, "ws://", 5) == 0)
 	{
@@ -1171,6 +1175,26 @@ void CClient::Render()
 	GameClient()->OnRender();
 	DebugRender();
 
+	if(State() == IClient::STATE_ONLINE && m_ConnectStartTime)
+	{
+		// layers are left out until their images are loaded, report both
+		// the first frame and the first one that drew the whole map
+		char aBuf[64];
+		float Seconds = (time_get() - m_ConnectStartTime) / (float)time_freq();
+		if(!m_FirstFrameRendered)
+		{
+			str_format(aBuf, sizeof(aBuf), "first frame rendered %.2fs after connecting", Seconds);
+			m_pConsole->Print(IConsole::OUTPUT_LEVEL_ADDINFO, "client", aBuf);
+			m_FirstFrameRendered = true;
+		}
+		if(GameClient()->MapLayersComplete())
+		{
+			str_format(aBuf, sizeof(aBuf), "all map layers rendered %.2fs after connecting", Seconds);
+			m_pConsole->Print(IConsole::OUTPUT_LEVEL_ADDINFO, "client", aBuf);
+			m_ConnectStartTime = 0;
+		}
+	}
+
 	if(State() == IClient::STATE_ONLINE && g_Config.m_ClAntiPingLimit)
 	{
 		int64_t Now = time_get();
@@ -3012,6 +3036,11 @@ void CClient::InitInterfaces()
 	m_Friends.Init();
 	m_Foes.Init(true);
 
+	// the server browser only recomputes the friend state of servers
+	// whose info changed, refilter all of them when the friends change
+	m_pConsole->Chain("add_friend", ConchainServerBrowserUpdate, this);
+	m_pConsole->Chain("remove_friend", ConchainServerBrowserUpdate, this);
+
 	m_GhostRecorder.Init();
 	m_GhostLoader.Init();
 }
@@ -3170,6 +3199,14 @@ void CClient::Run()
 	{
 		set_new_tick();
 
+#if defined(CONF_VIDEORECORDER)
+		// videos advance by fixed steps instead of the wall clock, so render
+		// them as fast as possible
+		bool RenderUnlimited = IVideo::Current() != 0;
+#else
+		bool RenderUnlimited = false;
+#endif
+
 		// handle pending connects
 		if(m_aCmdConnect[0])
 		{
@@ -3280,7 +3317,7 @@ void CClient::Run()
 
 			if(IsRenderActive &&
 				(!g_Config.m_GfxAsyncRenderOld || m_pGraphics->IsIdle()) &&
-				(!g_Config.m_GfxRefreshRate || (time_freq() / (int64_t)g_Config.m_GfxRefreshRate) <= Now - LastRenderTime))
+				(RenderUnlimited || !g_Config.m_GfxRefreshRate || (time_freq() / (int64_t)g_Config.m_GfxRefreshRate) <= Now - LastRenderTime))
 			{
 				m_RenderFrames++;
 
@@ -3398,14 +3435,14 @@ void CClient::Run()
 #ifdef CONF_DEBUG
 			g_Config.m_DbgStress ||
 #endif
-			(g_Config.m_ClRefreshRateInactive && !m_pGraphics->WindowActive()))
+			(g_Config.m_ClRefreshRateInactive && !m_pGraphics->WindowActive() && !RenderUnlimited))
 		{
 			SleepTimeInMicroSeconds = ((int64_t)1000000 / (int64_t)g_Config.m_ClRefreshRateInactive) - (Now - LastTime);
 			if(SleepTimeInMicroSeconds / (int64_t)1000 > (int64_t)0)
 				thread_sleep(SleepTimeInMicroSeconds);
 			Slept = true;
 		}
-		else if(g_Config.m_ClRefreshRate)
+		else if(g_Config.m_ClRefreshRate && !RenderUnlimited)
 		{
 			SleepTimeInMicroSeconds = ((int64_t)1000000 / (int64_t)g_Config.m_ClRefreshRate) - (Now - LastTime);
 			if(SleepTimeInMicroSeconds > (int64_t)0)
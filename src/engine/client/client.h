@@ -133,6 +133,9 @@ class CClient : public IClient, public CDemoPlayer::IListener
 
 	unsigned m_SnapshotParts[NUM_DUMMIES];
 	int64_t m_LocalStartTime;
+	// reset once a frame after connecting drew all map layers
+	int64_t m_ConnectStartTime;
+	bool m_FirstFrameRendered;
 
 	IGraphics::CTextureHandle m_DebugFont;
 	int m_DebugSoundIndex = 0;
@@ -143,6 +143,9 @@ CGraphics_Threaded::CGraphics_Threaded()
 	m_apCommandBuffers[0] = 0x0;
 	m_apCommandBuffers[1] = 0x0;
 
+	m_FirstFreeCommandList = -1;
+	m_RecordingCommandList = -1;
+
 	m_NumVertices = 0;
 
 	m_ScreenWidth = -1;
@@ -642,12 +645,130 @@ void CGraphics_Threaded::CopyTextureFromTextureBufferSub(uint8_t *pDestBuffer, i
 
 void CGraphics_Threaded::KickCommandBuffer()
 {
-	m_pBackend->RunBuffer(m_pCommandBuffer);
+	// the buffer of a command list is full, submit what was recorded so far and continue afterwards
+	int RecordingCommandList = m_RecordingCommandList;
+	if(RecordingCommandList != -1)
+	{
+		EndCommandList();
+		SubmitCommandList(RecordingCommandList);
+	}
+
+	m_pBackend->RunBuffer(FrameCommandBuffer());
 
 	// swap buffer
 	m_CurrentCommandBuffer ^= 1;
-	m_pCommandBuffer = m_apCommandBuffers[m_CurrentCommandBuffer];
+	m_pCommandBuffer = FrameCommandBuffer();
 	m_pCommandBuffer->Reset();
+
+	// the backend is done with the buffer we swapped to, so are with the command lists appended to it
+	for(auto &CommandList : m_CommandLists)
+	{
+		for(int &SubmittedTo : CommandList.m_aSubmittedTo)
+		{
+			if(SubmittedTo == (int)m_CurrentCommandBuffer)
+				SubmittedTo = -1;
+		}
+	}
+
+	if(RecordingCommandList != -1)
+		BeginCommandList(RecordingCommandList);
+}
+
+int CGraphics_Threaded::CreateCommandList()
+{
+	int Index = -1;
+	if(m_FirstFreeCommandList == -1)
+	{
+		Index = m_CommandLists.size();
+		m_CommandLists.emplace_back();
+	}
+	else
+	{
+		Index = m_FirstFreeCommandList;
+		m_FirstFreeCommandList = m_CommandLists[Index].m_FreeIndex;
+		m_CommandLists[Index].m_FreeIndex = Index;
+	}
+
+	SCommandList &CommandList = m_CommandLists[Index];
+	for(int i = 0; i < NUM_CMDBUFFERS; ++i)
+	{
+		// start small, the buffers grow to what the list needs
+		CommandList.m_apBuffers[i] = new CCommandBuffer(CMD_BUFFER_CMD_BUFFER_SIZE / 16, CMD_BUFFER_DATA_BUFFER_SIZE / 16);
+		CommandList.m_aSubmittedTo[i] = -1;
+	}
+	CommandList.m_RecordBuffer = -1;
+
+	return Index;
+}
+
+void CGraphics_Threaded::DeleteCommandList(int ListIndex)
+{
+	if(ListIndex == -1)
+		return;
+
+	dbg_assert(m_RecordingCommandList != ListIndex, "deleting a command list that is being recorded");
+
+	// the backend might still run commands of this list
+	WaitForIdle();
+
+	SCommandList &CommandList = m_CommandLists[ListIndex];
+	for(auto &pBuffer : CommandList.m_apBuffers)
+	{
+		delete pBuffer;
+		pBuffer = nullptr;
+	}
+	CommandList.m_RecordBuffer = -1;
+
+	CommandList.m_FreeIndex = m_FirstFreeCommandList;
+	m_FirstFreeCommandList = ListIndex;
+}
+
+void CGraphics_Threaded::BeginCommandList(int ListIndex)
+{
+	dbg_assert(m_RecordingCommandList == -1, "a command list is already being recorded");
+
+	SCommandList &CommandList = m_CommandLists[ListIndex];
+	m_RecordingCommandList = ListIndex;
+
+	if(CommandList.m_RecordBuffer == -1)
+	{
+		for(int i = 0; i < NUM_CMDBUFFERS; ++i)
+		{
+			if(CommandList.m_aSubmittedTo[i] == -1)
+			{
+				CommandList.m_RecordBuffer = i;
+				CommandList.m_apBuffers[i]->Reset();
+				break;
+			}
+		}
+	}
+
+	// all buffers of this list are still in use, record straight into the frame instead
+	if(CommandList.m_RecordBuffer == -1)
+		return;
+
+	m_pCommandBuffer = CommandList.m_apBuffers[CommandList.m_RecordBuffer];
+}
+
+void CGraphics_Threaded::EndCommandList()
+{
+	dbg_assert(m_RecordingCommandList != -1, "no command list is being recorded");
+
+	m_pCommandBuffer = FrameCommandBuffer();
+	m_RecordingCommandList = -1;
+}
+
+void CGraphics_Threaded::SubmitCommandList(int ListIndex)
+{
+	dbg_assert(m_RecordingCommandList != ListIndex, "submitting a command list that is being recorded");
+
+	SCommandList &CommandList = m_CommandLists[ListIndex];
+	if(CommandList.m_RecordBuffer == -1)
+		return;
+
+	FrameCommandBuffer()->AppendBuffer(CommandList.m_apBuffers[CommandList.m_RecordBuffer]);
+	CommandList.m_aSubmittedTo[CommandList.m_RecordBuffer] = m_CurrentCommandBuffer;
+	CommandList.m_RecordBuffer = -1;
 }
 
 void CGraphics_Threaded::ScreenshotDirect()
@@ -2249,7 +2370,10 @@ int CGraphics_Threaded::Init()
 	m_FirstFreeBufferObjectIndex = -1;
 	m_FirstFreeQuadContainer = -1;
 
-	m_pBackend = CreateGraphicsBackend();
+	if(g_Config.m_GfxNullBackend)
+		m_pBackend = new CGraphicsBackend_Null();
+	else
+		m_pBackend = CreateGraphicsBackend();
 	if(InitWindow() != 0)
 		return -1;
 
@@ -2299,6 +2423,12 @@ void CGraphics_Threaded::Shutdown()
 	// delete the command buffers
 	for(auto &pCommandBuffer : m_apCommandBuffers)
 		delete pCommandBuffer;
+	for(auto &CommandList : m_CommandLists)
+	{
+		for(auto &pCommandBuffer : CommandList.m_apBuffers)
+			delete pCommandBuffer;
+	}
+	m_CommandLists.clear();
 }
 
 int CGraphics_Threaded::GetNumScreens() const
@@ -10,50 +10,129 @@
 #define CMD_BUFFER_DATA_BUFFER_SIZE 1024 * 1024 * 2
 #define CMD_BUFFER_CMD_BUFFER_SIZE 1024 * 256
 
+// command buffers grow up to this factor of their initial size before a mid-frame kick is required
+#define CMD_BUFFER_MAX_GROWTH_FACTOR 32
+// grown command buffers shrink again after this many frames that used less than half of them
+#define CMD_BUFFER_SHRINK_FRAMES 64
+
 class CCommandBuffer
 {
+	// a list of memory chunks, new chunks are appended when the buffer is full,
+	// so pointers into the buffer stay valid until the next Reset
 	class CBuffer
 	{
-		unsigned char *m_pData;
+		struct SChunk
+		{
+			unsigned char *m_pData;
+			unsigned m_Size;
+			unsigned m_Used;
+		};
+
+		std::vector<SChunk> m_vChunks;
+		unsigned m_InitialSize;
+		unsigned m_MaxSize;
 		unsigned m_Size;
 		unsigned m_Used;
+		int m_NumLowUseFrames;
+
+		bool Grow(unsigned Requested)
+		{
+			unsigned MinSize = Requested + (unsigned)alignof(std::max_align_t);
+			if(m_Size >= m_MaxSize || m_MaxSize - m_Size < MinSize)
+				return false;
+
+			// double the total size, but stay below the maximum
+			unsigned NewSize = minimum(maximum(m_Size, MinSize), m_MaxSize - m_Size);
+
+			SChunk Chunk;
+			Chunk.m_pData = new unsigned char[NewSize];
+			Chunk.m_Size = NewSize;
+			Chunk.m_Used = 0;
+			m_vChunks.push_back(Chunk);
+			m_Size += NewSize;
+			return true;
+		}
 
 	public:
 		CBuffer(unsigned BufferSize)
 		{
+			m_InitialSize = BufferSize;
+			m_MaxSize = BufferSize * CMD_BUFFER_MAX_GROWTH_FACTOR;
 			m_Size = BufferSize;
-			m_pData = new unsigned char[m_Size];
 			m_Used = 0;
+			m_NumLowUseFrames = 0;
+
+			SChunk Chunk;
+			Chunk.m_pData = new unsigned char[BufferSize];
+			Chunk.m_Size = BufferSize;
+			Chunk.m_Used = 0;
+			m_vChunks.push_back(Chunk);
 		}
 
 		~CBuffer()
 		{
-			delete[] m_pData;
-			m_pData = 0x0;
+			for(auto &Chunk : m_vChunks)
+				delete[] Chunk.m_pData;
+			m_vChunks.clear();
 			m_Used = 0;
 			m_Size = 0;
 		}
 
 		void Reset()
 		{
+			// don't keep the memory of a single heavy frame forever
+			unsigned NewSize = m_Size;
+			if(m_Size > m_InitialSize && m_Used < m_Size / 2)
+			{
+				if(++m_NumLowUseFrames >= CMD_BUFFER_SHRINK_FRAMES)
+				{
+					NewSize = maximum(m_InitialSize, m_Size / 2);
+					m_NumLowUseFrames = 0;
+				}
+			}
+			else
+				m_NumLowUseFrames = 0;
+
+			// merge the chunks, so a frame of the same size fits into one chunk next time
+			if(m_vChunks.size() > 1 || NewSize != m_Size)
+			{
+				for(auto &Chunk : m_vChunks)
+					delete[] Chunk.m_pData;
+				m_vChunks.clear();
+
+				SChunk Chunk;
+				Chunk.m_pData = new unsigned char[NewSize];
+				Chunk.m_Size = NewSize;
+				m_vChunks.push_back(Chunk);
+				m_Size = NewSize;
+			}
+			m_vChunks.back().m_Used = 0;
 			m_Used = 0;
 		}
 
 		void *Alloc(unsigned Requested, unsigned Alignment = alignof(std::max_align_t))
 		{
-			size_t Offset = reinterpret_cast<uintptr_t>(m_pData + m_Used) % Alignment;
-			if(Offset)
-				Offset = Alignment - Offset;
+			for(int Try = 0; Try < 2; Try++)
+			{
+				SChunk &Chunk = m_vChunks.back();
+				size_t Offset = reinterpret_cast<uintptr_t>(Chunk.m_pData + Chunk.m_Used) % Alignment;
+				if(Offset)
+					Offset = Alignment - Offset;
 
-			if(Requested + Offset + m_Used > m_Size)
-				return 0;
+				if(Requested + Offset + Chunk.m_Used <= Chunk.m_Size)
+				{
+					void *pPtr = &Chunk.m_pData[Chunk.m_Used + Offset];
+					Chunk.m_Used += Requested + Offset;
+					m_Used += Requested + Offset;
+					return pPtr;
+				}
 
-			void *pPtr = &m_pData[m_Used + Offset];
-			m_Used += Requested + Offset;
-			return pPtr;
+				if(Try > 0 || !Grow(Requested))
+					break;
+			}
+			return 0;
 		}
 
-		unsigned char *DataPtr() { return m_pData; }
 		unsigned DataSize() const { return m_Size; }
 		unsigned DataUsed() const { return m_Used; }
 	};
@@ -614,6 +693,20 @@ public:
 		return true;
 	}
 
+	// links the commands of another buffer to the end of this one.
+	// the memory of the other buffer must stay valid until this buffer was run
+	void AppendBuffer(CCommandBuffer *pOther)
+	{
+		if(!pOther->m_pCmdBufferHead)
+			return;
+
+		if(m_pCmdBufferTail)
+			m_pCmdBufferTail->m_pNext = pOther->m_pCmdBufferHead;
+		if(!m_pCmdBufferHead)
+			m_pCmdBufferHead = pOther->m_pCmdBufferHead;
+		m_pCmdBufferTail = pOther->m_pCmdBufferTail;
+	}
+
 	SCommand *Head()
 	{
 		return m_pCmdBufferHead;
@@ -720,9 +813,35 @@ class CGraphics_Threaded : public IEngineGraphics
 	bool m_IsNewOpenGL;
 
 	CCommandBuffer *m_apCommandBuffers[NUM_CMDBUFFERS];
+	// the buffer that is currently recorded into, either the frame buffer or the buffer of a command list
 	CCommandBuffer *m_pCommandBuffer;
 	unsigned m_CurrentCommandBuffer;
 
+	struct SCommandList
+	{
+		SCommandList()
+		{
+			for(int i = 0; i < NUM_CMDBUFFERS; ++i)
+			{
+				m_apBuffers[i] = nullptr;
+				m_aSubmittedTo[i] = -1;
+			}
+			m_RecordBuffer = -1;
+			m_FreeIndex = -1;
+		}
+
+		CCommandBuffer *m_apBuffers[NUM_CMDBUFFERS];
+		// index of the frame buffer a buffer was appended to, -1 if it can be recorded into
+		int m_aSubmittedTo[NUM_CMDBUFFERS];
+		// the buffer that holds commands that were not submitted yet, -1 if none
+		int m_RecordBuffer;
+
+		int m_FreeIndex;
+	};
+	std::vector<SCommandList> m_CommandLists;
+	int m_FirstFreeCommandList;
+	int m_RecordingCommandList;
+
 	//
 	class IStorage *m_pStorage;
 	class IConsole *m_pConsole;
@@ -850,6 +969,7 @@ class CGraphics_Threaded : public IEngineGraphics
 	}
 
 	void KickCommandBuffer();
+	CCommandBuffer *FrameCommandBuffer() { return m_apCommandBuffers[m_CurrentCommandBuffer]; }
 
 	void AddBackEndWarningIfExists();
 
@@ -1188,6 +1308,12 @@ public:
 	void Swap() override;
 	bool SetVSync(bool State) override;
 
+	int CreateCommandList() override;
+	void DeleteCommandList(int ListIndex) override;
+	void BeginCommandList(int ListIndex) override;
+	void EndCommandList() override;
+	void SubmitCommandList(int ListIndex) override;
+
 	int GetVideoModes(CVideoMode *pModes, int MaxModes, int Screen) override;
 
 	virtual int GetDesktopScreenWidth() const { return g_Config.m_GfxDesktopWidth; }
@@ -4,6 +4,8 @@
 #include <engine/graphics.h>
 #include <engine/shared/config.h>
 
+#include "graphics_threaded.h"
+
 #include <cstddef>
 #include <vector>
 
@@ -171,6 +173,12 @@ public:
 	void Swap() override{};
 	bool SetVSync(bool State) override { return false; };
 
+	int CreateCommandList() override { return -1; };
+	void DeleteCommandList(int ListIndex) override{};
+	void BeginCommandList(int ListIndex) override{};
+	void EndCommandList() override{};
+	void SubmitCommandList(int ListIndex) override{};
+
 	int GetVideoModes(CVideoMode *pModes, int MaxModes, int Screen) override { return 0; };
 
 	virtual int GetDesktopScreenWidth() const { return g_Config.m_GfxDesktopWidth; }
@@ -196,4 +204,105 @@ public:
 	const char *GetRendererString() override { return "headless"; };
 };
 
+// a backend that discards all command buffers, used with CGraphics_Threaded
+// to measure the CPU cost of recording a frame without a GPU
+class CGraphicsBackend_Null : public IGraphicsBackend
+{
+	int64_t m_NumCommands;
+
+public:
+	CGraphicsBackend_Null() :
+		m_NumCommands(0) {}
+
+	int Init(const char *pName, int *Screen, int *pWidth, int *pHeight, int *pRefreshRate, int FsaaSamples, int Flags, int *pDesktopWidth, int *pDesktopHeight, int *pCurrentWidth, int *pCurrentHeight, class IStorage *pStorage) override
+	{
+		if(*pWidth == 0 || *pHeight == 0)
+		{
+			*pWidth = 800;
+			*pHeight = 600;
+		}
+		if(*pRefreshRate == 0)
+			*pRefreshRate = 60;
+		*pDesktopWidth = *pWidth;
+		*pDesktopHeight = *pHeight;
+		*pCurrentWidth = *pWidth;
+		*pCurrentHeight = *pHeight;
+		return 0;
+	}
+	int Shutdown() override { return 0; }
+
+	int MemoryUsage() const override { return 0; }
+
+	void GetVideoModes(CVideoMode *pModes, int MaxModes, int *pNumModes, int HiDPIScale, int MaxWindowWidth, int MaxWindowHeight, int Screen) override { *pNumModes = 0; }
+	void GetCurrentVideoMode(CVideoMode &CurMode, int HiDPIScale, int MaxWindowWidth, int MaxWindowHeight, int Screen) override {}
+
+	int GetNumScreens() const override { return 1; }
+
+	void Minimize() override {}
+	void Maximize() override {}
+	void SetWindowParams(int FullscreenMode, bool IsBorderless) override {}
+	bool SetWindowScreen(int Index) override { return false; }
+	int GetWindowScreen() override { return 0; }
+	int WindowActive() override { return 1; }
+	int WindowOpen() override { return 1; }
+	void SetWindowGrab(bool Grab) override {}
+	void ResizeWindow(int w, int h, int RefreshRate) override {}
+	void GetViewportSize(int &w, int &h) override {}
+	void NotifyWindow() override {}
+
+	void RunBuffer(CCommandBuffer *pBuffer) override
+	{
+		for(CCommandBuffer::SCommand *pCommand = pBuffer->Head(); pCommand; pCommand = pCommand->m_pNext)
+		{
+			m_NumCommands++;
+
+			// only do what the caller relies on: free moved memory and answer synchronous requests
+			switch(pCommand->m_Cmd)
+			{
+			case CCommandBuffer::CMD_SIGNAL: static_cast<const CCommandBuffer::SCommand_Signal *>(pCommand)->m_pSemaphore->Signal(); break;
+			case CCommandBuffer::CMD_TEXTURE_CREATE: free(static_cast<const CCommandBuffer::SCommand_Texture_Create *>(pCommand)->m_pData); break;
+			case CCommandBuffer::CMD_TEXTURE_UPDATE: free(static_cast<const CCommandBuffer::SCommand_Texture_Update *>(pCommand)->m_pData); break;
+			case CCommandBuffer::CMD_VSYNC: *static_cast<const CCommandBuffer::SCommand_VSync *>(pCommand)->m_pRetOk = true; break;
+			case CCommandBuffer::CMD_CREATE_BUFFER_OBJECT:
+			{
+				const CCommandBuffer::SCommand_CreateBufferObject *pCmd = static_cast<const CCommandBuffer::SCommand_CreateBufferObject *>(pCommand);
+				if(pCmd->m_DeletePointer)
+					free(pCmd->m_pUploadData);
+				break;
+			}
+			case CCommandBuffer::CMD_RECREATE_BUFFER_OBJECT:
+			{
+				const CCommandBuffer::SCommand_RecreateBufferObject *pCmd = static_cast<const CCommandBuffer::SCommand_RecreateBufferObject *>(pCommand);
+				if(pCmd->m_DeletePointer)
+					free(pCmd->m_pUploadData);
+				break;
+			}
+			case CCommandBuffer::CMD_UPDATE_BUFFER_OBJECT:
+			{
+				const CCommandBuffer::SCommand_UpdateBufferObject *pCmd = static_cast<const CCommandBuffer::SCommand_UpdateBufferObject *>(pCommand);
+				if(pCmd->m_DeletePointer)
+					free(pCmd->m_pUploadData);
+				break;
+			}
+			}
+		}
+	}
+	bool IsIdle() const override { return true; }
+	void WaitForIdle() override {}
+
+	// pretend to support everything, so the same paths as on a modern GPU are recorded
+	bool IsNewOpenGL() override { return true; }
+	bool HasTileBuffering() override { return true; }
+	bool HasQuadBuffering() override { return true; }
+	bool HasTextBuffering() override { return true; }
+	bool HasQuadContainerBuffering() override { return true; }
+	bool Has2DTextureArrays() override { return true; }
+
+	const char *GetVendorString() override { return "null"; }
+	const char *GetVersionString() override { return "null"; }
+	const char *GetRendererString() override { return "null"; }
+
+	int64_t NumCommands() const { return m_NumCommands; }
+};
+
 #endif // ENGINE_CLIENT_GRAPHICS_THREADED_NULL_H
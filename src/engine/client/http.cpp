@@ -215,6 +215,11 @@ CGet::CGet(const char *pUrl, CTimeout Timeout, HTTPLOG LogProgress) :
 }
 
 CGet::~CGet()
+{
+	FreeBuffer();
+}
+
+void CGet::FreeBuffer()
 {
 	m_BufferSize = 0;
 	m_BufferLength = 0;
@@ -91,6 +91,12 @@ class CGet : public CRequest
 	size_t m_BufferLength;
 	unsigned char *m_pBuffer;
 
+protected:
+	// the received data, unlike `Result()` also usable in `OnCompletion()`
+	unsigned char *Buffer() const { return m_pBuffer; }
+	size_t BufferLength() const { return m_BufferLength; }
+	void FreeBuffer();
+
 public:
 	CGet(const char *pUrl, CTimeout Timeout, HTTPLOG LogProgress = HTTPLOG::ALL);
 	~CGet();
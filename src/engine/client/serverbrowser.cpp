@@ -63,6 +63,12 @@ CServerBrowser::CServerBrowser()
 	m_Sorthash = 0;
 	m_aFilterString[0] = 0;
 	m_aFilterGametypeString[0] = 0;
+	m_aExcludeString[0] = 0;
+	m_FilterPing = 0;
+	m_FilterCountryIndex = 0;
+	m_aLowerFilterString[0] = 0;
+	m_aLowerFilterGametypeString[0] = 0;
+	m_aLowerExcludeString[0] = 0;
 
 	m_ServerlistType = 0;
 	m_BroadcastTime = 0;
@@ -257,136 +263,149 @@ bool CServerBrowser::SortCompareNumPlayersAndPing(int Index1, int Index2) const
 		return a->m_Info.m_Latency > b->m_Info.m_Latency;
 }
 
-void CServerBrowser::Filter()
+void SetFilteredPlayers(const CServerInfo &Item)
 {
-	int i = 0, p = 0;
-	m_NumSortedServers = 0;
-
-	// allocate the sorted list
-	if(m_NumSortedServersCapacity < m_NumServers)
+	Item.m_NumFilteredPlayers = g_Config.m_BrFilterSpectators ? Item.m_NumPlayers : Item.m_NumClients;
+	if(g_Config.m_BrFilterConnectingPlayers)
 	{
-		if(m_pSortedServerlist)
-			free(m_pSortedServerlist);
-		m_NumSortedServersCapacity = m_NumServers;
-		m_pSortedServerlist = (int *)calloc(m_NumSortedServersCapacity, sizeof(int));
+		for(const auto &Client : Item.m_aClients)
+		{
+			if((!g_Config.m_BrFilterSpectators || Client.m_Player) && str_comp(Client.m_aName, "(connecting)") == 0 && Client.m_aClan[0] == '\0')
+				Item.m_NumFilteredPlayers--;
+		}
 	}
+}
 
-	// filter the servers
-	for(i = 0; i < m_NumServers; i++)
+bool CServerBrowser::IsFiltered(CServerEntry *pEntry) const
+{
+	CServerInfo &Info = pEntry->m_Info;
+	int NumClients = minimum(Info.m_NumClients, (int)MAX_CLIENTS);
+	int Filtered = 0;
+
+	if(g_Config.m_BrFilterEmpty && Info.m_NumFilteredPlayers == 0)
+		Filtered = 1;
+	else if(g_Config.m_BrFilterFull && Players(Info) == Max(Info))
+		Filtered = 1;
+	else if(g_Config.m_BrFilterPw && Info.m_Flags & SERVER_FLAG_PASSWORD)
+		Filtered = 1;
+	else if(g_Config.m_BrFilterPing && g_Config.m_BrFilterPing < Info.m_Latency)
+		Filtered = 1;
+	else if(g_Config.m_BrFilterCompatversion && str_comp_num(Info.m_aVersion, m_aNetVersion, 3) != 0)
+		Filtered = 1;
+	else if(g_Config.m_BrFilterServerAddress[0] && !str_find_nocase(Info.m_aAddress, g_Config.m_BrFilterServerAddress))
+		Filtered = 1;
+	else if(g_Config.m_BrFilterGametypeStrict && m_aFilterGametypeString[0] && str_comp_nocase(Info.m_aGameType, m_aFilterGametypeString))
+		Filtered = 1;
+	else if(!g_Config.m_BrFilterGametypeStrict && m_aLowerFilterGametypeString[0] && !str_find(pEntry->m_aLowerGameType, m_aLowerFilterGametypeString))
+		Filtered = 1;
+	else if(g_Config.m_BrFilterUnfinishedMap && Info.m_HasRank == 1)
+		Filtered = 1;
+	else
 	{
-		int Filtered = 0;
-
-		if(g_Config.m_BrFilterEmpty && m_ppServerlist[i]->m_Info.m_NumFilteredPlayers == 0)
-			Filtered = 1;
-		else if(g_Config.m_BrFilterFull && Players(m_ppServerlist[i]->m_Info) == Max(m_ppServerlist[i]->m_Info))
-			Filtered = 1;
-		else if(g_Config.m_BrFilterPw && m_ppServerlist[i]->m_Info.m_Flags & SERVER_FLAG_PASSWORD)
-			Filtered = 1;
-		else if(g_Config.m_BrFilterPing && g_Config.m_BrFilterPing < m_ppServerlist[i]->m_Info.m_Latency)
-			Filtered = 1;
-		else if(g_Config.m_BrFilterCompatversion && str_comp_num(m_ppServerlist[i]->m_Info.m_aVersion, m_aNetVersion, 3) != 0)
-			Filtered = 1;
-		else if(g_Config.m_BrFilterServerAddress[0] && !str_find_nocase(m_ppServerlist[i]->m_Info.m_aAddress, g_Config.m_BrFilterServerAddress))
-			Filtered = 1;
-		else if(g_Config.m_BrFilterGametypeStrict && g_Config.m_BrFilterGametype[0] && str_comp_nocase(m_ppServerlist[i]->m_Info.m_aGameType, g_Config.m_BrFilterGametype))
-			Filtered = 1;
-		else if(!g_Config.m_BrFilterGametypeStrict && g_Config.m_BrFilterGametype[0] && !str_utf8_find_nocase(m_ppServerlist[i]->m_Info.m_aGameType, g_Config.m_BrFilterGametype))
-			Filtered = 1;
-		else if(g_Config.m_BrFilterUnfinishedMap && m_ppServerlist[i]->m_Info.m_HasRank == 1)
-			Filtered = 1;
-		else
+		if(g_Config.m_BrFilterCountry)
 		{
-			if(g_Config.m_BrFilterCountry)
+			Filtered = 1;
+			// match against player country
+			for(int p = 0; p < NumClients; p++)
 			{
-				Filtered = 1;
-				// match against player country
-				for(p = 0; p < minimum(m_ppServerlist[i]->m_Info.m_NumClients, (int)MAX_CLIENTS); p++)
+				if(Info.m_aClients[p].m_Country == m_FilterCountryIndex)
 				{
-					if(m_ppServerlist[i]->m_Info.m_aClients[p].m_Country == g_Config.m_BrFilterCountryIndex)
-					{
-						Filtered = 0;
-						break;
-					}
+					Filtered = 0;
+					break;
 				}
 			}
+		}
 
-			if(!Filtered && g_Config.m_BrFilterString[0] != 0)
-			{
-				int MatchFound = 0;
-
-				m_ppServerlist[i]->m_Info.m_QuickSearchHit = 0;
-
-				// match against server name
-				if(str_utf8_find_nocase(m_ppServerlist[i]->m_Info.m_aName, g_Config.m_BrFilterString))
-				{
-					MatchFound = 1;
-					m_ppServerlist[i]->m_Info.m_QuickSearchHit |= IServerBrowser::QUICK_SERVERNAME;
-				}
-
-				// match against players
-				for(p = 0; p < minimum(m_ppServerlist[i]->m_Info.m_NumClients, (int)MAX_CLIENTS); p++)
-				{
-					if(str_utf8_find_nocase(m_ppServerlist[i]->m_Info.m_aClients[p].m_aName, g_Config.m_BrFilterString) ||
-						str_utf8_find_nocase(m_ppServerlist[i]->m_Info.m_aClients[p].m_aClan, g_Config.m_BrFilterString))
-					{
-						MatchFound = 1;
-						m_ppServerlist[i]->m_Info.m_QuickSearchHit |= IServerBrowser::QUICK_PLAYER;
-						break;
-					}
-				}
+		if(!Filtered && m_aLowerFilterString[0] != 0)
+		{
+			int MatchFound = 0;
 
-				// match against map
-				if(str_utf8_find_nocase(m_ppServerlist[i]->m_Info.m_aMap, g_Config.m_BrFilterString))
-				{
-					MatchFound = 1;
-					m_ppServerlist[i]->m_Info.m_QuickSearchHit |= IServerBrowser::QUICK_MAPNAME;
-				}
+			Info.m_QuickSearchHit = 0;
 
-				if(!MatchFound)
-					Filtered = 1;
+			// match against server name
+			if(str_find(pEntry->m_aLowerName, m_aLowerFilterString))
+			{
+				MatchFound = 1;
+				Info.m_QuickSearchHit |= IServerBrowser::QUICK_SERVERNAME;
 			}
 
-			if(!Filtered && g_Config.m_BrExcludeString[0] != 0)
+			// match against players
+			for(int p = 0; p < NumClients; p++)
 			{
-				int MatchFound = 0;
-
-				// match against server name
-				if(str_utf8_find_nocase(m_ppServerlist[i]->m_Info.m_aName, g_Config.m_BrExcludeString))
-				{
-					MatchFound = 1;
-				}
-
-				// match against map
-				if(str_utf8_find_nocase(m_ppServerlist[i]->m_Info.m_aMap, g_Config.m_BrExcludeString))
-				{
-					MatchFound = 1;
-				}
-
-				// match against gametype
-				if(str_utf8_find_nocase(m_ppServerlist[i]->m_Info.m_aGameType, g_Config.m_BrExcludeString))
+				if(str_find(pEntry->m_aaLowerClientNames[p], m_aLowerFilterString) ||
+					str_find(pEntry->m_aaLowerClientClans[p], m_aLowerFilterString))
 				{
 					MatchFound = 1;
+					Info.m_QuickSearchHit |= IServerBrowser::QUICK_PLAYER;
+					break;
 				}
+			}
 
-				if(MatchFound)
-					Filtered = 1;
+			// match against map
+			if(str_find(pEntry->m_aLowerMap, m_aLowerFilterString))
+			{
+				MatchFound = 1;
+				Info.m_QuickSearchHit |= IServerBrowser::QUICK_MAPNAME;
 			}
+
+			if(!MatchFound)
+				Filtered = 1;
 		}
 
-		if(Filtered == 0)
+		if(!Filtered && m_aLowerExcludeString[0] != 0)
 		{
-			// check for friend
-			m_ppServerlist[i]->m_Info.m_FriendState = IFriends::FRIEND_NO;
-			for(p = 0; p < minimum(m_ppServerlist[i]->m_Info.m_NumClients, (int)MAX_CLIENTS); p++)
+			// match against server name, map and gametype
+			if(str_find(pEntry->m_aLowerName, m_aLowerExcludeString) ||
+				str_find(pEntry->m_aLowerMap, m_aLowerExcludeString) ||
+				str_find(pEntry->m_aLowerGameType, m_aLowerExcludeString))
 			{
-				m_ppServerlist[i]->m_Info.m_aClients[p].m_FriendState = m_pFriends->GetFriendState(m_ppServerlist[i]->m_Info.m_aClients[p].m_aName,
-					m_ppServerlist[i]->m_Info.m_aClients[p].m_aClan);
-				m_ppServerlist[i]->m_Info.m_FriendState = maximum(m_ppServerlist[i]->m_Info.m_FriendState, m_ppServerlist[i]->m_Info.m_aClients[p].m_FriendState);
+				Filtered = 1;
 			}
+		}
+	}
 
-			if(!g_Config.m_BrFilterFriends || m_ppServerlist[i]->m_Info.m_FriendState != IFriends::FRIEND_NO)
-				m_pSortedServerlist[m_NumSortedServers++] = i;
+	if(Filtered == 0)
+	{
+		// check for friend
+		Info.m_FriendState = IFriends::FRIEND_NO;
+		for(int p = 0; p < NumClients; p++)
+		{
+			Info.m_aClients[p].m_FriendState = m_pFriends->GetFriendState(Info.m_aClients[p].m_aName, Info.m_aClients[p].m_aClan);
+			Info.m_FriendState = maximum(Info.m_FriendState, Info.m_aClients[p].m_FriendState);
 		}
+
+		if(g_Config.m_BrFilterFriends && Info.m_FriendState == IFriends::FRIEND_NO)
+			Filtered = 1;
+	}
+
+	return Filtered;
+}
+
+void CServerBrowser::Filter(bool Incremental)
+{
+	m_NumSortedServers = 0;
+
+	// allocate the sorted list
+	if(m_NumSortedServersCapacity < m_NumServers)
+	{
+		if(m_pSortedServerlist)
+			free(m_pSortedServerlist);
+		m_NumSortedServersCapacity = m_NumServers;
+		m_pSortedServerlist = (int *)calloc(m_NumSortedServersCapacity, sizeof(int));
+	}
+
+	// filter the servers
+	for(int i = 0; i < m_NumServers; i++)
+	{
+		CServerEntry *pEntry = m_ppServerlist[i];
+		if(!Incremental || pEntry->m_FilterDirty)
+		{
+			SetFilteredPlayers(pEntry->m_Info);
+			pEntry->m_Filtered = IsFiltered(pEntry);
+			pEntry->m_FilterDirty = false;
+		}
+		if(!pEntry->m_Filtered)
+			m_pSortedServerlist[m_NumSortedServers++] = i;
 	}
 }
 
@@ -407,31 +426,33 @@ int CServerBrowser::SortHash() const
 	return i;
 }
 
-void SetFilteredPlayers(const CServerInfo &Item)
+bool CServerBrowser::FilterChanged() const
 {
-	Item.m_NumFilteredPlayers = g_Config.m_BrFilterSpectators ? Item.m_NumPlayers : Item.m_NumClients;
-	if(g_Config.m_BrFilterConnectingPlayers)
-	{
-		for(const auto &Client : Item.m_aClients)
-		{
-			if((!g_Config.m_BrFilterSpectators || Client.m_Player) && str_comp(Client.m_aName, "(connecting)") == 0 && Client.m_aClan[0] == '\0')
-				Item.m_NumFilteredPlayers--;
-		}
-	}
+	return m_Sorthash != SortHash() ||
+	       str_comp(m_aFilterString, g_Config.m_BrFilterString) != 0 ||
+	       str_comp(m_aFilterGametypeString, g_Config.m_BrFilterGametype) != 0 ||
+	       str_comp(m_aExcludeString, g_Config.m_BrExcludeString) != 0 ||
+	       m_FilterPing != g_Config.m_BrFilterPing ||
+	       m_FilterCountryIndex != g_Config.m_BrFilterCountryIndex;
 }
 
-void CServerBrowser::Sort()
+void CServerBrowser::Sort(bool Incremental)
 {
-	int i;
-
-	// fill m_NumFilteredPlayers
-	for(i = 0; i < m_NumServers; i++)
+	if(!Incremental)
 	{
-		SetFilteredPlayers(m_ppServerlist[i]->m_Info);
+		m_Sorthash = SortHash();
+		str_copy(m_aFilterString, g_Config.m_BrFilterString, sizeof(m_aFilterString));
+		str_copy(m_aFilterGametypeString, g_Config.m_BrFilterGametype, sizeof(m_aFilterGametypeString));
+		str_copy(m_aExcludeString, g_Config.m_BrExcludeString, sizeof(m_aExcludeString));
+		m_FilterPing = g_Config.m_BrFilterPing;
+		m_FilterCountryIndex = g_Config.m_BrFilterCountryIndex;
+		str_utf8_lowercase(m_aFilterString, m_aLowerFilterString, sizeof(m_aLowerFilterString));
+		str_utf8_lowercase(m_aFilterGametypeString, m_aLowerFilterGametypeString, sizeof(m_aLowerFilterGametypeString));
+		str_utf8_lowercase(m_aExcludeString, m_aLowerExcludeString, sizeof(m_aLowerExcludeString));
 	}
 
 	// create filtered list
-	Filter();
+	Filter(Incremental);
 
 	// sort
 	if(g_Config.m_BrSortOrder == 2 && (g_Config.m_BrSort == IServerBrowser::SORT_NUMPLAYERS || g_Config.m_BrSort == IServerBrowser::SORT_PING))
@@ -446,10 +467,6 @@ void CServerBrowser::Sort()
 		std::stable_sort(m_pSortedServerlist, m_pSortedServerlist + m_NumSortedServers, SortWrap(this, &CServerBrowser::SortCompareNumPlayers));
 	else if(g_Config.m_BrSort == IServerBrowser::SORT_GAMETYPE)
 		std::stable_sort(m_pSortedServerlist, m_pSortedServerlist + m_NumSortedServers, SortWrap(this, &CServerBrowser::SortCompareGametype));
-
-	str_copy(m_aFilterGametypeString, g_Config.m_BrFilterGametype, sizeof(m_aFilterGametypeString));
-	str_copy(m_aFilterString, g_Config.m_BrFilterString, sizeof(m_aFilterString));
-	m_Sorthash = SortHash();
 }
 
 void CServerBrowser::RemoveRequest(CServerEntry *pEntry)
@@ -535,6 +552,21 @@ void CServerBrowser::SetInfo(CServerEntry *pEntry, const CServerInfo &Info)
 	std::sort(pEntry->m_Info.m_aClients, pEntry->m_Info.m_aClients + Info.m_NumReceivedClients, CPlayerScoreNameLess());
 
 	pEntry->m_GotInfo = 1;
+	UpdateLowercaseInfo(pEntry);
+}
+
+void CServerBrowser::UpdateLowercaseInfo(CServerEntry *pEntry)
+{
+	const CServerInfo &Info = pEntry->m_Info;
+	str_utf8_lowercase(Info.m_aName, pEntry->m_aLowerName, sizeof(pEntry->m_aLowerName));
+	str_utf8_lowercase(Info.m_aMap, pEntry->m_aLowerMap, sizeof(pEntry->m_aLowerMap));
+	str_utf8_lowercase(Info.m_aGameType, pEntry->m_aLowerGameType, sizeof(pEntry->m_aLowerGameType));
+	for(int i = 0; i < minimum(Info.m_NumClients, (int)MAX_CLIENTS); i++)
+	{
+		str_utf8_lowercase(Info.m_aClients[i].m_aName, pEntry->m_aaLowerClientNames[i], sizeof(pEntry->m_aaLowerClientNames[i]));
+		str_utf8_lowercase(Info.m_aClients[i].m_aClan, pEntry->m_aaLowerClientClans[i], sizeof(pEntry->m_aaLowerClientClans[i]));
+	}
+	pEntry->m_FilterDirty = true;
 }
 
 void CServerBrowser::SetLatency(NETADDR Addr, int Latency)
@@ -548,6 +580,7 @@ void CServerBrowser::SetLatency(NETADDR Addr, int Latency)
 		{
 			pEntry->m_Info.m_Latency = Latency;
 			pEntry->m_Info.m_LatencyIsEstimated = false;
+			pEntry->m_FilterDirty = true;
 		}
 	}
 	m_pPingCache->CachePing(Addr, Latency);
@@ -570,6 +603,7 @@ CServerBrowser::CServerEntry *CServerBrowser::Add(const NETADDR &Addr)
 	pEntry->m_Info.m_HasRank = -1;
 	net_addr_str(&Addr, pEntry->m_Info.m_aAddress, sizeof(pEntry->m_Info.m_aAddress), true);
 	str_copy(pEntry->m_Info.m_aName, pEntry->m_Info.m_aAddress, sizeof(pEntry->m_Info.m_aName));
+	UpdateLowercaseInfo(pEntry);
 
 	// check if it's a favorite
 	pEntry->m_Info.m_Favorite = IsFavorite(Addr);
@@ -1254,12 +1288,18 @@ void CServerBrowser::Update(bool ForceResort)
 		}
 	}
 
-	// check if we need to resort
-	if(m_Sorthash != SortHash() || ForceResort || m_SortOnNextUpdate)
+	// check if we need to resort, new server infos only have to be
+	// filtered themselves
+	if(FilterChanged() || ForceResort)
 	{
 		Sort();
 		m_SortOnNextUpdate = false;
 	}
+	else if(m_SortOnNextUpdate)
+	{
+		Sort(true);
+		m_SortOnNextUpdate = false;
+	}
 }
 
 int CServerBrowser::FindFavorite(const NETADDR &Addr) const
@@ -1459,7 +1499,9 @@ void CServerBrowser::LoadDDNetRanks()
 	{
 		if(m_ppServerlist[i]->m_Info.m_aMap[0])
 			m_ppServerlist[i]->m_Info.m_HasRank = HasRank(m_ppServerlist[i]->m_Info.m_aMap);
+		m_ppServerlist[i]->m_FilterDirty = true;
 	}
+	m_SortOnNextUpdate = true;
 }
 
 int CServerBrowser::HasRank(const char *pMap)
@@ -28,6 +28,18 @@ public:
 		bool m_Request64Legacy;
 		CServerInfo m_Info;
 
+		// lowercase copies of the searched fields, so searching doesn't
+		// have to convert them for every filter pass
+		char m_aLowerName[sizeof(CServerInfo::m_aName)];
+		char m_aLowerMap[sizeof(CServerInfo::m_aMap)];
+		char m_aLowerGameType[sizeof(CServerInfo::m_aGameType)];
+		char m_aaLowerClientNames[MAX_CLIENTS][MAX_NAME_LENGTH];
+		char m_aaLowerClientClans[MAX_CLIENTS][MAX_CLAN_LENGTH];
+
+		// only set entries are filtered again when the filter didn't change
+		bool m_FilterDirty;
+		bool m_Filtered;
+
 		CServerEntry *m_pNextIp; // ip hashed list
 
 		CServerEntry *m_pPrevReq; // request list
@@ -186,9 +198,16 @@ private:
 	int m_NumServers;
 	int m_NumServerCapacity;
 
+	// the filter settings of the last full filter pass
 	int m_Sorthash;
 	char m_aFilterString[64];
 	char m_aFilterGametypeString[128];
+	char m_aExcludeString[64];
+	int m_FilterPing;
+	int m_FilterCountryIndex;
+	char m_aLowerFilterString[64];
+	char m_aLowerFilterGametypeString[128];
+	char m_aLowerExcludeString[64];
 
 	int m_ServerlistType;
 	int64_t m_BroadcastTime;
@@ -212,9 +231,12 @@ private:
 	bool SortCompareNumPlayersAndPing(int Index1, int Index2) const;
 
 	//
-	void Filter();
-	void Sort();
+	bool IsFiltered(CServerEntry *pEntry) const;
+	void Filter(bool Incremental);
+	void Sort(bool Incremental = false);
 	int SortHash() const;
+	bool FilterChanged() const;
+	static void UpdateLowercaseInfo(CServerEntry *pEntry);
 
 	void CleanUp();
 
@@ -240,14 +240,31 @@ private:
 		CServerInfo m_Info;
 	};
 
+	// Parses the server list on the job thread right after downloading
+	// it, the client thread only takes the parsed servers.
+	class CGetServers : public CGet
+	{
+		virtual int OnCompletion(int State);
+
+	public:
+		CGetServers(const char *pUrl, CTimeout Timeout) :
+			CGet(pUrl, Timeout) {}
+
+		std::vector<CEntry> m_aServers;
+		std::vector<NETADDR> m_aLegacyServers;
+	};
+
 	static bool Validate(json_value *pJson);
+	static bool ParseList(const char *pData, int Size, std::vector<CEntry> *paServers, std::vector<NETADDR> *paLegacyServers);
 	static bool Parse(json_value *pJson, std::vector<CEntry> *paServers, std::vector<NETADDR> *paLegacyServers);
 
+	friend bool ServerbrowserParseList(const char *pData, int Size, int *pNumServers, int *pNumLegacyServers);
+
 	IEngine *m_pEngine;
 	IConsole *m_pConsole;
 
 	int m_State = STATE_DONE;
-	std::shared_ptr<CGet> m_pGetServers;
+	std::shared_ptr<CGetServers> m_pGetServers;
 	std::unique_ptr<CChooseMaster> m_pChooseMaster;
 
 	std::vector<CEntry> m_aServers;
@@ -277,7 +294,7 @@ void CServerBrowserHttp::Update()
 		}
 		// 10 seconds connection timeout, lower than 8KB/s for 10 seconds to fail.
 		CTimeout Timeout{10000, 8000, 10};
-		m_pEngine->AddJob(m_pGetServers = std::make_shared<CGet>(pBestUrl, Timeout));
+		m_pEngine->AddJob(m_pGetServers = std::make_shared<CGetServers>(pBestUrl, Timeout));
 		m_State = STATE_REFRESHING;
 	}
 	else if(m_State == STATE_REFRESHING)
@@ -287,15 +304,15 @@ void CServerBrowserHttp::Update()
 			return;
 		}
 		m_State = STATE_DONE;
-		std::shared_ptr<CGet> pGetServers = nullptr;
+		std::shared_ptr<CGetServers> pGetServers = nullptr;
 		std::swap(m_pGetServers, pGetServers);
 
-		bool Success = true;
-		json_value *pJson = pGetServers->ResultJson();
-		Success = Success && pJson;
-		Success = Success && !Parse(pJson, &m_aServers, &m_aLegacyServers);
-		json_value_free(pJson);
-		if(!Success)
+		if(pGetServers->State() == HTTP_DONE)
+		{
+			std::swap(m_aServers, pGetServers->m_aServers);
+			std::swap(m_aLegacyServers, pGetServers->m_aLegacyServers);
+		}
+		else
 		{
 			m_pConsole->Print(IConsole::OUTPUT_LEVEL_STANDARD, "serverbrowse_http", "failed getting serverlist, trying to find best URL");
 			m_pChooseMaster->Reset();
@@ -350,6 +367,45 @@ bool ServerbrowserParseUrl(NETADDR *pOut, const char *pUrl)
 	}
 	return false;
 }
+int CServerBrowserHttp::CGetServers::OnCompletion(int State)
+{
+	if(State != HTTP_DONE)
+	{
+		return State;
+	}
+	int64_t StartTime = time_get();
+	int Size = BufferLength();
+	bool Error = ParseList((const char *)Buffer(), Size, &m_aServers, &m_aLegacyServers);
+	// the parsed list replaces the raw data, don't keep both around
+	FreeBuffer();
+	if(Error)
+	{
+		return HTTP_ERROR;
+	}
+	dbg_msg("serverbrowse_http", "parsed %d servers and %d legacy servers from %d bytes in %.2fms",
+		(int)m_aServers.size(), (int)m_aLegacyServers.size(), Size, (time_get() - StartTime) * 1000.0 / time_freq());
+	return State;
+}
+
+bool CServerBrowserHttp::ParseList(const char *pData, int Size, std::vector<CEntry> *paServers, std::vector<NETADDR> *paLegacyServers)
+{
+	json_value *pJson = json_parse(pData, Size);
+	bool Error = !pJson || Parse(pJson, paServers, paLegacyServers);
+	json_value_free(pJson);
+	return Error;
+}
+bool ServerbrowserParseList(const char *pData, int Size, int *pNumServers, int *pNumLegacyServers)
+{
+	std::vector<CServerBrowserHttp::CEntry> aServers;
+	std::vector<NETADDR> aLegacyServers;
+	if(CServerBrowserHttp::ParseList(pData, Size, &aServers, &aLegacyServers))
+	{
+		return true;
+	}
+	*pNumServers = aServers.size();
+	*pNumLegacyServers = aLegacyServers.size();
+	return false;
+}
 bool CServerBrowserHttp::Validate(json_value *pJson)
 {
 	std::vector<CEntry> aServers;
@@ -368,6 +424,8 @@ bool CServerBrowserHttp::Parse(json_value *pJson, std::vector<CEntry> *paServers
 	{
 		return true;
 	}
+	// every server has at least one address
+	aServers.reserve(Servers.u.array.length);
 	for(unsigned int i = 0; i < Servers.u.array.length; i++)
 	{
 		const json_value &Server = Servers[i];
@@ -429,8 +487,8 @@ bool CServerBrowserHttp::Parse(json_value *pJson, std::vector<CEntry> *paServers
 			aLegacyServers.push_back(ParsedAddr);
 		}
 	}
-	*paServers = aServers;
-	*paLegacyServers = aLegacyServers;
+	*paServers = std::move(aServers);
+	*paLegacyServers = std::move(aLegacyServers);
 	return false;
 }
 
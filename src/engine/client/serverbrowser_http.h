@@ -27,4 +27,7 @@ public:
 };
 
 IServerBrowserHttp *CreateServerBrowserHttp(IEngine *pEngine, IConsole *pConsole, IStorage *pStorage, const char *pPreviousBestUrl);
+// Parses a master server list the way the server browser does, returns true
+// on error.
+bool ServerbrowserParseList(const char *pData, int Size, int *pNumServers, int *pNumLegacyServers);
 #endif // ENGINE_CLIENT_SERVERBROWSER_HTTP_H
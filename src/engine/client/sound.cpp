@@ -281,10 +281,11 @@ static void SdlCallback(void *pUnused, Uint8 *pStream, int Len)
 {
 	(void)pUnused;
 #if defined(CONF_VIDEORECORDER)
+	// the video recorder mixes in CSound::Update, stay silent meanwhile
 	if(!(IVideo::Current() && g_Config.m_ClVideoSndEnable))
 		Mix((short *)pStream, Len / 2 / 2);
 	else
-		IVideo::Current()->NextAudioFrame(Mix);
+		mem_zero(pStream, Len);
 #else
 	Mix((short *)pStream, Len / 2 / 2);
 #endif
@@ -354,10 +355,12 @@ int CSound::Update()
 		m_SoundVolume = WantedVolume;
 		lock_unlock(m_SoundLock);
 	}
-	//#if defined(CONF_VIDEORECORDER)
-	//	if(IVideo::Current() && g_Config.m_ClVideoSndEnable)
-	//		IVideo::Current()->NextAudioFrame(Mix);
-	//#endif
+#if defined(CONF_VIDEORECORDER)
+	// mix the audio for the video independently of the sound device, so it
+	// keeps up with the video frames however fast they are rendered
+	if(m_SoundEnabled && IVideo::Current() && g_Config.m_ClVideoSndEnable)
+		IVideo::Current()->NextAudioFrame(Mix);
+#endif
 	return 0;
 }
 
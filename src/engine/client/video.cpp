@@ -16,7 +16,6 @@
 
 #define STREAM_PIX_FMT AV_PIX_FMT_YUV420P /* default pix_fmt */
 
-const size_t FORMAT_NCHANNELS = 3;
 const size_t FORMAT_GL_NCHANNELS = 4;
 LOCK g_WriteLock = 0;
 
@@ -27,11 +26,15 @@ CVideo::CVideo(CGraphics_Threaded *pGraphics, IStorage *pStorage, IConsole *pCon
 	m_VideoStream(),
 	m_AudioStream()
 {
-	m_pPixels = 0;
+	for(auto &pPixels : m_apPixels)
+		pPixels = 0;
+	m_FramesQueued = 0;
+	m_FramesEncoded = 0;
+	m_StopEncoding = false;
+	m_pEncodeThread = 0;
 
 	m_pFormatContext = 0;
 	m_pFormat = 0;
-	m_pRGB = 0;
 	m_pOptDict = 0;
 
 	m_VideoCodec = 0;
@@ -101,10 +104,9 @@ void CVideo::Start()
 
 	m_pFormat = m_pFormatContext->oformat;
 
-	size_t NVals = FORMAT_NCHANNELS * m_Width * m_Height;
 	size_t GLNVals = FORMAT_GL_NCHANNELS * m_Width * m_Height;
-	m_pPixels = (uint8_t *)malloc(GLNVals * sizeof(TWGLubyte));
-	m_pRGB = (uint8_t *)malloc(NVals * sizeof(uint8_t));
+	for(auto &pPixels : m_apPixels)
+		pPixels = (TWGLubyte *)malloc(GLNVals * sizeof(TWGLubyte));
 
 	/* Add the audio and video streams using the default format codecs
 	 * and initialize the codecs. */
@@ -157,7 +159,7 @@ void CVideo::Start()
 	{
 		m_VideoStream.pSwsCtx = sws_getCachedContext(
 			m_VideoStream.pSwsCtx,
-			m_VideoStream.pEnc->width, m_VideoStream.pEnc->height, AV_PIX_FMT_RGB24,
+			m_VideoStream.pEnc->width, m_VideoStream.pEnc->height, AV_PIX_FMT_RGBA,
 			m_VideoStream.pEnc->width, m_VideoStream.pEnc->height, AV_PIX_FMT_YUV420P,
 			0, 0, 0, 0);
 	}
@@ -171,6 +173,11 @@ void CVideo::Start()
 		dbg_msg("video_recorder", "Error occurred when opening output file: %s", aBuf);
 		return;
 	}
+
+	for(int i = 0; i < NUM_FRAME_SLOTS; i++)
+		m_FreeSlots.Signal();
+	m_pEncodeThread = thread_init(EncodeThread, this, "video encode");
+
 	m_Recording = true;
 	m_Started = true;
 	ms_Time = time_get();
@@ -190,6 +197,15 @@ void CVideo::Stop()
 	while(m_ProcessingVideoFrame || m_ProcessingAudioFrame)
 		thread_sleep(10);
 
+	if(m_pEncodeThread)
+	{
+		// let the encode thread finish the queued frames
+		m_StopEncoding = true;
+		m_FilledSlots.Signal();
+		thread_wait(m_pEncodeThread);
+		m_pEncodeThread = 0;
+	}
+
 	FinishFrames(&m_VideoStream);
 
 	if(m_HasAudio)
@@ -209,11 +225,11 @@ void CVideo::Stop()
 	if(m_pFormatContext)
 		avformat_free_context(m_pFormatContext);
 
-	if(m_pRGB)
-		free(m_pRGB);
-
-	if(m_pPixels)
-		free(m_pPixels);
+	for(auto &pPixels : m_apPixels)
+	{
+		free(pPixels);
+		pPixels = 0;
+	}
 
 	if(ms_pCurrentVideo)
 		delete ms_pCurrentVideo;
@@ -230,14 +246,13 @@ void CVideo::NextVideoFrameThread()
 		if(m_Vseq >= 2)
 		{
 			m_ProcessingVideoFrame = true;
-			m_VideoStream.pFrame->pts = (int64_t)m_VideoStream.pEnc->frame_number;
-			//dbg_msg("video_recorder", "vframe: %d", m_VideoStream.pEnc->frame_number);
-
-			ReadRGBFromGL();
-			FillVideoFrame();
-			lock_wait(g_WriteLock);
-			WriteFrame(&m_VideoStream);
-			lock_unlock(g_WriteLock);
+
+			// only the read back has to happen on the backend thread, the
+			// conversion and the encoding are done by the encode thread
+			m_FreeSlots.Wait();
+			ReadRGBFromGL(m_apPixels[m_FramesQueued % NUM_FRAME_SLOTS]);
+			m_FramesQueued++;
+			m_FilledSlots.Signal();
 			m_ProcessingVideoFrame = false;
 		}
 
@@ -247,6 +262,34 @@ void CVideo::NextVideoFrameThread()
 	}
 }
 
+void CVideo::EncodeThread(void *pUser)
+{
+	((CVideo *)pUser)->EncodeFrames();
+}
+
+void CVideo::EncodeFrames()
+{
+	while(true)
+	{
+		m_FilledSlots.Wait();
+		// Stop() signals once more after the last frame
+		if(m_StopEncoding && m_FramesEncoded == m_FramesQueued)
+			break;
+
+		m_VideoStream.pFrame->pts = (int64_t)m_VideoStream.pEnc->frame_number;
+		//dbg_msg("video_recorder", "vframe: %d", m_VideoStream.pEnc->frame_number);
+
+		FillVideoFrame(m_apPixels[m_FramesEncoded % NUM_FRAME_SLOTS]);
+		m_FramesEncoded++;
+		// the slot isn't needed anymore once the frame is converted
+		m_FreeSlots.Signal();
+
+		lock_wait(g_WriteLock);
+		WriteFrame(&m_VideoStream);
+		lock_unlock(g_WriteLock);
+	}
+}
+
 void CVideo::NextVideoFrame()
 {
 	if(m_Recording)
@@ -274,7 +317,7 @@ void CVideo::NextAudioFrameTimeline()
 	if(m_Recording && m_HasAudio)
 	{
 		//if(m_Vframe * m_AudioStream.pEnc->sample_rate / m_FPS >= m_AudioStream.pEnc->frame_number*m_AudioStream.pEnc->frame_size)
-		if(m_VideoStream.pEnc->frame_number * (double)m_AudioStream.pEnc->sample_rate / m_FPS >= (double)m_AudioStream.pEnc->frame_number * m_AudioStream.pEnc->frame_size)
+		if(m_FramesQueued * (double)m_AudioStream.pEnc->sample_rate / m_FPS >= (double)m_AudioStream.pEnc->frame_number * m_AudioStream.pEnc->frame_size)
 		{
 			m_NextAudioFrame = true;
 		}
@@ -364,32 +407,25 @@ void CVideo::FillAudioFrame()
 {
 }
 
-void CVideo::FillVideoFrame()
+void CVideo::FillVideoFrame(const TWGLubyte *pPixels)
 {
-	const int InLinesize[1] = {3 * m_VideoStream.pEnc->width};
-	sws_scale(m_VideoStream.pSwsCtx, (const uint8_t *const *)&m_pRGB, InLinesize, 0,
+	// GL returns the rows bottom up, start at the top row and walk backwards
+	// instead of flipping the image first
+	const uint8_t *apIn[1] = {pPixels + FORMAT_GL_NCHANNELS * m_Width * (m_Height - 1)};
+	const int aInLinesize[1] = {-(int)FORMAT_GL_NCHANNELS * m_Width};
+	sws_scale(m_VideoStream.pSwsCtx, apIn, aInLinesize, 0,
 		m_VideoStream.pEnc->height, m_VideoStream.pFrame->data, m_VideoStream.pFrame->linesize);
 }
 
-void CVideo::ReadRGBFromGL()
+void CVideo::ReadRGBFromGL(TWGLubyte *pPixels)
 {
 	/* Get RGBA to align to 32 bits instead of just 24 for RGB. May be faster for FFmpeg. */
 	glReadBuffer(GL_FRONT);
 	GLint Alignment;
 	glGetIntegerv(GL_PACK_ALIGNMENT, &Alignment);
 	glPixelStorei(GL_PACK_ALIGNMENT, 1);
-	glReadPixels(0, 0, m_Width, m_Height, GL_RGBA, GL_UNSIGNED_BYTE, m_pPixels);
+	glReadPixels(0, 0, m_Width, m_Height, GL_RGBA, GL_UNSIGNED_BYTE, pPixels);
 	glPixelStorei(GL_PACK_ALIGNMENT, Alignment);
-	for(int i = 0; i < m_Height; i++)
-	{
-		for(int j = 0; j < m_Width; j++)
-		{
-			size_t CurGL = FORMAT_GL_NCHANNELS * (m_Width * (m_Height - i - 1) + j);
-			size_t CurRGB = FORMAT_NCHANNELS * (m_Width * i + j);
-			for(int k = 0; k < (int)FORMAT_NCHANNELS; k++)
-				m_pRGB[CurRGB + k] = m_pPixels[CurGL + k];
-		}
-	}
 }
 
 AVFrame *CVideo::AllocPicture(enum AVPixelFormat PixFmt, int Width, int Height)
@@ -2,9 +2,12 @@
 #define ENGINE_CLIENT_VIDEO_H
 
 #include <base/system.h>
+#include <base/tl/threading.h>
 
 #include "graphics_defines.h"
 
+#include <atomic>
+
 extern "C" {
 #include <libavcodec/avcodec.h>
 #include <libavformat/avformat.h>
@@ -61,8 +64,17 @@ public:
 	static void Init() { av_log_set_level(AV_LOG_DEBUG); }
 
 private:
-	void FillVideoFrame();
-	void ReadRGBFromGL();
+	enum
+	{
+		// frames that can be read back before the encoder has to catch up
+		NUM_FRAME_SLOTS = 4,
+	};
+
+	static void EncodeThread(void *pUser);
+	void EncodeFrames();
+
+	void FillVideoFrame(const TWGLubyte *pPixels);
+	void ReadRGBFromGL(TWGLubyte *pPixels);
 
 	void FillAudioFrame();
 
@@ -102,7 +114,15 @@ private:
 
 	bool m_HasAudio;
 
-	TWGLubyte *m_pPixels;
+	// the backend thread reads the frames back into these slots, the
+	// encode thread converts and encodes them in the same order
+	TWGLubyte *m_apPixels[NUM_FRAME_SLOTS];
+	CSemaphore m_FreeSlots;
+	CSemaphore m_FilledSlots;
+	std::atomic<int> m_FramesQueued;
+	int m_FramesEncoded;
+	std::atomic<bool> m_StopEncoding;
+	void *m_pEncodeThread;
 
 	OutputStream m_VideoStream;
 	OutputStream m_AudioStream;
@@ -115,8 +135,6 @@ private:
 	AVFormatContext *m_pFormatContext;
 	AVOutputFormat *m_pFormat;
 
-	uint8_t *m_pRGB;
-
 	int m_SndBufferSize;
 };
 
@@ -402,6 +402,15 @@ public:
 	virtual void Swap() = 0;
 	virtual int GetNumScreens() const = 0;
 
+	// command lists are recorded independently of the frame and are added to it by submitting them.
+	// the order of the submissions defines the render order, not the order of the recording
+	virtual int CreateCommandList() = 0;
+	virtual void DeleteCommandList(int ListIndex) = 0;
+	// while a command list is recorded, all render calls are recorded into it instead of the frame
+	virtual void BeginCommandList(int ListIndex) = 0;
+	virtual void EndCommandList() = 0;
+	virtual void SubmitCommandList(int ListIndex) = 0;
+
 	// synchronization
 	virtual void InsertSignal(class CSemaphore *pSemaphore) = 0;
 	virtual bool IsIdle() const = 0;
@@ -246,6 +246,8 @@ public:
 	virtual char *GetMapName() const = 0;
 
 	virtual bool IsSixup(int ClientID) const = 0;
+
+	virtual class CProfiler *Profiler() = 0;
 };
 
 class IGameServer : public IInterface
@@ -308,6 +310,11 @@ public:
 	virtual void OnClientEngineDrop(int ClientID, const char *pReason) = 0;
 
 	virtual void FillAntibot(CAntibotRoundData *pData) = 0;
+
+	// used to replay teehistorian files, restores the recorded random seed
+	// and returns the current character core of a client
+	virtual bool SeedPrng(const char *pDescription) = 0;
+	virtual bool CharacterCore(int ClientID, CNetObj_CharacterCore *pCore, int *pSpawnTick) = 0;
 };
 
 extern IGameServer *CreateGameServer();
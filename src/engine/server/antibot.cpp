@@ -7,7 +7,7 @@
 
 #ifdef CONF_ANTIBOT
 CAntibot::CAntibot() :
-	m_pServer(0), m_pConsole(0), m_pGameServer(0), m_Initialized(false)
+	m_pServer(0), m_pConsole(0), m_pGameServer(0), m_Initialized(false), m_NumEvents(0)
 {
 }
 CAntibot::~CAntibot()
@@ -63,10 +63,14 @@ void CAntibot::Init()
 	m_Data.m_pUser = this;
 	AntibotInit(&m_Data);
 
+	if(m_Data.m_ModuleFlags & ANTIBOT_MODULEFLAG_BATCH_EVENTS)
+		Console()->Print(IConsole::OUTPUT_LEVEL_DEBUG, "antibot", "module receives game hooks in batches");
+
 	m_Initialized = true;
 }
 void CAntibot::RoundStart(IGameServer *pGameServer)
 {
+	FlushEvents();
 	m_pGameServer = pGameServer;
 	mem_zero(&m_RoundData, sizeof(m_RoundData));
 	m_RoundData.m_Map.m_pTiles = 0;
@@ -76,13 +80,18 @@ void CAntibot::RoundStart(IGameServer *pGameServer)
 void CAntibot::RoundEnd()
 {
 	// Let the external module clean up first
+	FlushEvents();
 	AntibotRoundEnd();
 
 	m_pGameServer = 0;
 	if(m_RoundData.m_Map.m_pTiles)
 		free(m_RoundData.m_Map.m_pTiles);
 }
-void CAntibot::Dump() { AntibotDump(); }
+void CAntibot::Dump()
+{
+	FlushEvents();
+	AntibotDump();
+}
 void CAntibot::Update()
 {
 	m_Data.m_Now = time_get();
@@ -94,71 +103,120 @@ void CAntibot::Update()
 		AntibotUpdateData();
 	}
 }
+bool CAntibot::AddEvent(int Type, int ClientID, int Arg)
+{
+	if(!(m_Data.m_ModuleFlags & ANTIBOT_MODULEFLAG_BATCH_EVENTS))
+		return false;
+
+	if(m_NumEvents == ANTIBOT_MAX_EVENTS)
+		FlushEvents();
+
+	CAntibotEvent *pEvent = &m_aEvents[m_NumEvents++];
+	pEvent->m_Type = Type;
+	pEvent->m_ClientID = ClientID;
+	pEvent->m_Tick = Server()->Tick();
+	pEvent->m_Arg = Arg;
+	return true;
+}
+bool CAntibot::FlushEvents()
+{
+	// hand over the collected hooks before anything that isn't batched so
+	// the module sees everything in order
+	if(!m_NumEvents)
+		return false;
+
+	Update();
+	AntibotOnEvents(m_aEvents, m_NumEvents);
+	m_NumEvents = 0;
+	return true;
+}
 
 void CAntibot::OnPlayerInit(int ClientID)
 {
+	if(AddEvent(ANTIBOT_EVENT_PLAYER_INIT, ClientID))
+		return;
 	Update();
 	AntibotOnPlayerInit(ClientID);
 }
 void CAntibot::OnPlayerDestroy(int ClientID)
 {
+	if(AddEvent(ANTIBOT_EVENT_PLAYER_DESTROY, ClientID))
+		return;
 	Update();
 	AntibotOnPlayerDestroy(ClientID);
 }
 void CAntibot::OnSpawn(int ClientID)
 {
+	if(AddEvent(ANTIBOT_EVENT_SPAWN, ClientID))
+		return;
 	Update();
 	AntibotOnSpawn(ClientID);
 }
 void CAntibot::OnHammerFireReloading(int ClientID)
 {
+	if(AddEvent(ANTIBOT_EVENT_HAMMER_FIRE_RELOADING, ClientID))
+		return;
 	Update();
 	AntibotOnHammerFireReloading(ClientID);
 }
 void CAntibot::OnHammerFire(int ClientID)
 {
+	if(AddEvent(ANTIBOT_EVENT_HAMMER_FIRE, ClientID))
+		return;
 	Update();
 	AntibotOnHammerFire(ClientID);
 }
 void CAntibot::OnHammerHit(int ClientID)
 {
+	if(AddEvent(ANTIBOT_EVENT_HAMMER_HIT, ClientID))
+		return;
 	Update();
 	AntibotOnHammerHit(ClientID);
 }
 void CAntibot::OnDirectInput(int ClientID)
 {
+	if(AddEvent(ANTIBOT_EVENT_DIRECT_INPUT, ClientID))
+		return;
 	Update();
 	AntibotOnDirectInput(ClientID);
 }
 void CAntibot::OnCharacterTick(int ClientID)
 {
+	if(AddEvent(ANTIBOT_EVENT_CHARACTER_TICK, ClientID))
+		return;
 	Update();
 	AntibotOnCharacterTick(ClientID);
 }
 void CAntibot::OnHookAttach(int ClientID, bool Player)
 {
+	if(AddEvent(ANTIBOT_EVENT_HOOK_ATTACH, ClientID, Player))
+		return;
 	Update();
 	AntibotOnHookAttach(ClientID, Player);
 }
 
 void CAntibot::OnEngineTick()
 {
-	Update();
+	if(!FlushEvents())
+		Update();
 	AntibotOnEngineTick();
 }
 void CAntibot::OnEngineClientJoin(int ClientID, bool Sixup)
 {
-	Update();
+	if(!FlushEvents())
+		Update();
 	AntibotOnEngineClientJoin(ClientID, Sixup);
 }
 void CAntibot::OnEngineClientDrop(int ClientID, const char *pReason)
 {
-	Update();
+	if(!FlushEvents())
+		Update();
 	AntibotOnEngineClientDrop(ClientID, pReason);
 }
 bool CAntibot::OnEngineClientMessage(int ClientID, const void *pData, int Size, int Flags)
 {
-	Update();
+	if(!FlushEvents())
+		Update();
 	int AntibotFlags = 0;
 	if((Flags & MSGFLAG_VITAL) == 0)
 	{
@@ -168,7 +226,8 @@ bool CAntibot::OnEngineClientMessage(int ClientID, const void *pData, int Size,
 }
 bool CAntibot::OnEngineServerMessage(int ClientID, const void *pData, int Size, int Flags)
 {
-	Update();
+	if(!FlushEvents())
+		Update();
 	int AntibotFlags = 0;
 	if((Flags & MSGFLAG_VITAL) == 0)
 	{
@@ -178,6 +237,7 @@ bool CAntibot::OnEngineServerMessage(int ClientID, const void *pData, int Size,
 }
 bool CAntibot::OnEngineSimulateClientMessage(int *pClientID, void *pBuffer, int BufferSize, int *pOutSize, int *pFlags)
 {
+	FlushEvents();
 	int AntibotFlags = 0;
 	bool Result = AntibotOnEngineSimulateClientMessage(pClientID, pBuffer, BufferSize, pOutSize, &AntibotFlags);
 	if(Result)
@@ -192,7 +252,7 @@ bool CAntibot::OnEngineSimulateClientMessage(int *pClientID, void *pBuffer, int
 }
 #else
 CAntibot::CAntibot() :
-	m_pServer(0), m_pConsole(0), m_pGameServer(0), m_Initialized(false)
+	m_pServer(0), m_pConsole(0), m_pGameServer(0), m_Initialized(false), m_NumEvents(0)
 {
 }
 CAntibot::~CAntibot()
@@ -219,6 +279,8 @@ void CAntibot::Dump()
 void CAntibot::Update()
 {
 }
+bool CAntibot::AddEvent(int Type, int ClientID, int Arg) { return false; }
+bool CAntibot::FlushEvents() { return false; }
 
 void CAntibot::OnPlayerInit(int ClientID) {}
 void CAntibot::OnPlayerDestroy(int ClientID) {}
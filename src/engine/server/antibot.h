@@ -18,7 +18,13 @@ class CAntibot : public IEngineAntibot
 	CAntibotRoundData m_RoundData;
 	bool m_Initialized;
 
+	// game hooks collected for the next AntibotOnEvents batch
+	CAntibotEvent m_aEvents[ANTIBOT_MAX_EVENTS];
+	int m_NumEvents;
+
 	void Update();
+	bool AddEvent(int Type, int ClientID, int Arg = 0);
+	bool FlushEvents();
 	static void Send(int ClientID, const void *pData, int Size, int Flags, void *pUser);
 	static void Log(const char *pMessage, void *pUser);
 	static void Report(int ClientID, const char *pMessage, void *pUser);
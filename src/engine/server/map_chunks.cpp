@@ -0,0 +1,108 @@
+#include "map_chunks.h"
+
+#include <base/math.h>
+
+#include <engine/shared/packer.h>
+#include <engine/shared/protocol.h>
+
+void CMapChunks::Init(const unsigned char *pMap, int MapSize, unsigned MapCrc, int ChunkSize, bool Sixup)
+{
+	dbg_assert(ChunkSize > 0 && ChunkSize <= MAP_CHUNK_SIZE_LARGE, "invalid map chunk size");
+
+	Clear();
+	m_ChunkSize = ChunkSize;
+	m_MapSize = MapSize;
+
+	int NumChunks = MapSize > 0 ? (MapSize + ChunkSize - 1) / ChunkSize : 1;
+	m_vData.reserve(MapSize + NumChunks * 16);
+	m_vOffsets.reserve(NumChunks + 1);
+
+	CPacker Packer;
+	for(int Chunk = 0; Chunk < NumChunks; Chunk++)
+	{
+		int Offset = Chunk * ChunkSize;
+		int Size = minimum(ChunkSize, MapSize - Offset);
+
+		// same layout as a CMsgPacker(NETMSG_MAP_DATA, true) repacked by the server
+		Packer.Reset();
+		Packer.AddInt((NETMSG_MAP_DATA << 1) | 1);
+		if(!Sixup)
+		{
+			Packer.AddInt(Chunk == NumChunks - 1);
+			Packer.AddInt(MapCrc);
+			Packer.AddInt(Chunk);
+			Packer.AddInt(Size);
+		}
+		Packer.AddRaw(pMap + Offset, Size);
+		dbg_assert(!Packer.Error(), "map chunk too large");
+
+		m_vOffsets.push_back(m_vData.size());
+		m_vData.insert(m_vData.end(), Packer.Data(), Packer.Data() + Packer.Size());
+	}
+	m_vOffsets.push_back(m_vData.size());
+}
+
+void CMapChunks::Clear()
+{
+	m_vData.clear();
+	m_vData.shrink_to_fit();
+	m_vOffsets.clear();
+	m_ChunkSize = 0;
+	m_MapSize = 0;
+}
+
+int CMapChunks::ChunkDataSize(int Chunk) const
+{
+	if(Chunk < 0 || Chunk >= NumChunks())
+		return 0;
+	return minimum(m_ChunkSize, m_MapSize - Chunk * m_ChunkSize);
+}
+
+const unsigned char *CMapChunks::Msg(int Chunk, int *pSize) const
+{
+	if(Chunk < 0 || Chunk >= NumChunks())
+		return 0;
+	*pSize = m_vOffsets[Chunk + 1] - m_vOffsets[Chunk];
+	return &m_vData[m_vOffsets[Chunk]];
+}
+
+void CMapDownloadWindow::Init(int Window, int MaxWindow)
+{
+	for(int i = 0; i < HISTORY; i++)
+		m_aSentChunk[i] = -1;
+	m_MinRtt = -1;
+	m_SmoothedRtt = -1;
+	m_MaxWindow = clamp(MaxWindow, 0, (int)HISTORY - 1);
+	m_Window = clamp(Window, 0, m_MaxWindow);
+	m_NumAcks = 0;
+}
+
+void CMapDownloadWindow::OnSend(int Chunk, int64_t Time)
+{
+	// only the first transmission gives a meaningful sample
+	if(Chunk < 0 || m_aSentChunk[Chunk % HISTORY] == Chunk)
+		return;
+	m_aSentChunk[Chunk % HISTORY] = Chunk;
+	m_aSentTime[Chunk % HISTORY] = Time;
+}
+
+void CMapDownloadWindow::OnAck(int Chunk, int64_t Time)
+{
+	if(Chunk < 0 || m_aSentChunk[Chunk % HISTORY] != Chunk)
+		return;
+
+	int64_t Rtt = maximum(Time - m_aSentTime[Chunk % HISTORY], (int64_t)0);
+	m_MinRtt = m_MinRtt < 0 ? Rtt : minimum(m_MinRtt, Rtt);
+	m_SmoothedRtt = m_SmoothedRtt < 0 ? Rtt : (m_SmoothedRtt * 7 + Rtt) / 8;
+
+	// adjust at most once per window worth of acks
+	if(++m_NumAcks <= m_Window)
+		return;
+	m_NumAcks = 0;
+
+	// allow some jitter on top of the base RTT before backing off
+	if(m_SmoothedRtt > m_MinRtt * 2 + time_freq() / 100)
+		m_Window = clamp(m_Window - 1, minimum(1, m_MaxWindow), m_MaxWindow);
+	else
+		m_Window = minimum(m_Window + 1, m_MaxWindow);
+}
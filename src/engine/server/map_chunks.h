@@ -0,0 +1,78 @@
+#ifndef ENGINE_SERVER_MAP_CHUNKS_H
+#define ENGINE_SERVER_MAP_CHUNKS_H
+
+#include <base/system.h>
+
+#include <vector>
+
+enum
+{
+	MAP_CHUNK_SIZE_COMPAT = 1024 - 128,
+	// the 0.6 chunk header stores the size in 10 bits, leave room for the message header
+	MAP_CHUNK_SIZE_DDNET = 1024 - 16,
+	// fits into a single packet together with the chunk, message and packet headers
+	MAP_CHUNK_SIZE_LARGE = 1280,
+};
+
+// all NETMSG_MAP_DATA messages of one map, packed once on map load and
+// shared by every downloading client
+class CMapChunks
+{
+	std::vector<unsigned char> m_vData;
+	std::vector<int> m_vOffsets;
+	int m_ChunkSize;
+	int m_MapSize;
+
+public:
+	CMapChunks() :
+		m_ChunkSize(0), m_MapSize(0) {}
+
+	void Init(const unsigned char *pMap, int MapSize, unsigned MapCrc, int ChunkSize, bool Sixup);
+	void Clear();
+
+	bool Valid() const { return m_ChunkSize > 0; }
+	int ChunkSize() const { return m_ChunkSize; }
+	int MapSize() const { return m_MapSize; }
+	int NumChunks() const { return m_vOffsets.empty() ? 0 : (int)m_vOffsets.size() - 1; }
+	// number of map bytes carried by the chunk
+	int ChunkDataSize(int Chunk) const;
+	// the packed message of the chunk, 0 if it is out of range
+	const unsigned char *Msg(int Chunk, int *pSize) const;
+};
+
+// send-ahead window of a single map download
+//
+// The client requests chunk N after it received chunk N-1, which gives a
+// round trip time sample for every chunk. The window grows by one chunk per
+// window while the smoothed RTT stays close to the minimum and shrinks when
+// it rises, i.e. when the data starts queueing somewhere on the path.
+class CMapDownloadWindow
+{
+	enum
+	{
+		HISTORY = 64,
+	};
+
+	int m_aSentChunk[HISTORY];
+	int64_t m_aSentTime[HISTORY];
+	int64_t m_MinRtt;
+	int64_t m_SmoothedRtt;
+	int m_Window;
+	int m_MaxWindow;
+	int m_NumAcks;
+
+public:
+	CMapDownloadWindow() { Init(0, 0); }
+
+	void Init(int Window, int MaxWindow);
+	void OnSend(int Chunk, int64_t Time);
+	// the client has received the chunk
+	void OnAck(int Chunk, int64_t Time);
+
+	// number of chunks sent ahead of the requested one
+	int Window() const { return m_Window; }
+	// smoothed round trip time in time_freq() units, -1 if unknown
+	int64_t Rtt() const { return m_SmoothedRtt; }
+};
+
+#endif
@@ -1,5 +1,9 @@
 #include "name_ban.h"
 
+#include <base/math.h>
+
+#include <algorithm>
+
 CNameBan *IsNameBanned(const char *pName, CNameBan *pNameBans, int NumNameBans)
 {
 	char aTrimmed[MAX_NAME_LENGTH];
@@ -22,3 +26,178 @@ CNameBan *IsNameBanned(const char *pName, CNameBan *pNameBans, int NumNameBans)
 	}
 	return pResult;
 }
+
+void CNameSkeleton::Set(const char *pName)
+{
+	str_copy(m_aName, pName, sizeof(m_aName));
+	m_Length = str_utf8_to_skeleton(m_aName, m_aSkeleton, sizeof(m_aSkeleton) / sizeof(m_aSkeleton[0]));
+
+	// FNV-1a
+	m_Hash = 2166136261u;
+	for(int i = 0; i < m_Length; i++)
+	{
+		m_Hash ^= (unsigned)m_aSkeleton[i];
+		m_Hash *= 16777619u;
+	}
+}
+
+static int SkeletonDistance(const CNameBan &Ban, const int *pSkeleton, int SkeletonLength)
+{
+	int aBuffer[MAX_NAME_SKELETON_LENGTH * 2 + 2];
+	return str_utf32_dist_buffer(pSkeleton, SkeletonLength, Ban.m_aSkeleton, Ban.m_SkeletonLength, aBuffer, sizeof(aBuffer) / sizeof(aBuffer[0]));
+}
+
+// the skeleton is padded with 0 on both sides, a skeleton of length N has N + 1 bigrams
+static int SkeletonBigrams(const int *pSkeleton, int SkeletonLength, uint64_t *pBigrams)
+{
+	for(int i = 0; i <= SkeletonLength; i++)
+	{
+		uint32_t First = i > 0 ? pSkeleton[i - 1] : 0;
+		uint32_t Second = i < SkeletonLength ? pSkeleton[i] : 0;
+		pBigrams[i] = ((uint64_t)First << 32) | Second;
+	}
+	std::sort(pBigrams, pBigrams + SkeletonLength + 1);
+	return SkeletonLength + 1;
+}
+
+// minimum number of shared bigrams of two skeletons within the given edit distance
+static int MinSharedBigrams(int Length1, int Length2, int Distance)
+{
+	return maximum(Length1, Length2) + 1 - 2 * Distance;
+}
+
+void CNameBans::Insert(int Ban)
+{
+	const CNameBan &NewBan = m_vBans[Ban];
+	if(NewBan.m_IsSubstring == 1)
+		m_vSubstringBans.push_back(Ban);
+
+	if(MinSharedBigrams(NewBan.m_SkeletonLength, 0, NewBan.m_Distance) <= 0)
+	{
+		m_vUnfilteredBans.push_back(Ban);
+		return;
+	}
+
+	uint64_t aBigrams[MAX_NAME_SKELETON_LENGTH + 1];
+	int NumBigrams = SkeletonBigrams(NewBan.m_aSkeleton, NewBan.m_SkeletonLength, aBigrams);
+	for(int i = 0; i < NumBigrams;)
+	{
+		int Count = 1;
+		while(i + Count < NumBigrams && aBigrams[i + Count] == aBigrams[i])
+			Count++;
+		m_BigramIndex[aBigrams[i]].push_back({Ban, Count});
+		i += Count;
+	}
+}
+
+void CNameBans::Rebuild()
+{
+	m_BigramIndex.clear();
+	m_vUnfilteredBans.clear();
+	m_vSubstringBans.clear();
+	for(int i = 0; i < (int)m_vBans.size(); i++)
+		Insert(i);
+}
+
+int CNameBans::Find(const char *pName) const
+{
+	for(int i = 0; i < (int)m_vBans.size(); i++)
+	{
+		if(str_comp(m_vBans[i].m_aName, pName) == 0)
+			return i;
+	}
+	return -1;
+}
+
+void CNameBans::Add(const CNameBan &Ban)
+{
+	m_vBans.push_back(Ban);
+	m_vSharedBigrams.push_back(0);
+	Insert(m_vBans.size() - 1);
+}
+
+void CNameBans::Update(int Index, int Distance, int IsSubstring, const char *pReason)
+{
+	CNameBan &Ban = m_vBans[Index];
+	bool Changed = Ban.m_Distance != Distance || Ban.m_IsSubstring != IsSubstring;
+	Ban.m_Distance = Distance;
+	Ban.m_IsSubstring = IsSubstring;
+	str_copy(Ban.m_aReason, pReason, sizeof(Ban.m_aReason));
+
+	if(Changed)
+		Rebuild();
+}
+
+void CNameBans::Remove(int Index)
+{
+	m_vBans.erase(m_vBans.begin() + Index);
+	m_vSharedBigrams.pop_back();
+	Rebuild();
+}
+
+void CNameBans::Clear()
+{
+	m_vBans.clear();
+	m_vSharedBigrams.clear();
+	Rebuild();
+}
+
+CNameBan *CNameBans::IsBanned(const char *pName)
+{
+	if(m_vBans.empty())
+		return 0;
+
+	char aTrimmed[MAX_NAME_LENGTH];
+	str_copy(aTrimmed, str_utf8_skip_whitespaces(pName), sizeof(aTrimmed));
+	str_utf8_trim_right(aTrimmed);
+
+	int aSkeleton[MAX_NAME_SKELETON_LENGTH];
+	int SkeletonLength = str_utf8_to_skeleton(aTrimmed, aSkeleton, sizeof(aSkeleton) / sizeof(aSkeleton[0]));
+
+	// like `IsNameBanned`, the last matching ban wins
+	int Result = -1;
+	for(int Ban : m_vSubstringBans)
+	{
+		if(Ban > Result && str_utf8_find_nocase(pName, m_vBans[Ban].m_aName))
+			Result = Ban;
+	}
+
+	for(int Ban : m_vUnfilteredBans)
+	{
+		if(Ban > Result && SkeletonDistance(m_vBans[Ban], aSkeleton, SkeletonLength) <= m_vBans[Ban].m_Distance)
+			Result = Ban;
+	}
+
+	// count the shared bigrams with every ban
+	uint64_t aBigrams[MAX_NAME_SKELETON_LENGTH + 1];
+	int NumBigrams = SkeletonBigrams(aSkeleton, SkeletonLength, aBigrams);
+	for(int i = 0; i < NumBigrams;)
+	{
+		int Count = 1;
+		while(i + Count < NumBigrams && aBigrams[i + Count] == aBigrams[i])
+			Count++;
+
+		auto Postings = m_BigramIndex.find(aBigrams[i]);
+		if(Postings != m_BigramIndex.end())
+		{
+			for(const SPosting &Posting : Postings->second)
+			{
+				if(m_vSharedBigrams[Posting.m_Ban] == 0)
+					m_vTouchedBans.push_back(Posting.m_Ban);
+				m_vSharedBigrams[Posting.m_Ban] += minimum(Count, Posting.m_Count);
+			}
+		}
+		i += Count;
+	}
+
+	for(int Ban : m_vTouchedBans)
+	{
+		const CNameBan &Candidate = m_vBans[Ban];
+		if(Ban > Result && m_vSharedBigrams[Ban] >= MinSharedBigrams(SkeletonLength, Candidate.m_SkeletonLength, Candidate.m_Distance) && SkeletonDistance(Candidate, aSkeleton, SkeletonLength) <= Candidate.m_Distance)
+			Result = Ban;
+		m_vSharedBigrams[Ban] = 0;
+	}
+	m_vTouchedBans.clear();
+
+	return Result == -1 ? 0 : &m_vBans[Result];
+}
@@ -4,6 +4,9 @@
 #include <base/system.h>
 #include <engine/shared/protocol.h>
 
+#include <unordered_map>
+#include <vector>
+
 enum
 {
 	MAX_NAME_SKELETON_LENGTH = MAX_NAME_LENGTH * 4,
@@ -31,4 +34,69 @@ public:
 
 CNameBan *IsNameBanned(const char *pName, CNameBan *pNameBans, int NumNameBans);
 
+// the confusable skeleton of a name, two names are confusable if their skeletons are equal
+class CNameSkeleton
+{
+	char m_aName[MAX_NAME_LENGTH];
+	int m_aSkeleton[MAX_NAME_SKELETON_LENGTH];
+	int m_Length;
+	unsigned m_Hash;
+
+public:
+	CNameSkeleton() { Set(""); }
+	CNameSkeleton(const char *pName) { Set(pName); }
+
+	void Set(const char *pName);
+	// only recomputes the skeleton if the name changed
+	void Update(const char *pName)
+	{
+		if(str_comp(m_aName, pName) != 0)
+			Set(pName);
+	}
+
+	bool IsConfusable(const CNameSkeleton &Other) const
+	{
+		return m_Hash == Other.m_Hash && m_Length == Other.m_Length && mem_comp(m_aSkeleton, Other.m_aSkeleton, m_Length * sizeof(m_aSkeleton[0])) == 0;
+	}
+};
+
+// name bans with an inverted index over the bigrams of their skeletons.
+// an edit can destroy at most two bigrams, so a name within the distance of
+// a ban shares a minimum number of bigrams with it, bans that don't reach
+// that count are skipped without computing the edit distance
+class CNameBans
+{
+	struct SPosting
+	{
+		int m_Ban;
+		int m_Count;
+	};
+
+	std::vector<CNameBan> m_vBans;
+	std::unordered_map<uint64_t, std::vector<SPosting>> m_BigramIndex;
+	// bans whose distance is too large compared to their length to be filtered
+	std::vector<int> m_vUnfilteredBans;
+	std::vector<int> m_vSubstringBans;
+
+	// per lookup, kept to avoid allocations
+	std::vector<int> m_vSharedBigrams;
+	std::vector<int> m_vTouchedBans;
+
+	void Insert(int Ban);
+	void Rebuild();
+
+public:
+	int Num() const { return m_vBans.size(); }
+	CNameBan &Get(int Index) { return m_vBans[Index]; }
+	int Find(const char *pName) const;
+
+	void Add(const CNameBan &Ban);
+	void Update(int Index, int Distance, int IsSubstring, const char *pReason);
+	void Remove(int Index);
+	void Clear();
+
+	// same result as `IsNameBanned` with all bans
+	CNameBan *IsBanned(const char *pName);
+};
+
 #endif // ENGINE_SERVER_NAME_BAN_H
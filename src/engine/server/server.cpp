@@ -40,6 +40,7 @@
 #include "databases/connection.h"
 #include "databases/connection_pool.h"
 #include "register.h"
+#include "teehistorian_replay.h"
 
 #if defined(CONF_FAMILY_WINDOWS)
 #define WIN32_LEAN_AND_MEAN
@@ -278,6 +279,10 @@ void CServer::CClient::Reset()
 	m_SnapRate = CClient::SNAPRATE_INIT;
 	m_Score = 0;
 	m_NextMapChunk = 0;
+	m_MapChunks = -1;
+	m_MapChunkSend = 0;
+	m_MapChunkLimit = 0;
+	m_MapDownloadBytes = 0;
 	m_Flags = 0;
 	m_DDNetVersion = VERSION_NONE;
 	m_GotDDNetVersionPacket = false;
@@ -288,8 +293,8 @@ CServer::CServer() :
 	m_Register(false), m_RegSixup(true)
 {
 	for(int i = 0; i < MAX_CLIENTS; i++)
-		m_aDemoRecorder[i] = CDemoRecorder(&m_SnapshotDelta, true);
-	m_aDemoRecorder[MAX_CLIENTS] = CDemoRecorder(&m_SnapshotDelta, false);
+		m_aDemoRecorder[i].Init(&m_SnapshotDelta, true);
+	m_aDemoRecorder[MAX_CLIENTS].Init(&m_SnapshotDelta, false);
 
 	m_TickSpeed = SERVER_TICK_SPEED;
 
@@ -297,12 +302,14 @@ CServer::CServer() :
 
 	m_CurrentGameTick = 0;
 	m_RunServer = UNINITIALIZED;
+	m_Replaying = false;
 
 	for(int i = 0; i < 2; i++)
 	{
 		m_apCurrentMapData[i] = 0;
 		m_aCurrentMapSize[i] = 0;
 	}
+	m_NextMapChunksClient = 0;
 
 	m_MapReload = 0;
 	m_ReloadedWhenEmpty = false;
@@ -324,6 +331,15 @@ CServer::CServer() :
 
 	m_aErrorShutdownReason[0] = 0;
 
+	m_ProfileZoneNetwork = m_Profiler.AddZone("network");
+	m_ProfileZoneTick = m_Profiler.AddZone("tick");
+	m_ProfileZoneSnap = m_Profiler.AddZone("snap");
+	m_ProfileZoneRconCommands = m_Profiler.AddZone("rcon_commands");
+	m_ProfileZoneFifo = m_Profiler.AddZone("fifo");
+	m_ProfileZoneRegister = m_Profiler.AddZone("register");
+	m_ProfileZoneAntibot = m_Profiler.AddZone("antibot");
+	m_aProfileTraceFile[0] = 0;
+
 	Init();
 }
 
@@ -350,11 +366,13 @@ bool CServer::IsClientNameAvailable(int ClientID, const char *pNameRequest)
 		return false;
 
 	// make sure that two clients don't have the same name
+	CNameSkeleton Request(pNameRequest);
 	for(int i = 0; i < MAX_CLIENTS; i++)
 	{
 		if(i != ClientID && m_aClients[i].m_State >= CClient::STATE_READY)
 		{
-			if(str_utf8_comp_confusable(pNameRequest, m_aClients[i].m_aName) == 0)
+			m_aClients[i].m_NameSkeleton.Update(m_aClients[i].m_aName);
+			if(Request.IsConfusable(m_aClients[i].m_NameSkeleton))
 				return false;
 		}
 	}
@@ -368,7 +386,7 @@ bool CServer::SetClientNameImpl(int ClientID, const char *pNameRequest, bool Set
 	if(m_aClients[ClientID].m_State < CClient::STATE_READY)
 		return false;
 
-	CNameBan *pBanned = IsNameBanned(pNameRequest, m_aNameBans.base_ptr(), m_aNameBans.size());
+	CNameBan *pBanned = m_NameBans.IsBanned(pNameRequest);
 	if(pBanned)
 	{
 		if(m_aClients[ClientID].m_State == CClient::STATE_READY && Set)
@@ -643,6 +661,9 @@ int CServer::Port() const
 
 int CServer::MaxClients() const
 {
+	// the net server isn't opened for replays
+	if(m_Replaying)
+		return g_Config.m_SvMaxClients;
 	return m_NetServer.MaxClients();
 }
 
@@ -782,7 +803,8 @@ int CServer::SendMsg(CMsgPacker *pMsg, int Flags, int ClientID)
 					{
 						continue;
 					}
-					m_NetServer.Send(&Packet);
+					if(!m_Replaying)
+						m_NetServer.Send(&Packet);
 				}
 			}
 		}
@@ -808,7 +830,7 @@ int CServer::SendMsg(CMsgPacker *pMsg, int Flags, int ClientID)
 			m_aDemoRecorder[MAX_CLIENTS].RecordMessage(Pack.Data(), Pack.Size());
 		}
 
-		if(!(Flags & MSGFLAG_NOSEND))
+		if(!(Flags & MSGFLAG_NOSEND) && !m_Replaying)
 			m_NetServer.Send(&Packet);
 	}
 
@@ -831,7 +853,8 @@ void CServer::SendMsgRaw(int ClientID, const void *pData, int Size, int Flags)
 	{
 		Packet.m_Flags |= NETSENDFLAG_FLUSH;
 	}
-	m_NetServer.Send(&Packet);
+	if(!m_Replaying)
+		m_NetServer.Send(&Packet);
 }
 
 void CServer::DoSnapshot()
@@ -1170,49 +1193,101 @@ void CServer::SendMap(int ClientID)
 		if(Sixup)
 		{
 			Msg.AddInt(g_Config.m_SvMapWindow);
-			Msg.AddInt(1024 - 128);
+			Msg.AddInt(m_aMapChunks[MAPCHUNKS_SIXUP].ChunkSize());
 			Msg.AddRaw(m_aCurrentMapSha256[Sixup].data, sizeof(m_aCurrentMapSha256[Sixup].data));
 		}
 		SendMsg(&Msg, MSGFLAG_VITAL | MSGFLAG_FLUSH, ClientID);
 	}
 
 	m_aClients[ClientID].m_NextMapChunk = 0;
+	m_aClients[ClientID].m_MapChunks = -1;
+	m_aClients[ClientID].m_MapChunkSend = 0;
+	m_aClients[ClientID].m_MapChunkLimit = 0;
+	m_aClients[ClientID].m_MapDownloadBytes = 0;
 }
 
 void CServer::SendMapData(int ClientID, int Chunk)
 {
-	int Sixup = IsSixup(ClientID);
-	unsigned int ChunkSize = 1024 - 128;
-	unsigned int Offset = Chunk * ChunkSize;
-	int Last = 0;
+	CClient &Client = m_aClients[ClientID];
+	const CMapChunks &Chunks = m_aMapChunks[Client.m_MapChunks];
 
 	// drop faulty map data requests
-	if(Chunk < 0 || Offset > m_aCurrentMapSize[Sixup])
+	int Size;
+	const unsigned char *pMsg = Chunks.Msg(Chunk, &Size);
+	if(!pMsg)
 		return;
 
-	if(Offset + ChunkSize >= m_aCurrentMapSize[Sixup])
-	{
-		ChunkSize = m_aCurrentMapSize[Sixup] - Offset;
-		Last = 1;
-	}
+	// the chunks are packed on map load, skip the repacking in SendMsg but
+	// keep its antibot and demo recorder hooks
+	int Flags = MSGFLAG_VITAL | MSGFLAG_FLUSH;
+	if(Antibot()->OnEngineServerMessage(ClientID, pMsg, Size, Flags))
+		return;
+	m_aDemoRecorder[ClientID].RecordMessage(pMsg, Size);
+	m_aDemoRecorder[MAX_CLIENTS].RecordMessage(pMsg, Size);
+	SendMsgRaw(ClientID, pMsg, Size, Flags);
 
-	CMsgPacker Msg(NETMSG_MAP_DATA, true);
-	if(!Sixup)
+	int64_t Now = time_get();
+	if(Client.m_MapDownloadBytes == 0)
 	{
-		Msg.AddInt(Last);
-		Msg.AddInt(m_aCurrentMapCrc[SIX]);
-		Msg.AddInt(Chunk);
-		Msg.AddInt(ChunkSize);
+		Client.m_MapDownloadStart = Now;
+		Client.m_MapDownloadEnd = 0;
 	}
-	Msg.AddRaw(&m_apCurrentMapData[Sixup][Offset], ChunkSize);
-	SendMsg(&Msg, MSGFLAG_VITAL | MSGFLAG_FLUSH, ClientID);
+	Client.m_MapDownloadBytes += Chunks.ChunkDataSize(Chunk);
+	Client.m_MapWindow.OnSend(Chunk, Now);
 
 	if(g_Config.m_Debug)
 	{
 		char aBuf[256];
-		str_format(aBuf, sizeof(aBuf), "sending chunk %d with size %d", Chunk, ChunkSize);
+		str_format(aBuf, sizeof(aBuf), "sending chunk %d with size %d", Chunk, Chunks.ChunkDataSize(Chunk));
 		Console()->Print(IConsole::OUTPUT_LEVEL_DEBUG, "server", aBuf);
 	}
+
+	if(Chunk == Chunks.NumChunks() - 1 && Client.m_MapDownloadEnd == 0)
+	{
+		Client.m_MapDownloadEnd = Now;
+
+		char aBuf[256];
+		str_format(aBuf, sizeof(aBuf), "ClientID=%d sent map, %d bytes in %.2fs (%d KiB/s) chunk=%d window=%d rtt=%dms",
+			ClientID, Client.m_MapDownloadBytes, (Now - Client.m_MapDownloadStart) / (float)time_freq(), MapDownloadRate(ClientID) / 1024,
+			Chunks.ChunkSize(), Client.m_MapWindow.Window(), (int)(Client.m_MapWindow.Rtt() * 1000 / time_freq()));
+		Console()->Print(IConsole::OUTPUT_LEVEL_ADDINFO, "server", aBuf);
+	}
+}
+
+void CServer::SendMapChunks()
+{
+	// send the allowed chunks round robin, but leave the rest of the time
+	// to the next tick
+	int64_t Deadline = TickStartTime(m_CurrentGameTick + 1);
+	bool Sent;
+	do
+	{
+		Sent = false;
+		for(int i = 0; i < MAX_CLIENTS; i++)
+		{
+			int ClientID = (m_NextMapChunksClient + i) % MAX_CLIENTS;
+			CClient &Client = m_aClients[ClientID];
+			if(Client.m_State < CClient::STATE_CONNECTING || Client.m_MapChunks < 0)
+				continue;
+
+			int Limit = minimum(Client.m_MapChunkLimit, m_aMapChunks[Client.m_MapChunks].NumChunks());
+			if(Client.m_MapChunkSend >= Limit)
+				continue;
+
+			SendMapData(ClientID, Client.m_MapChunkSend++);
+			Sent = true;
+		}
+		m_NextMapChunksClient = (m_NextMapChunksClient + 1) % MAX_CLIENTS;
+	} while(Sent && time_get() < Deadline);
+}
+
+int CServer::MapDownloadRate(int ClientID) const
+{
+	const CClient &Client = m_aClients[ClientID];
+	if(Client.m_MapDownloadBytes == 0)
+		return 0;
+	int64_t End = Client.m_MapDownloadEnd ? Client.m_MapDownloadEnd : time_get();
+	return (int)(Client.m_MapDownloadBytes * time_freq() / maximum(End - Client.m_MapDownloadStart, (int64_t)1));
 }
 
 void CServer::SendConnectionReady(int ClientID)
@@ -1438,31 +1513,33 @@ void CServer::ProcessClientPacket(CNetChunk *pPacket)
 			if((pPacket->m_Flags & NET_CHUNKFLAG_VITAL) == 0 || m_aClients[ClientID].m_State < CClient::STATE_CONNECTING)
 				return;
 
-			if(m_aClients[ClientID].m_Sixup)
+			CClient &Client = m_aClients[ClientID];
+			if(Client.m_MapChunks < 0)
 			{
-				for(int i = 0; i < g_Config.m_SvMapWindow; i++)
-				{
-					SendMapData(ClientID, m_aClients[ClientID].m_NextMapChunk++);
-				}
+				// clients that identified as DDNet read the chunk size from the message
+				Client.m_MapChunks = Client.m_Sixup ? MAPCHUNKS_SIXUP : Client.m_DDNetVersion >= VERSION_DDNET_OLD ? MAPCHUNKS_LARGE : MAPCHUNKS_COMPAT;
+				int MaxWindow = MAP_DOWNLOAD_MAX_INFLIGHT / maximum(m_aMapChunks[Client.m_MapChunks].ChunkSize(), 1) - 1;
+				Client.m_MapWindow.Init(g_Config.m_SvMapWindow, g_Config.m_SvMapWindow ? MaxWindow : 0);
+			}
+
+			// the chunks themselves are sent from SendMapChunks
+			if(Client.m_Sixup)
+			{
+				Client.m_MapChunkLimit += g_Config.m_SvMapWindow;
 				return;
 			}
 
 			int Chunk = Unpacker.GetInt();
-			if(Chunk != m_aClients[ClientID].m_NextMapChunk || !g_Config.m_SvFastDownload)
+			if(Chunk != Client.m_NextMapChunk || !g_Config.m_SvFastDownload)
 			{
 				SendMapData(ClientID, Chunk);
 				return;
 			}
 
-			if(Chunk == 0)
-			{
-				for(int i = 0; i < g_Config.m_SvMapWindow; i++)
-				{
-					SendMapData(ClientID, i);
-				}
-			}
-			SendMapData(ClientID, g_Config.m_SvMapWindow + m_aClients[ClientID].m_NextMapChunk);
-			m_aClients[ClientID].m_NextMapChunk++;
+			// the request for a chunk acknowledges the previous one
+			Client.m_MapWindow.OnAck(Chunk - 1, time_get());
+			Client.m_MapChunkLimit = maximum(Client.m_MapChunkLimit, Chunk + Client.m_MapWindow.Window() + 1);
+			Client.m_NextMapChunk++;
 		}
 		else if(Msg == NETMSG_READY)
 		{
@@ -1501,7 +1578,7 @@ void CServer::ProcessClientPacket(CNetChunk *pPacket)
 				if(IsSixup(ClientID))
 				{
 					CMsgPacker Msg(4, true, true); //NETMSG_SERVERINFO //TODO: Import the shared protocol from 7 aswell
-					GetServerInfoSixup(&Msg, -1, false);
+					GetServerInfoSixup(&Msg, false);
 					SendMsg(&Msg, MSGFLAG_VITAL | MSGFLAG_FLUSH, ClientID);
 				}
 				GameServer()->OnClientEnter(ClientID);
@@ -1775,6 +1852,7 @@ static inline int GetCacheIndex(int Type, bool SendClient)
 CServer::CCache::CCache()
 {
 	m_Cache.clear();
+	m_Valid = false;
 }
 
 CServer::CCache::~CCache()
@@ -1784,10 +1862,20 @@ CServer::CCache::~CCache()
 
 CServer::CCache::CCacheChunk::CCacheChunk(const void *pData, int Size)
 {
-	mem_copy(m_aData, pData, Size);
+	mem_copy(&m_aBuffer[MAX_HEADER_SIZE], pData, Size);
 	m_DataSize = Size;
 }
 
+const unsigned char *CServer::CCache::CCacheChunk::Packet(const unsigned char *pType, int TypeSize, const void *pToken, int TokenSize, int *pSize)
+{
+	dbg_assert(TypeSize + TokenSize <= MAX_HEADER_SIZE, "serverinfo header too large");
+	unsigned char *pPacket = &m_aBuffer[MAX_HEADER_SIZE - TypeSize - TokenSize];
+	mem_copy(pPacket, pType, TypeSize);
+	mem_copy(pPacket + TypeSize, pToken, TokenSize);
+	*pSize = TypeSize + TokenSize + m_DataSize;
+	return pPacket;
+}
+
 void CServer::CCache::AddChunk(const void *pData, int Size)
 {
 	m_Cache.emplace_back(pData, Size);
@@ -1796,6 +1884,7 @@ void CServer::CCache::AddChunk(const void *pData, int Size)
 void CServer::CCache::Clear()
 {
 	m_Cache.clear();
+	m_Valid = false;
 }
 
 void CServer::CacheServerInfo(CCache *pCache, int Type, bool SendClients)
@@ -2056,73 +2145,81 @@ void CServer::CacheServerInfoSixup(CCache *pCache, bool SendClients)
 	pCache->AddChunk(Packer.Data(), Packer.Size());
 }
 
-void CServer::SendServerInfo(const NETADDR *pAddr, int Token, int Type, bool SendClients)
+CServer::CCache *CServer::ServerInfoCache(int Type, bool SendClients)
 {
-	CPacker p;
-	char aBuf[128];
-	p.Reset();
+	int Index = GetCacheIndex(Type, SendClients);
+	CCache *pCache = &m_aServerInfoCache[Index];
+	if(!pCache->m_Valid)
+	{
+		CacheServerInfo(pCache, Index / 2, SendClients);
+		pCache->m_Valid = true;
+	}
+	return pCache;
+}
 
-	CCache *pCache = &m_aServerInfoCache[GetCacheIndex(Type, SendClients)];
+CServer::CCache *CServer::ServerInfoCacheSixup(bool SendClients)
+{
+	CCache *pCache = &m_aSixupServerInfoCache[SendClients];
+	if(!pCache->m_Valid)
+	{
+		CacheServerInfoSixup(pCache, SendClients);
+		pCache->m_Valid = true;
+	}
+	return pCache;
+}
 
-#define ADD_RAW(p, x) (p).AddRaw(x, sizeof(x))
-#define ADD_INT(p, x) \
-	do \
-	{ \
-		str_format(aBuf, sizeof(aBuf), "%d", x); \
-		(p).AddString(aBuf, 0); \
-	} while(0)
+void CServer::SendServerInfo(const NETADDR *pAddr, int Token, int Type, bool SendClients)
+{
+	CCache *pCache = ServerInfoCache(Type, SendClients);
+
+	// the cached chunks are complete responses, only the token differs
+	char aToken[16];
+	int TokenSize = str_format(aToken, sizeof(aToken), "%d", Token) + 1;
 
 	CNetChunk Packet;
 	Packet.m_ClientID = -1;
 	Packet.m_Address = *pAddr;
 	Packet.m_Flags = NETSENDFLAG_CONNLESS;
 
-	for(const auto &Chunk : pCache->m_Cache)
+	for(auto &Chunk : pCache->m_Cache)
 	{
-		p.Reset();
+		const unsigned char *pType;
 		if(Type == SERVERINFO_EXTENDED)
-		{
-			if(&Chunk == &pCache->m_Cache.front())
-				p.AddRaw(SERVERBROWSE_INFO_EXTENDED, sizeof(SERVERBROWSE_INFO_EXTENDED));
-			else
-				p.AddRaw(SERVERBROWSE_INFO_EXTENDED_MORE, sizeof(SERVERBROWSE_INFO_EXTENDED_MORE));
-			ADD_INT(p, Token);
-		}
+			pType = &Chunk == &pCache->m_Cache.front() ? SERVERBROWSE_INFO_EXTENDED : SERVERBROWSE_INFO_EXTENDED_MORE;
 		else if(Type == SERVERINFO_64_LEGACY)
-		{
-			ADD_RAW(p, SERVERBROWSE_INFO_64_LEGACY);
-			ADD_INT(p, Token);
-		}
+			pType = SERVERBROWSE_INFO_64_LEGACY;
 		else if(Type == SERVERINFO_VANILLA || Type == SERVERINFO_INGAME)
-		{
-			ADD_RAW(p, SERVERBROWSE_INFO);
-			ADD_INT(p, Token);
-		}
+			pType = SERVERBROWSE_INFO;
 		else
 		{
 			dbg_assert(false, "unknown serverinfo type");
+			return;
 		}
 
-		p.AddRaw(Chunk.m_aData, Chunk.m_DataSize);
-		Packet.m_pData = p.Data();
-		Packet.m_DataSize = p.Size();
+		Packet.m_pData = Chunk.Packet(pType, sizeof(SERVERBROWSE_INFO), aToken, TokenSize, &Packet.m_DataSize);
 		m_NetServer.Send(&Packet);
 	}
 }
 
-void CServer::GetServerInfoSixup(CPacker *pPacker, int Token, bool SendClients)
+void CServer::SendServerInfoSixup(const NETADDR *pAddr, SECURITY_TOKEN ResponseToken, int Token, bool SendClients)
 {
-	if(Token != -1)
-	{
-		pPacker->Reset();
-		pPacker->AddRaw(SERVERBROWSE_INFO, sizeof(SERVERBROWSE_INFO));
-		pPacker->AddInt(Token);
-	}
+	CCache::CCacheChunk &Chunk = ServerInfoCacheSixup(SendClients)->m_Cache.front();
 
-	SendClients = SendClients && Token != -1;
+	unsigned char aToken[8];
+	int TokenSize = CVariableInt::Pack(aToken, Token) - aToken;
 
-	CCache::CCacheChunk &FirstChunk = m_aSixupServerInfoCache[SendClients].m_Cache.front();
-	pPacker->AddRaw(FirstChunk.m_aData, FirstChunk.m_DataSize);
+	CNetChunk Packet;
+	Packet.m_ClientID = -1;
+	Packet.m_Address = *pAddr;
+	Packet.m_Flags = NETSENDFLAG_CONNLESS;
+	Packet.m_pData = Chunk.Packet(SERVERBROWSE_INFO, sizeof(SERVERBROWSE_INFO), aToken, TokenSize, &Packet.m_DataSize);
+	m_NetServer.SendConnlessSixup(&Packet, ResponseToken);
+}
+
+void CServer::GetServerInfoSixup(CPacker *pPacker, bool SendClients)
+{
+	CCache::CCacheChunk &FirstChunk = ServerInfoCacheSixup(SendClients)->m_Cache.front();
+	pPacker->AddRaw(FirstChunk.Data(), FirstChunk.m_DataSize);
 }
 
 void CServer::ExpireServerInfo()
@@ -2135,12 +2232,11 @@ void CServer::UpdateServerInfo(bool Resend)
 	if(m_RunServer == UNINITIALIZED)
 		return;
 
-	for(int i = 0; i < 3; i++)
-		for(int j = 0; j < 2; j++)
-			CacheServerInfo(&m_aServerInfoCache[i * 2 + j], i, j);
-
-	for(int i = 0; i < 2; i++)
-		CacheServerInfoSixup(&m_aSixupServerInfoCache[i], i);
+	// the caches are rebuilt on the next request
+	for(auto &Cache : m_aServerInfoCache)
+		Cache.Clear();
+	for(auto &Cache : m_aSixupServerInfoCache)
+		Cache.Clear();
 
 	if(Resend)
 	{
@@ -2153,7 +2249,7 @@ void CServer::UpdateServerInfo(bool Resend)
 				else
 				{
 					CMsgPacker Msg(4, true, true); //NETMSG_SERVERINFO //TODO: Import the shared protocol from 7 aswell
-					GetServerInfoSixup(&Msg, -1, false);
+					GetServerInfoSixup(&Msg, false);
 					SendMsg(&Msg, MSGFLAG_VITAL | MSGFLAG_FLUSH, i);
 				}
 			}
@@ -2217,17 +2313,7 @@ void CServer::PumpNetwork(bool PacketWaiting)
 						if(Unpacker.Error())
 							continue;
 
-						CPacker Packer;
-						CNetChunk Response;
-
-						GetServerInfoSixup(&Packer, SrvBrwsToken, RateLimitServerInfoConnless());
-
-						Response.m_ClientID = -1;
-						Response.m_Address = Packet.m_Address;
-						Response.m_Flags = NETSENDFLAG_CONNLESS;
-						Response.m_pData = Packer.Data();
-						Response.m_DataSize = Packer.Size();
-						m_NetServer.SendConnlessSixup(&Response, ResponseToken);
+						SendServerInfoSixup(&Packet.m_Address, ResponseToken, SrvBrwsToken, RateLimitServerInfoConnless());
 					}
 					else if(Type != -1)
 					{
@@ -2270,6 +2356,8 @@ void CServer::PumpNetwork(bool PacketWaiting)
 		}
 	}
 
+	SendMapChunks();
+
 	m_ServerBan.Update();
 	m_Econ.Update();
 }
@@ -2334,6 +2422,9 @@ int CServer::LoadMap(const char *pMapName)
 		m_apCurrentMapData[SIX] = (unsigned char *)malloc(m_aCurrentMapSize[SIX]);
 		io_read(File, m_apCurrentMapData[SIX], m_aCurrentMapSize[SIX]);
 		io_close(File);
+
+		m_aMapChunks[MAPCHUNKS_COMPAT].Init(m_apCurrentMapData[SIX], m_aCurrentMapSize[SIX], m_aCurrentMapCrc[SIX], MAP_CHUNK_SIZE_COMPAT, false);
+		m_aMapChunks[MAPCHUNKS_LARGE].Init(m_apCurrentMapData[SIX], m_aCurrentMapSize[SIX], m_aCurrentMapCrc[SIX], MAP_CHUNK_SIZE_DDNET, false);
 	}
 
 	// load sixup version of the map
@@ -2357,6 +2448,7 @@ int CServer::LoadMap(const char *pMapName)
 
 			m_aCurrentMapSha256[SIXUP] = sha256(m_apCurrentMapData[SIXUP], m_aCurrentMapSize[SIXUP]);
 			m_aCurrentMapCrc[SIXUP] = crc32(0, m_apCurrentMapData[SIXUP], m_aCurrentMapSize[SIXUP]);
+			m_aMapChunks[MAPCHUNKS_SIXUP].Init(m_apCurrentMapData[SIXUP], m_aCurrentMapSize[SIXUP], m_aCurrentMapCrc[SIXUP], MAP_CHUNK_SIZE_LARGE, true);
 			sha256_str(m_aCurrentMapSha256[SIXUP], aSha256, sizeof(aSha256));
 			str_format(aBufMsg, sizeof(aBufMsg), "%s sha256 is %s", aBuf, aSha256);
 			Console()->Print(IConsole::OUTPUT_LEVEL_ADDINFO, "sixup", aBufMsg);
@@ -2490,8 +2582,13 @@ int CServer::Run()
 		UpdateServerInfo();
 		while(m_RunServer < STOPPING)
 		{
+			m_Profiler.SetEnabled(g_Config.m_SvProfile);
+
 			if(NonActive)
+			{
+				CProfileScope Scope(&m_Profiler, m_ProfileZoneNetwork);
 				PumpNetwork(PacketWaiting);
+			}
 
 			set_new_tick();
 
@@ -2620,38 +2717,68 @@ int CServer::Run()
 					}
 				}
 
-				GameServer()->OnTick();
+				{
+					CProfileScope Scope(&m_Profiler, m_ProfileZoneTick);
+					GameServer()->OnTick();
+				}
 				if(ErrorShutdown())
 				{
 					break;
 				}
+
+				if(m_Profiler.EndTick())
+				{
+					if(m_Profiler.WriteTrace(Storage(), m_aProfileTraceFile))
+						str_format(aBuf, sizeof(aBuf), "wrote profile trace to '%s'", m_aProfileTraceFile);
+					else
+						str_format(aBuf, sizeof(aBuf), "failed to write profile trace to '%s'", m_aProfileTraceFile);
+					Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "profile", aBuf);
+				}
 			}
 
 			// snap game
 			if(NewTicks)
 			{
 				if(g_Config.m_SvHighBandwidth || (m_CurrentGameTick % 2) == 0)
+				{
+					CProfileScope Scope(&m_Profiler, m_ProfileZoneSnap);
 					DoSnapshot();
+				}
 
-				UpdateClientRconCommands();
+				{
+					CProfileScope Scope(&m_Profiler, m_ProfileZoneRconCommands);
+					UpdateClientRconCommands();
+				}
 
 #if defined(CONF_FAMILY_UNIX)
-				m_Fifo.Update();
+				{
+					CProfileScope Scope(&m_Profiler, m_ProfileZoneFifo);
+					m_Fifo.Update();
+				}
 #endif
 			}
 
 			// master server stuff
-			m_Register.RegisterUpdate(m_NetServer.NetType());
-			if(g_Config.m_SvSixup)
-				m_RegSixup.RegisterUpdate(m_NetServer.NetType());
+			{
+				CProfileScope Scope(&m_Profiler, m_ProfileZoneRegister);
+				m_Register.RegisterUpdate(m_NetServer.NetType());
+				if(g_Config.m_SvSixup)
+					m_RegSixup.RegisterUpdate(m_NetServer.NetType());
+			}
 
 			if(m_ServerInfoNeedsUpdate)
 				UpdateServerInfo();
 
-			Antibot()->OnEngineTick();
+			{
+				CProfileScope Scope(&m_Profiler, m_ProfileZoneAntibot);
+				Antibot()->OnEngineTick();
+			}
 
 			if(!NonActive)
+			{
+				CProfileScope Scope(&m_Profiler, m_ProfileZoneNetwork);
 				PumpNetwork(PacketWaiting);
+			}
 
 			NonActive = true;
 
@@ -2804,6 +2931,14 @@ void CServer::ConStatus(IConsole::IResult *pResult, void *pUser)
 		else
 		{
 			str_format(aBuf, sizeof(aBuf), "id=%d addr=<{%s}> connecting", i, aAddrStr);
+			if(pThis->m_aClients[i].m_MapDownloadBytes > 0)
+			{
+				const CMapChunks &Chunks = pThis->m_aMapChunks[pThis->m_aClients[i].m_MapChunks];
+				char aDownload[128];
+				str_format(aDownload, sizeof(aDownload), " map=%d/%d rate=%dKiB/s window=%d",
+					pThis->m_aClients[i].m_MapDownloadBytes, Chunks.MapSize(), pThis->MapDownloadRate(i) / 1024, pThis->m_aClients[i].m_MapWindow.Window());
+				str_append(aBuf, aDownload, sizeof(aBuf));
+			}
 		}
 		pThis->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "server", aBuf);
 	}
@@ -3028,21 +3163,17 @@ void CServer::ConNameBan(IConsole::IResult *pResult, void *pUser)
 	int Distance = pResult->NumArguments() > 1 ? pResult->GetInteger(1) : str_length(pName) / 3;
 	int IsSubstring = pResult->NumArguments() > 2 ? pResult->GetInteger(2) : 0;
 
-	for(int i = 0; i < pThis->m_aNameBans.size(); i++)
+	int Index = pThis->m_NameBans.Find(pName);
+	if(Index != -1)
 	{
-		CNameBan *pBan = &pThis->m_aNameBans[i];
-		if(str_comp(pBan->m_aName, pName) == 0)
-		{
-			str_format(aBuf, sizeof(aBuf), "changed name='%s' distance=%d old_distance=%d is_substring=%d old_is_substring=%d reason='%s' old_reason='%s'", pName, Distance, pBan->m_Distance, IsSubstring, pBan->m_IsSubstring, pReason, pBan->m_aReason);
-			pThis->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "name_ban", aBuf);
-			pBan->m_Distance = Distance;
-			pBan->m_IsSubstring = IsSubstring;
-			str_copy(pBan->m_aReason, pReason, sizeof(pBan->m_aReason));
-			return;
-		}
+		CNameBan *pBan = &pThis->m_NameBans.Get(Index);
+		str_format(aBuf, sizeof(aBuf), "changed name='%s' distance=%d old_distance=%d is_substring=%d old_is_substring=%d reason='%s' old_reason='%s'", pName, Distance, pBan->m_Distance, IsSubstring, pBan->m_IsSubstring, pReason, pBan->m_aReason);
+		pThis->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "name_ban", aBuf);
+		pThis->m_NameBans.Update(Index, Distance, IsSubstring, pReason);
+		return;
 	}
 
-	pThis->m_aNameBans.add(CNameBan(pName, Distance, IsSubstring, pReason));
+	pThis->m_NameBans.Add(CNameBan(pName, Distance, IsSubstring, pReason));
 	str_format(aBuf, sizeof(aBuf), "added name='%s' distance=%d is_substring=%d reason='%s'", pName, Distance, IsSubstring, pReason);
 	pThis->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "name_ban", aBuf);
 }
@@ -3052,16 +3183,14 @@ void CServer::ConNameUnban(IConsole::IResult *pResult, void *pUser)
 	CServer *pThis = (CServer *)pUser;
 	const char *pName = pResult->GetString(0);
 
-	for(int i = 0; i < pThis->m_aNameBans.size(); i++)
+	int Index = pThis->m_NameBans.Find(pName);
+	if(Index != -1)
 	{
-		CNameBan *pBan = &pThis->m_aNameBans[i];
-		if(str_comp(pBan->m_aName, pName) == 0)
-		{
-			char aBuf[128];
-			str_format(aBuf, sizeof(aBuf), "removed name='%s' distance=%d is_substring=%d reason='%s'", pBan->m_aName, pBan->m_Distance, pBan->m_IsSubstring, pBan->m_aReason);
-			pThis->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "name_ban", aBuf);
-			pThis->m_aNameBans.remove_index(i);
-		}
+		CNameBan *pBan = &pThis->m_NameBans.Get(Index);
+		char aBuf[128];
+		str_format(aBuf, sizeof(aBuf), "removed name='%s' distance=%d is_substring=%d reason='%s'", pBan->m_aName, pBan->m_Distance, pBan->m_IsSubstring, pBan->m_aReason);
+		pThis->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "name_ban", aBuf);
+		pThis->m_NameBans.Remove(Index);
 	}
 }
 
@@ -3069,15 +3198,52 @@ void CServer::ConNameBans(IConsole::IResult *pResult, void *pUser)
 {
 	CServer *pThis = (CServer *)pUser;
 
-	for(int i = 0; i < pThis->m_aNameBans.size(); i++)
+	for(int i = 0; i < pThis->m_NameBans.Num(); i++)
 	{
-		CNameBan *pBan = &pThis->m_aNameBans[i];
+		CNameBan *pBan = &pThis->m_NameBans.Get(i);
 		char aBuf[128];
 		str_format(aBuf, sizeof(aBuf), "name='%s' distance=%d is_substring=%d reason='%s'", pBan->m_aName, pBan->m_Distance, pBan->m_IsSubstring, pBan->m_aReason);
 		pThis->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "name_ban", aBuf);
 	}
 }
 
+void CServer::ConProfile(IConsole::IResult *pResult, void *pUser)
+{
+	CServer *pThis = (CServer *)pUser;
+	if(!g_Config.m_SvProfile && !pThis->m_Profiler.Tracing())
+		pThis->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "profile", "profiling is disabled, enable it with 'sv_profile 1'");
+	pThis->m_Profiler.Dump(pThis->Console());
+}
+
+void CServer::ConProfileReset(IConsole::IResult *pResult, void *pUser)
+{
+	((CServer *)pUser)->m_Profiler.Reset();
+}
+
+void CServer::ConProfileTrace(IConsole::IResult *pResult, void *pUser)
+{
+	CServer *pThis = (CServer *)pUser;
+	int Ticks = pResult->NumArguments() > 0 ? pResult->GetInteger(0) : pThis->TickSpeed() * 10;
+	if(Ticks <= 0)
+	{
+		pThis->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "profile", "number of ticks must be positive");
+		return;
+	}
+	if(pResult->NumArguments() > 1)
+		str_copy(pThis->m_aProfileTraceFile, pResult->GetString(1), sizeof(pThis->m_aProfileTraceFile));
+	else
+	{
+		char aDate[20];
+		str_timestamp(aDate, sizeof(aDate));
+		str_format(pThis->m_aProfileTraceFile, sizeof(pThis->m_aProfileTraceFile), "dumps/profile_%s.json", aDate);
+	}
+	pThis->m_Profiler.StartTrace(Ticks);
+
+	char aBuf[IO_MAX_PATH_LENGTH + 64];
+	str_format(aBuf, sizeof(aBuf), "tracing %d ticks to '%s'", Ticks, pThis->m_aProfileTraceFile);
+	pThis->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "profile", aBuf);
+}
+
 void CServer::ConShutdown(IConsole::IResult *pResult, void *pUser)
 {
 	((CServer *)pUser)->m_RunServer = STOPPING;
@@ -3487,6 +3653,10 @@ void CServer::RegisterCommands()
 	Console()->Register("name_unban", "s[name]", CFGFLAG_SERVER, ConNameUnban, this, "Unban a certain nickname");
 	Console()->Register("name_bans", "", CFGFLAG_SERVER, ConNameBans, this, "List all name bans");
 
+	Console()->Register("profile", "", CFGFLAG_SERVER, ConProfile, this, "Show how long each phase of the server loop takes (in microseconds)");
+	Console()->Register("profile_reset", "", CFGFLAG_SERVER, ConProfileReset, this, "Clear the collected profiling data");
+	Console()->Register("profile_trace", "?i[ticks] ?s[file]", CFGFLAG_SERVER, ConProfileTrace, this, "Record the server loop for some ticks and save it as a chrome trace");
+
 	Console()->Chain("sv_name", ConchainSpecialInfoupdate, this);
 	Console()->Chain("password", ConchainSpecialInfoupdate, this);
 
@@ -3537,6 +3707,7 @@ static CServer *CreateServer() { return new CServer(); }
 int main(int argc, const char **argv) // ignore_convention
 {
 	bool Silent = false;
+	const char *pReplayFile = 0;
 
 	for(int i = 1; i < argc; i++) // ignore_convention
 	{
@@ -3546,7 +3717,10 @@ int main(int argc, const char **argv) // ignore_convention
 #if defined(CONF_FAMILY_WINDOWS)
 			ShowWindow(GetConsoleWindow(), SW_HIDE);
 #endif
-			break;
+		}
+		else if(str_comp("--replay", argv[i]) == 0 && i + 1 < argc) // ignore_convention
+		{
+			pReplayFile = argv[++i]; // ignore_convention
 		}
 	}
 
@@ -3629,9 +3803,20 @@ int main(int argc, const char **argv) // ignore_convention
 
 	pEngine->InitLogfile();
 
-	// run the server
-	dbg_msg("server", "starting...");
-	int Ret = pServer->Run();
+	int Ret;
+	if(pReplayFile)
+	{
+		// run the game on a recorded teehistorian file instead
+		dbg_msg("server", "replaying '%s'...", pReplayFile);
+		CTeeHistorianReplay Replay(pServer);
+		Ret = Replay.Run(pReplayFile);
+	}
+	else
+	{
+		// run the server
+		dbg_msg("server", "starting...");
+		Ret = pServer->Run();
+	}
 
 	MysqlUninit();
 
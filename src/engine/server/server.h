@@ -17,6 +17,7 @@
 #include <engine/shared/fifo.h>
 #include <engine/shared/netban.h>
 #include <engine/shared/network.h>
+#include <engine/shared/profiler.h>
 #include <engine/shared/protocol.h>
 #include <engine/shared/snapshot.h>
 #include <engine/shared/uuid_manager.h>
@@ -27,6 +28,7 @@
 
 #include "antibot.h"
 #include "authmanager.h"
+#include "map_chunks.h"
 #include "name_ban.h"
 
 #if defined(CONF_UPNP)
@@ -88,6 +90,8 @@ public:
 
 class CServer : public IServer
 {
+	friend class CTeeHistorianReplay;
+
 	class IGameServer *m_pGameServer;
 	class CConfig *m_pConfig;
 	class IConsole *m_pConsole;
@@ -166,6 +170,7 @@ public:
 		int m_CurrentInput;
 
 		char m_aName[MAX_NAME_LENGTH];
+		CNameSkeleton m_NameSkeleton;
 		char m_aClan[MAX_CLAN_LENGTH];
 		int m_Country;
 		int m_Score;
@@ -174,6 +179,15 @@ public:
 		int m_AuthTries;
 		int m_NextMapChunk;
 		int m_Flags;
+
+		// map download, sent from CServer::SendMapChunks
+		int m_MapChunks;
+		int m_MapChunkSend;
+		int m_MapChunkLimit;
+		CMapDownloadWindow m_MapWindow;
+		int64_t m_MapDownloadStart;
+		int64_t m_MapDownloadEnd;
+		int m_MapDownloadBytes;
 		bool m_ShowIps;
 
 		const IConsole::CCommandInfo *m_pRconCmdToSend;
@@ -225,6 +239,8 @@ public:
 	};
 
 	int m_RunServer;
+	// set while replaying a teehistorian file, nothing is sent then
+	bool m_Replaying;
 
 	int m_MapReload;
 	bool m_ReloadedWhenEmpty;
@@ -247,6 +263,19 @@ public:
 	unsigned char *m_apCurrentMapData[2];
 	unsigned int m_aCurrentMapSize[2];
 
+	enum
+	{
+		MAPCHUNKS_COMPAT = 0,
+		MAPCHUNKS_LARGE,
+		MAPCHUNKS_SIXUP,
+		NUM_MAPCHUNKS,
+
+		// bytes of map data in flight per client, must stay well below NET_CONN_BUFFERSIZE
+		MAP_DOWNLOAD_MAX_INFLIGHT = 20 * 1024,
+	};
+	CMapChunks m_aMapChunks[NUM_MAPCHUNKS];
+	int m_NextMapChunksClient;
+
 	CDemoRecorder m_aDemoRecorder[MAX_CLIENTS + 1];
 	CRegister m_Register;
 	CRegister m_RegSixup;
@@ -259,7 +288,17 @@ public:
 
 	char m_aErrorShutdownReason[128];
 
-	array<CNameBan> m_aNameBans;
+	CProfiler m_Profiler;
+	int m_ProfileZoneNetwork;
+	int m_ProfileZoneTick;
+	int m_ProfileZoneSnap;
+	int m_ProfileZoneRconCommands;
+	int m_ProfileZoneFifo;
+	int m_ProfileZoneRegister;
+	int m_ProfileZoneAntibot;
+	char m_aProfileTraceFile[IO_MAX_PATH_LENGTH];
+
+	CNameBans m_NameBans;
 
 	CServer();
 	~CServer();
@@ -317,6 +356,8 @@ public:
 	void SendCapabilities(int ClientID);
 	void SendMap(int ClientID);
 	void SendMapData(int ClientID, int Chunk);
+	void SendMapChunks();
+	int MapDownloadRate(int ClientID) const;
 	void SendConnectionReady(int ClientID);
 	void SendRconLine(int ClientID, const char *pLine);
 	static void SendRconLineAuthed(const char *pLine, void *pUser, ColorRGBA PrintColor = {1, 1, 1, 1});
@@ -333,14 +374,27 @@ public:
 		class CCacheChunk
 		{
 		public:
+			enum
+			{
+				// room for the packet type and the token in front of the data
+				MAX_HEADER_SIZE = 32,
+			};
+
 			CCacheChunk(const void *pData, int Size);
 			CCacheChunk(const CCacheChunk &) = delete;
 
+			const unsigned char *Data() const { return &m_aBuffer[MAX_HEADER_SIZE]; }
+			// writes the header directly in front of the data, returns the whole packet
+			const unsigned char *Packet(const unsigned char *pType, int TypeSize, const void *pToken, int TokenSize, int *pSize);
+
 			int m_DataSize;
-			unsigned char m_aData[NET_MAX_PAYLOAD];
+
+		private:
+			unsigned char m_aBuffer[MAX_HEADER_SIZE + NET_MAX_PAYLOAD];
 		};
 
 		std::list<CCacheChunk> m_Cache;
+		bool m_Valid;
 
 		CCache();
 		~CCache();
@@ -355,8 +409,11 @@ public:
 	void ExpireServerInfo();
 	void CacheServerInfo(CCache *pCache, int Type, bool SendClients);
 	void CacheServerInfoSixup(CCache *pCache, bool SendClients);
+	CCache *ServerInfoCache(int Type, bool SendClients);
+	CCache *ServerInfoCacheSixup(bool SendClients);
 	void SendServerInfo(const NETADDR *pAddr, int Token, int Type, bool SendClients);
-	void GetServerInfoSixup(CPacker *pPacker, int Token, bool SendClients);
+	void SendServerInfoSixup(const NETADDR *pAddr, SECURITY_TOKEN ResponseToken, int Token, bool SendClients);
+	void GetServerInfoSixup(CPacker *pPacker, bool SendClients);
 	bool RateLimitServerInfoConnless();
 	void SendServerInfoConnless(const NETADDR *pAddr, int Token, int Type);
 	void UpdateServerInfo(bool Resend = false);
@@ -396,6 +453,10 @@ public:
 	static void ConNameUnban(IConsole::IResult *pResult, void *pUser);
 	static void ConNameBans(IConsole::IResult *pResult, void *pUser);
 
+	static void ConProfile(IConsole::IResult *pResult, void *pUser);
+	static void ConProfileReset(IConsole::IResult *pResult, void *pUser);
+	static void ConProfileTrace(IConsole::IResult *pResult, void *pUser);
+
 	// console commands for sqlmasters
 	static void ConAddSqlServer(IConsole::IResult *pResult, void *pUserData);
 	static void ConDumpSqlServers(IConsole::IResult *pResult, void *pUserData);
@@ -463,6 +524,8 @@ public:
 
 	bool IsSixup(int ClientID) const { return m_aClients[ClientID].m_Sixup; }
 
+	CProfiler *Profiler() { return &m_Profiler; }
+
 #ifdef CONF_FAMILY_UNIX
 	enum CONN_LOGGING_CMD
 	{
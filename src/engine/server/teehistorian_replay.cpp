@@ -0,0 +1,494 @@
+#include "teehistorian_replay.h"
+#include "server.h"
+
+#include <engine/config.h>
+#include <engine/shared/config.h>
+#include <engine/shared/json.h>
+#include <engine/shared/protocol_ex.h>
+#include <engine/shared/teehistorian_ex.h>
+#include <engine/storage.h>
+
+CTeeHistorianReplay::CTeeHistorianReplay(CServer *pServer)
+{
+	m_pServer = pServer;
+	m_pData = 0;
+	m_DataSize = 0;
+}
+
+bool CTeeHistorianReplay::LoadFile(const char *pFilename)
+{
+	IOHANDLE File = m_pServer->Storage()->OpenFile(pFilename, IOFLAG_READ, IStorage::TYPE_ALL);
+	if(!File)
+		File = m_pServer->Storage()->OpenFile(pFilename, IOFLAG_READ, IStorage::TYPE_ABSOLUTE);
+	if(!File)
+	{
+		dbg_msg("replay", "failed to open '%s'", pFilename);
+		return false;
+	}
+	m_DataSize = (int)io_length(File);
+	m_pData = (unsigned char *)malloc(maximum(m_DataSize, 1));
+	bool Success = (int)io_read(File, m_pData, m_DataSize) == m_DataSize;
+	io_close(File);
+	if(!Success || !m_Reader.Reset(m_pData, m_DataSize))
+	{
+		dbg_msg("replay", "'%s' is not a teehistorian file", pFilename);
+		return false;
+	}
+	return true;
+}
+
+bool CTeeHistorianReplay::Init()
+{
+	CServer *pServer = m_pServer;
+	IConsole *pConsole = pServer->Console();
+
+	json_value *pHeader = json_parse(m_Reader.Header(), str_length(m_Reader.Header()));
+	if(!pHeader || pHeader->type != json_object)
+	{
+		dbg_msg("replay", "invalid teehistorian header");
+		json_value_free(pHeader);
+		return false;
+	}
+	const json_value &Header = *pHeader;
+	const char *pMapName = json_string_get(&Header["map_name"]);
+	const char *pMapSha256 = json_string_get(&Header["map_sha256"]);
+	const char *pPrng = json_string_get(&Header["prng_description"]);
+	const json_value &Config = Header["config"];
+	const json_value &Tuning = Header["tuning"];
+	if(!pMapName || Config.type != json_object || Tuning.type != json_object)
+	{
+		dbg_msg("replay", "teehistorian header misses the map or the config");
+		json_value_free(pHeader);
+		return false;
+	}
+
+	// replace the local config with the recorded one, only non-default
+	// values are recorded
+	pServer->Kernel()->RequestInterface<IConfigManager>()->Reset();
+	char aLine[1024];
+	for(unsigned i = 0; i < Config.u.object.length; i++)
+	{
+		const char *pValue = json_string_get(Config.u.object.values[i].value);
+		if(!pValue)
+			continue;
+		str_format(aLine, sizeof(aLine), "%s \"", Config.u.object.values[i].name);
+		char *pDst = aLine + str_length(aLine);
+		str_escape(&pDst, pValue, aLine + sizeof(aLine));
+		str_append(aLine, "\"", sizeof(aLine));
+		pConsole->ExecuteLine(aLine);
+	}
+	g_Config.m_SvTeeHistorian = 0;
+	str_copy(g_Config.m_SvMap, pMapName, sizeof(g_Config.m_SvMap));
+
+	{
+		int Size = pServer->GameServer()->PersistentClientDataSize();
+		for(auto &Client : pServer->m_aClients)
+		{
+			Client.m_HasPersistentData = false;
+			Client.m_pPersistentData = malloc(Size);
+		}
+	}
+
+	if(!pServer->LoadMap(g_Config.m_SvMap))
+	{
+		dbg_msg("replay", "failed to load map. mapname='%s'", g_Config.m_SvMap);
+		json_value_free(pHeader);
+		return false;
+	}
+	char aSha256[SHA256_MAXSTRSIZE];
+	sha256_str(pServer->m_aCurrentMapSha256[CServer::SIX], aSha256, sizeof(aSha256));
+	if(pMapSha256 && str_comp(pMapSha256, aSha256) != 0)
+		dbg_msg("replay", "WARNING: map sha256 differs from the recorded one. recorded=%s loaded=%s", pMapSha256, aSha256);
+
+	pServer->m_AuthManager.Init();
+	pServer->m_PrintCBIndex = pConsole->RegisterPrintCallback(g_Config.m_ConsoleOutputLevel, CServer::SendRconLineAuthed, pServer);
+	// only used for drops initiated by the game, the net server stays closed
+	pServer->m_NetServer.SetCallbacks(CServer::NewClientCallback, CServer::NewClientNoAuthCallback, CServer::ClientRejoinCallback, CServer::DelClientCallback, pServer);
+
+	pServer->Antibot()->Init();
+	pServer->GameServer()->OnInit();
+
+	if(pPrng && !pServer->GameServer()->SeedPrng(pPrng))
+		dbg_msg("replay", "WARNING: couldn't restore the random seed '%s'", pPrng);
+
+	// tuning is stored as fixed point, the half offset makes the float
+	// parsing of the tune command truncate back to the recorded value
+	for(unsigned i = 0; i < Tuning.u.object.length; i++)
+	{
+		const char *pValue = json_string_get(Tuning.u.object.values[i].value);
+		if(!pValue)
+			continue;
+		int Value = str_toint(pValue);
+		str_format(aLine, sizeof(aLine), "tune %s %.4f", Tuning.u.object.values[i].name, (Value + (Value < 0 ? -0.5f : 0.5f)) / 100.0f);
+		pConsole->ExecuteLine(aLine);
+	}
+	json_value_free(pHeader);
+
+	pConsole->StoreCommands(false);
+	return !pServer->ErrorShutdown();
+}
+
+void CTeeHistorianReplay::Shutdown()
+{
+	CServer *pServer = m_pServer;
+	for(int i = 0; i < MAX_CLIENTS; i++)
+	{
+		if(pServer->m_aClients[i].m_State != CServer::CClient::STATE_EMPTY)
+			pServer->m_NetServer.Drop(i, "Replay finished");
+	}
+	pServer->GameServer()->OnShutdown();
+	pServer->m_pMap->Unload();
+	for(auto &Client : pServer->m_aClients)
+	{
+		free(Client.m_pPersistentData);
+		Client.m_pPersistentData = 0;
+	}
+}
+
+void CTeeHistorianReplay::Tick()
+{
+	CServer *pServer = m_pServer;
+	set_new_tick();
+
+	pServer->m_CurrentGameTick++;
+	for(int i = 0; i < MAX_CLIENTS; i++)
+	{
+		if(m_aNextInput[i] && pServer->m_aClients[i].m_State == CServer::CClient::STATE_INGAME)
+			pServer->GameServer()->OnClientPredictedInput(i, pServer->m_aClients[i].m_LatestInput.m_aData);
+		m_aNextInput[i] = false;
+	}
+
+	{
+		CProfileScope Scope(&pServer->m_Profiler, pServer->m_ProfileZoneTick);
+		pServer->GameServer()->OnTick();
+	}
+
+	if(g_Config.m_SvHighBandwidth || (pServer->Tick() % 2) == 0)
+	{
+		CProfileScope Scope(&pServer->m_Profiler, pServer->m_ProfileZoneSnap);
+		pServer->DoSnapshot();
+		// pretend every client acknowledged the snapshot right away, so the
+		// snapshots are deltas like on a server with good connections
+		for(auto &Client : pServer->m_aClients)
+		{
+			if(Client.m_State != CServer::CClient::STATE_INGAME)
+				continue;
+			Client.m_LastAckedSnapshot = pServer->Tick();
+			Client.m_SnapRate = CServer::CClient::SNAPRATE_FULL;
+		}
+	}
+
+	if(pServer->m_Profiler.EndTick())
+	{
+		char aBuf[256];
+		if(pServer->m_Profiler.WriteTrace(pServer->Storage(), pServer->m_aProfileTraceFile))
+			str_format(aBuf, sizeof(aBuf), "wrote profile trace to '%s'", pServer->m_aProfileTraceFile);
+		else
+			str_format(aBuf, sizeof(aBuf), "failed to write profile trace to '%s'", pServer->m_aProfileTraceFile);
+		pServer->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "profile", aBuf);
+	}
+}
+
+void CTeeHistorianReplay::Check()
+{
+	// the recorded positions are written right after the world tick, check
+	// them before anything else of the tick is applied
+	if(m_CheckedTick == m_pServer->Tick())
+		return;
+	m_CheckedTick = m_pServer->Tick();
+
+	for(int i = 0; i < MAX_CLIENTS; i++)
+	{
+		CNetObj_CharacterCore Core;
+		int SpawnTick;
+		bool Alive = m_pServer->GameServer()->CharacterCore(i, &Core, &SpawnTick);
+		// characters are recorded right after the world tick, the ones that
+		// spawned later in the tick only show up in the next one
+		if(Alive && SpawnTick == m_CheckedTick)
+			Alive = false;
+		const CExpected &Expected = m_aExpected[i];
+		if(!Alive && !Expected.m_Alive)
+			continue;
+
+		m_NumChecked++;
+		if(Alive == Expected.m_Alive && (!Alive || (Core.m_X == Expected.m_X && Core.m_Y == Expected.m_Y)))
+			continue;
+
+		m_NumMismatches++;
+		if(m_aFirstMismatch[i] < 0)
+		{
+			// positions stay off once they diverged, only report the first tick
+			m_aFirstMismatch[i] = m_CheckedTick;
+			char aBuf[256];
+			str_format(aBuf, sizeof(aBuf), "mismatch tick=%d cid=%d recorded=%s(%d, %d) replayed=%s(%d, %d)",
+				m_CheckedTick, i,
+				Expected.m_Alive ? "alive" : "dead", Expected.m_X, Expected.m_Y,
+				Alive ? "alive" : "dead", Alive ? Core.m_X : 0, Alive ? Core.m_Y : 0);
+			m_pServer->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "replay", aBuf);
+		}
+	}
+}
+
+void CTeeHistorianReplay::Connect(int ClientID)
+{
+	CServer::CClient *pClient = &m_pServer->m_aClients[ClientID];
+	if(pClient->m_State == CServer::CClient::STATE_EMPTY)
+		CServer::NewClientCallback(ClientID, m_pServer, m_aJoinSixup[ClientID]);
+	if(pClient->m_State >= CServer::CClient::STATE_READY)
+		return;
+
+	// the map download isn't recorded, the client is ready as soon as it
+	// starts to talk to the game
+	pClient->m_State = CServer::CClient::STATE_READY;
+	m_pServer->GameServer()->OnClientConnected(ClientID, 0);
+}
+
+void CTeeHistorianReplay::Enter(int ClientID)
+{
+	Connect(ClientID);
+	CServer::CClient *pClient = &m_pServer->m_aClients[ClientID];
+	if(pClient->m_State != CServer::CClient::STATE_READY)
+		return;
+
+	// the version of the client is recorded after it entered the game but
+	// known before, look for it in the rest of the tick
+	CTeeHistorianReader Reader = m_Reader;
+	CTeeHistorianReader::CItem Item;
+	while(Reader.Next(&Item) && Item.m_Tick == m_Reader.Tick())
+	{
+		if(Item.m_Type == CTeeHistorianReader::ITEM_EX && Item.m_ExID == TEEHISTORIAN_DDNETVER && Item.m_ClientID == ClientID)
+		{
+			SetDDNetVersion(&Item);
+			break;
+		}
+	}
+
+	pClient->m_State = CServer::CClient::STATE_INGAME;
+	m_pServer->GameServer()->OnClientEnter(ClientID);
+}
+
+void CTeeHistorianReplay::SetDDNetVersion(const CTeeHistorianReader::CItem *pItem)
+{
+	CServer::CClient *pClient = &m_pServer->m_aClients[pItem->m_ClientID];
+	if(pClient->m_GotDDNetVersionPacket)
+		return;
+
+	CUnpacker Unpacker;
+	Unpacker.Reset(pItem->m_pData, pItem->m_DataSize);
+	Unpacker.GetInt();
+	const CUuid *pConnectionID = (const CUuid *)Unpacker.GetRaw(sizeof(CUuid));
+	int DDNetVersion = Unpacker.GetInt();
+	const char *pDDNetVersionStr = Unpacker.GetString(CUnpacker::SANITIZE_CC);
+	if(Unpacker.Error())
+		return;
+
+	pClient->m_ConnectionID = *pConnectionID;
+	pClient->m_DDNetVersion = DDNetVersion;
+	str_copy(pClient->m_aDDNetVersionStr, pDDNetVersionStr, sizeof(pClient->m_aDDNetVersionStr));
+	pClient->m_DDNetVersionSettled = true;
+	pClient->m_GotDDNetVersionPacket = true;
+}
+
+void CTeeHistorianReplay::ApplyEx(const CTeeHistorianReader::CItem *pItem)
+{
+	int ClientID = pItem->m_ClientID;
+	if(ClientID < 0 || ClientID >= MAX_CLIENTS)
+		return;
+
+	CServer::CClient *pClient = &m_pServer->m_aClients[ClientID];
+	CUnpacker Unpacker;
+	Unpacker.Reset(pItem->m_pData, pItem->m_DataSize);
+	Unpacker.GetInt();
+
+	switch(pItem->m_ExID)
+	{
+	case TEEHISTORIAN_JOINVER6:
+	case TEEHISTORIAN_JOINVER7:
+		m_aJoinSixup[ClientID] = pItem->m_ExID == TEEHISTORIAN_JOINVER7;
+		break;
+	case TEEHISTORIAN_PLAYER_READY:
+		Enter(ClientID);
+		break;
+	case TEEHISTORIAN_DDNETVER:
+		SetDDNetVersion(pItem);
+		break;
+	case TEEHISTORIAN_AUTH_INIT:
+	case TEEHISTORIAN_AUTH_LOGIN:
+	{
+		int Level = Unpacker.GetInt();
+		if(Unpacker.Error() || pClient->m_State == CServer::CClient::STATE_EMPTY)
+			break;
+		pClient->m_Authed = Level;
+		pClient->m_AuthKey = -1;
+		m_pServer->GameServer()->OnSetAuthed(ClientID, Level);
+		break;
+	}
+	case TEEHISTORIAN_AUTH_LOGOUT:
+		if(pClient->m_State == CServer::CClient::STATE_EMPTY)
+			break;
+		pClient->m_Authed = AUTHED_NO;
+		pClient->m_AuthKey = -1;
+		m_pServer->GameServer()->OnSetAuthed(ClientID, AUTHED_NO);
+		break;
+	}
+	// the old version chunk is the result of a recorded game message, the
+	// save and load chunks would need the database
+}
+
+void CTeeHistorianReplay::Apply(const CTeeHistorianReader::CItem *pItem)
+{
+	CServer *pServer = m_pServer;
+	int ClientID = pItem->m_ClientID;
+
+	if(pItem->m_Type == CTeeHistorianReader::ITEM_PLAYER || pItem->m_Type == CTeeHistorianReader::ITEM_PLAYER_OLD)
+	{
+		CExpected *pExpected = &m_aExpected[ClientID];
+		pExpected->m_Alive = pItem->m_Type == CTeeHistorianReader::ITEM_PLAYER;
+		pExpected->m_X = pItem->m_X;
+		pExpected->m_Y = pItem->m_Y;
+		return;
+	}
+	Check();
+
+	switch(pItem->m_Type)
+	{
+	case CTeeHistorianReader::ITEM_JOIN:
+		if(ClientID >= 0 && ClientID < MAX_CLIENTS && pServer->m_aClients[ClientID].m_State == CServer::CClient::STATE_EMPTY)
+			CServer::NewClientCallback(ClientID, pServer, m_aJoinSixup[ClientID]);
+		break;
+	case CTeeHistorianReader::ITEM_DROP:
+		if(ClientID >= 0 && ClientID < MAX_CLIENTS && pServer->m_aClients[ClientID].m_State != CServer::CClient::STATE_EMPTY)
+			CServer::DelClientCallback(ClientID, pItem->m_pReason, pServer);
+		if(ClientID >= 0 && ClientID < MAX_CLIENTS)
+		{
+			m_aJoinSixup[ClientID] = false;
+			m_aNextInput[ClientID] = false;
+		}
+		break;
+	case CTeeHistorianReader::ITEM_INPUT:
+	{
+		// recorded as early input right before the next tick
+		CServer::CClient *pClient = &pServer->m_aClients[ClientID];
+		if(pClient->m_State != CServer::CClient::STATE_INGAME)
+		{
+			// files without the ready chunk only show the first input
+			Enter(ClientID);
+		}
+		if(pClient->m_State != CServer::CClient::STATE_INGAME)
+			break;
+		mem_zero(pClient->m_LatestInput.m_aData, sizeof(pClient->m_LatestInput.m_aData));
+		mem_copy(pClient->m_LatestInput.m_aData, &pItem->m_Input, sizeof(pItem->m_Input));
+		pClient->m_LatestInput.m_GameTick = pServer->Tick() + 1;
+		pServer->GameServer()->OnClientDirectInput(ClientID, pClient->m_LatestInput.m_aData);
+		pServer->GameServer()->OnClientPredictedEarlyInput(ClientID, pClient->m_LatestInput.m_aData);
+		m_aNextInput[ClientID] = true;
+		break;
+	}
+	case CTeeHistorianReader::ITEM_MESSAGE:
+	{
+		if(ClientID < 0 || ClientID >= MAX_CLIENTS)
+			break;
+		Connect(ClientID);
+		CUnpacker Unpacker;
+		Unpacker.Reset(pItem->m_pData, pItem->m_DataSize);
+		CMsgPacker Packer(NETMSG_EX, true);
+		int Msg;
+		bool Sys;
+		CUuid Uuid;
+		if(UnpackMessageID(&Msg, &Sys, &Uuid, &Unpacker, &Packer) == UNPACKMESSAGE_OK && !Sys)
+			pServer->GameServer()->OnMessage(Msg, &Unpacker, ClientID);
+		break;
+	}
+	case CTeeHistorianReader::ITEM_CONSOLE_COMMAND:
+	{
+		// tick 0 is the config and the map settings, those are already
+		// applied, and the game reruns its own commands itself
+		if(pItem->m_Tick == 0 || ClientID == IConsole::CLIENT_ID_GAME)
+			break;
+		char aLine[1024];
+		str_copy(aLine, pItem->m_pCommand, sizeof(aLine));
+		for(int i = 0; i < pItem->m_NumArgs; i++)
+		{
+			str_append(aLine, " \"", sizeof(aLine));
+			char *pDst = aLine + str_length(aLine);
+			str_escape(&pDst, pItem->m_apArgs[i], aLine + sizeof(aLine));
+			str_append(aLine, "\"", sizeof(aLine));
+		}
+		pServer->Console()->ExecuteLineFlag(aLine, pItem->m_FlagMask, ClientID, false);
+		break;
+	}
+	case CTeeHistorianReader::ITEM_EX:
+		ApplyEx(pItem);
+		break;
+	}
+}
+
+int CTeeHistorianReplay::Run(const char *pFilename)
+{
+	CServer *pServer = m_pServer;
+	pServer->m_Replaying = true;
+	pServer->m_RunServer = CServer::RUNNING;
+
+	if(!LoadFile(pFilename) || !Init())
+	{
+		free(m_pData);
+		return -1;
+	}
+
+	for(int i = 0; i < MAX_CLIENTS; i++)
+	{
+		m_aJoinSixup[i] = false;
+		m_aNextInput[i] = false;
+		m_aExpected[i].m_Alive = false;
+		m_aExpected[i].m_X = 0;
+		m_aExpected[i].m_Y = 0;
+		m_aFirstMismatch[i] = -1;
+	}
+	m_CheckedTick = -1;
+	m_NumChecked = 0;
+	m_NumMismatches = 0;
+
+	pServer->m_Profiler.SetEnabled(true);
+	pServer->m_Profiler.Reset();
+	pServer->m_GameStartTime = time_get();
+	int StartTick = pServer->Tick();
+	int64_t StartTime = time_get();
+
+	CTeeHistorianReader::CItem Item;
+	bool Finished = false;
+	while(m_Reader.Next(&Item) && !pServer->ErrorShutdown())
+	{
+		while(pServer->Tick() < Item.m_Tick)
+		{
+			Check();
+			Tick();
+		}
+		Apply(&Item);
+		Finished = Item.m_Type == CTeeHistorianReader::ITEM_FINISH;
+	}
+	// the last tick of an unfinished file can be cut off in the middle of
+	// the player positions
+	if(Finished)
+		Check();
+
+	int64_t Duration = time_get() - StartTime;
+	int Ticks = pServer->Tick() - StartTick;
+	double Seconds = Duration / (double)time_freq();
+	char aBuf[256];
+	if(m_Reader.Error())
+	{
+		str_format(aBuf, sizeof(aBuf), "the file is corrupt after tick %d, stopped early", m_Reader.Tick());
+		pServer->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "replay", aBuf);
+	}
+	str_format(aBuf, sizeof(aBuf), "replayed %d ticks in %.3fs, %.0f ticks/s, %.1fx realtime",
+		Ticks, Seconds, Seconds > 0 ? Ticks / Seconds : 0.0, Seconds > 0 ? Ticks / Seconds / pServer->TickSpeed() : 0.0);
+	pServer->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "replay", aBuf);
+	pServer->m_Profiler.Dump(pServer->Console());
+	str_format(aBuf, sizeof(aBuf), "checked %d player ticks, %d mismatches", m_NumChecked, m_NumMismatches);
+	pServer->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "replay", aBuf);
+
+	Shutdown();
+	free(m_pData);
+	m_pData = 0;
+	return m_NumMismatches > 0 ? 1 : 0;
+}
@@ -0,0 +1,58 @@
+#ifndef ENGINE_SERVER_TEEHISTORIAN_REPLAY_H
+#define ENGINE_SERVER_TEEHISTORIAN_REPLAY_H
+
+#include <engine/shared/protocol.h>
+#include <engine/shared/teehistorian_reader.h>
+
+class CServer;
+
+// Runs the game server on the recorded joins, inputs, messages and commands
+// of a teehistorian file, without network and without waiting between
+// ticks. After each tick the characters are compared to the recorded
+// positions, so it works both as a benchmark and as a determinism check.
+class CTeeHistorianReplay
+{
+public:
+	CTeeHistorianReplay(CServer *pServer);
+
+	// returns 0 if all positions matched, 1 on mismatches and -1 if the
+	// file couldn't be replayed at all
+	int Run(const char *pFilename);
+
+private:
+	struct CExpected
+	{
+		bool m_Alive;
+		int m_X;
+		int m_Y;
+	};
+
+	bool LoadFile(const char *pFilename);
+	bool Init();
+	void Shutdown();
+
+	void Tick();
+	void Check();
+	void Apply(const CTeeHistorianReader::CItem *pItem);
+	void ApplyEx(const CTeeHistorianReader::CItem *pItem);
+	void Connect(int ClientID);
+	void Enter(int ClientID);
+	void SetDDNetVersion(const CTeeHistorianReader::CItem *pItem);
+
+	CServer *m_pServer;
+	unsigned char *m_pData;
+	int m_DataSize;
+	CTeeHistorianReader m_Reader;
+
+	bool m_aJoinSixup[MAX_CLIENTS];
+	// the recorded input is for the next tick
+	bool m_aNextInput[MAX_CLIENTS];
+
+	CExpected m_aExpected[MAX_CLIENTS];
+	int m_aFirstMismatch[MAX_CLIENTS];
+	int m_CheckedTick;
+	int m_NumChecked;
+	int m_NumMismatches;
+};
+
+#endif // ENGINE_SERVER_TEEHISTORIAN_REPLAY_H
@@ -1,6 +1,8 @@
 /* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
 /* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#include <ctype.h>
 #include <new>
+#include <vector>
 
 #include <base/color.h>
 #include <base/math.h>
@@ -313,11 +315,81 @@ char *CConsole::Format(char *pBuf, int Size, const char *pFrom, const char *pStr
 	return pBuf;
 }
 
-void CConsole::Print(int Level, const char *pFrom, const char *pStr, ColorRGBA PrintColor)
+bool CConsole::FilterLog(int Level, const char *pFrom)
+{
+	for(auto &Filter : m_vLogFilters)
+	{
+		if(str_comp(Filter.m_aCategory, pFrom) != 0)
+			continue;
+
+		if(Level > Filter.m_Level)
+			return false;
+		if(!Filter.m_Rate)
+			return true;
+
+		int64_t Now = time_get();
+		if(Now >= Filter.m_WindowStart + time_freq())
+		{
+			if(Filter.m_NumSuppressed)
+			{
+				char aBuf[64];
+				str_format(aBuf, sizeof(aBuf), "%d lines suppressed", Filter.m_NumSuppressed);
+				Output(OUTPUT_LEVEL_STANDARD, pFrom, aBuf, ColorRGBA(1, 1, 1, 1));
+			}
+			Filter.m_WindowStart = Now;
+			Filter.m_NumLines = 0;
+			Filter.m_NumSuppressed = 0;
+		}
+		if(Filter.m_NumLines >= Filter.m_Rate)
+		{
+			Filter.m_NumSuppressed++;
+			return false;
+		}
+		Filter.m_NumLines++;
+		return true;
+	}
+	return true;
+}
+
+void CConsole::Output(int Level, const char *pFrom, const char *pStr, ColorRGBA PrintColor)
 {
-	set_console_msg_color(&PrintColor);
-	dbg_msg(pFrom, "%s", pStr);
-	set_console_msg_color(NULL);
+	bool Captured = false;
+	if(m_pLogThread && std::this_thread::get_id() == m_MainThread)
+	{
+		// level, color, category and text as they are, nothing is
+		// formatted on this thread
+		char aRecord[sizeof(ColorRGBA) + 64 + 4096];
+		int FromLength = minimum(str_length(pFrom), 63);
+		int StrLength = minimum(str_length(pStr), 4095);
+		mem_copy(aRecord, &PrintColor, sizeof(PrintColor));
+		mem_copy(aRecord + sizeof(PrintColor), pFrom, FromLength);
+		aRecord[sizeof(PrintColor) + FromLength] = 0;
+		mem_copy(aRecord + sizeof(PrintColor) + FromLength + 1, pStr, StrLength);
+		aRecord[sizeof(PrintColor) + FromLength + 1 + StrLength] = 0;
+		if(m_LogQueue.Push(Level, 0, aRecord, sizeof(PrintColor) + FromLength + StrLength + 2))
+		{
+			// the sink only has to be woken if it ran out of work
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			if(m_LogSleeping.load(std::memory_order_relaxed) && m_LogSleeping.exchange(false))
+				sphore_signal(&m_LogSemaphore);
+		}
+		else
+			m_NumLogDropped++;
+		Captured = true;
+	}
+	if(!Captured)
+	{
+		set_console_msg_color(&PrintColor);
+		dbg_msg(pFrom, "%s", pStr);
+		set_console_msg_color(NULL);
+	}
+
+	bool Wanted = false;
+	for(int i = 0; i < m_NumPrintCB; ++i)
+		Wanted = Wanted || (Level <= m_aPrintCB[i].m_OutputLevel && m_aPrintCB[i].m_pfnPrintCallback);
+	if(!Wanted)
+		return;
+
 	char aBuf[1024];
 	Format(aBuf, sizeof(aBuf), pFrom, pStr);
 	for(int i = 0; i < m_NumPrintCB; ++i)
@@ -329,6 +401,138 @@ void CConsole::Print(int Level, const char *pFrom, const char *pStr, ColorRGBA P
 	}
 }
 
+void CConsole::Print(int Level, const char *pFrom, const char *pStr, ColorRGBA PrintColor)
+{
+	// the filters are only changed and checked on the console's thread
+	if(!m_vLogFilters.empty() && std::this_thread::get_id() == m_MainThread && !FilterLog(Level, pFrom))
+		return;
+	Output(Level, pFrom, pStr, PrintColor);
+}
+
+void CConsole::ConLogFilter(IResult *pResult, void *pUserData)
+{
+	CConsole *pConsole = static_cast<CConsole *>(pUserData);
+	const char *pCategory = pResult->GetString(0);
+	int Level = clamp(pResult->GetInteger(1), -1, (int)OUTPUT_LEVEL_DEBUG);
+	int Rate = pResult->NumArguments() > 2 ? maximum(pResult->GetInteger(2), 0) : 0;
+
+	CLogFilter *pFilter = 0;
+	for(auto &Filter : pConsole->m_vLogFilters)
+		if(str_comp(Filter.m_aCategory, pCategory) == 0)
+			pFilter = &Filter;
+
+	if(Level == OUTPUT_LEVEL_DEBUG && Rate == 0)
+	{
+		if(pFilter)
+			pConsole->m_vLogFilters.erase(pConsole->m_vLogFilters.begin() + (pFilter - pConsole->m_vLogFilters.data()));
+	}
+	else
+	{
+		if(!pFilter)
+		{
+			CLogFilter NewFilter;
+			str_copy(NewFilter.m_aCategory, pCategory, sizeof(NewFilter.m_aCategory));
+			NewFilter.m_WindowStart = 0;
+			NewFilter.m_NumLines = 0;
+			NewFilter.m_NumSuppressed = 0;
+			pConsole->m_vLogFilters.push_back(NewFilter);
+			pFilter = &pConsole->m_vLogFilters.back();
+		}
+		pFilter->m_Level = Level;
+		pFilter->m_Rate = Rate;
+	}
+
+	char aBuf[128];
+	str_format(aBuf, sizeof(aBuf), "category '%s' limited to level %d, %d lines per second", pCategory, Level, Rate);
+	pConsole->Print(OUTPUT_LEVEL_STANDARD, "console", aBuf);
+}
+
+void CConsole::ConLogFilters(IResult *pResult, void *pUserData)
+{
+	CConsole *pConsole = static_cast<CConsole *>(pUserData);
+	char aBuf[128];
+	for(const auto &Filter : pConsole->m_vLogFilters)
+	{
+		str_format(aBuf, sizeof(aBuf), "%s: level %d, %d lines per second", Filter.m_aCategory, Filter.m_Level, Filter.m_Rate);
+		pConsole->Print(OUTPUT_LEVEL_STANDARD, "console", aBuf);
+	}
+	str_format(aBuf, sizeof(aBuf), "%d categories limited", (int)pConsole->m_vLogFilters.size());
+	pConsole->Print(OUTPUT_LEVEL_STANDARD, "console", aBuf);
+}
+
+void CConsole::LogThread(void *pUser)
+{
+	((CConsole *)pUser)->RunLogSink();
+}
+
+bool CConsole::PopLogRecord()
+{
+	int Level;
+	int ID;
+	int Size;
+	char aRecord[sizeof(ColorRGBA) + 64 + 4096];
+
+	// both the sink and the console's thread consume, one record at a time
+	lock_wait(m_LogPopLock);
+	bool Popped = m_LogQueue.Pop(&Level, &ID, aRecord, sizeof(aRecord), &Size);
+	if(Popped)
+	{
+		ColorRGBA Color;
+		mem_copy(&Color, aRecord, sizeof(Color));
+		const char *pFrom = aRecord + sizeof(Color);
+		const char *pStr = pFrom + str_length(pFrom) + 1;
+		if(m_pfnLogWriter)
+			m_pfnLogWriter(pFrom, pStr, m_pLogWriterUser);
+		else
+		{
+			set_console_msg_color(&Color);
+			dbg_msg(pFrom, "%s", pStr);
+			set_console_msg_color(NULL);
+		}
+	}
+	lock_unlock(m_LogPopLock);
+	return Popped;
+}
+
+void CConsole::FlushLog(void *pUser)
+{
+	CConsole *pSelf = (CConsole *)pUser;
+	// the queued lines are written with dbg_msg as well
+	if(pSelf->m_LogDraining)
+		return;
+	pSelf->m_LogDraining = true;
+	while(pSelf->PopLogRecord())
+	{
+	}
+	pSelf->m_LogDraining = false;
+}
+
+void CConsole::RunLogSink()
+{
+	while(true)
+	{
+		while(PopLogRecord())
+		{
+		}
+
+		int NumDropped = m_NumLogDropped.exchange(0);
+		if(NumDropped)
+			dbg_msg("console", "log output too fast, dropped %d lines", NumDropped);
+
+		if(m_LogShutdown.load())
+			break;
+
+		// sleep until the next line, the producer checks the flag after
+		// pushing, so one of both sides always sees the other
+		m_LogSleeping.store(true);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if(m_LogQueue.Used() == 0 && !m_LogShutdown.load())
+			sphore_wait(&m_LogSemaphore);
+		else if(!m_LogSleeping.exchange(false))
+			sphore_wait(&m_LogSemaphore); // a producer already signalled
+	}
+}
+
 void CConsole::SetTeeHistorianCommandCallback(FTeeHistorianCommandCallback pfnCallback, void *pUser)
 {
 	m_pfnTeeHistorianCommandCallback = pfnCallback;
@@ -538,9 +742,17 @@ void CConsole::PossibleCommands(const char *pStr, int FlagMask, bool Temp, FPoss
 	}
 }
 
+unsigned CConsole::CommandHash(const char *pName)
+{
+	unsigned Hash = 5381;
+	for(; *pName; pName++)
+		Hash = Hash * 33 + tolower((unsigned char)*pName);
+	return Hash % COMMAND_HASH_SIZE;
+}
+
 CConsole::CCommand *CConsole::FindCommand(const char *pName, int FlagMask)
 {
-	for(CCommand *pCommand = m_pFirstCommand; pCommand; pCommand = pCommand->m_pNext)
+	for(CCommand *pCommand = m_apCommandHash[CommandHash(pName)]; pCommand; pCommand = pCommand->m_pNextHash)
 	{
 		if(pCommand->m_Flags & FlagMask)
 		{
@@ -555,7 +767,9 @@ CConsole::CCommand *CConsole::FindCommand(const char *pName, int FlagMask)
 void CConsole::ExecuteLine(const char *pStr, int ClientID, bool InterpretSemicolons)
 {
 	CConsole::ExecuteLineStroked(1, pStr, ClientID, InterpretSemicolons); // press it
-	CConsole::ExecuteLineStroked(0, pStr, ClientID, InterpretSemicolons); // then release it
+	// releasing only does something for stroke commands, skip parsing the line again otherwise
+	if(str_find(pStr, "+"))
+		CConsole::ExecuteLineStroked(0, pStr, ClientID, InterpretSemicolons); // then release it
 }
 
 void CConsole::ExecuteLineFlag(const char *pStr, int FlagMask, int ClientID, bool InterpretSemicolons)
@@ -921,7 +1135,8 @@ void CConsole::ConToggleStroke(IConsole::IResult *pResult, void *pUser)
 		pConsole->Print(OUTPUT_LEVEL_STANDARD, "console", aBuf);
 }
 
-CConsole::CConsole(int FlagMask)
+CConsole::CConsole(int FlagMask) :
+	m_LogQueue(2 * 1024 * 1024)
 {
 	m_FlagMask = FlagMask;
 	m_AccessLevel = ACCESS_LEVEL_ADMIN;
@@ -932,6 +1147,7 @@ CConsole::CConsole(int FlagMask)
 	m_apStrokeStr[1] = "1";
 	m_ExecutionQueue.Reset();
 	m_pFirstCommand = 0;
+	mem_zero(m_apCommandHash, sizeof(m_apCommandHash));
 	m_pFirstExec = 0;
 	mem_zero(m_aPrintCB, sizeof(m_aPrintCB));
 	m_NumPrintCB = 0;
@@ -951,6 +1167,21 @@ CConsole::CConsole(int FlagMask)
 	Register("access_status", "i[accesslevel]", CFGFLAG_SERVER, ConCommandStatus, this, "List all commands which are accessible for admin = 0, moderator = 1, helper = 2, all = 3");
 	Register("cmdlist", "", CFGFLAG_SERVER | CFGFLAG_CHAT, ConUserCommandStatus, this, "List all commands which are accessible for users");
 
+	Register("log_filter", "s[category] i[level] ?i[lines per second]", CFGFLAG_SERVER | CFGFLAG_CLIENT, ConLogFilter, this, "Limit the output of a category to a level (-1 mutes it) and optionally a rate, level 2 and rate 0 remove the limit");
+	Register("log_filters", "", CFGFLAG_SERVER | CFGFLAG_CLIENT, ConLogFilters, this, "List the output limits of the categories");
+
+	m_LogSleeping.store(false);
+	m_LogShutdown.store(false);
+	m_NumLogDropped.store(0);
+	m_MainThread = std::this_thread::get_id();
+	sphore_init(&m_LogSemaphore);
+	m_LogPopLock = lock_create();
+	m_LogDraining = false;
+	m_pfnLogWriter = 0;
+	m_pLogWriterUser = 0;
+	m_pLogThread = thread_init(LogThread, this, "console log");
+	m_LogFlushHook = dbg_flush_hook(FlushLog, this);
+
 	// DDRace
 
 	m_Cheated = false;
@@ -958,6 +1189,16 @@ CConsole::CConsole(int FlagMask)
 
 CConsole::~CConsole()
 {
+	// write everything that was captured
+	if(m_LogFlushHook)
+		dbg_flush_hook(0, 0);
+	m_LogShutdown.store(true);
+	if(m_LogSleeping.exchange(false))
+		sphore_signal(&m_LogSemaphore);
+	thread_wait(m_pLogThread);
+	sphore_destroy(&m_LogSemaphore);
+	lock_destroy(m_LogPopLock);
+
 	CCommand *pCommand = m_pFirstCommand;
 	while(pCommand)
 	{
@@ -1020,6 +1261,11 @@ void CConsole::ParseArguments(int NumArgs, const char **ppArguments)
 			// skip silent param
 			continue;
 		}
+		else if(!str_comp("--replay", ppArguments[i]))
+		{
+			// skip the teehistorian file to replay, handled by the server
+			i++;
+		}
 		else
 		{
 			// search arguments for overrides
@@ -1032,10 +1278,7 @@ void CConsole::AddCommandSorted(CCommand *pCommand)
 {
 	if(!m_pFirstCommand || str_comp(pCommand->m_pName, m_pFirstCommand->m_pName) <= 0)
 	{
-		if(m_pFirstCommand && m_pFirstCommand->m_pNext)
-			pCommand->m_pNext = m_pFirstCommand;
-		else
-			pCommand->m_pNext = 0;
+		pCommand->m_pNext = m_pFirstCommand;
 		m_pFirstCommand = pCommand;
 	}
 	else
@@ -1050,6 +1293,39 @@ void CConsole::AddCommandSorted(CCommand *pCommand)
 			}
 		}
 	}
+
+	// new commands shadow older ones of the same name, like in the list
+	unsigned Hash = CommandHash(pCommand->m_pName);
+	pCommand->m_pNextHash = m_apCommandHash[Hash];
+	m_apCommandHash[Hash] = pCommand;
+}
+
+void CConsole::RemoveCommandHash(CCommand *pCommand)
+{
+	for(CCommand **ppCur = &m_apCommandHash[CommandHash(pCommand->m_pName)]; *ppCur; ppCur = &(*ppCur)->m_pNextHash)
+	{
+		if(*ppCur == pCommand)
+		{
+			*ppCur = pCommand->m_pNextHash;
+			break;
+		}
+	}
+}
+
+void CConsole::RebuildCommandHash()
+{
+	// insert in reverse list order to keep the order of equal names
+	std::vector<CCommand *> vpCommands;
+	for(CCommand *pCommand = m_pFirstCommand; pCommand; pCommand = pCommand->m_pNext)
+		vpCommands.push_back(pCommand);
+
+	mem_zero(m_apCommandHash, sizeof(m_apCommandHash));
+	for(auto it = vpCommands.rbegin(); it != vpCommands.rend(); ++it)
+	{
+		unsigned Hash = CommandHash((*it)->m_pName);
+		(*it)->m_pNextHash = m_apCommandHash[Hash];
+		m_apCommandHash[Hash] = *it;
+	}
 }
 
 void CConsole::Register(const char *pName, const char *pParams,
@@ -1140,6 +1416,7 @@ void CConsole::DeregisterTemp(const char *pName)
 	// add to recycle list
 	if(pRemoved)
 	{
+		RemoveCommandHash(pRemoved);
 		pRemoved->m_pNext = m_pRecycleList;
 		m_pRecycleList = pRemoved;
 	}
@@ -1163,6 +1440,7 @@ void CConsole::DeregisterTempAll()
 		}
 	}
 
+	RebuildCommandHash();
 	m_TempCommands.Reset();
 	m_pRecycleList = 0;
 }
@@ -1211,7 +1489,7 @@ void CConsole::StoreCommands(bool Store)
 
 const IConsole::CCommandInfo *CConsole::GetCommandInfo(const char *pName, int FlagMask, bool Temp)
 {
-	for(CCommand *pCommand = m_pFirstCommand; pCommand; pCommand = pCommand->m_pNext)
+	for(CCommand *pCommand = m_apCommandHash[CommandHash(pName)]; pCommand; pCommand = pCommand->m_pNextHash)
 	{
 		if(pCommand->m_Flags & FlagMask && pCommand->m_Temp == Temp)
 		{
@@ -4,16 +4,26 @@
 #define ENGINE_SHARED_CONSOLE_H
 
 #include "memheap.h"
+#include "spsc_queue.h"
 #include <base/math.h>
 #include <engine/console.h>
 #include <engine/storage.h>
 
+#include <atomic>
+#include <thread>
+#include <vector>
+
 class CConsole : public IConsole
 {
+public:
+	typedef void (*FLogWriter)(const char *pFrom, const char *pStr, void *pUser);
+
+private:
 	class CCommand : public CCommandInfo
 	{
 	public:
 		CCommand *m_pNext;
+		CCommand *m_pNextHash;
 		int m_Flags;
 		bool m_Temp;
 		FCommandCallback m_pfnCallback;
@@ -38,6 +48,13 @@ class CConsole : public IConsole
 	const char *m_apStrokeStr[2];
 	CCommand *m_pFirstCommand;
 
+	enum
+	{
+		COMMAND_HASH_SIZE = 1024,
+	};
+	// commands by case insensitive name, same order as in the sorted list for equal names
+	CCommand *m_apCommandHash[COMMAND_HASH_SIZE];
+
 	class CExecFile
 	{
 	public:
@@ -71,6 +88,46 @@ class CConsole : public IConsole
 	} m_aPrintCB[MAX_PRINT_CB];
 	int m_NumPrintCB;
 
+	// per category output level and rate limit, checked before anything
+	// is formatted
+	struct CLogFilter
+	{
+		char m_aCategory[32];
+		int m_Level;
+		int m_Rate;
+		int64_t m_WindowStart;
+		int m_NumLines;
+		int m_NumSuppressed;
+	};
+	std::vector<CLogFilter> m_vLogFilters;
+
+	// lines for the loggers are captured into the queue and formatted and
+	// written by the sink thread, prints from other threads than the one
+	// that created the console are written directly. A dbg_msg on the
+	// console's thread writes the queued lines first, so they stay in order
+	// and an assert doesn't lose them.
+	CSpscQueue m_LogQueue;
+	LOCK m_LogPopLock;
+	bool m_LogDraining;
+	bool m_LogFlushHook;
+	FLogWriter m_pfnLogWriter;
+	void *m_pLogWriterUser;
+	void *m_pLogThread;
+	SEMAPHORE m_LogSemaphore;
+	std::atomic<bool> m_LogSleeping;
+	std::atomic<bool> m_LogShutdown;
+	std::atomic<int> m_NumLogDropped;
+	std::thread::id m_MainThread;
+
+	static void LogThread(void *pUser);
+	void RunLogSink();
+	static void FlushLog(void *pUser);
+	bool PopLogRecord();
+	bool FilterLog(int Level, const char *pFrom);
+	void Output(int Level, const char *pFrom, const char *pStr, ColorRGBA PrintColor);
+	static void ConLogFilter(IResult *pResult, void *pUserData);
+	static void ConLogFilters(IResult *pResult, void *pUserData);
+
 	FTeeHistorianCommandCallback m_pfnTeeHistorianCommandCallback;
 	void *m_pTeeHistorianCommandUserdata;
 
@@ -92,10 +149,12 @@ class CConsole : public IConsole
 		CResult() :
 			IResult()
 		{
-			mem_zero(m_aStringStorage, sizeof(m_aStringStorage));
+			// only the first m_NumArgs arguments and the parsed part of the
+			// storage are ever read, don't clear the whole 40KiB
+			m_aStringStorage[0] = 0;
 			m_pArgsStart = 0;
 			m_pCommand = 0;
-			mem_zero(m_apArgs, sizeof(m_apArgs));
+			m_Victim = VICTIM_NONE;
 		}
 
 		CResult &operator=(const CResult &Other)
@@ -190,7 +249,10 @@ class CConsole : public IConsole
 		}
 	} m_ExecutionQueue;
 
+	static unsigned CommandHash(const char *pName);
 	void AddCommandSorted(CCommand *pCommand);
+	void RemoveCommandHash(CCommand *pCommand);
+	void RebuildCommandHash();
 	CCommand *FindCommand(const char *pName, int FlagMask);
 
 public:
@@ -221,6 +283,14 @@ public:
 	virtual void Print(int Level, const char *pFrom, const char *pStr, ColorRGBA PrintColor = {1, 1, 1, 1});
 	virtual void SetTeeHistorianCommandCallback(FTeeHistorianCommandCallback pfnCallback, void *pUser);
 
+	// replaces the loggers as destination of the queued lines, must be
+	// set before anything is printed
+	void SetLogWriter(FLogWriter pfnWriter, void *pUser)
+	{
+		m_pfnLogWriter = pfnWriter;
+		m_pLogWriterUser = pUser;
+	}
+
 	void SetAccessLevel(int AccessLevel) { m_AccessLevel = clamp(AccessLevel, (int)(ACCESS_LEVEL_ADMIN), (int)(ACCESS_LEVEL_USER)); }
 	void ResetServerGameSettings();
 	// DDRace
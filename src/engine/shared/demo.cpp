@@ -31,6 +31,11 @@ static const int s_NumMarkersOffset = 176;
 static const ColorRGBA gs_DemoPrintColor{0.7f, 0.7f, 0.7f, 1.0f};
 
 CDemoRecorder::CDemoRecorder(class CSnapshotDelta *pSnapshotDelta, bool NoMapData)
+{
+	Init(pSnapshotDelta, NoMapData);
+}
+
+void CDemoRecorder::Init(class CSnapshotDelta *pSnapshotDelta, bool NoMapData)
 {
 	m_File = 0;
 	m_aCurrentFilename[0] = '\0';
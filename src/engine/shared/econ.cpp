@@ -14,9 +14,9 @@ int CEcon::NewClientCallback(int ClientID, void *pUser)
 	str_format(aBuf, sizeof(aBuf), "client accepted. cid=%d addr=%s'", ClientID, aAddrStr);
 	pThis->Console()->Print(IConsole::OUTPUT_LEVEL_ADDINFO, "econ", aBuf);
 
-	pThis->m_aClients[ClientID].m_State = CClient::STATE_CONNECTED;
-	pThis->m_aClients[ClientID].m_TimeConnected = time_get();
-	pThis->m_aClients[ClientID].m_AuthTries = 0;
+	pThis->m_vClients[ClientID].m_State = CClient::STATE_CONNECTED;
+	pThis->m_vClients[ClientID].m_TimeConnected = time_get();
+	pThis->m_vClients[ClientID].m_AuthTries = 0;
 
 	pThis->m_NetConsole.Send(ClientID, "Enter password:");
 	return 0;
@@ -32,7 +32,7 @@ int CEcon::DelClientCallback(int ClientID, const char *pReason, void *pUser)
 	str_format(aBuf, sizeof(aBuf), "client dropped. cid=%d addr=%s reason='%s'", ClientID, aAddrStr, pReason);
 	pThis->Console()->Print(IConsole::OUTPUT_LEVEL_ADDINFO, "econ", aBuf);
 
-	pThis->m_aClients[ClientID].m_State = CClient::STATE_EMPTY;
+	pThis->m_vClients[ClientID].m_State = CClient::STATE_EMPTY;
 	return 0;
 }
 
@@ -55,7 +55,7 @@ void CEcon::ConLogout(IConsole::IResult *pResult, void *pUserData)
 {
 	CEcon *pThis = static_cast<CEcon *>(pUserData);
 
-	if(pThis->m_UserClientID >= 0 && pThis->m_UserClientID < NET_MAX_CONSOLE_CLIENTS && pThis->m_aClients[pThis->m_UserClientID].m_State != CClient::STATE_EMPTY)
+	if(pThis->m_UserClientID >= 0 && pThis->m_UserClientID < (int)pThis->m_vClients.size() && pThis->m_vClients[pThis->m_UserClientID].m_State != CClient::STATE_EMPTY)
 		pThis->m_NetConsole.Drop(pThis->m_UserClientID, "Logout");
 }
 
@@ -64,7 +64,9 @@ void CEcon::Init(CConfig *pConfig, IConsole *pConsole, CNetBan *pNetBan)
 	m_pConfig = pConfig;
 	m_pConsole = pConsole;
 
-	for(auto &Client : m_aClients)
+	m_vClients.clear();
+	m_vClients.resize(g_Config.m_EcMaxClients);
+	for(auto &Client : m_vClients)
 		Client.m_State = CClient::STATE_EMPTY;
 
 	m_Ready = false;
@@ -87,7 +89,7 @@ void CEcon::Init(CConfig *pConfig, IConsole *pConsole, CNetBan *pNetBan)
 		BindAddr.port = g_Config.m_EcPort;
 	}
 
-	if(m_NetConsole.Open(BindAddr, pNetBan, 0))
+	if(m_NetConsole.Open(BindAddr, pNetBan, m_vClients.size(), g_Config.m_EcOutputBuffer * 1024))
 	{
 		m_NetConsole.SetCallbacks(NewClientCallback, DelClientCallback, this);
 		m_Ready = true;
@@ -116,24 +118,25 @@ void CEcon::Update()
 
 	while(m_NetConsole.Recv(aBuf, (int)(sizeof(aBuf)) - 1, &ClientID))
 	{
-		dbg_assert(m_aClients[ClientID].m_State != CClient::STATE_EMPTY, "got message from empty slot");
-		if(m_aClients[ClientID].m_State == CClient::STATE_CONNECTED)
+		dbg_assert(m_vClients[ClientID].m_State != CClient::STATE_EMPTY, "got message from empty slot");
+		if(m_vClients[ClientID].m_State == CClient::STATE_CONNECTED)
 		{
 			if(str_comp(aBuf, g_Config.m_EcPassword) == 0)
 			{
-				m_aClients[ClientID].m_State = CClient::STATE_AUTHED;
+				m_vClients[ClientID].m_State = CClient::STATE_AUTHED;
 				m_NetConsole.Send(ClientID, "Authentication successful. External console access granted.");
+				m_NetConsole.SetBroadcast(ClientID, true);
 
 				str_format(aBuf, sizeof(aBuf), "cid=%d authed", ClientID);
 				Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "econ", aBuf);
 			}
 			else
 			{
-				m_aClients[ClientID].m_AuthTries++;
+				m_vClients[ClientID].m_AuthTries++;
 				char aMsg[128];
-				str_format(aMsg, sizeof(aMsg), "Wrong password %d/%d.", m_aClients[ClientID].m_AuthTries, MAX_AUTH_TRIES);
+				str_format(aMsg, sizeof(aMsg), "Wrong password %d/%d.", m_vClients[ClientID].m_AuthTries, MAX_AUTH_TRIES);
 				m_NetConsole.Send(ClientID, aMsg);
-				if(m_aClients[ClientID].m_AuthTries >= MAX_AUTH_TRIES)
+				if(m_vClients[ClientID].m_AuthTries >= MAX_AUTH_TRIES)
 				{
 					if(!g_Config.m_EcBantime)
 						m_NetConsole.Drop(ClientID, "Too many authentication tries");
@@ -142,7 +145,7 @@ void CEcon::Update()
 				}
 			}
 		}
-		else if(m_aClients[ClientID].m_State == CClient::STATE_AUTHED)
+		else if(m_vClients[ClientID].m_State == CClient::STATE_AUTHED)
 		{
 			char aFormatted[256];
 			str_format(aFormatted, sizeof(aFormatted), "cid=%d cmd='%s'", ClientID, aBuf);
@@ -153,10 +156,10 @@ void CEcon::Update()
 		}
 	}
 
-	for(int i = 0; i < NET_MAX_CONSOLE_CLIENTS; ++i)
+	for(int i = 0; i < (int)m_vClients.size(); ++i)
 	{
-		if(m_aClients[i].m_State == CClient::STATE_CONNECTED &&
-			time_get() > m_aClients[i].m_TimeConnected + g_Config.m_EcAuthTimeout * time_freq())
+		if(m_vClients[i].m_State == CClient::STATE_CONNECTED &&
+			time_get() > m_vClients[i].m_TimeConnected + g_Config.m_EcAuthTimeout * time_freq())
 			m_NetConsole.Drop(i, "authentication timeout");
 	}
 }
@@ -166,15 +169,10 @@ void CEcon::Send(int ClientID, const char *pLine)
 	if(!m_Ready)
 		return;
 
+	// authed clients receive the broadcasts, the line is queued only once
 	if(ClientID == -1)
-	{
-		for(int i = 0; i < NET_MAX_CONSOLE_CLIENTS; i++)
-		{
-			if(m_aClients[i].m_State == CClient::STATE_AUTHED)
-				m_NetConsole.Send(i, pLine);
-		}
-	}
-	else if(ClientID >= 0 && ClientID < NET_MAX_CONSOLE_CLIENTS && m_aClients[ClientID].m_State == CClient::STATE_AUTHED)
+		m_NetConsole.Send(-1, pLine);
+	else if(ClientID >= 0 && ClientID < (int)m_vClients.size() && m_vClients[ClientID].m_State == CClient::STATE_AUTHED)
 		m_NetConsole.Send(ClientID, pLine);
 }
 
@@ -5,6 +5,8 @@
 
 #include <engine/console.h>
 
+#include <vector>
+
 class CConfig;
 
 class CEcon
@@ -28,7 +30,7 @@ class CEcon
 		int64_t m_TimeConnected;
 		int m_AuthTries;
 	};
-	CClient m_aClients[NET_MAX_CONSOLE_CLIENTS];
+	std::vector<CClient> m_vClients;
 
 	CConfig *m_pConfig;
 	IConsole *m_pConsole;
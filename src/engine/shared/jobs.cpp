@@ -30,6 +30,7 @@ int IJob::Status()
 CJobPool::CJobPool()
 {
 	// empty the pool
+	m_MaxThreads = 0;
 	m_NumThreads = 0;
 	m_Shutdown = false;
 	m_Lock = lock_create();
@@ -41,9 +42,12 @@ CJobPool::CJobPool()
 CJobPool::~CJobPool()
 {
 	m_Shutdown = true;
-	for(int i = 0; i < m_NumThreads; i++)
+	lock_wait(m_Lock);
+	int NumThreads = m_NumThreads;
+	lock_unlock(m_Lock);
+	for(int i = 0; i < NumThreads; i++)
 		sphore_signal(&m_Semaphore);
-	for(int i = 0; i < m_NumThreads; i++)
+	for(int i = 0; i < NumThreads; i++)
 	{
 		if(m_apThreads[i])
 			thread_wait(m_apThreads[i]);
@@ -82,10 +86,7 @@ void CJobPool::WorkerThread(void *pUser)
 
 void CJobPool::Init(int NumThreads)
 {
-	// start threads
-	m_NumThreads = NumThreads > MAX_THREADS ? MAX_THREADS : NumThreads;
-	for(int i = 0; i < NumThreads; i++)
-		m_apThreads[i] = thread_init(WorkerThread, this, "CJobPool worker");
+	m_MaxThreads = NumThreads > MAX_THREADS ? MAX_THREADS : NumThreads;
 }
 
 void CJobPool::Add(std::shared_ptr<IJob> pJob)
@@ -99,6 +100,14 @@ void CJobPool::Add(std::shared_ptr<IJob> pJob)
 	if(!m_pFirstJob)
 		m_pFirstJob = m_pLastJob;
 
+	// start one more worker per queued job until the pool is full, servers
+	// that never add jobs don't need to keep idle threads around
+	if(m_NumThreads < m_MaxThreads)
+	{
+		m_apThreads[m_NumThreads] = thread_init(WorkerThread, this, "CJobPool worker");
+		m_NumThreads++;
+	}
+
 	lock_unlock(m_Lock);
 	sphore_signal(&m_Semaphore);
 }
@@ -42,7 +42,8 @@ class CJobPool
 	{
 		MAX_THREADS = 32
 	};
-	int m_NumThreads;
+	int m_MaxThreads;
+	int m_NumThreads GUARDED_BY(m_Lock);
 	void *m_apThreads[MAX_THREADS];
 	std::atomic<bool> m_Shutdown;
 
@@ -57,6 +58,7 @@ public:
 	CJobPool();
 	~CJobPool();
 
+	// the worker threads are only started once jobs get added
 	void Init(int NumThreads);
 	void Add(std::shared_ptr<IJob> pJob);
 	static void RunBlocking(IJob *pJob);
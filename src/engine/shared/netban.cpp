@@ -2,6 +2,7 @@
 
 #include <engine/console.h>
 #include <engine/shared/config.h>
+#include <engine/shared/linereader.h>
 #include <engine/storage.h>
 
 #include "netban.h"
@@ -43,11 +44,31 @@ int CNetBan::CNetHash::MakeHashArray(const NETADDR *pAddr, CNetHash aHash[17])
 	return Length;
 }
 
+template<class T, int HashCount>
+void CNetBan::CBanPool<T, HashCount>::AllocBlock()
+{
+	CBan<T> *pBlock = new CBan<T>[BLOCK_SIZE]();
+	m_vpBlocks.emplace_back(pBlock);
+
+	for(int i = 0; i < BLOCK_SIZE; ++i)
+	{
+		pBlock[i].m_pNext = i < BLOCK_SIZE - 1 ? &pBlock[i + 1] : m_pFirstFree;
+		pBlock[i].m_pPrev = i > 0 ? &pBlock[i - 1] : 0;
+	}
+	if(m_pFirstFree)
+		m_pFirstFree->m_pPrev = &pBlock[BLOCK_SIZE - 1];
+	m_pFirstFree = &pBlock[0];
+}
+
 template<class T, int HashCount>
 typename CNetBan::CBan<T> *CNetBan::CBanPool<T, HashCount>::Add(const T *pData, const CBanInfo *pInfo, const CNetHash *pNetHash)
 {
 	if(!m_pFirstFree)
-		return 0;
+	{
+		if(IsFull())
+			return 0;
+		AllocBlock();
+	}
 
 	// create new ban
 	CBan<T> *pBan = m_pFirstFree;
@@ -196,25 +217,17 @@ void CNetBan::UnbanAll()
 {
 	m_BanAddrPool.Reset();
 	m_BanRangePool.Reset();
+	m_BanTrie.Reset();
 }
 
 template<class T, int HashCount>
 void CNetBan::CBanPool<T, HashCount>::Reset()
 {
 	mem_zero(m_aapHashList, sizeof(m_aapHashList));
-	mem_zero(m_aBans, sizeof(m_aBans));
+	m_vpBlocks.clear();
+	m_pFirstFree = 0;
 	m_pFirstUsed = 0;
 	m_CountUsed = 0;
-
-	for(int i = 1; i < MAX_BANS - 1; ++i)
-	{
-		m_aBans[i].m_pNext = &m_aBans[i + 1];
-		m_aBans[i].m_pPrev = &m_aBans[i - 1];
-	}
-
-	m_aBans[0].m_pNext = &m_aBans[1];
-	m_aBans[MAX_BANS - 1].m_pPrev = &m_aBans[MAX_BANS - 2];
-	m_pFirstFree = &m_aBans[0];
 }
 
 template<class T, int HashCount>
@@ -232,13 +245,373 @@ typename CNetBan::CBan<T> *CNetBan::CBanPool<T, HashCount>::Get(int Index) const
 	return 0;
 }
 
+// 128 bit unsigned integer holding an address right-aligned, used to
+// split ranges into CIDR prefixes
+struct CNetUint128
+{
+	uint64_t m_Hi;
+	uint64_t m_Lo;
+
+	static CNetUint128 FromAddr(const NETADDR *pAddr, int Bytes)
+	{
+		CNetUint128 Result = {0, 0};
+		for(int i = 0; i < Bytes; ++i)
+		{
+			Result.m_Hi = (Result.m_Hi << 8) | (Result.m_Lo >> 56);
+			Result.m_Lo = (Result.m_Lo << 8) | pAddr->ip[i];
+		}
+		return Result;
+	}
+
+	void ToBytes(unsigned char *pBytes, int Bytes) const
+	{
+		for(int i = 0; i < Bytes; ++i)
+		{
+			int Shift = (Bytes - 1 - i) * 8;
+			pBytes[i] = Shift >= 64 ? (m_Hi >> (Shift - 64)) & 0xff : (m_Lo >> Shift) & 0xff;
+		}
+	}
+
+	// 2^Bits - 1
+	static CNetUint128 Mask(int Bits)
+	{
+		CNetUint128 Result;
+		Result.m_Hi = Bits >= 128 ? ~(uint64_t)0 : Bits > 64 ? ((uint64_t)1 << (Bits - 64)) - 1 : 0;
+		Result.m_Lo = Bits >= 64 ? ~(uint64_t)0 : ((uint64_t)1 << Bits) - 1;
+		return Result;
+	}
+
+	bool operator==(const CNetUint128 &Other) const { return m_Hi == Other.m_Hi && m_Lo == Other.m_Lo; }
+	CNetUint128 operator+(const CNetUint128 &Other) const
+	{
+		CNetUint128 Result = {m_Hi + Other.m_Hi, m_Lo + Other.m_Lo};
+		Result.m_Hi += Result.m_Lo < m_Lo;
+		return Result;
+	}
+	CNetUint128 operator-(const CNetUint128 &Other) const
+	{
+		CNetUint128 Result = {m_Hi - Other.m_Hi, m_Lo - Other.m_Lo};
+		Result.m_Hi -= m_Lo < Other.m_Lo;
+		return Result;
+	}
+
+	int TrailingZeros() const
+	{
+		int Count = 0;
+		for(uint64_t Part : {m_Lo, m_Hi})
+		{
+			if(Part == 0)
+			{
+				Count += 64;
+				continue;
+			}
+			while(!(Part & 1))
+			{
+				Part >>= 1;
+				++Count;
+			}
+			break;
+		}
+		return Count;
+	}
+
+	// index of the highest set bit, -1 for zero
+	int Log2() const
+	{
+		int Log = -1;
+		for(uint64_t Part = m_Hi ? m_Hi : m_Lo; Part; Part >>= 1)
+			++Log;
+		return m_Hi && Log >= 0 ? Log + 64 : Log;
+	}
+};
+
+// calls Func(pPrefix, Length) for the smallest set of CIDR prefixes covering the range
+template<class F>
+static void SplitRange(const CNetRange *pRange, F Func)
+{
+	int Bytes = pRange->m_LB.type == NETTYPE_IPV6 ? 16 : 4;
+	int Bits = Bytes * 8;
+	CNetUint128 Cur = CNetUint128::FromAddr(&pRange->m_LB, Bytes);
+	CNetUint128 End = CNetUint128::FromAddr(&pRange->m_UB, Bytes);
+	CNetUint128 All = CNetUint128::Mask(Bits);
+	CNetUint128 One = {0, 1};
+
+	while(true)
+	{
+		// largest block aligned at the current address that does not exceed the end
+		CNetUint128 Diff = End - Cur;
+		int Fit = Diff == All ? Bits : (Diff + One).Log2();
+		int Size = minimum(minimum(Cur.TrailingZeros(), Bits), Fit);
+
+		unsigned char aPrefix[16];
+		Cur.ToBytes(aPrefix, Bytes);
+		Func(aPrefix, Bits - Size);
+
+		CNetUint128 Last = Cur + CNetUint128::Mask(Size);
+		if(Last == End)
+			break;
+		Cur = Last + One;
+	}
+}
+
+static inline int NetBit(const unsigned char *pKey, int Bit)
+{
+	return (pKey[Bit / 8] >> (7 - Bit % 8)) & 1;
+}
+
+// number of leading bits both keys have in common, at most Limit
+static int NetCommonBits(const unsigned char *pKey1, const unsigned char *pKey2, int Limit)
+{
+	for(int i = 0; i * 8 < Limit; ++i)
+	{
+		unsigned Diff = pKey1[i] ^ pKey2[i];
+		if(Diff)
+		{
+			int Common = i * 8;
+			while(!(Diff & 0x80))
+			{
+				Diff <<= 1;
+				++Common;
+			}
+			return minimum(Common, Limit);
+		}
+	}
+	return Limit;
+}
+
+static int NetTrieRoot(int Type)
+{
+	if(Type == NETTYPE_IPV4 || Type == NETTYPE_WEBSOCKET_IPV4)
+		return 0;
+	if(Type == NETTYPE_IPV6)
+		return 1;
+	return -1;
+}
+
+void CNetBan::CBanTrie::Reset()
+{
+	m_vNodes.clear();
+	m_vEntries.clear();
+	m_FirstFreeNode = -1;
+	m_FirstFreeEntry = -1;
+	m_NumFreeNodes = 0;
+
+	unsigned char aZero[16] = {0};
+	NewNode(aZero, 0); // ROOT_IPV4
+	NewNode(aZero, 0); // ROOT_IPV6
+}
+
+int CNetBan::CBanTrie::NewNode(const unsigned char *pPrefix, int Length)
+{
+	int Index;
+	if(m_FirstFreeNode >= 0)
+	{
+		Index = m_FirstFreeNode;
+		m_FirstFreeNode = m_vNodes[Index].m_aChildren[0];
+		--m_NumFreeNodes;
+	}
+	else
+	{
+		Index = m_vNodes.size();
+		m_vNodes.emplace_back();
+	}
+
+	CNode &Node = m_vNodes[Index];
+	mem_zero(Node.m_aPrefix, sizeof(Node.m_aPrefix));
+	mem_copy(Node.m_aPrefix, pPrefix, (Length + 7) / 8);
+	if(Length % 8)
+		Node.m_aPrefix[Length / 8] &= 0xff << (8 - Length % 8);
+	Node.m_Length = Length;
+	Node.m_aChildren[0] = Node.m_aChildren[1] = -1;
+	Node.m_FirstEntry = -1;
+	return Index;
+}
+
+void CNetBan::CBanTrie::InsertPrefix(int Root, const unsigned char *pPrefix, int Length, CBanAddr *pAddrBan, CBanRange *pRangeBan)
+{
+	int Node = Root;
+	while(m_vNodes[Node].m_Length < Length)
+	{
+		int Bit = NetBit(pPrefix, m_vNodes[Node].m_Length);
+		int Child = m_vNodes[Node].m_aChildren[Bit];
+		if(Child < 0)
+		{
+			int Leaf = NewNode(pPrefix, Length);
+			m_vNodes[Node].m_aChildren[Bit] = Leaf;
+			Node = Leaf;
+			break;
+		}
+
+		int Common = NetCommonBits(m_vNodes[Child].m_aPrefix, pPrefix, minimum(m_vNodes[Child].m_Length, Length));
+		if(Common == m_vNodes[Child].m_Length)
+		{
+			Node = Child;
+			continue;
+		}
+
+		// split the edge to the child
+		int Split = NewNode(pPrefix, Common);
+		m_vNodes[Split].m_aChildren[NetBit(m_vNodes[Child].m_aPrefix, Common)] = Child;
+		m_vNodes[Node].m_aChildren[Bit] = Split;
+		Node = Split;
+		if(Common < Length)
+		{
+			int Leaf = NewNode(pPrefix, Length);
+			m_vNodes[Split].m_aChildren[NetBit(pPrefix, Common)] = Leaf;
+			Node = Leaf;
+		}
+		break;
+	}
+
+	int Entry;
+	if(m_FirstFreeEntry >= 0)
+	{
+		Entry = m_FirstFreeEntry;
+		m_FirstFreeEntry = m_vEntries[Entry].m_Next;
+	}
+	else
+	{
+		Entry = m_vEntries.size();
+		m_vEntries.emplace_back();
+	}
+	m_vEntries[Entry].m_pAddrBan = pAddrBan;
+	m_vEntries[Entry].m_pRangeBan = pRangeBan;
+	m_vEntries[Entry].m_Next = m_vNodes[Node].m_FirstEntry;
+	m_vNodes[Node].m_FirstEntry = Entry;
+}
+
+void CNetBan::CBanTrie::RemovePrefix(int Root, const unsigned char *pPrefix, int Length, CBanAddr *pAddrBan, CBanRange *pRangeBan)
+{
+	int aPath[128 + 2];
+	int Depth = 0;
+	int Node = Root;
+	aPath[Depth++] = Node;
+	while(m_vNodes[Node].m_Length < Length)
+	{
+		Node = m_vNodes[Node].m_aChildren[NetBit(pPrefix, m_vNodes[Node].m_Length)];
+		if(Node < 0 || m_vNodes[Node].m_Length > Length || NetCommonBits(m_vNodes[Node].m_aPrefix, pPrefix, m_vNodes[Node].m_Length) < m_vNodes[Node].m_Length)
+			return;
+		aPath[Depth++] = Node;
+	}
+
+	// unlink the entry
+	for(int *pEntry = &m_vNodes[Node].m_FirstEntry; *pEntry >= 0; pEntry = &m_vEntries[*pEntry].m_Next)
+	{
+		CEntry &Entry = m_vEntries[*pEntry];
+		if(Entry.m_pAddrBan == pAddrBan && Entry.m_pRangeBan == pRangeBan)
+		{
+			int Free = *pEntry;
+			*pEntry = Entry.m_Next;
+			Entry.m_Next = m_FirstFreeEntry;
+			m_FirstFreeEntry = Free;
+			break;
+		}
+	}
+
+	// remove nodes that are neither needed for entries nor for branching
+	while(Depth > 1)
+	{
+		CNode &Cur = m_vNodes[aPath[Depth - 1]];
+		int NumChildren = (Cur.m_aChildren[0] >= 0) + (Cur.m_aChildren[1] >= 0);
+		if(Cur.m_FirstEntry >= 0 || NumChildren == 2)
+			break;
+
+		int Replacement = NumChildren ? Cur.m_aChildren[Cur.m_aChildren[0] < 0] : -1;
+		CNode &Parent = m_vNodes[aPath[Depth - 2]];
+		Parent.m_aChildren[Parent.m_aChildren[1] == aPath[Depth - 1]] = Replacement;
+
+		Cur.m_aChildren[0] = m_FirstFreeNode;
+		m_FirstFreeNode = aPath[Depth - 1];
+		++m_NumFreeNodes;
+		--Depth;
+		if(NumChildren)
+			break;
+	}
+}
+
+void CNetBan::CBanTrie::Insert(CBanAddr *pBan)
+{
+	int Root = NetTrieRoot(pBan->m_Data.type);
+	if(Root >= 0)
+		InsertPrefix(Root, pBan->m_Data.ip, Root == ROOT_IPV6 ? 128 : 32, pBan, 0);
+}
+
+void CNetBan::CBanTrie::Insert(CBanRange *pBan)
+{
+	int Root = NetTrieRoot(pBan->m_Data.m_LB.type);
+	if(Root >= 0)
+		SplitRange(&pBan->m_Data, [&](const unsigned char *pPrefix, int Length) { InsertPrefix(Root, pPrefix, Length, 0, pBan); });
+}
+
+void CNetBan::CBanTrie::Remove(CBanAddr *pBan)
+{
+	int Root = NetTrieRoot(pBan->m_Data.type);
+	if(Root >= 0)
+		RemovePrefix(Root, pBan->m_Data.ip, Root == ROOT_IPV6 ? 128 : 32, pBan, 0);
+}
+
+void CNetBan::CBanTrie::Remove(CBanRange *pBan)
+{
+	int Root = NetTrieRoot(pBan->m_Data.m_LB.type);
+	if(Root >= 0)
+		SplitRange(&pBan->m_Data, [&](const unsigned char *pPrefix, int Length) { RemovePrefix(Root, pPrefix, Length, 0, pBan); });
+}
+
+bool CNetBan::CBanTrie::Find(const NETADDR *pAddr, CBanAddr **ppAddrBan, CBanRange **ppRangeBan) const
+{
+	int Root = NetTrieRoot(pAddr->type);
+	if(Root < 0)
+		return false;
+
+	// descend along the address bits only and remember the nodes with bans,
+	// the deepest of them that actually matches the address wins
+	int Bits = Root == ROOT_IPV6 ? 128 : 32;
+	int aCandidates[128 + 1];
+	int NumCandidates = 0;
+	for(int Node = Root; Node >= 0;)
+	{
+		const CNode &Cur = m_vNodes[Node];
+		if(Cur.m_FirstEntry >= 0)
+			aCandidates[NumCandidates++] = Node;
+		if(Cur.m_Length >= Bits)
+			break;
+		Node = Cur.m_aChildren[NetBit(pAddr->ip, Cur.m_Length)];
+	}
+
+	int Best = -1;
+	while(NumCandidates > 0 && Best < 0)
+	{
+		int Node = aCandidates[--NumCandidates];
+		if(NetCommonBits(m_vNodes[Node].m_aPrefix, pAddr->ip, m_vNodes[Node].m_Length) == m_vNodes[Node].m_Length)
+			Best = Node;
+	}
+	if(Best < 0)
+		return false;
+
+	*ppAddrBan = 0;
+	*ppRangeBan = 0;
+	for(int Entry = m_vNodes[Best].m_FirstEntry; Entry >= 0; Entry = m_vEntries[Entry].m_Next)
+	{
+		if(m_vEntries[Entry].m_pAddrBan)
+		{
+			*ppAddrBan = m_vEntries[Entry].m_pAddrBan;
+			*ppRangeBan = 0;
+			break;
+		}
+		if(!*ppRangeBan)
+			*ppRangeBan = m_vEntries[Entry].m_pRangeBan;
+	}
+	return true;
+}
+
 template<class T>
-int CNetBan::Ban(T *pBanPool, const typename T::CDataType *pData, int Seconds, const char *pReason)
+int CNetBan::Ban(T *pBanPool, const typename T::CDataType *pData, int Seconds, const char *pReason, bool Verbose)
 {
 	// do not ban localhost
 	if(NetMatch(pData, &m_LocalhostIPV4) || NetMatch(pData, &m_LocalhostIPV6))
 	{
-		Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "net_ban", "ban failed (localhost)");
+		if(Verbose)
+			Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "net_ban", "ban failed (localhost)");
 		return -1;
 	}
 
@@ -256,9 +629,12 @@ int CNetBan::Ban(T *pBanPool, const typename T::CDataType *pData, int Seconds, c
 	{
 		// adjust the ban
 		pBanPool->Update(pBan, &Info);
-		char aBuf[128];
-		MakeBanInfo(pBan, aBuf, sizeof(aBuf), MSGTYPE_LIST);
-		Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "net_ban", aBuf);
+		if(Verbose)
+		{
+			char aBuf[128];
+			MakeBanInfo(pBan, aBuf, sizeof(aBuf), MSGTYPE_LIST);
+			Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "net_ban", aBuf);
+		}
 		return 1;
 	}
 
@@ -266,12 +642,16 @@ int CNetBan::Ban(T *pBanPool, const typename T::CDataType *pData, int Seconds, c
 	pBan = pBanPool->Add(pData, &Info, &NetHash);
 	if(pBan)
 	{
-		char aBuf[128];
-		MakeBanInfo(pBan, aBuf, sizeof(aBuf), MSGTYPE_BANADD);
-		Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "net_ban", aBuf);
+		m_BanTrie.Insert(pBan);
+		if(Verbose)
+		{
+			char aBuf[128];
+			MakeBanInfo(pBan, aBuf, sizeof(aBuf), MSGTYPE_BANADD);
+			Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "net_ban", aBuf);
+		}
 		return 0;
 	}
-	else
+	else if(Verbose)
 		Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "net_ban", "ban failed (full banlist)");
 	return -1;
 }
@@ -285,6 +665,7 @@ int CNetBan::Unban(T *pBanPool, const typename T::CDataType *pData)
 	{
 		char aBuf[256];
 		MakeBanInfo(pBan, aBuf, sizeof(aBuf), MSGTYPE_BANREM);
+		m_BanTrie.Remove(pBan);
 		pBanPool->Remove(pBan);
 		Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "net_ban", aBuf);
 		return 0;
@@ -300,6 +681,7 @@ void CNetBan::Init(IConsole *pConsole, IStorage *pStorage)
 	m_pStorage = pStorage;
 	m_BanAddrPool.Reset();
 	m_BanRangePool.Reset();
+	m_BanTrie.Reset();
 
 	net_host_lookup("localhost", &m_LocalhostIPV4, NETTYPE_IPV4);
 	net_host_lookup("localhost", &m_LocalhostIPV6, NETTYPE_IPV6);
@@ -311,6 +693,7 @@ void CNetBan::Init(IConsole *pConsole, IStorage *pStorage)
 	Console()->Register("unban_all", "", CFGFLAG_SERVER | CFGFLAG_MASTER | CFGFLAG_STORE, ConUnbanAll, this, "Unban all entries");
 	Console()->Register("bans", "", CFGFLAG_SERVER | CFGFLAG_MASTER | CFGFLAG_STORE, ConBans, this, "Show banlist");
 	Console()->Register("bans_save", "s[file]", CFGFLAG_SERVER | CFGFLAG_MASTER | CFGFLAG_STORE, ConBansSave, this, "Save banlist in a file");
+	Console()->Register("bans_import", "s[file] ?i[minutes] ?r[reason]", CFGFLAG_SERVER | CFGFLAG_MASTER | CFGFLAG_STORE, ConBansImport, this, "Ban all addresses, CIDR prefixes and ranges listed in a file, permanently by default");
 }
 
 void CNetBan::Update()
@@ -323,12 +706,14 @@ void CNetBan::Update()
 	{
 		str_format(aBuf, sizeof(aBuf), "ban %s expired", NetToString(&m_BanAddrPool.First()->m_Data, aNetStr, sizeof(aNetStr)));
 		Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "net_ban", aBuf);
+		m_BanTrie.Remove(m_BanAddrPool.First());
 		m_BanAddrPool.Remove(m_BanAddrPool.First());
 	}
 	while(m_BanRangePool.First() && m_BanRangePool.First()->m_Info.m_Expires != CBanInfo::EXPIRES_NEVER && m_BanRangePool.First()->m_Info.m_Expires < Now)
 	{
 		str_format(aBuf, sizeof(aBuf), "ban %s expired", NetToString(&m_BanRangePool.First()->m_Data, aNetStr, sizeof(aNetStr)));
 		Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "net_ban", aBuf);
+		m_BanTrie.Remove(m_BanRangePool.First());
 		m_BanRangePool.Remove(m_BanRangePool.First());
 	}
 }
@@ -369,6 +754,7 @@ int CNetBan::UnbanByIndex(int Index)
 	if(pBan)
 	{
 		NetToString(&pBan->m_Data, aBuf, sizeof(aBuf));
+		m_BanTrie.Remove(pBan);
 		Result = m_BanAddrPool.Remove(pBan);
 	}
 	else
@@ -377,6 +763,7 @@ int CNetBan::UnbanByIndex(int Index)
 		if(pBan)
 		{
 			NetToString(&pBan->m_Data, aBuf, sizeof(aBuf));
+			m_BanTrie.Remove(pBan);
 			Result = m_BanRangePool.Remove(pBan);
 		}
 		else
@@ -392,41 +779,99 @@ int CNetBan::UnbanByIndex(int Index)
 	return Result;
 }
 
-bool CNetBan::IsBanned(const NETADDR *pOrigAddr, char *pBuf, unsigned BufferSize) const
+bool CNetBan::IsBanned(const NETADDR *pAddr, char *pBuf, unsigned BufferSize) const
 {
-	NETADDR Addr;
-	const NETADDR *pAddr = pOrigAddr;
-	if(pOrigAddr->type == NETTYPE_WEBSOCKET_IPV4)
-	{
-		mem_copy(&Addr, pOrigAddr, sizeof(NETADDR));
-		pAddr = &Addr;
-		Addr.type = NETTYPE_IPV4;
-	}
-	CNetHash aHash[17];
-	int Length = CNetHash::MakeHashArray(pAddr, aHash);
+	CBanAddr *pAddrBan;
+	CBanRange *pRangeBan;
+	if(!m_BanTrie.Find(pAddr, &pAddrBan, &pRangeBan))
+		return false;
 
-	// check ban addresses
-	CBanAddr *pBan = m_BanAddrPool.Find(pAddr, &aHash[Length]);
-	if(pBan)
-	{
-		MakeBanInfo(pBan, pBuf, BufferSize, MSGTYPE_PLAYER);
-		return true;
-	}
+	if(pAddrBan)
+		MakeBanInfo(pAddrBan, pBuf, BufferSize, MSGTYPE_PLAYER);
+	else
+		MakeBanInfo(pRangeBan, pBuf, BufferSize, MSGTYPE_PLAYER);
+	return true;
+}
+
+int CNetBan::ImportBans(const char *pFilename, int Seconds, const char *pReason)
+{
+	IOHANDLE File = Storage()->OpenFile(pFilename, IOFLAG_READ, IStorage::TYPE_ALL);
+	if(!File)
+		return -1;
 
-	// check ban ranges
-	for(int i = Length - 1; i >= 0; --i)
+	CLineReader LineReader;
+	LineReader.Init(File);
+
+	int NumBans = 0, NumErrors = 0;
+	char *pLine;
+	while((pLine = LineReader.Get()))
 	{
-		for(CBanRange *pBan = m_BanRangePool.First(&aHash[i]); pBan; pBan = pBan->m_pHashNext)
+		// strip comments
+		char *pComment = (char *)str_find(pLine, "#");
+		if(pComment)
+			*pComment = '\0';
+		pLine = (char *)str_utf8_skip_whitespaces(pLine);
+		str_utf8_trim_right(pLine);
+		if(!pLine[0])
+			continue;
+
+		// "addr", "addr/prefix", "first - last" or "first last"
+		CNetRange Range;
+		char *pSecond = (char *)str_find(pLine, "-");
+		if(!pSecond)
+			pSecond = (char *)str_find(pLine, " ");
+		if(!pSecond)
+			pSecond = (char *)str_find(pLine, "\t");
+		char *pPrefix = (char *)str_find(pLine, "/");
+		int Result;
+		if(pSecond)
+		{
+			*pSecond = '\0';
+			str_utf8_trim_right(pLine);
+			pSecond = (char *)str_utf8_skip_whitespaces(pSecond + 1);
+			if(net_addr_from_str(&Range.m_LB, pLine) || net_addr_from_str(&Range.m_UB, pSecond) || !Range.IsValid())
+				Result = -1;
+			else
+				Result = Ban(&m_BanRangePool, &Range, Seconds, pReason, false);
+		}
+		else
 		{
-			if(NetMatch(&pBan->m_Data, pAddr, i, Length))
+			if(pPrefix)
+				*pPrefix = '\0';
+			int Bits = 0, Length = 0;
+			if(net_addr_from_str(&Range.m_LB, pLine) == 0)
 			{
-				MakeBanInfo(pBan, pBuf, BufferSize, MSGTYPE_PLAYER);
-				return true;
+				Bits = Range.m_LB.type == NETTYPE_IPV6 ? 128 : 32;
+				Length = pPrefix ? (str_isallnum(pPrefix + 1) ? str_toint(pPrefix + 1) : -1) : Bits;
+			}
+
+			if(Length <= 0 || Length > Bits)
+				Result = -1;
+			else if(Length == Bits)
+				Result = Ban(&m_BanAddrPool, &Range.m_LB, Seconds, pReason, false);
+			else
+			{
+				Range.m_UB = Range.m_LB;
+				for(int i = Length; i < Bits; ++i)
+				{
+					Range.m_LB.ip[i / 8] &= ~(0x80 >> (i % 8));
+					Range.m_UB.ip[i / 8] |= 0x80 >> (i % 8);
+				}
+				Result = Ban(&m_BanRangePool, &Range, Seconds, pReason, false);
 			}
 		}
+
+		if(Result < 0)
+			NumErrors++;
+		else
+			NumBans++;
 	}
+	io_close(File);
 
-	return false;
+	char aBuf[256];
+	str_format(aBuf, sizeof(aBuf), "imported %d bans from '%s' (%d invalid entries)", NumBans, pFilename, NumErrors);
+	Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "net_ban", aBuf);
+	return NumBans;
 }
 
 void CNetBan::ConBan(IConsole::IResult *pResult, void *pUser)
@@ -558,3 +1003,19 @@ void CNetBan::ConBansSave(IConsole::IResult *pResult, void *pUser)
 	str_format(aBuf, sizeof(aBuf), "saved banlist to '%s'", pResult->GetString(0));
 	pThis->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "net_ban", aBuf);
 }
+
+void CNetBan::ConBansImport(IConsole::IResult *pResult, void *pUser)
+{
+	CNetBan *pThis = static_cast<CNetBan *>(pUser);
+
+	const char *pFilename = pResult->GetString(0);
+	int Minutes = pResult->NumArguments() > 1 ? clamp(pResult->GetInteger(1), 0, 525600) : 0;
+	const char *pReason = pResult->NumArguments() > 2 ? pResult->GetString(2) : "No reason given";
+
+	if(pThis->ImportBans(pFilename, Minutes * 60, pReason) < 0)
+	{
+		char aBuf[256];
+		str_format(aBuf, sizeof(aBuf), "failed to import bans from '%s'", pFilename);
+		pThis->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "net_ban", aBuf);
+	}
+}
@@ -5,6 +5,9 @@
 
 #include <base/system.h>
 
+#include <memory>
+#include <vector>
+
 inline int NetComp(const NETADDR *pAddr1, const NETADDR *pAddr2)
 {
 	return mem_comp(pAddr1, pAddr2, pAddr1->type == NETTYPE_IPV4 ? 8 : 20);
@@ -131,11 +134,14 @@ protected:
 	private:
 		enum
 		{
-			MAX_BANS = 1024,
+			MAX_BANS = 1024 * 1024,
+			BLOCK_SIZE = 1024,
 		};
 
+		void AllocBlock();
+
 		CBan<CDataType> *m_aapHashList[HashCount][256];
-		CBan<CDataType> m_aBans[MAX_BANS];
+		std::vector<std::unique_ptr<CBan<CDataType>[]>> m_vpBlocks;
 		CBan<CDataType> *m_pFirstFree;
 		CBan<CDataType> *m_pFirstUsed;
 		int m_CountUsed;
@@ -146,10 +152,59 @@ protected:
 	typedef CBan<NETADDR> CBanAddr;
 	typedef CBan<CNetRange> CBanRange;
 
+	// compressed binary radix trie over the address bans and the ranges
+	// split into CIDR prefixes, one root per address family
+	class CBanTrie
+	{
+	public:
+		void Reset();
+		void Insert(CBanAddr *pBan);
+		void Insert(CBanRange *pBan);
+		void Remove(CBanAddr *pBan);
+		void Remove(CBanRange *pBan);
+
+		// finds the ban with the longest prefix matching the address,
+		// address bans win over ranges of the same length
+		bool Find(const NETADDR *pAddr, CBanAddr **ppAddrBan, CBanRange **ppRangeBan) const;
+		int NumNodes() const { return (int)m_vNodes.size() - m_NumFreeNodes; }
+
+	private:
+		enum
+		{
+			ROOT_IPV4 = 0,
+			ROOT_IPV6,
+		};
+
+		struct CNode
+		{
+			unsigned char m_aPrefix[16];
+			int m_Length; // in bits
+			int m_aChildren[2];
+			int m_FirstEntry;
+		};
+
+		struct CEntry
+		{
+			CBanAddr *m_pAddrBan;
+			CBanRange *m_pRangeBan;
+			int m_Next;
+		};
+
+		std::vector<CNode> m_vNodes;
+		std::vector<CEntry> m_vEntries;
+		int m_FirstFreeNode;
+		int m_FirstFreeEntry;
+		int m_NumFreeNodes;
+
+		int NewNode(const unsigned char *pPrefix, int Length);
+		void InsertPrefix(int Root, const unsigned char *pPrefix, int Length, CBanAddr *pAddrBan, CBanRange *pRangeBan);
+		void RemovePrefix(int Root, const unsigned char *pPrefix, int Length, CBanAddr *pAddrBan, CBanRange *pRangeBan);
+	};
+
 	template<class T>
 	void MakeBanInfo(const CBan<T> *pBan, char *pBuf, unsigned BuffSize, int Type) const;
 	template<class T>
-	int Ban(T *pBanPool, const typename T::CDataType *pData, int Seconds, const char *pReason);
+	int Ban(T *pBanPool, const typename T::CDataType *pData, int Seconds, const char *pReason, bool Verbose = true);
 	template<class T>
 	int Unban(T *pBanPool, const typename T::CDataType *pData);
 
@@ -157,6 +212,7 @@ protected:
 	class IStorage *m_pStorage;
 	CBanAddrPool m_BanAddrPool;
 	CBanRangePool m_BanRangePool;
+	CBanTrie m_BanTrie;
 	NETADDR m_LocalhostIPV4, m_LocalhostIPV6;
 
 public:
@@ -182,6 +238,7 @@ public:
 	int UnbanByIndex(int Index);
 	void UnbanAll();
 	bool IsBanned(const NETADDR *pAddr, char *pBuf, unsigned BufferSize) const;
+	int ImportBans(const char *pFilename, int Seconds, const char *pReason);
 
 	static void ConBan(class IConsole::IResult *pResult, void *pUser);
 	static void ConBanRange(class IConsole::IResult *pResult, void *pUser);
@@ -190,6 +247,7 @@ public:
 	static void ConUnbanAll(class IConsole::IResult *pResult, void *pUser);
 	static void ConBans(class IConsole::IResult *pResult, void *pUser);
 	static void ConBansSave(class IConsole::IResult *pResult, void *pUser);
+	static void ConBansImport(class IConsole::IResult *pResult, void *pUser);
 };
 
 template<class T>
@@ -5,6 +5,7 @@
 
 #include "huffman.h"
 #include "ringbuffer.h"
+#include "spsc_queue.h"
 
 #include <base/math.h>
 
@@ -57,7 +58,6 @@ enum
 	NET_MAX_CHUNKHEADERSIZE = 5,
 	NET_PACKETHEADERSIZE = 3,
 	NET_MAX_CLIENTS = 64,
-	NET_MAX_CONSOLE_CLIENTS = 4,
 	NET_MAX_SEQUENCE = 1 << 10,
 	NET_SEQUENCE_MASK = NET_MAX_SEQUENCE - 1,
 
@@ -253,22 +253,31 @@ private:
 	char m_aBuffer[NET_MAX_PACKETSIZE];
 	int m_BufferOffset;
 
+	// lines waiting for the socket to become writable
+	std::vector<char> m_vSendBuffer;
+	int m_SendOffset;
+	int m_MaxSendBuffer;
+
 	char m_aErrorString[256];
 
 	bool m_LineEndingDetected;
 	char m_aLineEnding[3];
 
 public:
-	void Init(NETSOCKET Socket, const NETADDR *pAddr);
+	void Init(NETSOCKET Socket, const NETADDR *pAddr, int MaxSendBuffer);
 	void Disconnect(const char *pReason);
 
 	int State() const { return m_State; }
 	const NETADDR *PeerAddress() const { return &m_PeerAddr; }
+	NETSOCKET Socket() const { return m_Socket; }
 	const char *ErrorString() const { return m_aErrorString; }
+	bool SendPending() const { return m_SendOffset < (int)m_vSendBuffer.size(); }
 
 	void Reset();
 	int Update();
+	// queues the line, it is written by the next Flush
 	int Send(const char *pLine);
+	int Flush();
 	int Recv(char *pLine, int MaxLength);
 };
 
@@ -387,42 +396,106 @@ public:
 	SECURITY_TOKEN GetVanillaToken(const NETADDR &Addr) { return absolute(GetToken(Addr)); }
 };
 
+// Serves the econ connections from its own thread. Connections, drops and
+// received lines are handed to the game thread, lines to send and drops
+// the other way round, both through lock-free queues. All public
+// functions except the constructor are for the game thread.
 class CNetConsole
 {
+	enum
+	{
+		// game thread -> network thread
+		CMD_SEND = 0,
+		CMD_BROADCAST,
+		CMD_SET_BROADCAST,
+		CMD_DROP,
+		CMD_RELEASE,
+		// longest line including the terminator, longer ones are cut
+		// when they are queued
+		MAX_COMMAND_SIZE = 8192,
+
+		// network thread -> game thread
+		EVENT_NEW = 0,
+		EVENT_DROP,
+		EVENT_LINE,
+
+		SLOT_FREE = 0,
+		SLOT_ONLINE,
+		// closed by the network thread, kept until the game thread
+		// acknowledged the drop so late lines can't reach a new client
+		SLOT_CLOSING,
+
+		LISTEN_ID = -1,
+	};
+
 	struct CSlot
 	{
 		CConsoleNetConnection m_Connection;
+		int m_State;
+		bool m_Broadcast;
+		bool m_DropPending;
+		char m_aDropReason[128];
+	};
+
+	struct CClient
+	{
+		bool m_Online;
+		NETADDR m_Addr;
 	};
 
 	NETSOCKET m_Socket;
 	class CNetBan *m_pNetBan;
-	CSlot m_aSlots[NET_MAX_CONSOLE_CLIENTS];
+	int m_MaxSendBuffer;
+
+	// network thread
+	std::vector<CSlot> m_vSlots;
+	NETPOLL *m_pPoll;
+	void *m_pThread;
+	std::atomic<bool> m_Shutdown;
+
+	// game thread
+	std::vector<CClient> m_vClients;
+	int m_NumDroppedLines;
+
+	CSpscQueue m_Commands;
+	CSpscQueue m_Events;
 
 	NETFUNC_NEWCLIENT_CON m_pfnNewClient;
 	NETFUNC_DELCLIENT m_pfnDelClient;
 	void *m_pUser;
 
-	CNetRecvUnpacker m_RecvUnpacker;
+	static void ThreadFunc(void *pUser);
+	void Run();
+	void AcceptClients();
+	void ProcessCommands();
+	void CloseSlot(int ClientID, const char *pReason);
+	void PushCommand(int Type, int ClientID, const char *pData);
 
 public:
+	CNetConsole();
+	~CNetConsole();
+
 	void SetCallbacks(NETFUNC_NEWCLIENT_CON pfnNewClient, NETFUNC_DELCLIENT pfnDelClient, void *pUser);
 
 	//
-	bool Open(NETADDR BindAddr, class CNetBan *pNetBan, int Flags);
+	bool Open(NETADDR BindAddr, class CNetBan *pNetBan, int MaxClients, int MaxSendBuffer);
 	int Close();
 
 	//
 	int Recv(char *pLine, int MaxLength, int *pClientID = 0);
+	// ClientID -1 sends to all clients that receive broadcasts
 	int Send(int ClientID, const char *pLine);
+	void SetBroadcast(int ClientID, bool Broadcast);
 	int Update();
 
 	//
-	int AcceptClient(NETSOCKET Socket, const NETADDR *pAddr);
 	int Drop(int ClientID, const char *pReason);
 
 	// status requests
-	const NETADDR *ClientAddr(int ClientID) const { return m_aSlots[ClientID].m_Connection.PeerAddress(); }
+	int MaxClients() const { return m_vClients.size(); }
+	const NETADDR *ClientAddr(int ClientID) const { return &m_vClients[ClientID].m_Addr; }
 	class CNetBan *NetBan() const { return m_pNetBan; }
+	NETSOCKET Socket() const { return m_Socket; }
 };
 
 // client side
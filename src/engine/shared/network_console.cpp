@@ -7,26 +7,73 @@
 #include "netban.h"
 #include "network.h"
 
-bool CNetConsole::Open(NETADDR BindAddr, CNetBan *pNetBan, int Flags)
+CNetConsole::CNetConsole() :
+	m_Commands(1024 * 1024), m_Events(256 * 1024)
 {
-	// zero out the whole structure
-	mem_zero(this, sizeof(*this));
 	m_Socket.type = NETTYPE_INVALID;
 	m_Socket.ipv4sock = -1;
 	m_Socket.ipv6sock = -1;
+	m_pNetBan = 0;
+	m_MaxSendBuffer = 0;
+	m_pPoll = 0;
+	m_pThread = 0;
+	m_Shutdown.store(false);
+	m_NumDroppedLines = 0;
+	m_pfnNewClient = 0;
+	m_pfnDelClient = 0;
+	m_pUser = 0;
+}
+
+CNetConsole::~CNetConsole()
+{
+	Close();
+}
+
+bool CNetConsole::Open(NETADDR BindAddr, CNetBan *pNetBan, int MaxClients, int MaxSendBuffer)
+{
 	m_pNetBan = pNetBan;
+	m_MaxSendBuffer = MaxSendBuffer;
 
 	// open socket
 	m_Socket = net_tcp_create(BindAddr);
 	if(!m_Socket.type)
 		return false;
-	if(net_tcp_listen(m_Socket, NET_MAX_CONSOLE_CLIENTS))
+	if(net_tcp_listen(m_Socket, MaxClients))
+	{
+		net_tcp_close(m_Socket);
+		m_Socket.type = NETTYPE_INVALID;
 		return false;
+	}
 	net_set_non_blocking(m_Socket);
 
-	for(auto &Slot : m_aSlots)
+	m_pPoll = net_poll_create();
+	if(!m_pPoll || net_poll_add(m_pPoll, m_Socket, LISTEN_ID, NETPOLL_READ))
+	{
+		if(m_pPoll)
+			net_poll_destroy(m_pPoll);
+		m_pPoll = 0;
+		net_tcp_close(m_Socket);
+		m_Socket.type = NETTYPE_INVALID;
+		return false;
+	}
+
+	m_vSlots.resize(MaxClients);
+	for(auto &Slot : m_vSlots)
+	{
 		Slot.m_Connection.Reset();
+		Slot.m_State = SLOT_FREE;
+		Slot.m_Broadcast = false;
+		Slot.m_DropPending = false;
+	}
+	m_vClients.resize(MaxClients);
+	for(auto &Client : m_vClients)
+	{
+		Client.m_Online = false;
+		mem_zero(&Client.m_Addr, sizeof(Client.m_Addr));
+	}
 
+	m_Shutdown.store(false);
+	m_pThread = thread_init(ThreadFunc, this, "econ");
 	return true;
 }
 
@@ -39,111 +86,315 @@ void CNetConsole::SetCallbacks(NETFUNC_NEWCLIENT_CON pfnNewClient, NETFUNC_DELCL
 
 int CNetConsole::Close()
 {
-	for(auto &Slot : m_aSlots)
-		Slot.m_Connection.Disconnect("closing console");
+	if(!m_pThread)
+		return 0;
 
-	net_tcp_close(m_Socket);
+	// the network thread sends what is queued and disconnects everyone
+	m_Shutdown.store(true);
+	net_poll_wake(m_pPoll);
+	thread_wait(m_pThread);
+	m_pThread = 0;
 
+	net_poll_destroy(m_pPoll);
+	m_pPoll = 0;
+	net_tcp_close(m_Socket);
+	m_Socket.type = NETTYPE_INVALID;
 	return 0;
 }
 
+void CNetConsole::PushCommand(int Type, int ClientID, const char *pData)
+{
+	char aData[MAX_COMMAND_SIZE];
+	int Size = pData ? str_length(pData) + 1 : 0;
+	if(Size > MAX_COMMAND_SIZE)
+	{
+		str_utf8_copy(aData, pData, sizeof(aData));
+		pData = aData;
+		Size = str_length(aData) + 1;
+	}
+	if(!m_Commands.Push(Type, ClientID, pData, Size))
+	{
+		if(Type == CMD_SEND || Type == CMD_BROADCAST)
+		{
+			m_NumDroppedLines++;
+			return;
+		}
+
+		// drops and releases must not get lost, the network thread
+		// makes room quickly once it's awake
+		net_poll_wake(m_pPoll);
+		while(!m_Commands.Push(Type, ClientID, pData, Size))
+			thread_yield();
+	}
+
+	// write bursts in larger batches, the rest is sent on Update
+	if(m_Commands.Used() > m_Commands.Capacity() / 2)
+		net_poll_wake(m_pPoll);
+}
+
 int CNetConsole::Drop(int ClientID, const char *pReason)
 {
+	if(!m_vClients[ClientID].m_Online)
+		return 0;
+
 	if(m_pfnDelClient)
 		m_pfnDelClient(ClientID, pReason, m_pUser);
 
-	m_aSlots[ClientID].m_Connection.Disconnect(pReason);
+	m_vClients[ClientID].m_Online = false;
+	PushCommand(CMD_DROP, ClientID, pReason ? pReason : "");
+	return 0;
+}
+
+int CNetConsole::Update()
+{
+	if(!m_pThread)
+		return 0;
+
+	if(m_NumDroppedLines)
+	{
+		char aBuf[128];
+		str_format(aBuf, sizeof(aBuf), "output too fast, dropped %d lines", m_NumDroppedLines);
+		m_NumDroppedLines = 0;
+		dbg_msg("econ", "%s", aBuf);
+	}
 
+	// hand over everything queued since the last update in one go
+	if(m_Commands.Used())
+		net_poll_wake(m_pPoll);
 	return 0;
 }
 
-int CNetConsole::AcceptClient(NETSOCKET Socket, const NETADDR *pAddr)
+int CNetConsole::Recv(char *pLine, int MaxLength, int *pClientID)
 {
-	char aError[256] = {0};
-	int FreeSlot = -1;
+	if(!m_pThread)
+		return 0;
 
-	// look for free slot or multiple client
-	for(int i = 0; i < NET_MAX_CONSOLE_CLIENTS; i++)
+	int Type;
+	int ClientID;
+	int Size;
+	char aData[NET_MAX_PACKETSIZE];
+	while(m_Events.Pop(&Type, &ClientID, aData, sizeof(aData), &Size))
 	{
-		if(FreeSlot == -1 && m_aSlots[i].m_Connection.State() == NET_CONNSTATE_OFFLINE)
-			FreeSlot = i;
-		if(m_aSlots[i].m_Connection.State() != NET_CONNSTATE_OFFLINE)
+		if(Type == EVENT_NEW)
 		{
-			if(net_addr_comp(pAddr, m_aSlots[i].m_Connection.PeerAddress()) == 0)
+			m_vClients[ClientID].m_Online = true;
+			mem_copy(&m_vClients[ClientID].m_Addr, aData, sizeof(NETADDR));
+
+			// the ban list belongs to the game thread
+			char aBuf[128];
+			if(NetBan() && NetBan()->IsBanned(&m_vClients[ClientID].m_Addr, aBuf, sizeof(aBuf)))
 			{
-				str_copy(aError, "only one client per IP allowed", sizeof(aError));
-				break;
+				m_vClients[ClientID].m_Online = false;
+				PushCommand(CMD_DROP, ClientID, aBuf);
 			}
+			else if(m_pfnNewClient)
+				m_pfnNewClient(ClientID, m_pUser);
 		}
-	}
+		else if(Type == EVENT_DROP)
+		{
+			// nothing to do if the game thread dropped the client itself
+			if(!m_vClients[ClientID].m_Online)
+				continue;
 
-	// accept client
-	if(!aError[0] && FreeSlot != -1)
-	{
-		m_aSlots[FreeSlot].m_Connection.Init(Socket, pAddr);
-		if(m_pfnNewClient)
-			m_pfnNewClient(FreeSlot, m_pUser);
-		return 0;
+			m_vClients[ClientID].m_Online = false;
+			if(m_pfnDelClient)
+				m_pfnDelClient(ClientID, aData, m_pUser);
+			PushCommand(CMD_RELEASE, ClientID, 0);
+		}
+		else if(Type == EVENT_LINE)
+		{
+			if(!m_vClients[ClientID].m_Online || Size > MaxLength)
+				continue;
+
+			mem_copy(pLine, aData, Size);
+			if(pClientID)
+				*pClientID = ClientID;
+			return 1;
+		}
 	}
+	return 0;
+}
+
+int CNetConsole::Send(int ClientID, const char *pLine)
+{
+	if(!m_pThread)
+		return -1;
+
+	if(ClientID == -1)
+		PushCommand(CMD_BROADCAST, -1, pLine);
+	else if(m_vClients[ClientID].m_Online)
+		PushCommand(CMD_SEND, ClientID, pLine);
+	else
+		return -1;
+	return 0;
+}
 
-	// reject client
-	if(!aError[0])
-		str_copy(aError, "no free slot available", sizeof(aError));
+void CNetConsole::SetBroadcast(int ClientID, bool Broadcast)
+{
+	if(m_vClients[ClientID].m_Online)
+		PushCommand(CMD_SET_BROADCAST, ClientID, Broadcast ? "1" : "0");
+}
 
-	net_tcp_send(Socket, aError, str_length(aError));
-	net_tcp_close(Socket);
+void CNetConsole::ThreadFunc(void *pUser)
+{
+	((CNetConsole *)pUser)->Run();
+}
 
-	return -1;
+void CNetConsole::CloseSlot(int ClientID, const char *pReason)
+{
+	CSlot &Slot = m_vSlots[ClientID];
+	net_poll_remove(m_pPoll, Slot.m_Connection.Socket());
+	Slot.m_Connection.Disconnect(pReason);
 }
 
-int CNetConsole::Update()
+void CNetConsole::AcceptClients()
 {
 	NETSOCKET Socket;
 	NETADDR Addr;
-
-	if(net_tcp_accept(m_Socket, &Socket, &Addr) > 0)
+	while(net_tcp_accept(m_Socket, &Socket, &Addr) >= 0)
 	{
-		// check if we just should drop the packet
-		char aBuf[128];
-		if(NetBan() && NetBan()->IsBanned(&Addr, aBuf, sizeof(aBuf)))
+		const char *pError = 0;
+		int FreeSlot = -1;
+
+		// look for free slot or multiple client
+		for(int i = 0; i < (int)m_vSlots.size(); i++)
 		{
-			// banned, reply with a message and drop
-			net_tcp_send(Socket, aBuf, str_length(aBuf));
+			if(FreeSlot == -1 && m_vSlots[i].m_State == SLOT_FREE)
+				FreeSlot = i;
+			if(m_vSlots[i].m_State == SLOT_ONLINE && net_addr_comp(&Addr, m_vSlots[i].m_Connection.PeerAddress()) == 0)
+			{
+				pError = "only one client per IP allowed";
+				break;
+			}
+		}
+		if(!pError && FreeSlot == -1)
+			pError = "no free slot available";
+		if(!pError && net_poll_add(m_pPoll, Socket, FreeSlot, NETPOLL_READ) < 0)
+			pError = "no free slot available";
+		// the game thread is behind, try again later
+		if(!pError && !m_Events.Push(EVENT_NEW, FreeSlot, &Addr, sizeof(Addr)))
+		{
+			net_poll_remove(m_pPoll, Socket);
+			pError = "server busy";
+		}
+
+		if(pError)
+		{
+			net_tcp_send(Socket, pError, str_length(pError));
 			net_tcp_close(Socket);
+			continue;
 		}
-		else
-			AcceptClient(Socket, &Addr);
-	}
 
-	for(int i = 0; i < NET_MAX_CONSOLE_CLIENTS; i++)
-	{
-		if(m_aSlots[i].m_Connection.State() == NET_CONNSTATE_ONLINE)
-			m_aSlots[i].m_Connection.Update();
-		if(m_aSlots[i].m_Connection.State() == NET_CONNSTATE_ERROR)
-			Drop(i, m_aSlots[i].m_Connection.ErrorString());
+		CSlot &Slot = m_vSlots[FreeSlot];
+		Slot.m_Connection.Init(Socket, &Addr, m_MaxSendBuffer);
+		Slot.m_State = SLOT_ONLINE;
+		Slot.m_Broadcast = false;
+		Slot.m_DropPending = false;
 	}
-
-	return 0;
 }
 
-int CNetConsole::Recv(char *pLine, int MaxLength, int *pClientID)
+void CNetConsole::ProcessCommands()
 {
-	for(int i = 0; i < NET_MAX_CONSOLE_CLIENTS; i++)
+	int Type;
+	int ClientID;
+	int Size;
+	char aData[MAX_COMMAND_SIZE];
+	while(m_Commands.Pop(&Type, &ClientID, aData, sizeof(aData), &Size))
 	{
-		if(m_aSlots[i].m_Connection.State() == NET_CONNSTATE_ONLINE && m_aSlots[i].m_Connection.Recv(pLine, MaxLength))
+		if(Type == CMD_BROADCAST)
 		{
-			if(pClientID)
-				*pClientID = i;
-			return 1;
+			for(auto &Slot : m_vSlots)
+				if(Slot.m_State == SLOT_ONLINE && Slot.m_Broadcast)
+					Slot.m_Connection.Send(aData);
+			continue;
+		}
+
+		CSlot &Slot = m_vSlots[ClientID];
+		if(Type == CMD_SEND)
+		{
+			if(Slot.m_State == SLOT_ONLINE)
+				Slot.m_Connection.Send(aData);
+		}
+		else if(Type == CMD_SET_BROADCAST)
+		{
+			if(Slot.m_State == SLOT_ONLINE)
+				Slot.m_Broadcast = aData[0] == '1';
+		}
+		else if(Type == CMD_DROP)
+		{
+			// the game thread doesn't wait for the drop event of a slot
+			// it dropped itself, so a closing slot is free now as well
+			if(Slot.m_State == SLOT_ONLINE)
+				CloseSlot(ClientID, aData);
+			Slot.m_State = SLOT_FREE;
+			Slot.m_DropPending = false;
+		}
+		else if(Type == CMD_RELEASE)
+		{
+			if(Slot.m_State == SLOT_CLOSING)
+				Slot.m_State = SLOT_FREE;
 		}
 	}
-	return 0;
 }
 
-int CNetConsole::Send(int ClientID, const char *pLine)
+void CNetConsole::Run()
 {
-	if(m_aSlots[ClientID].m_Connection.State() == NET_CONNSTATE_ONLINE)
-		return m_aSlots[ClientID].m_Connection.Send(pLine);
-	else
-		return -1;
+	NETPOLLEVENT aEvents[64];
+	while(!m_Shutdown.load())
+	{
+		// lines from the game thread wake us, the timeout only retries
+		// events that didn't fit into the queue
+		int NumEvents = net_poll_wait(m_pPoll, aEvents, 64, 100);
+		for(int i = 0; i < NumEvents; i++)
+		{
+			if(aEvents[i].id == LISTEN_ID)
+			{
+				AcceptClients();
+				continue;
+			}
+
+			CSlot &Slot = m_vSlots[aEvents[i].id];
+			if(Slot.m_State == SLOT_ONLINE && (aEvents[i].events & NETPOLL_READ))
+				Slot.m_Connection.Update();
+		}
+
+		ProcessCommands();
+
+		for(int i = 0; i < (int)m_vSlots.size(); i++)
+		{
+			CSlot &Slot = m_vSlots[i];
+			if(Slot.m_State == SLOT_ONLINE)
+			{
+				// leave lines in the connection buffer while the game
+				// thread is behind
+				char aLine[NET_MAX_PACKETSIZE];
+				while(m_Events.Capacity() - m_Events.Used() > (int)sizeof(aLine) * 3 && Slot.m_Connection.Recv(aLine, (int)sizeof(aLine) - 1))
+					m_Events.Push(EVENT_LINE, i, aLine, str_length(aLine) + 1);
+
+				// one write for everything queued since the last round
+				Slot.m_Connection.Flush();
+
+				if(Slot.m_Connection.State() == NET_CONNSTATE_ERROR)
+				{
+					str_copy(Slot.m_aDropReason, Slot.m_Connection.ErrorString(), sizeof(Slot.m_aDropReason));
+					CloseSlot(i, 0);
+					Slot.m_State = SLOT_CLOSING;
+					Slot.m_DropPending = true;
+				}
+				else
+					net_poll_modify(m_pPoll, Slot.m_Connection.Socket(), i, NETPOLL_READ | (Slot.m_Connection.SendPending() ? NETPOLL_WRITE : 0));
+			}
+
+			if(Slot.m_DropPending && m_Events.Push(EVENT_DROP, i, Slot.m_aDropReason, str_length(Slot.m_aDropReason) + 1))
+				Slot.m_DropPending = false;
+		}
+	}
+
+	ProcessCommands();
+	for(int i = 0; i < (int)m_vSlots.size(); i++)
+	{
+		if(m_vSlots[i].m_State == SLOT_ONLINE)
+			CloseSlot(i, "closing console");
+		m_vSlots[i].m_State = SLOT_FREE;
+	}
 }
@@ -14,6 +14,8 @@ void CConsoleNetConnection::Reset()
 	m_Socket.ipv6sock = -1;
 	m_aBuffer[0] = 0;
 	m_BufferOffset = 0;
+	m_vSendBuffer.clear();
+	m_SendOffset = 0;
 
 	m_LineEndingDetected = false;
 #if defined(CONF_FAMILY_WINDOWS)
@@ -27,9 +29,10 @@ void CConsoleNetConnection::Reset()
 #endif
 }
 
-void CConsoleNetConnection::Init(NETSOCKET Socket, const NETADDR *pAddr)
+void CConsoleNetConnection::Init(NETSOCKET Socket, const NETADDR *pAddr, int MaxSendBuffer)
 {
 	Reset();
+	m_MaxSendBuffer = MaxSendBuffer;
 
 	m_Socket = Socket;
 	net_set_non_blocking(m_Socket);
@@ -45,6 +48,8 @@ void CConsoleNetConnection::Disconnect(const char *pReason)
 
 	if(pReason && pReason[0])
 		Send(pReason);
+	if(State() == NET_CONNSTATE_ONLINE)
+		Flush();
 
 	net_tcp_close(m_Socket);
 
@@ -156,31 +161,46 @@ int CConsoleNetConnection::Send(const char *pLine)
 	if(State() != NET_CONNSTATE_ONLINE)
 		return -1;
 
-	char aBuf[1024];
-	str_copy(aBuf, pLine, (int)(sizeof(aBuf)) - 2);
-	int Length = str_length(aBuf);
-	aBuf[Length] = m_aLineEnding[0];
-	aBuf[Length + 1] = m_aLineEnding[1];
-	aBuf[Length + 2] = m_aLineEnding[2];
-	Length += 3;
-	const char *pData = aBuf;
+	int Length = str_length(pLine);
+	if((int)m_vSendBuffer.size() - m_SendOffset + Length + 3 > m_MaxSendBuffer)
+	{
+		m_State = NET_CONNSTATE_ERROR;
+		str_copy(m_aErrorString, "too weak connection (output queue full)", sizeof(m_aErrorString));
+		return -1;
+	}
+
+	// reclaim the sent part once it dominates the buffer
+	if(m_SendOffset > 0 && m_SendOffset >= (int)m_vSendBuffer.size() / 2)
+	{
+		m_vSendBuffer.erase(m_vSendBuffer.begin(), m_vSendBuffer.begin() + m_SendOffset);
+		m_SendOffset = 0;
+	}
+	m_vSendBuffer.insert(m_vSendBuffer.end(), pLine, pLine + Length);
+	m_vSendBuffer.insert(m_vSendBuffer.end(), m_aLineEnding, m_aLineEnding + 3);
+	return 0;
+}
 
-	while(true)
+int CConsoleNetConnection::Flush()
+{
+	while(State() == NET_CONNSTATE_ONLINE && SendPending())
 	{
-		int Send = net_tcp_send(m_Socket, pData, Length);
-		if(Send < 0)
+		int Sent = net_tcp_send(m_Socket, &m_vSendBuffer[m_SendOffset], (int)m_vSendBuffer.size() - m_SendOffset);
+		if(Sent < 0)
 		{
+			if(net_would_block())
+				return 0;
+
 			m_State = NET_CONNSTATE_ERROR;
 			str_copy(m_aErrorString, "failed to send packet", sizeof(m_aErrorString));
 			return -1;
 		}
-
-		if(Send >= Length)
-			break;
-
-		pData += Send;
-		Length -= Send;
+		m_SendOffset += Sent;
 	}
 
+	if(!SendPending())
+	{
+		m_vSendBuffer.clear();
+		m_SendOffset = 0;
+	}
 	return 0;
 }
@@ -0,0 +1,153 @@
+#include "profiler.h"
+
+#include <base/math.h>
+
+#include <engine/console.h>
+#include <engine/storage.h>
+
+void CProfileHistogram::Reset()
+{
+	m_Count = 0;
+	m_Total = 0;
+	m_Max = 0;
+	mem_zero(m_aBuckets, sizeof(m_aBuckets));
+}
+
+int CProfileHistogram::BucketIndex(int64_t Value)
+{
+	if(Value < SUB_BUCKETS)
+		return maximum(Value, (int64_t)0);
+	int HighestBit = SUB_BUCKET_BITS;
+	while(HighestBit < MAX_BITS && (Value >> (HighestBit + 1)) != 0)
+		HighestBit++;
+	if(HighestBit == MAX_BITS)
+		return NUM_BUCKETS - 1;
+	int Sub = (Value >> (HighestBit - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1);
+	return (HighestBit - SUB_BUCKET_BITS + 1) * SUB_BUCKETS + Sub;
+}
+
+int64_t CProfileHistogram::BucketStart(int Index)
+{
+	if(Index < SUB_BUCKETS)
+		return Index;
+	int HighestBit = Index / SUB_BUCKETS + SUB_BUCKET_BITS - 1;
+	int64_t Sub = Index % SUB_BUCKETS;
+	return (SUB_BUCKETS + Sub) << (HighestBit - SUB_BUCKET_BITS);
+}
+
+void CProfileHistogram::Add(int64_t Value)
+{
+	m_aBuckets[BucketIndex(Value)]++;
+	m_Count++;
+	m_Total += Value;
+	m_Max = maximum(m_Max, Value);
+}
+
+int64_t CProfileHistogram::Percentile(double Fraction) const
+{
+	if(!m_Count)
+		return 0;
+	int64_t Wanted = maximum((int64_t)(m_Count * Fraction + 0.5), (int64_t)1);
+	int64_t Seen = 0;
+	for(int i = 0; i < NUM_BUCKETS; i++)
+	{
+		Seen += m_aBuckets[i];
+		if(Seen >= Wanted)
+		{
+			// the largest sample is known exactly, otherwise take the middle of the bucket
+			if(Seen == m_Count)
+				return m_Max;
+			return (BucketStart(i) + BucketStart(i + 1)) / 2;
+		}
+	}
+	return m_Max;
+}
+
+CProfiler::CProfiler()
+{
+	m_Enabled = false;
+	m_TraceTicks = 0;
+}
+
+int CProfiler::AddZone(const char *pName)
+{
+	for(int i = 0; i < (int)m_vZones.size(); i++)
+		if(str_comp(m_vZones[i].m_aName, pName) == 0)
+			return i;
+	m_vZones.emplace_back();
+	str_copy(m_vZones.back().m_aName, pName, sizeof(m_vZones.back().m_aName));
+	return m_vZones.size() - 1;
+}
+
+void CProfiler::Add(int Zone, int64_t Start, int64_t End)
+{
+	m_vZones[Zone].m_Histogram.Add(End - Start);
+	if(m_TraceTicks > 0 && m_vTraceEvents.size() < MAX_TRACE_EVENTS)
+		m_vTraceEvents.push_back({Zone, Start, End - Start});
+}
+
+void CProfiler::Reset()
+{
+	for(auto &Zone : m_vZones)
+		Zone.m_Histogram.Reset();
+}
+
+void CProfiler::Dump(IConsole *pConsole) const
+{
+	char aBuf[256];
+	str_format(aBuf, sizeof(aBuf), "%-20s %10s %9s %9s %9s %9s %9s", "zone", "count", "mean", "p50", "p90", "p99", "max");
+	pConsole->Print(IConsole::OUTPUT_LEVEL_STANDARD, "profile", aBuf);
+	for(const auto &Zone : m_vZones)
+	{
+		const CProfileHistogram &Histogram = Zone.m_Histogram;
+		if(!Histogram.Count())
+			continue;
+		// all times in microseconds
+		str_format(aBuf, sizeof(aBuf), "%-20s %10lld %9.1f %9.1f %9.1f %9.1f %9.1f",
+			Zone.m_aName, (long long)Histogram.Count(),
+			Histogram.Total() / (double)Histogram.Count() / 1000.0,
+			Histogram.Percentile(0.5) / 1000.0,
+			Histogram.Percentile(0.9) / 1000.0,
+			Histogram.Percentile(0.99) / 1000.0,
+			Histogram.Max() / 1000.0);
+		pConsole->Print(IConsole::OUTPUT_LEVEL_STANDARD, "profile", aBuf);
+	}
+}
+
+void CProfiler::StartTrace(int Ticks)
+{
+	m_vTraceEvents.clear();
+	m_TraceTicks = Ticks;
+}
+
+bool CProfiler::EndTick()
+{
+	if(m_TraceTicks <= 0)
+		return false;
+	return --m_TraceTicks == 0;
+}
+
+bool CProfiler::WriteTrace(IStorage *pStorage, const char *pFilename)
+{
+	IOHANDLE File = pStorage->OpenFile(pFilename, IOFLAG_WRITE, IStorage::TYPE_SAVE);
+	if(!File)
+		return false;
+
+	char aBuf[256];
+	const char *pStart = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+	io_write(File, pStart, str_length(pStart));
+	for(unsigned i = 0; i < m_vTraceEvents.size(); i++)
+	{
+		const CTraceEvent &Event = m_vTraceEvents[i];
+		str_format(aBuf, sizeof(aBuf), "%s\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":0,\"tid\":0,\"ts\":%.3f,\"dur\":%.3f}",
+			i ? "," : "", m_vZones[Event.m_Zone].m_aName, Event.m_Start / 1000.0, Event.m_Duration / 1000.0);
+		io_write(File, aBuf, str_length(aBuf));
+	}
+	const char *pEnd = "\n]}\n";
+	io_write(File, pEnd, str_length(pEnd));
+	io_close(File);
+
+	m_vTraceEvents.clear();
+	m_vTraceEvents.shrink_to_fit();
+	return true;
+}
@@ -0,0 +1,119 @@
+#ifndef ENGINE_SHARED_PROFILER_H
+#define ENGINE_SHARED_PROFILER_H
+
+#include <base/system.h>
+
+#include <vector>
+
+class IConsole;
+class IStorage;
+
+// Latency histogram with logarithmic buckets that are each split into
+// linear sub buckets, so every recorded value is known to within ~6%
+// independent of its magnitude.
+class CProfileHistogram
+{
+public:
+	enum
+	{
+		SUB_BUCKET_BITS = 4,
+		SUB_BUCKETS = 1 << SUB_BUCKET_BITS,
+		// covers values up to 2^40 ns, about 18 minutes
+		MAX_BITS = 40,
+		NUM_BUCKETS = (MAX_BITS - SUB_BUCKET_BITS + 1) * SUB_BUCKETS,
+	};
+
+	CProfileHistogram() { Reset(); }
+
+	void Reset();
+	void Add(int64_t Value);
+
+	int64_t Count() const { return m_Count; }
+	int64_t Total() const { return m_Total; }
+	int64_t Max() const { return m_Max; }
+	// approximate value below which the given fraction of samples lie
+	int64_t Percentile(double Fraction) const;
+
+	static int BucketIndex(int64_t Value);
+	static int64_t BucketStart(int Index);
+
+private:
+	int64_t m_Count;
+	int64_t m_Total;
+	int64_t m_Max;
+	unsigned m_aBuckets[NUM_BUCKETS];
+};
+
+// Collects the time spent in named zones of the main loop. Zones are
+// registered once and then measured with CProfileScope, which only costs
+// a branch while the profiler is disabled.
+class CProfiler
+{
+public:
+	CProfiler();
+
+	int AddZone(const char *pName);
+	int NumZones() const { return m_vZones.size(); }
+	const char *ZoneName(int Zone) const { return m_vZones[Zone].m_aName; }
+	const CProfileHistogram &Histogram(int Zone) const { return m_vZones[Zone].m_Histogram; }
+
+	void SetEnabled(bool Enabled) { m_Enabled = Enabled; }
+	bool Active() const { return m_Enabled || m_TraceTicks > 0; }
+
+	void Add(int Zone, int64_t Start, int64_t End);
+	void Reset();
+	void Dump(IConsole *pConsole) const;
+
+	// records every measured zone for the given number of ticks
+	void StartTrace(int Ticks);
+	bool Tracing() const { return m_TraceTicks > 0; }
+	// returns true once the requested ticks were recorded
+	bool EndTick();
+	// writes the recorded events in the chrome trace event format
+	bool WriteTrace(IStorage *pStorage, const char *pFilename);
+
+private:
+	struct CZone
+	{
+		char m_aName[32];
+		CProfileHistogram m_Histogram;
+	};
+
+	struct CTraceEvent
+	{
+		int m_Zone;
+		int64_t m_Start;
+		int64_t m_Duration;
+	};
+
+	enum
+	{
+		MAX_TRACE_EVENTS = 1 << 20,
+	};
+
+	bool m_Enabled;
+	std::vector<CZone> m_vZones;
+	int m_TraceTicks;
+	std::vector<CTraceEvent> m_vTraceEvents;
+};
+
+class CProfileScope
+{
+	CProfiler *m_pProfiler;
+	int m_Zone;
+	int64_t m_Start;
+
+public:
+	CProfileScope(CProfiler *pProfiler, int Zone) :
+		m_pProfiler(pProfiler), m_Zone(Zone)
+	{
+		m_Start = pProfiler->Active() ? time_get_nanoseconds() : -1;
+	}
+	~CProfileScope()
+	{
+		if(m_Start >= 0)
+			m_pProfiler->Add(m_Zone, m_Start, time_get_nanoseconds());
+	}
+};
+
+#endif
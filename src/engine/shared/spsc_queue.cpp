@@ -0,0 +1,78 @@
+#include "spsc_queue.h"
+
+#include <base/math.h>
+#include <base/system.h>
+
+CSpscQueue::CSpscQueue(int Capacity)
+{
+	unsigned Size = ALIGNMENT * 4;
+	while(Size < (unsigned)Capacity)
+		Size <<= 1;
+	m_vBuffer.resize(Size);
+	m_Mask = Size - 1;
+	m_ReadPos.store(0);
+	m_WritePos.store(0);
+}
+
+int CSpscQueue::Used() const
+{
+	return m_WritePos.load(std::memory_order_acquire) - m_ReadPos.load(std::memory_order_acquire);
+}
+
+bool CSpscQueue::Push(int Type, int ID, const void *pData, int Size)
+{
+	unsigned Write = m_WritePos.load(std::memory_order_relaxed);
+	unsigned Read = m_ReadPos.load(std::memory_order_acquire);
+	unsigned Need = Aligned(sizeof(CHeader) + Size);
+	unsigned Offset = Write & m_Mask;
+	unsigned Tail = m_vBuffer.size() - Offset;
+	unsigned Total = Need > Tail ? Tail + Need : Need;
+	if(Total > m_vBuffer.size() - (Write - Read))
+		return false;
+
+	if(Need > Tail)
+	{
+		// the tail is a multiple of the alignment, so a header always fits
+		CHeader *pPadding = (CHeader *)&m_vBuffer[Offset];
+		pPadding->m_Type = TYPE_PADDING;
+		pPadding->m_Size = Tail - sizeof(CHeader);
+		Write += Tail;
+		Offset = 0;
+	}
+
+	CHeader *pHeader = (CHeader *)&m_vBuffer[Offset];
+	pHeader->m_Type = Type;
+	pHeader->m_ID = ID;
+	pHeader->m_Size = Size;
+	if(Size)
+		mem_copy(pHeader + 1, pData, Size);
+	m_WritePos.store(Write + Need, std::memory_order_release);
+	return true;
+}
+
+bool CSpscQueue::Pop(int *pType, int *pID, void *pData, int MaxSize, int *pSize)
+{
+	unsigned Read = m_ReadPos.load(std::memory_order_relaxed);
+	unsigned Write = m_WritePos.load(std::memory_order_acquire);
+	while(Read != Write)
+	{
+		const CHeader *pHeader = (const CHeader *)&m_vBuffer[Read & m_Mask];
+		unsigned Next = Read + Aligned(sizeof(CHeader) + pHeader->m_Size);
+		if(pHeader->m_Type == TYPE_PADDING)
+		{
+			Read = Next;
+			continue;
+		}
+
+		*pType = pHeader->m_Type;
+		*pID = pHeader->m_ID;
+		*pSize = pHeader->m_Size;
+		int Copy = minimum(pHeader->m_Size, MaxSize);
+		if(Copy > 0)
+			mem_copy(pData, pHeader + 1, Copy);
+		m_ReadPos.store(Next, std::memory_order_release);
+		return true;
+	}
+	m_ReadPos.store(Read, std::memory_order_release);
+	return false;
+}
@@ -0,0 +1,54 @@
+#ifndef ENGINE_SHARED_SPSC_QUEUE_H
+#define ENGINE_SHARED_SPSC_QUEUE_H
+
+#include <atomic>
+#include <vector>
+
+// Lock-free queue of variable sized messages between exactly one producer
+// and one consumer thread.
+//
+// Messages are stored back to back in a fixed buffer, a message that
+// doesn't fit before the end of the buffer is preceded by padding and
+// starts at the beginning again. A full queue rejects new messages, the
+// producer decides whether to retry or drop them.
+class CSpscQueue
+{
+	struct CHeader
+	{
+		int m_Type;
+		int m_ID;
+		int m_Size;
+		int m_Padding;
+	};
+
+	enum
+	{
+		ALIGNMENT = sizeof(CHeader),
+		TYPE_PADDING = -1,
+	};
+
+	std::vector<char> m_vBuffer;
+	unsigned m_Mask;
+
+	// both only ever increase, the difference is the used space
+	std::atomic<unsigned> m_ReadPos;
+	std::atomic<unsigned> m_WritePos;
+
+	static unsigned Aligned(unsigned Size) { return (Size + ALIGNMENT - 1) & ~(unsigned)(ALIGNMENT - 1); }
+
+public:
+	// capacity is rounded up to a power of two
+	CSpscQueue(int Capacity);
+
+	// producer side, returns false if the message doesn't fit
+	bool Push(int Type, int ID, const void *pData, int Size);
+	// amount of the buffer in use, approximate for the producer
+	int Used() const;
+	int Capacity() const { return m_vBuffer.size(); }
+
+	// consumer side, returns false if the queue is empty. The data is
+	// truncated to MaxSize, *pSize is set to the full size.
+	bool Pop(int *pType, int *pID, void *pData, int MaxSize, int *pSize);
+};
+
+#endif
@@ -0,0 +1,185 @@
+#include "teehistorian_reader.h"
+
+#include <engine/shared/teehistorian_ex.h>
+
+static const CUuid TEEHISTORIAN_UUID = CalculateUuid("teehistorian@ddnet.tw");
+
+bool CTeeHistorianReader::Reset(const unsigned char *pData, int DataSize)
+{
+	m_pHeader = 0;
+	m_Error = true;
+	m_Finished = false;
+	// tick 0 is implicit at the start, the first player positions belong to tick 1
+	m_Tick = 0;
+	m_MaxClientID = MAX_CLIENTS;
+	for(auto &Player : m_aPlayers)
+	{
+		Player.m_Alive = false;
+		Player.m_InputExists = false;
+	}
+
+	if(DataSize < (int)sizeof(CUuid) || mem_comp(pData, &TEEHISTORIAN_UUID, sizeof(CUuid)) != 0)
+		return false;
+
+	m_Unpacker.Reset(pData + sizeof(CUuid), DataSize - sizeof(CUuid));
+	m_pHeader = m_Unpacker.GetString(0);
+	if(m_Unpacker.Error())
+		return false;
+
+	m_Error = false;
+	return true;
+}
+
+bool CTeeHistorianReader::ReadInput(CItem *pItem, bool Diff)
+{
+	pItem->m_Type = ITEM_INPUT;
+	pItem->m_ClientID = m_Unpacker.GetInt();
+	if(pItem->m_ClientID < 0 || pItem->m_ClientID >= MAX_CLIENTS)
+		return false;
+
+	CPlayer *pPlayer = &m_aPlayers[pItem->m_ClientID];
+	if(Diff && !pPlayer->m_InputExists)
+		return false;
+	int *pInput = (int *)&pPlayer->m_Input;
+	for(int i = 0; i < (int)(sizeof(pPlayer->m_Input) / sizeof(int)); i++)
+	{
+		int Value = m_Unpacker.GetInt();
+		pInput[i] = Diff ? pInput[i] + Value : Value;
+	}
+	pPlayer->m_InputExists = true;
+	pItem->m_Input = pPlayer->m_Input;
+	return true;
+}
+
+bool CTeeHistorianReader::Next(CItem *pItem)
+{
+	while(!m_Error && !m_Finished)
+	{
+		int Type = m_Unpacker.GetInt();
+		if(m_Unpacker.Error())
+		{
+			// the server didn't finish the file, e.g. because it crashed
+			break;
+		}
+
+		bool Valid = true;
+		bool Returned = true;
+		if(Type >= 0 || Type == -TEEHISTORIAN_PLAYER_NEW || Type == -TEEHISTORIAN_PLAYER_OLD)
+		{
+			int ClientID = Type >= 0 ? Type : m_Unpacker.GetInt();
+			if(ClientID < 0 || ClientID >= MAX_CLIENTS)
+			{
+				Valid = false;
+			}
+			else
+			{
+				// the tick is implicit if the player data doesn't continue in
+				// ascending client id order
+				if(ClientID <= m_MaxClientID)
+					m_Tick++;
+				m_MaxClientID = ClientID;
+
+				CPlayer *pPlayer = &m_aPlayers[ClientID];
+				pItem->m_ClientID = ClientID;
+				if(Type == -TEEHISTORIAN_PLAYER_OLD)
+				{
+					pItem->m_Type = ITEM_PLAYER_OLD;
+					pPlayer->m_Alive = false;
+				}
+				else
+				{
+					int X = m_Unpacker.GetInt();
+					int Y = m_Unpacker.GetInt();
+					if(Type >= 0)
+					{
+						Valid = pPlayer->m_Alive;
+						X += pPlayer->m_X;
+						Y += pPlayer->m_Y;
+					}
+					pItem->m_Type = ITEM_PLAYER;
+					pItem->m_X = pPlayer->m_X = X;
+					pItem->m_Y = pPlayer->m_Y = Y;
+					pPlayer->m_Alive = true;
+				}
+			}
+		}
+		else
+		{
+			switch(-Type)
+			{
+			case TEEHISTORIAN_FINISH:
+				pItem->m_Type = ITEM_FINISH;
+				m_Finished = true;
+				break;
+			case TEEHISTORIAN_TICK_SKIP:
+			{
+				int Skip = m_Unpacker.GetInt();
+				Valid = Skip >= 0;
+				m_Tick += Skip + 1;
+				m_MaxClientID = -1;
+				Returned = false;
+				break;
+			}
+			case TEEHISTORIAN_INPUT_DIFF:
+			case TEEHISTORIAN_INPUT_NEW:
+				Valid = ReadInput(pItem, Type == -TEEHISTORIAN_INPUT_DIFF);
+				break;
+			case TEEHISTORIAN_MESSAGE:
+				pItem->m_Type = ITEM_MESSAGE;
+				pItem->m_ClientID = m_Unpacker.GetInt();
+				pItem->m_DataSize = m_Unpacker.GetInt();
+				pItem->m_pData = m_Unpacker.GetRaw(pItem->m_DataSize);
+				break;
+			case TEEHISTORIAN_JOIN:
+				pItem->m_Type = ITEM_JOIN;
+				pItem->m_ClientID = m_Unpacker.GetInt();
+				break;
+			case TEEHISTORIAN_DROP:
+				pItem->m_Type = ITEM_DROP;
+				pItem->m_ClientID = m_Unpacker.GetInt();
+				pItem->m_pReason = m_Unpacker.GetString(0);
+				break;
+			case TEEHISTORIAN_CONSOLE_COMMAND:
+				pItem->m_Type = ITEM_CONSOLE_COMMAND;
+				pItem->m_ClientID = m_Unpacker.GetInt();
+				pItem->m_FlagMask = m_Unpacker.GetInt();
+				pItem->m_pCommand = m_Unpacker.GetString(0);
+				pItem->m_NumArgs = m_Unpacker.GetInt();
+				Valid = pItem->m_NumArgs >= 0 && pItem->m_NumArgs <= MAX_ARGS;
+				for(int i = 0; Valid && i < pItem->m_NumArgs; i++)
+					pItem->m_apArgs[i] = m_Unpacker.GetString(0);
+				break;
+			case TEEHISTORIAN_EX:
+			{
+				const CUuid *pUuid = (const CUuid *)m_Unpacker.GetRaw(sizeof(CUuid));
+				pItem->m_Type = ITEM_EX;
+				pItem->m_DataSize = m_Unpacker.GetInt();
+				pItem->m_pData = m_Unpacker.GetRaw(pItem->m_DataSize);
+				if(m_Unpacker.Error())
+					break;
+				pItem->m_Uuid = *pUuid;
+				pItem->m_ExID = g_UuidManager.LookupUuid(*pUuid);
+				// most extra chunks start with the client id they're about
+				CUnpacker Unpacker;
+				Unpacker.Reset(pItem->m_pData, pItem->m_DataSize);
+				pItem->m_ClientID = Unpacker.GetIntOrDefault(-1);
+				break;
+			}
+			default:
+				Valid = false;
+			}
+		}
+
+		if(!Valid || m_Unpacker.Error())
+		{
+			m_Error = true;
+			break;
+		}
+		if(Returned)
+		{
+			pItem->m_Tick = m_Tick;
+			return true;
+		}
+	}
+	return false;
+}
@@ -0,0 +1,96 @@
+#ifndef ENGINE_SHARED_TEEHISTORIAN_READER_H
+#define ENGINE_SHARED_TEEHISTORIAN_READER_H
+
+#include <engine/shared/packer.h>
+#include <engine/shared/protocol.h>
+#include <engine/shared/uuid_manager.h>
+#include <game/generated/protocol.h>
+
+// Reads the files written by CTeeHistorian item by item. The reader does
+// not own the file data and can be copied to look ahead.
+class CTeeHistorianReader
+{
+public:
+	enum
+	{
+		ITEM_FINISH,
+		// position of a player after the world tick
+		ITEM_PLAYER,
+		// the player has no character anymore
+		ITEM_PLAYER_OLD,
+		ITEM_INPUT,
+		ITEM_MESSAGE,
+		ITEM_JOIN,
+		ITEM_DROP,
+		ITEM_CONSOLE_COMMAND,
+		ITEM_EX,
+
+		MAX_ARGS = 16,
+	};
+
+	struct CItem
+	{
+		int m_Type;
+		int m_Tick;
+		int m_ClientID;
+
+		// ITEM_PLAYER
+		int m_X;
+		int m_Y;
+
+		// ITEM_INPUT, with the recorded difference already applied
+		CNetObj_PlayerInput m_Input;
+
+		// ITEM_MESSAGE and ITEM_EX
+		const void *m_pData;
+		int m_DataSize;
+
+		// ITEM_EX, UUID_UNKNOWN if the uuid isn't registered
+		CUuid m_Uuid;
+		int m_ExID;
+
+		// ITEM_DROP
+		const char *m_pReason;
+
+		// ITEM_CONSOLE_COMMAND
+		int m_FlagMask;
+		const char *m_pCommand;
+		int m_NumArgs;
+		const char *m_apArgs[MAX_ARGS];
+	};
+
+	// returns false if the data doesn't start with a teehistorian header
+	bool Reset(const unsigned char *pData, int DataSize);
+
+	// the header as a json object
+	const char *Header() const { return m_pHeader; }
+
+	// returns false at the end of the data or if it is corrupt
+	bool Next(CItem *pItem);
+	bool Error() const { return m_Error; }
+	int Tick() const { return m_Tick; }
+
+private:
+	struct CPlayer
+	{
+		bool m_Alive;
+		int m_X;
+		int m_Y;
+
+		bool m_InputExists;
+		CNetObj_PlayerInput m_Input;
+	};
+
+	bool ReadInput(CItem *pItem, bool Diff);
+
+	const char *m_pHeader;
+	CUnpacker m_Unpacker;
+	bool m_Error;
+	bool m_Finished;
+
+	int m_Tick;
+	int m_MaxClientID;
+	CPlayer m_aPlayers[MAX_CLIENTS];
+};
+
+#endif // ENGINE_SHARED_TEEHISTORIAN_READER_H
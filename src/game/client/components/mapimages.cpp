@@ -1,5 +1,6 @@
 /* (c) Magnus Auvinen. See licence.txt in the root of the distribution for more information. */
 /* If you are missing that file, acquire a complete release at teeworlds.com.                */
+#include <engine/engine.h>
 #include <engine/graphics.h>
 #include <engine/map.h>
 #include <engine/serverbrowser.h>
@@ -22,11 +23,15 @@ CMapImages::CMapImages() :
 CMapImages::CMapImages(int TextureSize)
 {
 	m_Count = 0;
+	m_pMap = 0;
+	m_ImageStart = 0;
 	m_TextureScale = TextureSize;
 	mem_zero(m_EntitiesIsLoaded, sizeof(m_EntitiesIsLoaded));
 	m_SpeedupArrowIsLoaded = false;
+	m_LayerSkipped = false;
 
 	mem_zero(m_aTextureUsedByTileOrQuadLayerFlag, sizeof(m_aTextureUsedByTileOrQuadLayerFlag));
+	mem_zero(m_aTextureLoaded, sizeof(m_aTextureLoaded));
 
 	str_copy(m_aEntitiesPath, "editor/entities_clear", sizeof(m_aEntitiesPath));
 
@@ -45,19 +50,52 @@ void CMapImages::OnInit()
 	}
 }
 
-void CMapImages::OnMapLoadImpl(class CLayers *pLayers, IMap *pMap)
+CMapImages::CLoadImageJob::CLoadImageJob(IGraphics *pGraphics, const char *pPath) :
+	m_pGraphics(pGraphics), m_Abort(false), m_Loaded(false)
+{
+	str_copy(m_aPath, pPath, sizeof(m_aPath));
+	m_Info.m_pData = 0;
+}
+
+CMapImages::CLoadImageJob::~CLoadImageJob()
+{
+	free(m_Info.m_pData);
+}
+
+void CMapImages::CLoadImageJob::Run()
+{
+	if(m_Abort)
+		return;
+	m_Loaded = m_pGraphics->LoadPNG(&m_Info, m_aPath, IStorage::TYPE_ALL);
+}
+
+void CMapImages::Unload()
 {
-	// unload all textures
 	for(int i = 0; i < m_Count; i++)
 	{
-		Graphics()->UnloadTexture(m_aTextures[i]);
+		if(m_aTextureLoaded[i])
+			Graphics()->UnloadTexture(m_aTextures[i]);
 		m_aTextures[i] = IGraphics::CTextureHandle();
 		m_aTextureUsedByTileOrQuadLayerFlag[i] = 0;
+		m_aTextureLoaded[i] = false;
+		if(m_apLoadImageJobs[i])
+		{
+			// the job frees the decoded image itself
+			m_apLoadImageJobs[i]->m_Abort = true;
+			m_apLoadImageJobs[i] = nullptr;
+		}
 	}
 	m_Count = 0;
+	m_pMap = 0;
+}
+
+void CMapImages::OnMapLoadImpl(class CLayers *pLayers, IMap *pMap)
+{
+	// unload all textures
+	Unload();
 
-	int Start;
-	pMap->GetType(MAPITEMTYPE_IMAGE, &Start, &m_Count);
+	m_pMap = pMap;
+	pMap->GetType(MAPITEMTYPE_IMAGE, &m_ImageStart, &m_Count);
 
 	m_Count = clamp(m_Count, 0, 64);
 
@@ -91,30 +129,72 @@ void CMapImages::OnMapLoadImpl(class CLayers *pLayers, IMap *pMap)
 		}
 	}
 
-	int TextureLoadFlag = Graphics()->HasTextureArrays() ? IGraphics::TEXLOAD_TO_2D_ARRAY_TEXTURE : IGraphics::TEXLOAD_TO_3D_TEXTURE;
-
-	// load new textures
+	// start decoding the external images of the layers, the textures are
+	// uploaded once the layers are rendered
+	IEngine *pEngine = Kernel()->RequestInterface<IEngine>();
 	for(int i = 0; i < m_Count; i++)
 	{
-		int LoadFlag = (((m_aTextureUsedByTileOrQuadLayerFlag[i] & 1) != 0) ? TextureLoadFlag : 0) | (((m_aTextureUsedByTileOrQuadLayerFlag[i] & 2) != 0) ? 0 : (Graphics()->IsTileBufferingEnabled() ? IGraphics::TEXLOAD_NO_2D_TEXTURE : 0));
-		CMapItemImage *pImg = (CMapItemImage *)pMap->GetItem(Start + i, 0, 0);
-		if(pImg->m_External)
+		CMapItemImage *pImg = (CMapItemImage *)pMap->GetItem(m_ImageStart + i, 0, 0);
+		if(!pImg->m_External || !m_aTextureUsedByTileOrQuadLayerFlag[i])
+			continue;
+
+		char aPath[IO_MAX_PATH_LENGTH];
+		char *pName = (char *)pMap->GetData(pImg->m_ImageName);
+		str_format(aPath, sizeof(aPath), "mapres/%s.png", pName);
+		pEngine->AddJob(m_apLoadImageJobs[i] = std::make_shared<CLoadImageJob>(Graphics(), aPath));
+	}
+}
+
+void CMapImages::Load(int Index)
+{
+	int TextureLoadFlag = Graphics()->HasTextureArrays() ? IGraphics::TEXLOAD_TO_2D_ARRAY_TEXTURE : IGraphics::TEXLOAD_TO_3D_TEXTURE;
+	int LoadFlag = (((m_aTextureUsedByTileOrQuadLayerFlag[Index] & 1) != 0) ? TextureLoadFlag : 0) | (((m_aTextureUsedByTileOrQuadLayerFlag[Index] & 2) != 0) ? 0 : (Graphics()->IsTileBufferingEnabled() ? IGraphics::TEXLOAD_NO_2D_TEXTURE : 0));
+	CMapItemImage *pImg = (CMapItemImage *)m_pMap->GetItem(m_ImageStart + Index, 0, 0);
+	if(pImg->m_External)
+	{
+		std::shared_ptr<CLoadImageJob> pJob = m_apLoadImageJobs[Index];
+		if(pJob)
 		{
-			char aPath[IO_MAX_PATH_LENGTH];
-			char *pName = (char *)pMap->GetData(pImg->m_ImageName);
-			str_format(aPath, sizeof(aPath), "mapres/%s.png", pName);
-			m_aTextures[i] = Graphics()->LoadTexture(aPath, IStorage::TYPE_ALL, CImageInfo::FORMAT_AUTO, LoadFlag);
+			if(pJob->Status() != IJob::STATE_DONE)
+				return;
+			if(pJob->m_Loaded)
+				m_aTextures[Index] = Graphics()->LoadTextureRaw(pJob->m_Info.m_Width, pJob->m_Info.m_Height, pJob->m_Info.m_Format, pJob->m_Info.m_pData, pJob->m_Info.m_Format, LoadFlag, pJob->m_aPath);
+			else
+				m_aTextures[Index] = Graphics()->LoadTexture(pJob->m_aPath, IStorage::TYPE_ALL, CImageInfo::FORMAT_AUTO, LoadFlag);
+			m_apLoadImageJobs[Index] = nullptr;
 		}
 		else
 		{
-			void *pData = pMap->GetData(pImg->m_ImageData);
-			char *pName = (char *)pMap->GetData(pImg->m_ImageName);
-			char aTexName[128];
-			str_format(aTexName, sizeof(aTexName), "%s %s", "embedded:", pName);
-			m_aTextures[i] = Graphics()->LoadTextureRaw(pImg->m_Width, pImg->m_Height, CImageInfo::FORMAT_RGBA, pData, CImageInfo::FORMAT_RGBA, LoadFlag, aTexName);
-			pMap->UnloadData(pImg->m_ImageData);
+			char aPath[IO_MAX_PATH_LENGTH];
+			char *pName = (char *)m_pMap->GetData(pImg->m_ImageName);
+			str_format(aPath, sizeof(aPath), "mapres/%s.png", pName);
+			m_aTextures[Index] = Graphics()->LoadTexture(aPath, IStorage::TYPE_ALL, CImageInfo::FORMAT_AUTO, LoadFlag);
 		}
 	}
+	else
+	{
+		void *pData = m_pMap->GetData(pImg->m_ImageData);
+		char *pName = (char *)m_pMap->GetData(pImg->m_ImageName);
+		char aTexName[128];
+		str_format(aTexName, sizeof(aTexName), "%s %s", "embedded:", pName);
+		m_aTextures[Index] = Graphics()->LoadTextureRaw(pImg->m_Width, pImg->m_Height, CImageInfo::FORMAT_RGBA, pData, CImageInfo::FORMAT_RGBA, LoadFlag, aTexName);
+		m_pMap->UnloadData(pImg->m_ImageData);
+	}
+	m_aTextureLoaded[Index] = true;
+}
+
+IGraphics::CTextureHandle CMapImages::Get(int Index)
+{
+	if(Index < 0 || Index >= m_Count)
+		return IGraphics::CTextureHandle();
+	if(!m_aTextureLoaded[Index])
+		Load(Index);
+	return m_aTextures[Index];
+}
+
+bool CMapImages::IsLoading(int Index) const
+{
+	return Index >= 0 && Index < m_Count && !m_aTextureLoaded[Index];
 }
 
 void CMapImages::OnMapLoad()
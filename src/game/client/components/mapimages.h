@@ -2,8 +2,12 @@
 /* If you are missing that file, acquire a complete release at teeworlds.com.                */
 #ifndef GAME_CLIENT_COMPONENTS_MAPIMAGES_H
 #define GAME_CLIENT_COMPONENTS_MAPIMAGES_H
+#include <engine/shared/jobs.h>
 #include <game/client/component.h>
 
+#include <atomic>
+#include <memory>
+
 enum EMapImageEntityLayerType
 {
 	MAP_IMAGE_ENTITY_LAYER_TYPE_GAME = 0,
@@ -43,10 +47,36 @@ class CMapImages : public CComponent
 	friend class CBackground;
 	friend class CMenuBackground;
 
+	class CLoadImageJob : public IJob
+	{
+		IGraphics *m_pGraphics;
+
+		virtual void Run();
+
+	public:
+		CLoadImageJob(IGraphics *pGraphics, const char *pPath);
+		virtual ~CLoadImageJob();
+
+		char m_aPath[IO_MAX_PATH_LENGTH];
+		// set if the map changed before the job ran
+		std::atomic<bool> m_Abort;
+		bool m_Loaded;
+		CImageInfo m_Info;
+	};
+
 	IGraphics::CTextureHandle m_aTextures[64];
 	int m_aTextureUsedByTileOrQuadLayerFlag[64]; // 0: nothing, 1(as flag): tile layer, 2(as flag): quad layer
+	bool m_aTextureLoaded[64];
+	// external images are decoded on a job thread right after the map loads
+	std::shared_ptr<CLoadImageJob> m_apLoadImageJobs[64];
 	int m_Count;
 
+	class IMap *m_pMap;
+	int m_ImageStart;
+
+	void Unload();
+	void Load(int Index);
+
 	char m_aEntitiesPath[IO_MAX_PATH_LENGTH];
 
 	bool HasFrontLayer(EMapImageModType ModType);
@@ -59,9 +89,16 @@ public:
 	CMapImages();
 	CMapImages(int ImageSize);
 
-	IGraphics::CTextureHandle Get(int Index) const { return m_aTextures[Index]; }
+	// uploads the image the first time a layer using it is rendered,
+	// check IsLoading() for images that are still being decoded
+	IGraphics::CTextureHandle Get(int Index);
+	bool IsLoading(int Index) const;
 	int Num() const { return m_Count; }
 
+	// set by the map layers when they skipped a layer because its image
+	// was still being decoded, reset at the start of every frame
+	bool m_LayerSkipped;
+
 	void OnMapLoadImpl(class CLayers *pLayers, class IMap *pMap);
 	virtual void OnMapLoad();
 	virtual void OnInit();
@@ -27,12 +27,17 @@ CMapLayers::CMapLayers(int t, bool OnlineOnly)
 	m_LastLocalTick = 0;
 	m_EnvelopeUpdate = false;
 	m_OnlineOnly = OnlineOnly;
+	m_EnvelopeCacheFrame = 0;
+	m_CommandList = -1;
+	m_RecordedAhead = false;
 }
 
 void CMapLayers::OnInit()
 {
 	m_pLayers = Layers();
 	m_pImages = &m_pClient->m_MapImages;
+	// not in the constructor, the game client copies the constructed layers
+	m_RecordAhead.m_pMapLayers = this;
 }
 
 CCamera *CMapLayers::GetCurCamera()
@@ -67,6 +72,32 @@ void CMapLayers::EnvelopeEval(int TimeOffsetMillis, int Env, float *pChannels, v
 	pChannels[2] = 0;
 	pChannels[3] = 0;
 
+	int Start, Num;
+	pThis->m_pLayers->Map()->GetType(MAPITEMTYPE_ENVELOPE, &Start, &Num);
+
+	if(Env >= Num)
+		return;
+
+	if((int)pThis->m_vEnvelopeCache.size() < Num)
+		pThis->m_vEnvelopeCache.resize(Num, CEnvelopeCacheEntry{-1, 0, {0, 0, 0, 0}});
+	CEnvelopeCacheEntry &Entry = pThis->m_vEnvelopeCache[Env];
+	if(Entry.m_Frame != pThis->m_EnvelopeCacheFrame || Entry.m_TimeOffsetMillis != TimeOffsetMillis)
+	{
+		CMapItemEnvelope *pItem = (CMapItemEnvelope *)pThis->m_pLayers->Map()->GetItem(Start + Env, 0, 0);
+		EnvelopeEvalUncached(TimeOffsetMillis, pItem, Entry.m_aChannels, pThis);
+		Entry.m_Frame = pThis->m_EnvelopeCacheFrame;
+		Entry.m_TimeOffsetMillis = TimeOffsetMillis;
+	}
+	mem_copy(pChannels, Entry.m_aChannels, sizeof(Entry.m_aChannels));
+}
+
+void CMapLayers::EnvelopeEvalUncached(int TimeOffsetMillis, CMapItemEnvelope *pItem, float *pChannels, CMapLayers *pThis)
+{
+	pChannels[0] = 0;
+	pChannels[1] = 0;
+	pChannels[2] = 0;
+	pChannels[3] = 0;
+
 	CEnvPoint *pPoints = 0;
 
 	{
@@ -76,14 +107,6 @@ void CMapLayers::EnvelopeEval(int TimeOffsetMillis, int Env, float *pChannels, v
 			pPoints = (CEnvPoint *)pThis->m_pLayers->Map()->GetItem(Start, 0, 0);
 	}
 
-	int Start, Num;
-	pThis->m_pLayers->Map()->GetType(MAPITEMTYPE_ENVELOPE, &Start, &Num);
-
-	if(Env >= Num)
-		return;
-
-	CMapItemEnvelope *pItem = (CMapItemEnvelope *)pThis->m_pLayers->Map()->GetItem(Start + Env, 0, 0);
-
 	const int64_t TickToMicroSeconds = (1000000ll / (int64_t)pThis->Client()->GameTickSpeed());
 
 	static int64_t s_Time = 0;
@@ -220,84 +243,6 @@ void FillTmpTileSpeedup(SGraphicTile *pTmpTile, SGraphicTileTexureCoords *pTmpTe
 	}
 }
 
-void FillTmpTile(SGraphicTile *pTmpTile, SGraphicTileTexureCoords *pTmpTex, bool As3DTextureCoord, unsigned char Flags, unsigned char Index, int x, int y, int Scale, CMapItemGroup *pGroup)
-{
-	if(pTmpTex)
-	{
-		unsigned char x0 = 0;
-		unsigned char y0 = 0;
-		unsigned char x1 = x0 + 1;
-		unsigned char y1 = y0;
-		unsigned char x2 = x0 + 1;
-		unsigned char y2 = y0 + 1;
-		unsigned char x3 = x0;
-		unsigned char y3 = y0 + 1;
-
-		if(Flags & TILEFLAG_VFLIP)
-		{
-			x0 = x2;
-			x1 = x3;
-			x2 = x3;
-			x3 = x0;
-		}
-
-		if(Flags & TILEFLAG_HFLIP)
-		{
-			y0 = y3;
-			y2 = y1;
-			y3 = y1;
-			y1 = y0;
-		}
-
-		if(Flags & TILEFLAG_ROTATE)
-		{
-			unsigned char Tmp = x0;
-			x0 = x3;
-			x3 = x2;
-			x2 = x1;
-			x1 = Tmp;
-			Tmp = y0;
-			y0 = y3;
-			y3 = y2;
-			y2 = y1;
-			y1 = Tmp;
-		}
-
-		pTmpTex->m_TexCoordTopLeft.x = x0;
-		pTmpTex->m_TexCoordTopLeft.y = y0;
-		pTmpTex->m_TexCoordBottomLeft.x = x3;
-		pTmpTex->m_TexCoordBottomLeft.y = y3;
-		pTmpTex->m_TexCoordTopRight.x = x1;
-		pTmpTex->m_TexCoordTopRight.y = y1;
-		pTmpTex->m_TexCoordBottomRight.x = x2;
-		pTmpTex->m_TexCoordBottomRight.y = y2;
-
-		if(As3DTextureCoord)
-		{
-			pTmpTex->m_TexCoordTopLeft.z = ((float)Index + 0.5f) / 256.f;
-			pTmpTex->m_TexCoordBottomLeft.z = ((float)Index + 0.5f) / 256.f;
-			pTmpTex->m_TexCoordTopRight.z = ((float)Index + 0.5f) / 256.f;
-			pTmpTex->m_TexCoordBottomRight.z = ((float)Index + 0.5f) / 256.f;
-		}
-		else
-		{
-			pTmpTex->m_TexCoordTopLeft.z = Index;
-			pTmpTex->m_TexCoordBottomLeft.z = Index;
-			pTmpTex->m_TexCoordTopRight.z = Index;
-			pTmpTex->m_TexCoordBottomRight.z = Index;
-		}
-	}
-
-	pTmpTile->m_TopLeft.x = x * Scale;
-	pTmpTile->m_TopLeft.y = y * Scale;
-	pTmpTile->m_BottomLeft.x = x * Scale;
-	pTmpTile->m_BottomLeft.y = y * Scale + Scale;
-	pTmpTile->m_TopRight.x = x * Scale + Scale;
-	pTmpTile->m_TopRight.y = y * Scale;
-	pTmpTile->m_BottomRight.x = x * Scale + Scale;
-	pTmpTile->m_BottomRight.y = y * Scale + Scale;
-}
-
 bool CMapLayers::STileLayerVisuals::Init(unsigned int Width, unsigned int Height)
 {
 	m_Width = Width;
@@ -1537,11 +1482,38 @@ void CMapLayers::LayersOfGroupCount(CMapItemGroup *pGroup, int &TileLayerCount,
 	QuadLayerCount += QuadLayerCounter;
 }
 
+void CMapLayers::RecordAhead()
+{
+	if(m_CommandList == -1)
+		m_CommandList = Graphics()->CreateCommandList();
+	// without command lists the layers are rendered at their usual place
+	if(m_CommandList == -1)
+		return;
+
+	Graphics()->BeginCommandList(m_CommandList);
+	RenderLayers();
+	Graphics()->EndCommandList();
+	m_RecordedAhead = true;
+}
+
 void CMapLayers::OnRender()
+{
+	if(m_RecordedAhead)
+	{
+		Graphics()->SubmitCommandList(m_CommandList);
+		m_RecordedAhead = false;
+		return;
+	}
+	RenderLayers();
+}
+
+void CMapLayers::RenderLayers()
 {
 	if(m_OnlineOnly && Client()->State() != IClient::STATE_ONLINE && Client()->State() != IClient::STATE_DEMOPLAYBACK)
 		return;
 
+	m_EnvelopeCacheFrame++;
+
 	CUIRect Screen;
 	Graphics()->GetScreen(&Screen.x, &Screen.y, &Screen.w, &Screen.h);
 
@@ -1746,7 +1718,16 @@ void CMapLayers::OnRender()
 							Graphics()->TextureSet(m_pImages->GetEntities(MAP_IMAGE_ENTITY_LAYER_TYPE_GAME));
 					}
 					else
-						Graphics()->TextureSet(m_pImages->Get(pTMap->m_Image));
+					{
+						IGraphics::CTextureHandle Texture = m_pImages->Get(pTMap->m_Image);
+						// draw nothing until the image is decoded
+						if(m_pImages->IsLoading(pTMap->m_Image))
+						{
+							m_pImages->m_LayerSkipped = true;
+							continue;
+						}
+						Graphics()->TextureSet(Texture);
+					}
 
 					CTile *pTiles = (CTile *)m_pLayers->Map()->GetData(pTMap->m_Data);
 					unsigned int Size = m_pLayers->Map()->GetDataSize(pTMap->m_Data);
@@ -1805,7 +1786,15 @@ void CMapLayers::OnRender()
 					if(pQLayer->m_Image == -1)
 						Graphics()->TextureClear();
 					else
-						Graphics()->TextureSet(m_pImages->Get(pQLayer->m_Image));
+					{
+						IGraphics::CTextureHandle Texture = m_pImages->Get(pQLayer->m_Image);
+						if(m_pImages->IsLoading(pQLayer->m_Image))
+						{
+							m_pImages->m_LayerSkipped = true;
+							continue;
+						}
+						Graphics()->TextureSet(Texture);
+					}
 
 					CQuad *pQuads = (CQuad *)m_pLayers->Map()->GetDataSwapped(pQLayer->m_Data);
 					if(m_Type == TYPE_BACKGROUND_FORCE || m_Type == TYPE_FULL_DESIGN)
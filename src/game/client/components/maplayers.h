@@ -17,6 +17,7 @@ typedef char *offset_ptr_size;
 typedef uintptr_t offset_ptr;
 typedef unsigned int offset_ptr32;
 
+struct CMapItemEnvelope;
 struct CMapItemGroup;
 struct CMapItemLayerTilemap;
 struct CMapItemLayerQuads;
@@ -35,6 +36,27 @@ class CMapLayers : public CComponent
 
 	bool m_OnlineOnly;
 
+	// the command list the layers were recorded into ahead of their place
+	// in the render order, see m_RecordAhead
+	int m_CommandList;
+	bool m_RecordedAhead;
+
+	void RenderLayers();
+	void RecordAhead();
+
+	// every envelope is evaluated once per frame, unless it's used with
+	// different time offsets
+	struct CEnvelopeCacheEntry
+	{
+		int m_Frame;
+		int m_TimeOffsetMillis;
+		float m_aChannels[4];
+	};
+	std::vector<CEnvelopeCacheEntry> m_vEnvelopeCache;
+	int m_EnvelopeCacheFrame;
+
+	static void EnvelopeEvalUncached(int TimeOffsetMillis, CMapItemEnvelope *pItem, float *pChannels, CMapLayers *pThis);
+
 	void MapScreenToGroup(float CenterX, float CenterY, CMapItemGroup *pGroup, float Zoom = 1.0f);
 
 	struct STileLayerVisuals
@@ -150,6 +172,17 @@ public:
 	virtual void OnRender();
 	virtual void OnMapLoad();
 
+	// added to the render order before the map layers themselves, records
+	// them into a command list that OnRender only submits. lets the
+	// foreground be recorded together with the background
+	class CRecordAhead : public CComponent
+	{
+	public:
+		CMapLayers *m_pMapLayers;
+		virtual void OnRender() { m_pMapLayers->RecordAhead(); }
+	};
+	CRecordAhead m_RecordAhead;
+
 	void RenderTileLayer(int LayerIndex, ColorRGBA *pColor, CMapItemLayerTilemap *pTileLayer, CMapItemGroup *pGroup);
 	void RenderTileBorder(int LayerIndex, ColorRGBA *pColor, CMapItemLayerTilemap *pTileLayer, CMapItemGroup *pGroup, int BorderX0, int BorderY0, int BorderX1, int BorderY1, int ScreenWidthTileCount, int ScreenHeightTileCount);
 	void RenderKillTileBorder(int LayerIndex, ColorRGBA *pColor, CMapItemLayerTilemap *pTileLayer, CMapItemGroup *pGroup);
@@ -22,18 +22,9 @@ CParticles::CParticles()
 void CParticles::OnReset()
 {
 	// reset particles
-	for(int i = 0; i < MAX_PARTICLES; i++)
-	{
-		m_aParticles[i].m_PrevPart = i - 1;
-		m_aParticles[i].m_NextPart = i + 1;
-	}
-
-	m_aParticles[0].m_PrevPart = 0;
-	m_aParticles[MAX_PARTICLES - 1].m_NextPart = -1;
-	m_FirstFree = 0;
-
-	for(int &FirstPart : m_aFirstPart)
-		FirstPart = -1;
+	for(auto &Group : m_aGroups)
+		Group.Clear();
+	m_NumParticles = 0;
 }
 
 void CParticles::Add(int Group, CParticle *pPart, float TimePassed)
@@ -50,27 +41,11 @@ void CParticles::Add(int Group, CParticle *pPart, float TimePassed)
 			return;
 	}
 
-	if(m_FirstFree == -1)
+	if(m_NumParticles >= CParticleGroup::MAX_PARTICLES)
 		return;
 
-	// remove from the free list
-	int Id = m_FirstFree;
-	m_FirstFree = m_aParticles[Id].m_NextPart;
-	if(m_FirstFree != -1)
-		m_aParticles[m_FirstFree].m_PrevPart = -1;
-
-	// copy data
-	m_aParticles[Id] = *pPart;
-
-	// insert to the group list
-	m_aParticles[Id].m_PrevPart = -1;
-	m_aParticles[Id].m_NextPart = m_aFirstPart[Group];
-	if(m_aFirstPart[Group] != -1)
-		m_aParticles[m_aFirstPart[Group]].m_PrevPart = Id;
-	m_aFirstPart[Group] = Id;
-
-	// set some parameters
-	m_aParticles[Id].m_Life = TimePassed;
+	m_aGroups[Group].Add(pPart, TimePassed);
+	m_NumParticles++;
 }
 
 void CParticles::Update(float TimePassed)
@@ -91,49 +66,8 @@ void CParticles::Update(float TimePassed)
 		FrictionFraction -= 0.05f;
 	}
 
-	for(int &FirstPart : m_aFirstPart)
-	{
-		int i = FirstPart;
-		while(i != -1)
-		{
-			int Next = m_aParticles[i].m_NextPart;
-			//m_aParticles[i].vel += flow_get(m_aParticles[i].pos)*time_passed * m_aParticles[i].flow_affected;
-			m_aParticles[i].m_Vel.y += m_aParticles[i].m_Gravity * TimePassed;
-
-			for(int f = 0; f < FrictionCount; f++) // apply friction
-				m_aParticles[i].m_Vel *= m_aParticles[i].m_Friction;
-
-			// move the point
-			vec2 Vel = m_aParticles[i].m_Vel * TimePassed;
-			Collision()->MovePoint(&m_aParticles[i].m_Pos, &Vel, 0.1f + 0.9f * random_float(), NULL);
-			m_aParticles[i].m_Vel = Vel * (1.0f / TimePassed);
-
-			m_aParticles[i].m_Life += TimePassed;
-			m_aParticles[i].m_Rot += TimePassed * m_aParticles[i].m_Rotspeed;
-
-			// check particle death
-			if(m_aParticles[i].m_Life > m_aParticles[i].m_LifeSpan)
-			{
-				// remove it from the group list
-				if(m_aParticles[i].m_PrevPart != -1)
-					m_aParticles[m_aParticles[i].m_PrevPart].m_NextPart = m_aParticles[i].m_NextPart;
-				else
-					FirstPart = m_aParticles[i].m_NextPart;
-
-				if(m_aParticles[i].m_NextPart != -1)
-					m_aParticles[m_aParticles[i].m_NextPart].m_PrevPart = m_aParticles[i].m_PrevPart;
-
-				// insert to the free list
-				if(m_FirstFree != -1)
-					m_aParticles[m_FirstFree].m_PrevPart = i;
-				m_aParticles[i].m_PrevPart = -1;
-				m_aParticles[i].m_NextPart = m_FirstFree;
-				m_FirstFree = i;
-			}
-
-			i = Next;
-		}
-	}
+	for(auto &Group : m_aGroups)
+		m_NumParticles -= Group.Update(Collision(), TimePassed, FrictionCount);
 }
 
 void CParticles::OnRender()
@@ -175,91 +109,76 @@ void CParticles::OnInit()
 	Graphics()->QuadContainerUpload(m_ParticleQuadContainerIndex);
 }
 
-bool CParticles::ParticleIsVisibleOnScreen(const vec2 &CurPos, float CurSize)
+void CParticles::RenderGroup(int Group)
 {
+	const CParticleGroup *pGroup = &m_aGroups[Group];
+
+	// cull the particles against the screen first. for simplicity assume
+	// the worst case rotation, that increases the bounding box around the
+	// particle by its diagonal
 	float ScreenX0, ScreenY0, ScreenX1, ScreenY1;
 	Graphics()->GetScreen(&ScreenX0, &ScreenY0, &ScreenX1, &ScreenY1);
+	const float HalfDiagonal = sqrtf(2) / 2;
 
-	// for simplicity assume the worst case rotation, that increases the bounding box around the particle by its diagonal
-	const float SqrtOf2 = sqrtf(2);
-	CurSize = SqrtOf2 * CurSize;
-
-	// always uses the mid of the particle
-	float SizeHalf = CurSize / 2;
-
-	return CurPos.x + SizeHalf >= ScreenX0 && CurPos.x - SizeHalf <= ScreenX1 && CurPos.y + SizeHalf >= ScreenY0 && CurPos.y - SizeHalf <= ScreenY1;
-}
+	static int s_aVisible[CParticleGroup::MAX_PARTICLES];
+	static float s_aSize[CParticleGroup::MAX_PARTICLES];
+	int NumVisible = 0;
+	// the newest particles are rendered first
+	for(int i = pGroup->m_Num - 1; i >= 0; i--)
+	{
+		float a = pGroup->m_aLife[i] / pGroup->m_aLifeSpan[i];
+		float Size = mix(pGroup->m_aStartSize[i], pGroup->m_aEndSize[i], a);
+		float Extent = Size * HalfDiagonal;
+		if(pGroup->m_aPosX[i] + Extent >= ScreenX0 && pGroup->m_aPosX[i] - Extent <= ScreenX1 && pGroup->m_aPosY[i] + Extent >= ScreenY0 && pGroup->m_aPosY[i] - Extent <= ScreenY1)
+		{
+			s_aVisible[NumVisible] = i;
+			s_aSize[NumVisible] = Size;
+			NumVisible++;
+		}
+	}
 
-void CParticles::RenderGroup(int Group)
-{
 	// don't use the buffer methods here, else the old renderer gets many draw calls
 	if(Graphics()->IsQuadContainerBufferingEnabled())
 	{
-		int i = m_aFirstPart[Group];
-
-		static IGraphics::SRenderSpriteInfo s_aParticleRenderInfo[MAX_PARTICLES];
+		static IGraphics::SRenderSpriteInfo s_aParticleRenderInfo[CParticleGroup::MAX_PARTICLES];
 
 		int CurParticleRenderCount = 0;
 
 		// batching makes sense for stuff like ninja particles
-		float LastColor[4];
+		ColorRGBA LastColor;
 		int LastQuadOffset = 0;
 
-		if(i != -1)
+		if(NumVisible)
 		{
-			LastColor[0] = m_aParticles[i].m_Color.r;
-			LastColor[1] = m_aParticles[i].m_Color.g;
-			LastColor[2] = m_aParticles[i].m_Color.b;
-			LastColor[3] = m_aParticles[i].m_Color.a;
-
-			Graphics()->SetColor(
-				m_aParticles[i].m_Color.r,
-				m_aParticles[i].m_Color.g,
-				m_aParticles[i].m_Color.b,
-				m_aParticles[i].m_Color.a);
-
-			LastQuadOffset = m_aParticles[i].m_Spr;
+			LastColor = pGroup->m_aColor[s_aVisible[0]];
+			Graphics()->SetColor(LastColor.r, LastColor.g, LastColor.b, LastColor.a);
+			LastQuadOffset = pGroup->m_aSpr[s_aVisible[0]];
 		}
 
-		while(i != -1)
+		for(int v = 0; v < NumVisible; v++)
 		{
-			int QuadOffset = m_aParticles[i].m_Spr;
-			float a = m_aParticles[i].m_Life / m_aParticles[i].m_LifeSpan;
-			vec2 p = m_aParticles[i].m_Pos;
-			float Size = mix(m_aParticles[i].m_StartSize, m_aParticles[i].m_EndSize, a);
+			int i = s_aVisible[v];
+			int QuadOffset = pGroup->m_aSpr[i];
+			const ColorRGBA &Color = pGroup->m_aColor[i];
 
-			// the current position, respecting the size, is inside the viewport, render it, else ignore
-			if(ParticleIsVisibleOnScreen(p, Size))
+			if(LastColor.r != Color.r || LastColor.g != Color.g || LastColor.b != Color.b || LastColor.a != Color.a || LastQuadOffset != QuadOffset)
 			{
-				if(LastColor[0] != m_aParticles[i].m_Color.r || LastColor[1] != m_aParticles[i].m_Color.g || LastColor[2] != m_aParticles[i].m_Color.b || LastColor[3] != m_aParticles[i].m_Color.a || LastQuadOffset != QuadOffset)
-				{
-					Graphics()->TextureSet(GameClient()->m_ParticlesSkin.m_SpriteParticles[LastQuadOffset - SPRITE_PART_SLICE]);
-					Graphics()->RenderQuadContainerAsSpriteMultiple(m_ParticleQuadContainerIndex, LastQuadOffset, CurParticleRenderCount, s_aParticleRenderInfo);
-					CurParticleRenderCount = 0;
-					LastQuadOffset = QuadOffset;
-
-					Graphics()->SetColor(
-						m_aParticles[i].m_Color.r,
-						m_aParticles[i].m_Color.g,
-						m_aParticles[i].m_Color.b,
-						m_aParticles[i].m_Color.a);
-
-					LastColor[0] = m_aParticles[i].m_Color.r;
-					LastColor[1] = m_aParticles[i].m_Color.g;
-					LastColor[2] = m_aParticles[i].m_Color.b;
-					LastColor[3] = m_aParticles[i].m_Color.a;
-				}
-
-				s_aParticleRenderInfo[CurParticleRenderCount].m_Pos[0] = p.x;
-				s_aParticleRenderInfo[CurParticleRenderCount].m_Pos[1] = p.y;
-
-				s_aParticleRenderInfo[CurParticleRenderCount].m_Scale = Size;
-				s_aParticleRenderInfo[CurParticleRenderCount].m_Rotation = m_aParticles[i].m_Rot;
-
-				++CurParticleRenderCount;
+				Graphics()->TextureSet(GameClient()->m_ParticlesSkin.m_SpriteParticles[LastQuadOffset - SPRITE_PART_SLICE]);
+				Graphics()->RenderQuadContainerAsSpriteMultiple(m_ParticleQuadContainerIndex, LastQuadOffset, CurParticleRenderCount, s_aParticleRenderInfo);
+				CurParticleRenderCount = 0;
+				LastQuadOffset = QuadOffset;
+
+				Graphics()->SetColor(Color.r, Color.g, Color.b, Color.a);
+				LastColor = Color;
 			}
 
-			i = m_aParticles[i].m_NextPart;
+			s_aParticleRenderInfo[CurParticleRenderCount].m_Pos[0] = pGroup->m_aPosX[i];
+			s_aParticleRenderInfo[CurParticleRenderCount].m_Pos[1] = pGroup->m_aPosY[i];
+
+			s_aParticleRenderInfo[CurParticleRenderCount].m_Scale = s_aSize[v];
+			s_aParticleRenderInfo[CurParticleRenderCount].m_Rotation = pGroup->m_aRot[i];
+
+			++CurParticleRenderCount;
 		}
 
 		Graphics()->TextureSet(GameClient()->m_ParticlesSkin.m_SpriteParticles[LastQuadOffset - SPRITE_PART_SLICE]);
@@ -267,37 +186,24 @@ void CParticles::RenderGroup(int Group)
 	}
 	else
 	{
-		int i = m_aFirstPart[Group];
-
 		Graphics()->BlendNormal();
 		Graphics()->WrapClamp();
 
-		while(i != -1)
+		for(int v = 0; v < NumVisible; v++)
 		{
-			float a = m_aParticles[i].m_Life / m_aParticles[i].m_LifeSpan;
-			vec2 p = m_aParticles[i].m_Pos;
-			float Size = mix(m_aParticles[i].m_StartSize, m_aParticles[i].m_EndSize, a);
-
-			// the current position, respecting the size, is inside the viewport, render it, else ignore
-			if(ParticleIsVisibleOnScreen(p, Size))
-			{
-				Graphics()->TextureSet(GameClient()->m_ParticlesSkin.m_SpriteParticles[m_aParticles[i].m_Spr - SPRITE_PART_SLICE]);
-				Graphics()->QuadsBegin();
+			int i = s_aVisible[v];
+			const ColorRGBA &Color = pGroup->m_aColor[i];
 
-				Graphics()->QuadsSetRotation(m_aParticles[i].m_Rot);
+			Graphics()->TextureSet(GameClient()->m_ParticlesSkin.m_SpriteParticles[pGroup->m_aSpr[i] - SPRITE_PART_SLICE]);
+			Graphics()->QuadsBegin();
 
-				Graphics()->SetColor(
-					m_aParticles[i].m_Color.r,
-					m_aParticles[i].m_Color.g,
-					m_aParticles[i].m_Color.b,
-					m_aParticles[i].m_Color.a); // pow(a, 0.75f) *
+			Graphics()->QuadsSetRotation(pGroup->m_aRot[i]);
 
-				IGraphics::CQuadItem QuadItem(p.x, p.y, Size, Size);
-				Graphics()->QuadsDraw(&QuadItem, 1);
-				Graphics()->QuadsEnd();
-			}
+			Graphics()->SetColor(Color.r, Color.g, Color.b, Color.a); // pow(a, 0.75f) *
 
-			i = m_aParticles[i].m_NextPart;
+			IGraphics::CQuadItem QuadItem(pGroup->m_aPosX[i], pGroup->m_aPosY[i], s_aSize[v], s_aSize[v]);
+			Graphics()->QuadsDraw(&QuadItem, 1);
+			Graphics()->QuadsEnd();
 		}
 		Graphics()->WrapNormal();
 		Graphics()->BlendNormal();
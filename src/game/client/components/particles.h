@@ -4,49 +4,7 @@
 #define GAME_CLIENT_COMPONENTS_PARTICLES_H
 #include <base/vmath.h>
 #include <game/client/component.h>
-
-// particles
-struct CParticle
-{
-	void SetDefault()
-	{
-		m_Vel = vec2(0, 0);
-		m_LifeSpan = 0;
-		m_StartSize = 32;
-		m_EndSize = 32;
-		m_Rot = 0;
-		m_Rotspeed = 0;
-		m_Gravity = 0;
-		m_Friction = 0;
-		m_FlowAffected = 1.0f;
-		m_Color = ColorRGBA(1, 1, 1, 1);
-	}
-
-	vec2 m_Pos;
-	vec2 m_Vel;
-
-	int m_Spr;
-
-	float m_FlowAffected;
-
-	float m_LifeSpan;
-
-	float m_StartSize;
-	float m_EndSize;
-
-	float m_Rot;
-	float m_Rotspeed;
-
-	float m_Gravity;
-	float m_Friction;
-
-	ColorRGBA m_Color;
-
-	// set by the particle system
-	float m_Life;
-	int m_PrevPart;
-	int m_NextPart;
-};
+#include <game/client/particle_group.h>
 
 class CParticles : public CComponent
 {
@@ -72,14 +30,9 @@ public:
 private:
 	int m_ParticleQuadContainerIndex;
 
-	enum
-	{
-		MAX_PARTICLES = 1024 * 8,
-	};
-
-	CParticle m_aParticles[MAX_PARTICLES];
-	int m_FirstFree;
-	int m_aFirstPart[NUM_GROUPS];
+	CParticleGroup m_aGroups[NUM_GROUPS];
+	// the limit is shared by all groups
+	int m_NumParticles;
 
 	void RenderGroup(int Group);
 	void Update(float TimePassed);
@@ -95,7 +48,5 @@ private:
 	CRenderGroup<GROUP_PROJECTILE_TRAIL> m_RenderTrail;
 	CRenderGroup<GROUP_EXPLOSIONS> m_RenderExplosions;
 	CRenderGroup<GROUP_GENERAL> m_RenderGeneral;
-
-	bool ParticleIsVisibleOnScreen(const vec2 &CurPos, float CurSize);
 };
 #endif
@@ -5,6 +5,7 @@
 #include <base/math.h>
 #include <base/system.h>
 #include <ctime>
+#include <thread>
 
 #include <engine/engine.h>
 #include <engine/graphics.h>
@@ -50,6 +51,18 @@ CSkins::CGetPngFile::CGetPngFile(CSkins *pSkins, IStorage *pStorage, const char
 {
 }
 
+CSkins::CLoadSkinJob::CLoadSkinJob(IGraphics *pGraphics, const char *pName, const char *pPath, int DirType) :
+	m_pGraphics(pGraphics), m_DirType(DirType), m_Loaded(false)
+{
+	str_copy(m_aName, pName, sizeof(m_aName));
+	str_copy(m_aPath, pPath, sizeof(m_aPath));
+}
+
+void CSkins::CLoadSkinJob::Run()
+{
+	m_Loaded = m_pGraphics->LoadPNG(&m_Info, m_aPath, m_DirType);
+}
+
 int CSkins::SkinScan(const char *pName, int IsDir, int DirType, void *pUser)
 {
 	CSkins *pSelf = (CSkins *)pUser;
@@ -63,16 +76,16 @@ int CSkins::SkinScan(const char *pName, int IsDir, int DirType, void *pUser)
 
 	// Don't add duplicate skins (one from user's config directory, other from
 	// client itself)
-	for(int i = 0; i < pSelf->Num(); i++)
+	for(auto &pJob : pSelf->m_vpLoadSkinJobs)
 	{
-		const char *pExName = pSelf->Get(i)->m_aName;
-		if(str_comp(pExName, aNameWithoutPng) == 0)
+		if(str_comp(pJob->m_aName, aNameWithoutPng) == 0)
 			return 0;
 	}
 
 	char aBuf[IO_MAX_PATH_LENGTH];
 	str_format(aBuf, sizeof(aBuf), "skins/%s", pName);
-	return pSelf->LoadSkin(aNameWithoutPng, aBuf, DirType);
+	pSelf->m_vpLoadSkinJobs.push_back(std::make_shared<CLoadSkinJob>(pSelf->Graphics(), aNameWithoutPng, aBuf, DirType));
+	return 0;
 }
 
 static void CheckMetrics(CSkin::SSkinMetricVariable &Metrics, uint8_t *pImg, int ImgWidth, int ImgX, int ImgY, int CheckWidth, int CheckHeight)
@@ -110,14 +123,6 @@ static void CheckMetrics(CSkin::SSkinMetricVariable &Metrics, uint8_t *pImg, int
 	Metrics.m_MaxHeight = CheckHeight;
 }
 
-int CSkins::LoadSkin(const char *pName, const char *pPath, int DirType)
-{
-	CImageInfo Info;
-	if(!LoadSkinPNG(Info, pName, pPath, DirType))
-		return 0;
-	return LoadSkin(pName, Info);
-}
-
 bool CSkins::LoadSkinPNG(CImageInfo &Info, const char *pName, const char *pPath, int DirType)
 {
 	char aBuf[512];
@@ -336,6 +341,33 @@ void CSkins::Refresh()
 	m_aSkins.clear();
 	m_aDownloadSkins.clear();
 	Storage()->ListDirectory(IStorage::TYPE_ALL, "skins", SkinScan, this);
+
+	// decoding the pngs takes most of the time, do it on all cores while
+	// the textures of the finished skins are created here. the engine's
+	// job pool is left alone, its few threads might be busy with downloads.
+	{
+		CJobPool JobPool;
+		JobPool.Init(maximum((int)std::thread::hardware_concurrency(), 1));
+		for(auto &pJob : m_vpLoadSkinJobs)
+			JobPool.Add(pJob);
+		for(auto &pJob : m_vpLoadSkinJobs)
+		{
+			while(pJob->Status() != IJob::STATE_DONE)
+				thread_sleep(100);
+			if(pJob->m_Loaded)
+			{
+				LoadSkin(pJob->m_aName, pJob->m_Info);
+			}
+			else
+			{
+				char aBuf[512];
+				str_format(aBuf, sizeof(aBuf), "failed to load skin from %s", pJob->m_aName);
+				Console()->Print(IConsole::OUTPUT_LEVEL_ADDINFO, "game", aBuf);
+			}
+		}
+	}
+	m_vpLoadSkinJobs.clear();
+
 	if(!m_aSkins.size())
 	{
 		Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "gameclient", "failed to load skins. folder='skins/'");
@@ -9,6 +9,9 @@
 #include <game/client/component.h>
 #include <game/client/skin.h>
 
+#include <memory>
+#include <vector>
+
 class CSkins : public CComponent
 {
 public:
@@ -43,12 +46,29 @@ public:
 	int Find(const char *pName);
 
 private:
+	// decodes the png of a skin from the skins directory
+	class CLoadSkinJob : public IJob
+	{
+		IGraphics *m_pGraphics;
+
+		virtual void Run();
+
+	public:
+		CLoadSkinJob(IGraphics *pGraphics, const char *pName, const char *pPath, int DirType);
+
+		char m_aName[24];
+		char m_aPath[IO_MAX_PATH_LENGTH];
+		int m_DirType;
+		bool m_Loaded;
+		CImageInfo m_Info;
+	};
+
 	sorted_array<CSkin> m_aSkins;
 	sorted_array<CDownloadSkin> m_aDownloadSkins;
+	std::vector<std::shared_ptr<CLoadSkinJob>> m_vpLoadSkinJobs;
 	char m_EventSkinPrefix[24];
 
 	bool LoadSkinPNG(CImageInfo &Info, const char *pName, const char *pPath, int DirType);
-	int LoadSkin(const char *pName, const char *pPath, int DirType);
 	int LoadSkin(const char *pName, CImageInfo &Info);
 	int FindImpl(const char *pName);
 	static int SkinScan(const char *pName, int IsDir, int DirType, void *pUser);
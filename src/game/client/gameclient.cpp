@@ -116,6 +116,7 @@ void CGameClient::OnConsoleInit()
 
 	m_All.Add(&m_BackGround); //render instead of m_MapLayersBackGround when g_Config.m_ClOverlayEntities == 100
 	m_All.Add(&m_MapLayersBackGround); // first to render
+	m_All.Add(&m_MapLayersForeGround.m_RecordAhead); // records the foreground right after the background, submitted at its place below
 	m_All.Add(&m_Particles.m_RenderTrail);
 	m_All.Add(&m_Items);
 	m_All.Add(&m_Players);
@@ -566,6 +567,8 @@ void CGameClient::UpdatePositions()
 
 void CGameClient::OnRender()
 {
+	m_MapImages.m_LayerSkipped = false;
+
 	// update the local character and spectate position
 	UpdatePositions();
 
@@ -1693,31 +1696,52 @@ void CGameClient::OnPredict()
 
 	// init
 	bool Dummy = g_Config.m_ClDummy ^ m_IsDummySwapping;
-	m_PredictedWorld.CopyWorld(&m_GameWorld);
-
-	// don't predict inactive players, or entities from other teams
-	for(int i = 0; i < MAX_CLIENTS; i++)
-		if(CCharacter *pChar = m_PredictedWorld.GetCharacterByID(i))
-			if((!m_Snap.m_aCharacters[i].m_Active && pChar->m_SnapTicks > 10) || IsOtherTeam(i))
-				pChar->Destroy();
+	int PredictDummyID = PredictDummy() ? m_PredictedDummyID : -1;
 
-	CProjectile *pProjNext = 0;
-	for(CProjectile *pProj = (CProjectile *)m_PredictedWorld.FindFirst(CGameWorld::ENTTYPE_PROJECTILE); pProj; pProj = pProjNext)
+	// the inputs of the ticks that were already predicted don't change, so
+	// only the new ticks have to be predicted as long as no new snapshot
+	// modified the game world. the freeze option depends on the last tick.
+	int FirstTick = Client()->GameTick(g_Config.m_ClDummy) + 1;
+	if(m_PredictedWorld.m_IsValidCopy && m_PredictedWorld.m_pParent == &m_GameWorld &&
+		m_PredictedWorld.GameTick() >= FirstTick - 1 && m_PredictedWorld.GameTick() < Client()->PredGameTick(g_Config.m_ClDummy) &&
+		m_PredictedWorldLocalID == m_Snap.m_LocalClientID && m_PredictedWorldDummyID == PredictDummyID &&
+		m_PredictedWorldDummy == Dummy && m_PredictedWorldDummySwapping == (m_IsDummySwapping != 0) &&
+		g_Config.m_ClPredictFreeze != 2)
+	{
+		FirstTick = m_PredictedWorld.GameTick() + 1;
+	}
+	else
 	{
-		pProjNext = (CProjectile *)pProj->TypeNext();
-		if(IsOtherTeam(pProj->GetOwner()))
-			m_PredictedWorld.RemoveEntity(pProj);
+		m_PredictedWorld.CopyWorld(&m_GameWorld);
+		m_PredictedWorldLocalID = m_Snap.m_LocalClientID;
+		m_PredictedWorldDummyID = PredictDummyID;
+		m_PredictedWorldDummy = Dummy;
+		m_PredictedWorldDummySwapping = m_IsDummySwapping != 0;
+
+		// don't predict inactive players, or entities from other teams
+		for(int i = 0; i < MAX_CLIENTS; i++)
+			if(CCharacter *pChar = m_PredictedWorld.GetCharacterByID(i))
+				if((!m_Snap.m_aCharacters[i].m_Active && pChar->m_SnapTicks > 10) || IsOtherTeam(i))
+					pChar->Destroy();
+
+		CProjectile *pProjNext = 0;
+		for(CProjectile *pProj = (CProjectile *)m_PredictedWorld.FindFirst(CGameWorld::ENTTYPE_PROJECTILE); pProj; pProj = pProjNext)
+		{
+			pProjNext = (CProjectile *)pProj->TypeNext();
+			if(IsOtherTeam(pProj->GetOwner()))
+				m_PredictedWorld.RemoveEntity(pProj);
+		}
 	}
 
 	CCharacter *pLocalChar = m_PredictedWorld.GetCharacterByID(m_Snap.m_LocalClientID);
 	if(!pLocalChar)
 		return;
 	CCharacter *pDummyChar = 0;
-	if(PredictDummy())
-		pDummyChar = m_PredictedWorld.GetCharacterByID(m_PredictedDummyID);
+	if(PredictDummyID >= 0)
+		pDummyChar = m_PredictedWorld.GetCharacterByID(PredictDummyID);
 
 	// predict
-	for(int Tick = Client()->GameTick(g_Config.m_ClDummy) + 1; Tick <= Client()->PredGameTick(g_Config.m_ClDummy); Tick++)
+	for(int Tick = FirstTick; Tick <= Client()->PredGameTick(g_Config.m_ClDummy); Tick++)
 	{
 		// fetch the previous characters
 		if(Tick == Client()->PredGameTick(g_Config.m_ClDummy))
@@ -3063,3 +3087,8 @@ bool CGameClient::IsDisplayingWarning()
 {
 	return m_Menus.GetCurPopup() == CMenus::POPUP_WARNING;
 }
+
+bool CGameClient::MapLayersComplete()
+{
+	return !m_MapImages.m_LayerSkipped;
+}
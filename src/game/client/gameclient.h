@@ -183,6 +183,14 @@ private:
 	int m_PredictedTick;
 	int m_LastNewPredictedTick[NUM_DUMMIES];
 
+	// the predicted world is continued from its last tick instead of
+	// predicting again from the snapshot until a new snapshot arrives or
+	// one of these changes
+	int m_PredictedWorldLocalID;
+	int m_PredictedWorldDummyID;
+	bool m_PredictedWorldDummy;
+	bool m_PredictedWorldDummySwapping;
+
 	int m_LastRoundStartTick;
 
 	int m_LastFlagCarrierRed;
@@ -514,6 +522,7 @@ public:
 	bool IsOtherTeam(int ClientID);
 	bool CanDisplayWarning();
 	bool IsDisplayingWarning();
+	bool MapLayersComplete();
 
 	void LoadGameSkin(const char *pPath, bool AsDir = false);
 	void LoadEmoticonsSkin(const char *pPath, bool AsDir = false);
@@ -0,0 +1,155 @@
+#include "particle_group.h"
+
+#include <base/math.h>
+#include <game/collision.h>
+
+CParticleGroup::CParticleGroup()
+{
+	m_Num = 0;
+}
+
+void CParticleGroup::Clear()
+{
+	m_Num = 0;
+	std::vector<float>().swap(m_aPosX);
+	std::vector<float>().swap(m_aPosY);
+	std::vector<float>().swap(m_aVelX);
+	std::vector<float>().swap(m_aVelY);
+	std::vector<float>().swap(m_aLife);
+	std::vector<float>().swap(m_aLifeSpan);
+	std::vector<float>().swap(m_aRot);
+	std::vector<float>().swap(m_aRotspeed);
+	std::vector<float>().swap(m_aGravity);
+	std::vector<float>().swap(m_aFriction);
+	std::vector<float>().swap(m_aStartSize);
+	std::vector<float>().swap(m_aEndSize);
+	std::vector<int>().swap(m_aSpr);
+	std::vector<ColorRGBA>().swap(m_aColor);
+}
+
+void CParticleGroup::Grow()
+{
+	int Capacity = m_aPosX.empty() ? 256 : minimum((int)m_aPosX.size() * 2, (int)MAX_PARTICLES);
+	m_aPosX.resize(Capacity);
+	m_aPosY.resize(Capacity);
+	m_aVelX.resize(Capacity);
+	m_aVelY.resize(Capacity);
+	m_aLife.resize(Capacity);
+	m_aLifeSpan.resize(Capacity);
+	m_aRot.resize(Capacity);
+	m_aRotspeed.resize(Capacity);
+	m_aGravity.resize(Capacity);
+	m_aFriction.resize(Capacity);
+	m_aStartSize.resize(Capacity);
+	m_aEndSize.resize(Capacity);
+	m_aSpr.resize(Capacity);
+	m_aColor.resize(Capacity);
+}
+
+void CParticleGroup::Move(int From, int To)
+{
+	m_aPosX[To] = m_aPosX[From];
+	m_aPosY[To] = m_aPosY[From];
+	m_aVelX[To] = m_aVelX[From];
+	m_aVelY[To] = m_aVelY[From];
+	m_aLife[To] = m_aLife[From];
+	m_aLifeSpan[To] = m_aLifeSpan[From];
+	m_aRot[To] = m_aRot[From];
+	m_aRotspeed[To] = m_aRotspeed[From];
+	m_aGravity[To] = m_aGravity[From];
+	m_aFriction[To] = m_aFriction[From];
+	m_aStartSize[To] = m_aStartSize[From];
+	m_aEndSize[To] = m_aEndSize[From];
+	m_aSpr[To] = m_aSpr[From];
+	m_aColor[To] = m_aColor[From];
+}
+
+void CParticleGroup::Add(const CParticle *pPart, float TimePassed)
+{
+	if(m_Num == (int)m_aPosX.size())
+		Grow();
+
+	int Id = m_Num++;
+	m_aPosX[Id] = pPart->m_Pos.x;
+	m_aPosY[Id] = pPart->m_Pos.y;
+	m_aVelX[Id] = pPart->m_Vel.x;
+	m_aVelY[Id] = pPart->m_Vel.y;
+	m_aLife[Id] = TimePassed;
+	m_aLifeSpan[Id] = pPart->m_LifeSpan;
+	m_aRot[Id] = pPart->m_Rot;
+	m_aRotspeed[Id] = pPart->m_Rotspeed;
+	m_aGravity[Id] = pPart->m_Gravity;
+	m_aFriction[Id] = pPart->m_Friction;
+	m_aStartSize[Id] = pPart->m_StartSize;
+	m_aEndSize[Id] = pPart->m_EndSize;
+	m_aSpr[Id] = pPart->m_Spr;
+	m_aColor[Id] = pPart->m_Color;
+}
+
+int CParticleGroup::Update(CCollision *pCollision, float TimePassed, int FrictionCount)
+{
+	int Num = m_Num;
+	float *pPosX = m_aPosX.data();
+	float *pPosY = m_aPosY.data();
+	float *pVelX = m_aVelX.data();
+	float *pVelY = m_aVelY.data();
+	float *pLife = m_aLife.data();
+	float *pRot = m_aRot.data();
+	const float *pRotspeed = m_aRotspeed.data();
+	const float *pGravity = m_aGravity.data();
+	const float *pFriction = m_aFriction.data();
+
+	// the plain loops over the arrays can be vectorized by the compiler
+	for(int i = 0; i < Num; i++)
+	{
+		pVelY[i] += pGravity[i] * TimePassed;
+		pLife[i] += TimePassed;
+		pRot[i] += TimePassed * pRotspeed[i];
+	}
+
+	for(int f = 0; f < FrictionCount; f++) // apply friction
+	{
+		for(int i = 0; i < Num; i++)
+		{
+			pVelX[i] *= pFriction[i];
+			pVelY[i] *= pFriction[i];
+		}
+	}
+
+	// move the points, only the ones that end up in a solid tile need to
+	// bounce off
+	static int s_aCollide[MAX_PARTICLES];
+	int NumCollide = 0;
+	for(int i = 0; i < Num; i++)
+	{
+		if(pCollision->CheckPoint(pPosX[i] + pVelX[i] * TimePassed, pPosY[i] + pVelY[i] * TimePassed))
+			s_aCollide[NumCollide++] = i;
+		else
+		{
+			pPosX[i] += pVelX[i] * TimePassed;
+			pPosY[i] += pVelY[i] * TimePassed;
+		}
+	}
+	for(int c = 0; c < NumCollide; c++)
+	{
+		int i = s_aCollide[c];
+		vec2 Pos(pPosX[i], pPosY[i]);
+		vec2 Vel = vec2(pVelX[i], pVelY[i]) * TimePassed;
+		pCollision->MovePoint(&Pos, &Vel, 0.1f + 0.9f * random_float(), NULL);
+		pVelX[i] = Vel.x / TimePassed;
+		pVelY[i] = Vel.y / TimePassed;
+	}
+
+	// check particle death
+	int Alive = 0;
+	for(int i = 0; i < Num; i++)
+	{
+		if(pLife[i] > m_aLifeSpan[i])
+			continue;
+		if(Alive != i)
+			Move(i, Alive);
+		Alive++;
+	}
+	m_Num = Alive;
+	return Num - Alive;
+}
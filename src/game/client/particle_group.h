@@ -0,0 +1,89 @@
+#ifndef GAME_CLIENT_PARTICLE_GROUP_H
+#define GAME_CLIENT_PARTICLE_GROUP_H
+
+#include <base/color.h>
+#include <base/vmath.h>
+
+#include <vector>
+
+// particles
+struct CParticle
+{
+	void SetDefault()
+	{
+		m_Vel = vec2(0, 0);
+		m_LifeSpan = 0;
+		m_StartSize = 32;
+		m_EndSize = 32;
+		m_Rot = 0;
+		m_Rotspeed = 0;
+		m_Gravity = 0;
+		m_Friction = 0;
+		m_FlowAffected = 1.0f;
+		m_Color = ColorRGBA(1, 1, 1, 1);
+	}
+
+	vec2 m_Pos;
+	vec2 m_Vel;
+
+	int m_Spr;
+
+	float m_FlowAffected;
+
+	float m_LifeSpan;
+
+	float m_StartSize;
+	float m_EndSize;
+
+	float m_Rot;
+	float m_Rotspeed;
+
+	float m_Gravity;
+	float m_Friction;
+
+	ColorRGBA m_Color;
+};
+
+// The particles of a group as a structure of arrays, in the order they were
+// added. Dead particles are removed by moving the later ones down. The
+// arrays grow with the number of particles, so a group that is rarely busy
+// doesn't reserve room for the whole particle limit.
+class CParticleGroup
+{
+public:
+	enum
+	{
+		MAX_PARTICLES = 1024 * 8,
+	};
+
+	CParticleGroup();
+
+	// removes all particles and releases the arrays
+	void Clear();
+	// the caller is responsible for keeping below MAX_PARTICLES
+	void Add(const CParticle *pPart, float TimePassed);
+	// returns the number of particles that died
+	int Update(class CCollision *pCollision, float TimePassed, int FrictionCount);
+
+	int m_Num;
+	std::vector<float> m_aPosX;
+	std::vector<float> m_aPosY;
+	std::vector<float> m_aVelX;
+	std::vector<float> m_aVelY;
+	std::vector<float> m_aLife;
+	std::vector<float> m_aLifeSpan;
+	std::vector<float> m_aRot;
+	std::vector<float> m_aRotspeed;
+	std::vector<float> m_aGravity;
+	std::vector<float> m_aFriction;
+	std::vector<float> m_aStartSize;
+	std::vector<float> m_aEndSize;
+	std::vector<int> m_aSpr;
+	std::vector<ColorRGBA> m_aColor;
+
+private:
+	void Grow();
+	void Move(int From, int To);
+};
+
+#endif // GAME_CLIENT_PARTICLE_GROUP_H
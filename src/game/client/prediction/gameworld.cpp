@@ -25,6 +25,7 @@ CGameWorld::CGameWorld()
 	m_GameTick = 0;
 	m_pParent = 0;
 	m_pChild = 0;
+	m_IsValidCopy = false;
 }
 
 CGameWorld::~CGameWorld()
@@ -280,6 +281,7 @@ void CGameWorld::ReleaseHooked(int ClientID)
 			Core->m_HookState = HOOK_RETRACTED;
 		}
 	}
+	OnModified();
 }
 
 CTuningParams *CGameWorld::Tuning()
@@ -529,10 +531,16 @@ void CGameWorld::CopyWorld(CGameWorld *pFrom)
 	}
 	m_pTuningList = pFrom->m_pTuningList;
 	m_Teams = pFrom->m_Teams;
-	// delete the previous entities
-	for(auto &pFirstEntityType : m_apFirstEntityTypes)
-		while(pFirstEntityType)
-			delete pFirstEntityType;
+	// the entities of the child are copies of the ones about to be reused
+	OnModified();
+	// reuse the previous entities instead of reallocating them, the number
+	// of entities per type rarely changes from one copy to the next
+	CEntity *apReuse[NUM_ENTTYPES];
+	for(int Type = 0; Type < NUM_ENTTYPES; Type++)
+	{
+		apReuse[Type] = m_apFirstEntityTypes[Type];
+		m_apFirstEntityTypes[Type] = 0;
+	}
 	for(int i = 0; i < MAX_CLIENTS; i++)
 	{
 		m_apCharacters[i] = 0;
@@ -543,15 +551,18 @@ void CGameWorld::CopyWorld(CGameWorld *pFrom)
 	{
 		for(CEntity *pEnt = pFrom->FindLast(Type); pEnt; pEnt = pEnt->TypePrev())
 		{
+			CEntity *pReuse = apReuse[Type];
+			if(pReuse)
+				apReuse[Type] = pReuse->m_pNextTypeEntity;
 			CEntity *pCopy = 0;
 			if(Type == ENTTYPE_PROJECTILE)
-				pCopy = new CProjectile(*((CProjectile *)pEnt));
+				pCopy = pReuse ? &(*(CProjectile *)pReuse = *(CProjectile *)pEnt) : new CProjectile(*((CProjectile *)pEnt));
 			else if(Type == ENTTYPE_LASER)
-				pCopy = new CLaser(*((CLaser *)pEnt));
+				pCopy = pReuse ? &(*(CLaser *)pReuse = *(CLaser *)pEnt) : new CLaser(*((CLaser *)pEnt));
 			else if(Type == ENTTYPE_CHARACTER)
-				pCopy = new CCharacter(*((CCharacter *)pEnt));
+				pCopy = pReuse ? &(*(CCharacter *)pReuse = *(CCharacter *)pEnt) : new CCharacter(*((CCharacter *)pEnt));
 			else if(Type == ENTTYPE_PICKUP)
-				pCopy = new CPickup(*((CPickup *)pEnt));
+				pCopy = pReuse ? &(*(CPickup *)pReuse = *(CPickup *)pEnt) : new CPickup(*((CPickup *)pEnt));
 			if(pCopy)
 			{
 				pCopy->m_pParent = pEnt;
@@ -559,6 +570,18 @@ void CGameWorld::CopyWorld(CGameWorld *pFrom)
 			}
 		}
 	}
+	// delete the previous entities that weren't needed anymore
+	for(auto &pReuse : apReuse)
+	{
+		while(pReuse)
+		{
+			CEntity *pEnt = pReuse;
+			pReuse = pEnt->m_pNextTypeEntity;
+			pEnt->m_pNextTypeEntity = 0;
+			pEnt->m_pPrevTypeEntity = 0;
+			delete pEnt;
+		}
+	}
 	m_IsValidCopy = true;
 }
 
@@ -611,4 +634,5 @@ void CGameWorld::Clear()
 	for(auto &pFirstEntityType : m_apFirstEntityTypes)
 		while(pFirstEntityType)
 			delete pFirstEntityType;
+	OnModified();
 }
@@ -49,6 +49,9 @@ enum
 
 typedef void (*ENVELOPE_EVAL)(int TimeOffsetMillis, int Env, float *pChannels, void *pUser);
 
+// fills the vertices of a tile for the buffered tile layer rendering
+void FillTmpTile(SGraphicTile *pTmpTile, SGraphicTileTexureCoords *pTmpTex, bool As3DTextureCoord, unsigned char Flags, unsigned char Index, int x, int y, int Scale, CMapItemGroup *pGroup);
+
 class CRenderTools
 {
 	int m_TeeQuadContainerIndex;
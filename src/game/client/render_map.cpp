@@ -4,6 +4,8 @@
 #include <engine/graphics.h>
 #include <math.h>
 
+#include <algorithm>
+
 #include "render.h"
 
 #include <engine/shared/config.h>
@@ -38,38 +40,39 @@ void CRenderTools::RenderEvalEnvelope(CEnvPoint *pPoints, int NumPoints, int Cha
 		TimeMicros = 0;
 
 	int TimeMillis = (int)(TimeMicros / 1000ll);
-	for(int i = 0; i < NumPoints - 1; i++)
+	// the points are sorted by time, find the first one that ends at or
+	// after the time
+	const CEnvPoint *pEnd = std::lower_bound(pPoints + 1, pPoints + NumPoints, TimeMillis, [](const CEnvPoint &Point, int Time) { return Point.m_Time < Time; });
+	int i = pEnd - pPoints - 1;
+	if(pEnd != pPoints + NumPoints && TimeMillis >= pPoints[i].m_Time)
 	{
-		if(TimeMillis >= pPoints[i].m_Time && TimeMillis <= pPoints[i + 1].m_Time)
+		float Delta = pPoints[i + 1].m_Time - pPoints[i].m_Time;
+		float a = (float)(((double)TimeMicros / 1000.0) - pPoints[i].m_Time) / Delta;
+
+		if(pPoints[i].m_Curvetype == CURVETYPE_SMOOTH)
+			a = -2 * a * a * a + 3 * a * a; // second hermite basis
+		else if(pPoints[i].m_Curvetype == CURVETYPE_SLOW)
+			a = a * a * a;
+		else if(pPoints[i].m_Curvetype == CURVETYPE_FAST)
 		{
-			float Delta = pPoints[i + 1].m_Time - pPoints[i].m_Time;
-			float a = (float)(((double)TimeMicros / 1000.0) - pPoints[i].m_Time) / Delta;
-
-			if(pPoints[i].m_Curvetype == CURVETYPE_SMOOTH)
-				a = -2 * a * a * a + 3 * a * a; // second hermite basis
-			else if(pPoints[i].m_Curvetype == CURVETYPE_SLOW)
-				a = a * a * a;
-			else if(pPoints[i].m_Curvetype == CURVETYPE_FAST)
-			{
-				a = 1 - a;
-				a = 1 - a * a * a;
-			}
-			else if(pPoints[i].m_Curvetype == CURVETYPE_STEP)
-				a = 0;
-			else
-			{
-				// linear
-			}
-
-			for(int c = 0; c < Channels; c++)
-			{
-				float v0 = fx2f(pPoints[i].m_aValues[c]);
-				float v1 = fx2f(pPoints[i + 1].m_aValues[c]);
-				pResult[c] = v0 + (v1 - v0) * a;
-			}
+			a = 1 - a;
+			a = 1 - a * a * a;
+		}
+		else if(pPoints[i].m_Curvetype == CURVETYPE_STEP)
+			a = 0;
+		else
+		{
+			// linear
+		}
 
-			return;
+		for(int c = 0; c < Channels; c++)
+		{
+			float v0 = fx2f(pPoints[i].m_aValues[c]);
+			float v1 = fx2f(pPoints[i + 1].m_aValues[c]);
+			pResult[c] = v0 + (v1 - v0) * a;
 		}
+
+		return;
 	}
 
 	pResult[0] = fx2f(pPoints[NumPoints - 1].m_aValues[0]);
@@ -79,12 +82,12 @@ void CRenderTools::RenderEvalEnvelope(CEnvPoint *pPoints, int NumPoints, int Cha
 	return;
 }
 
-static void Rotate(CPoint *pCenter, CPoint *pPoint, float Rotation)
+static void Rotate(CPoint *pCenter, CPoint *pPoint, float Cos, float Sin)
 {
 	int x = pPoint->x - pCenter->x;
 	int y = pPoint->y - pCenter->y;
-	pPoint->x = (int)(x * cosf(Rotation) - y * sinf(Rotation) + pCenter->x);
-	pPoint->y = (int)(x * sinf(Rotation) + y * cosf(Rotation) + pCenter->y);
+	pPoint->x = (int)(x * Cos - y * Sin + pCenter->x);
+	pPoint->y = (int)(x * Sin + y * Cos + pCenter->y);
 }
 
 void CRenderTools::RenderQuads(CQuad *pQuads, int NumQuads, int RenderFlags, ENVELOPE_EVAL pfnEval, void *pUser)
@@ -166,10 +169,12 @@ void CRenderTools::ForceRenderQuads(CQuad *pQuads, int NumQuads, int RenderFlags
 			aRotated[3] = q->m_aPoints[3];
 			pPoints = aRotated;
 
-			Rotate(&q->m_aPoints[4], &aRotated[0], Rot);
-			Rotate(&q->m_aPoints[4], &aRotated[1], Rot);
-			Rotate(&q->m_aPoints[4], &aRotated[2], Rot);
-			Rotate(&q->m_aPoints[4], &aRotated[3], Rot);
+			float Cos = cosf(Rot);
+			float Sin = sinf(Rot);
+			Rotate(&q->m_aPoints[4], &aRotated[0], Cos, Sin);
+			Rotate(&q->m_aPoints[4], &aRotated[1], Cos, Sin);
+			Rotate(&q->m_aPoints[4], &aRotated[2], Cos, Sin);
+			Rotate(&q->m_aPoints[4], &aRotated[3], Cos, Sin);
 		}
 
 		IGraphics::CFreeformItem Freeform(
@@ -260,6 +265,84 @@ void CRenderTools::RenderTileRectangle(int RectX, int RectY, int RectW, int Rect
 	Graphics()->MapScreen(ScreenX0, ScreenY0, ScreenX1, ScreenY1);
 }
 
+void FillTmpTile(SGraphicTile *pTmpTile, SGraphicTileTexureCoords *pTmpTex, bool As3DTextureCoord, unsigned char Flags, unsigned char Index, int x, int y, int Scale, CMapItemGroup *pGroup)
+{
+	if(pTmpTex)
+	{
+		unsigned char x0 = 0;
+		unsigned char y0 = 0;
+		unsigned char x1 = x0 + 1;
+		unsigned char y1 = y0;
+		unsigned char x2 = x0 + 1;
+		unsigned char y2 = y0 + 1;
+		unsigned char x3 = x0;
+		unsigned char y3 = y0 + 1;
+
+		if(Flags & TILEFLAG_VFLIP)
+		{
+			x0 = x2;
+			x1 = x3;
+			x2 = x3;
+			x3 = x0;
+		}
+
+		if(Flags & TILEFLAG_HFLIP)
+		{
+			y0 = y3;
+			y2 = y1;
+			y3 = y1;
+			y1 = y0;
+		}
+
+		if(Flags & TILEFLAG_ROTATE)
+		{
+			unsigned char Tmp = x0;
+			x0 = x3;
+			x3 = x2;
+			x2 = x1;
+			x1 = Tmp;
+			Tmp = y0;
+			y0 = y3;
+			y3 = y2;
+			y2 = y1;
+			y1 = Tmp;
+		}
+
+		pTmpTex->m_TexCoordTopLeft.x = x0;
+		pTmpTex->m_TexCoordTopLeft.y = y0;
+		pTmpTex->m_TexCoordBottomLeft.x = x3;
+		pTmpTex->m_TexCoordBottomLeft.y = y3;
+		pTmpTex->m_TexCoordTopRight.x = x1;
+		pTmpTex->m_TexCoordTopRight.y = y1;
+		pTmpTex->m_TexCoordBottomRight.x = x2;
+		pTmpTex->m_TexCoordBottomRight.y = y2;
+
+		if(As3DTextureCoord)
+		{
+			pTmpTex->m_TexCoordTopLeft.z = ((float)Index + 0.5f) / 256.f;
+			pTmpTex->m_TexCoordBottomLeft.z = ((float)Index + 0.5f) / 256.f;
+			pTmpTex->m_TexCoordTopRight.z = ((float)Index + 0.5f) / 256.f;
+			pTmpTex->m_TexCoordBottomRight.z = ((float)Index + 0.5f) / 256.f;
+		}
+		else
+		{
+			pTmpTex->m_TexCoordTopLeft.z = Index;
+			pTmpTex->m_TexCoordBottomLeft.z = Index;
+			pTmpTex->m_TexCoordTopRight.z = Index;
+			pTmpTex->m_TexCoordBottomRight.z = Index;
+		}
+	}
+
+	pTmpTile->m_TopLeft.x = x * Scale;
+	pTmpTile->m_TopLeft.y = y * Scale;
+	pTmpTile->m_BottomLeft.x = x * Scale;
+	pTmpTile->m_BottomLeft.y = y * Scale + Scale;
+	pTmpTile->m_TopRight.x = x * Scale + Scale;
+	pTmpTile->m_TopRight.y = y * Scale;
+	pTmpTile->m_BottomRight.x = x * Scale + Scale;
+	pTmpTile->m_BottomRight.y = y * Scale + Scale;
+}
+
 void CRenderTools::RenderTilemap(CTile *pTiles, int w, int h, float Scale, ColorRGBA Color, int RenderFlags,
 	ENVELOPE_EVAL pfnEval, void *pUser, int ColorEnv, int ColorEnvOffset)
 {
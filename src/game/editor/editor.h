@@ -292,6 +292,7 @@ public:
 		m_Height = 0;
 		m_pData = 0;
 		m_Format = 0;
+		m_TextureArray = false;
 	}
 
 	~CEditorImage();
@@ -299,6 +300,9 @@ public:
 	void AnalyseTileFlags();
 
 	IGraphics::CTextureHandle m_Texture;
+	// loaded as 2D array or 3D texture, buffered tile layers can only be
+	// drawn from those
+	bool m_TextureArray;
 	int m_External;
 	char m_aName[128];
 	unsigned char m_aTileFlags[256];
@@ -587,6 +591,32 @@ public:
 	int m_Switch;
 	int m_Tune;
 	char m_aFileName[IO_MAX_PATH_LENGTH];
+
+private:
+	// with tile buffering the layer is drawn from one buffer per chunk of
+	// tiles, a chunk is rebuilt when it's visible and its tiles differ from
+	// the ones it was built from
+	enum
+	{
+		TILE_CHUNK_SIZE = 32,
+	};
+
+	struct CTileChunk
+	{
+		int m_BufferContainerIndex;
+		bool m_Valid;
+		CTile m_aTiles[TILE_CHUNK_SIZE * TILE_CHUNK_SIZE];
+		// number of drawn tiles in front of each tile
+		unsigned short m_aTileOffsets[TILE_CHUNK_SIZE * TILE_CHUNK_SIZE];
+	};
+
+	std::vector<CTileChunk *> m_vpChunks;
+	int m_ChunksWidth;
+	int m_ChunksHeight;
+
+	void ClearChunks();
+	void UpdateChunk(CTileChunk *pChunk, int ChunkX, int ChunkY);
+	void RenderBuffered(ColorRGBA Color);
 };
 
 class CLayerQuads : public CLayer
@@ -42,10 +42,14 @@ CLayerTiles::CLayerTiles(int w, int h)
 
 	m_pTiles = new CTile[m_Width * m_Height];
 	mem_zero(m_pTiles, (size_t)m_Width * m_Height * sizeof(CTile));
+
+	m_ChunksWidth = 0;
+	m_ChunksHeight = 0;
 }
 
 CLayerTiles::~CLayerTiles()
 {
+	ClearChunks();
 	delete[] m_pTiles;
 }
 
@@ -82,16 +86,30 @@ void CLayerTiles::MakePalette()
 
 void CLayerTiles::Render(bool Tileset)
 {
+	// the entity textures are always loaded as array textures, images only
+	// when their size is a multiple of 16
+	bool TextureArray = true;
 	if(m_Image >= 0 && m_Image < m_pEditor->m_Map.m_lImages.size())
+	{
 		m_Texture = m_pEditor->m_Map.m_lImages[m_Image]->m_Texture;
+		TextureArray = m_pEditor->m_Map.m_lImages[m_Image]->m_TextureArray;
+	}
 	Graphics()->TextureSet(m_Texture);
 	ColorRGBA Color = ColorRGBA(m_Color.r / 255.0f, m_Color.g / 255.0f, m_Color.b / 255.0f, m_Color.a / 255.0f);
-	Graphics()->BlendNone();
-	m_pEditor->RenderTools()->RenderTilemap(m_pTiles, m_Width, m_Height, 32.0f, Color, LAYERRENDERFLAG_OPAQUE,
-		m_pEditor->EnvelopeEval, m_pEditor, m_ColorEnv, m_ColorEnvOffset);
-	Graphics()->BlendNormal();
-	m_pEditor->RenderTools()->RenderTilemap(m_pTiles, m_Width, m_Height, 32.0f, Color, LAYERRENDERFLAG_TRANSPARENT,
-		m_pEditor->EnvelopeEval, m_pEditor, m_ColorEnv, m_ColorEnvOffset);
+	if(Graphics()->IsTileBufferingEnabled() && m_Texture.IsValid() && TextureArray)
+	{
+		Graphics()->BlendNormal();
+		RenderBuffered(Color);
+	}
+	else
+	{
+		Graphics()->BlendNone();
+		m_pEditor->RenderTools()->RenderTilemap(m_pTiles, m_Width, m_Height, 32.0f, Color, LAYERRENDERFLAG_OPAQUE,
+			m_pEditor->EnvelopeEval, m_pEditor, m_ColorEnv, m_ColorEnvOffset);
+		Graphics()->BlendNormal();
+		m_pEditor->RenderTools()->RenderTilemap(m_pTiles, m_Width, m_Height, 32.0f, Color, LAYERRENDERFLAG_TRANSPARENT,
+			m_pEditor->EnvelopeEval, m_pEditor, m_ColorEnv, m_ColorEnvOffset);
+	}
 
 	// Render DDRace Layers
 	if(!Tileset)
@@ -107,6 +125,175 @@ void CLayerTiles::Render(bool Tileset)
 	}
 }
 
+void CLayerTiles::ClearChunks()
+{
+	for(auto &pChunk : m_vpChunks)
+	{
+		if(pChunk && pChunk->m_BufferContainerIndex != -1)
+			Graphics()->DeleteBufferContainer(pChunk->m_BufferContainerIndex, true);
+		delete pChunk;
+	}
+	m_vpChunks.clear();
+	m_ChunksWidth = 0;
+	m_ChunksHeight = 0;
+}
+
+void CLayerTiles::UpdateChunk(CTileChunk *pChunk, int ChunkX, int ChunkY)
+{
+	int StartX = ChunkX * TILE_CHUNK_SIZE;
+	int StartY = ChunkY * TILE_CHUNK_SIZE;
+	int w = minimum((int)TILE_CHUNK_SIZE, m_Width - StartX);
+	int h = minimum((int)TILE_CHUNK_SIZE, m_Height - StartY);
+
+	bool Changed = !pChunk->m_Valid;
+	for(int y = 0; y < h && !Changed; y++)
+		Changed = mem_comp(&pChunk->m_aTiles[y * TILE_CHUNK_SIZE], &m_pTiles[(StartY + y) * m_Width + StartX], w * sizeof(CTile)) != 0;
+	if(!Changed)
+		return;
+
+	if(!pChunk->m_Valid)
+		mem_zero(pChunk->m_aTiles, sizeof(pChunk->m_aTiles));
+	for(int y = 0; y < h; y++)
+		mem_copy(&pChunk->m_aTiles[y * TILE_CHUNK_SIZE], &m_pTiles[(StartY + y) * m_Width + StartX], w * sizeof(CTile));
+	pChunk->m_Valid = true;
+
+	if(pChunk->m_BufferContainerIndex != -1)
+	{
+		Graphics()->DeleteBufferContainer(pChunk->m_BufferContainerIndex, true);
+		pChunk->m_BufferContainerIndex = -1;
+	}
+
+	static std::vector<SGraphicTile> s_Tiles;
+	static std::vector<SGraphicTileTexureCoords> s_TileTexCoords;
+	s_Tiles.clear();
+	s_TileTexCoords.clear();
+
+	bool As3DTextureCoords = !Graphics()->HasTextureArrays();
+	for(int i = 0; i < TILE_CHUNK_SIZE * TILE_CHUNK_SIZE; i++)
+	{
+		pChunk->m_aTileOffsets[i] = s_Tiles.size();
+		const CTile &Tile = pChunk->m_aTiles[i];
+		if(!Tile.m_Index)
+			continue;
+		s_Tiles.emplace_back();
+		s_TileTexCoords.emplace_back();
+		FillTmpTile(&s_Tiles.back(), &s_TileTexCoords.back(), As3DTextureCoords, Tile.m_Flags, Tile.m_Index, StartX + i % TILE_CHUNK_SIZE, StartY + i / TILE_CHUNK_SIZE, 32, 0);
+	}
+	if(s_Tiles.empty())
+		return;
+
+	// interleave the positions and texture coordinates of the vertices
+	size_t Stride = sizeof(vec2) + sizeof(vec3);
+	size_t UploadDataSize = s_Tiles.size() * 4 * Stride;
+	char *pUploadData = (char *)malloc(UploadDataSize);
+	for(size_t i = 0; i < s_Tiles.size() * 4; i++)
+	{
+		mem_copy(pUploadData + i * Stride, &((vec2 *)&s_Tiles[0])[i], sizeof(vec2));
+		mem_copy(pUploadData + i * Stride + sizeof(vec2), &((vec3 *)&s_TileTexCoords[0])[i], sizeof(vec3));
+	}
+	int BufferObjectIndex = Graphics()->CreateBufferObject(UploadDataSize, pUploadData, true);
+
+	SBufferContainerInfo ContainerInfo;
+	ContainerInfo.m_Stride = Stride;
+	ContainerInfo.m_Attributes.push_back(SBufferContainerInfo::SAttribute());
+	SBufferContainerInfo::SAttribute *pAttr = &ContainerInfo.m_Attributes.back();
+	pAttr->m_DataTypeCount = 2;
+	pAttr->m_Type = GRAPHICS_TYPE_FLOAT;
+	pAttr->m_Normalized = false;
+	pAttr->m_pOffset = 0;
+	pAttr->m_FuncType = 0;
+	pAttr->m_VertBufferBindingIndex = BufferObjectIndex;
+	ContainerInfo.m_Attributes.push_back(SBufferContainerInfo::SAttribute());
+	pAttr = &ContainerInfo.m_Attributes.back();
+	pAttr->m_DataTypeCount = 3;
+	pAttr->m_Type = GRAPHICS_TYPE_FLOAT;
+	pAttr->m_Normalized = false;
+	pAttr->m_pOffset = (void *)(sizeof(vec2));
+	pAttr->m_FuncType = 0;
+	pAttr->m_VertBufferBindingIndex = BufferObjectIndex;
+
+	pChunk->m_BufferContainerIndex = Graphics()->CreateBufferContainer(&ContainerInfo);
+	Graphics()->IndicesNumRequiredNotify(s_Tiles.size() * 6);
+}
+
+void CLayerTiles::RenderBuffered(ColorRGBA Color)
+{
+	if(m_ColorEnv >= 0)
+	{
+		float aChannels[4];
+		m_pEditor->EnvelopeEval(m_ColorEnvOffset, m_ColorEnv, aChannels, m_pEditor);
+		Color.r *= aChannels[0];
+		Color.g *= aChannels[1];
+		Color.b *= aChannels[2];
+		Color.a *= aChannels[3];
+	}
+
+	if(m_ChunksWidth != m_Width || m_ChunksHeight != m_Height)
+	{
+		ClearChunks();
+		m_ChunksWidth = m_Width;
+		m_ChunksHeight = m_Height;
+	}
+	int NumChunksX = (m_Width + TILE_CHUNK_SIZE - 1) / TILE_CHUNK_SIZE;
+	int NumChunksY = (m_Height + TILE_CHUNK_SIZE - 1) / TILE_CHUNK_SIZE;
+	m_vpChunks.resize(NumChunksX * NumChunksY, nullptr);
+
+	float ScreenX0, ScreenY0, ScreenX1, ScreenY1;
+	Graphics()->GetScreen(&ScreenX0, &ScreenY0, &ScreenX1, &ScreenY1);
+	int X0 = maximum((int)floorf(ScreenX0 / 32.0f), 0);
+	int Y0 = maximum((int)floorf(ScreenY0 / 32.0f), 0);
+	int X1 = minimum((int)floorf(ScreenX1 / 32.0f), m_Width - 1);
+	int Y1 = minimum((int)floorf(ScreenY1 / 32.0f), m_Height - 1);
+
+	static std::vector<char *> s_IndexOffsets;
+	static std::vector<unsigned int> s_DrawCounts;
+
+	for(int ChunkY = Y0 / TILE_CHUNK_SIZE; Y0 <= Y1 && ChunkY <= Y1 / TILE_CHUNK_SIZE; ChunkY++)
+	{
+		for(int ChunkX = X0 / TILE_CHUNK_SIZE; X0 <= X1 && ChunkX <= X1 / TILE_CHUNK_SIZE; ChunkX++)
+		{
+			CTileChunk *&pChunk = m_vpChunks[ChunkY * NumChunksX + ChunkX];
+			if(!pChunk)
+			{
+				pChunk = new CTileChunk;
+				pChunk->m_BufferContainerIndex = -1;
+				pChunk->m_Valid = false;
+			}
+			UpdateChunk(pChunk, ChunkX, ChunkY);
+			if(pChunk->m_BufferContainerIndex == -1)
+				continue;
+
+			int StartX = maximum(X0 - ChunkX * TILE_CHUNK_SIZE, 0);
+			int EndX = minimum(X1 - ChunkX * TILE_CHUNK_SIZE, TILE_CHUNK_SIZE - 1);
+			int StartY = maximum(Y0 - ChunkY * TILE_CHUNK_SIZE, 0);
+			int EndY = minimum(Y1 - ChunkY * TILE_CHUNK_SIZE, TILE_CHUNK_SIZE - 1);
+
+			// one range of indices per row, joined if the rows are adjacent
+			s_IndexOffsets.clear();
+			s_DrawCounts.clear();
+			unsigned int LastEnd = 0;
+			for(int y = StartY; y <= EndY; y++)
+			{
+				unsigned int Start = pChunk->m_aTileOffsets[y * TILE_CHUNK_SIZE + StartX];
+				unsigned int End = pChunk->m_aTileOffsets[y * TILE_CHUNK_SIZE + EndX] + (pChunk->m_aTiles[y * TILE_CHUNK_SIZE + EndX].m_Index ? 1 : 0);
+				if(Start == End)
+					continue;
+				if(!s_DrawCounts.empty() && Start == LastEnd)
+					s_DrawCounts.back() += (End - Start) * 6;
+				else
+				{
+					s_IndexOffsets.push_back((char *)(uintptr_t)(Start * 6 * sizeof(unsigned int)));
+					s_DrawCounts.push_back((End - Start) * 6);
+				}
+				LastEnd = End;
+			}
+
+			if(!s_IndexOffsets.empty())
+				Graphics()->RenderTileLayer(pChunk->m_BufferContainerIndex, (float *)&Color, &s_IndexOffsets[0], &s_DrawCounts[0], s_IndexOffsets.size());
+		}
+	}
+}
+
 int CLayerTiles::ConvertX(float x) const { return (int)(x / 32.0f); }
 int CLayerTiles::ConvertY(float y) const { return (int)(y / 32.0f); }
 
@@ -38,6 +38,31 @@ void CPrng::Seed(uint64_t aSeed[2])
 	RandomBits();
 }
 
+bool CPrng::Seed(const char *pDescription)
+{
+	const char *pSeed = str_startswith(pDescription, NAME ":");
+	if(!pSeed || str_length(pSeed) != 33 || pSeed[16] != ':')
+	{
+		return false;
+	}
+	uint64_t aSeed[2] = {0, 0};
+	for(int i = 0; i < 33; i++)
+	{
+		if(i == 16)
+		{
+			continue;
+		}
+		int Digit = pSeed[i] >= '0' && pSeed[i] <= '9' ? pSeed[i] - '0' : pSeed[i] >= 'a' && pSeed[i] <= 'f' ? pSeed[i] - 'a' + 10 : -1;
+		if(Digit < 0)
+		{
+			return false;
+		}
+		aSeed[i / 17] = (aSeed[i / 17] << 4) | Digit;
+	}
+	Seed(aSeed);
+	return true;
+}
+
 unsigned int CPrng::RandomBits()
 {
 	dbg_assert(m_Seeded, "prng needs to be seeded before it can generate random numbers");
@@ -6,12 +6,20 @@
 #include "gamecontext.h"
 #include "player.h"
 
+#include <algorithm>
+#include <climits>
+
 //////////////////////////////////////////////////
 // Event handler
 //////////////////////////////////////////////////
 CEventHandler::CEventHandler()
 {
 	m_pGameServer = 0;
+	m_vEvents.reserve(128);
+	m_vData.reserve(128 * 64);
+	m_NumDropped = 0;
+	m_NumOverflows = 0;
+	m_LastWarning = 0;
 	Clear();
 }
 
@@ -22,48 +30,128 @@ void CEventHandler::SetGameServer(CGameContext *pGameServer)
 
 void *CEventHandler::Create(int Type, int Size, int64_t Mask)
 {
-	if(m_NumEvents == MAX_EVENTS)
-		return 0;
-	if(m_CurrentOffset + Size >= MAX_DATASIZE)
+	if((int)m_vEvents.size() == MAX_EVENTS)
+	{
+		m_NumDroppedTick++;
 		return 0;
+	}
 
-	void *p = &m_aData[m_CurrentOffset];
-	m_aOffsets[m_NumEvents] = m_CurrentOffset;
-	m_aTypes[m_NumEvents] = Type;
-	m_aSizes[m_NumEvents] = Size;
-	m_aClientMasks[m_NumEvents] = Mask;
-	m_CurrentOffset += Size;
-	m_NumEvents++;
-	return p;
+	CEvent Event;
+	Event.m_Type = Type;
+	Event.m_Offset = m_vData.size();
+	Event.m_Size = Size;
+	Event.m_ClientMask = Mask;
+	m_vEvents.push_back(Event);
+	// the returned pointer is only valid until the next event is created
+	m_vData.resize(m_vData.size() + Size);
+	m_CellsValid = false;
+	return &m_vData[Event.m_Offset];
 }
 
 void CEventHandler::Clear()
 {
-	m_NumEvents = 0;
-	m_CurrentOffset = 0;
+	if(m_NumDroppedTick || m_NumOverflowsTick)
+	{
+		m_NumDropped += m_NumDroppedTick;
+		m_NumOverflows += m_NumOverflowsTick;
+		if(!m_LastWarning || time_get() - m_LastWarning > time_freq() * 10)
+		{
+			m_LastWarning = time_get();
+			dbg_msg("events", "%d events dropped, %d snapshot overflows this tick (%lld dropped, %lld overflows in total)",
+				m_NumDroppedTick, m_NumOverflowsTick, (long long)m_NumDropped, (long long)m_NumOverflows);
+		}
+	}
+
+	m_vEvents.clear();
+	m_vData.clear();
+	m_vCells.clear();
+	m_CellsValid = true;
+	m_NumDroppedTick = 0;
+	m_NumOverflowsTick = 0;
+}
+
+int CEventHandler::Cell(float Coord)
+{
+	return (int)floorf(clamp(Coord, -1e9f, 1e9f) / (1 << CELL_SHIFT));
+}
+
+void CEventHandler::BuildCells()
+{
+	m_vCells.resize(m_vEvents.size());
+	for(int i = 0; i < (int)m_vEvents.size(); i++)
+	{
+		const CNetEvent_Common *pEvent = (const CNetEvent_Common *)&m_vData[m_vEvents[i].m_Offset];
+		m_vCells[i].m_CellX = Cell(pEvent->m_X);
+		m_vCells[i].m_CellY = Cell(pEvent->m_Y);
+		m_vCells[i].m_Event = i;
+	}
+	std::sort(m_vCells.begin(), m_vCells.end());
+	m_CellsValid = true;
+}
+
+void CEventHandler::SnapEvent(int SnappingClient, int Index)
+{
+	int Type = m_vEvents[Index].m_Type;
+	int Size = m_vEvents[Index].m_Size;
+	const char *pData = &m_vData[m_vEvents[Index].m_Offset];
+	if(SnappingClient != -1 && GameServer()->Server()->IsSixup(SnappingClient))
+		EventToSixup(&Type, &Size, &pData);
+
+	void *pItem = GameServer()->Server()->SnapNewItem(Type, Index, Size);
+	if(pItem)
+		mem_copy(pItem, pData, Size);
+	else
+		m_NumOverflowsTick++;
 }
 
 void CEventHandler::Snap(int SnappingClient)
 {
-	for(int i = 0; i < m_NumEvents; i++)
+	if(m_vEvents.empty())
+		return;
+
+	if(SnappingClient == -1 || GameServer()->m_apPlayers[SnappingClient]->m_ShowAll)
 	{
-		if(SnappingClient == -1 || CmaskIsSet(m_aClientMasks[i], SnappingClient))
+		for(int i = 0; i < (int)m_vEvents.size(); i++)
+			if(SnappingClient == -1 || CmaskIsSet(m_vEvents[i].m_ClientMask, SnappingClient))
+				SnapEvent(SnappingClient, i);
+		return;
+	}
+
+	if(!m_CellsValid)
+		BuildCells();
+
+	// only visit the cells in view of the client, restricted to the rows
+	// that contain events
+	const CPlayer *pPlayer = GameServer()->m_apPlayers[SnappingClient];
+	int MinX = Cell(pPlayer->m_ViewPos.x - pPlayer->m_ShowDistance.x);
+	int MaxX = Cell(pPlayer->m_ViewPos.x + pPlayer->m_ShowDistance.x);
+	int MinY = maximum(Cell(pPlayer->m_ViewPos.y - pPlayer->m_ShowDistance.y), m_vCells.front().m_CellY);
+	int MaxY = minimum(Cell(pPlayer->m_ViewPos.y + pPlayer->m_ShowDistance.y), m_vCells.back().m_CellY);
+
+	m_vVisible.clear();
+	std::vector<CCellEntry>::const_iterator it = m_vCells.begin();
+	for(int y = MinY; y <= MaxY && it != m_vCells.end(); y++)
+	{
+		CCellEntry First = {y, MinX, -1};
+		it = std::lower_bound(it, m_vCells.cend(), First);
+		for(; it != m_vCells.end() && it->m_CellY == y && it->m_CellX <= MaxX; ++it)
 		{
-			CNetEvent_Common *ev = (CNetEvent_Common *)&m_aData[m_aOffsets[i]];
-			if(!NetworkClipped(GameServer(), SnappingClient, vec2(ev->m_X, ev->m_Y)))
-			{
-				int Type = m_aTypes[i];
-				int Size = m_aSizes[i];
-				const char *Data = &m_aData[m_aOffsets[i]];
-				if(GameServer()->Server()->IsSixup(SnappingClient))
-					EventToSixup(&Type, &Size, &Data);
-
-				void *d = GameServer()->Server()->SnapNewItem(Type, i, Size);
-				if(d)
-					mem_copy(d, Data, Size);
-			}
+			const CEvent &Event = m_vEvents[it->m_Event];
+			const CNetEvent_Common *pEvent = (const CNetEvent_Common *)&m_vData[Event.m_Offset];
+			if(CmaskIsSet(Event.m_ClientMask, SnappingClient) && !NetworkClipped(GameServer(), SnappingClient, vec2(pEvent->m_X, pEvent->m_Y)))
+				m_vVisible.push_back(it->m_Event);
 		}
+		// jump to the next row with events
+		if(it != m_vCells.end() && it->m_CellY == y)
+			it = std::lower_bound(it, m_vCells.cend(), CCellEntry{y + 1, INT_MIN, -1});
+		if(it != m_vCells.end())
+			y = maximum(y, it->m_CellY - 1);
 	}
+
+	// keep the creation order like before
+	std::sort(m_vVisible.begin(), m_vVisible.end());
+	for(int Index : m_vVisible)
+		SnapEvent(SnappingClient, Index);
 }
 
 void CEventHandler::EventToSixup(int *Type, int *Size, const char **pData)
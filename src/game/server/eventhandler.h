@@ -6,21 +6,58 @@
 #include <base/system.h>
 #include <base/vmath.h>
 
+#include <vector>
+
 class CEventHandler
 {
-	static const int MAX_EVENTS = 128;
-	static const int MAX_DATASIZE = 128 * 64;
+	// upper bound so a broken entity can't exhaust memory, see NumDropped()
+	static const int MAX_EVENTS = 16384;
+	// events are bucketed into cells of 32x32 tiles for culling
+	static const int CELL_SHIFT = 10;
+
+	struct CEvent
+	{
+		int m_Type;
+		int m_Offset;
+		int m_Size;
+		int64_t m_ClientMask;
+	};
+
+	struct CCellEntry
+	{
+		int m_CellY;
+		int m_CellX;
+		int m_Event;
+
+		bool operator<(const CCellEntry &Other) const
+		{
+			if(m_CellY != Other.m_CellY)
+				return m_CellY < Other.m_CellY;
+			if(m_CellX != Other.m_CellX)
+				return m_CellX < Other.m_CellX;
+			return m_Event < Other.m_Event;
+		}
+	};
 
-	int m_aTypes[MAX_EVENTS]; // TODO: remove some of these arrays
-	int m_aOffsets[MAX_EVENTS];
-	int m_aSizes[MAX_EVENTS];
-	int64_t m_aClientMasks[MAX_EVENTS];
-	char m_aData[MAX_DATASIZE];
+	std::vector<CEvent> m_vEvents;
+	std::vector<char> m_vData;
+
+	// events sorted by cell, built on the first snap after events were created
+	std::vector<CCellEntry> m_vCells;
+	bool m_CellsValid;
+	std::vector<int> m_vVisible;
 
 	class CGameContext *m_pGameServer;
 
-	int m_CurrentOffset;
-	int m_NumEvents;
+	int m_NumDroppedTick;
+	int m_NumOverflowsTick;
+	int64_t m_NumDropped;
+	int64_t m_NumOverflows;
+	int64_t m_LastWarning;
+
+	static int Cell(float Coord);
+	void BuildCells();
+	void SnapEvent(int SnappingClient, int Index);
 
 public:
 	CGameContext *GameServer() const { return m_pGameServer; }
@@ -32,6 +69,12 @@ public:
 	void Snap(int SnappingClient);
 
 	void EventToSixup(int *Type, int *Size, const char **Data);
+
+	int NumEvents() const { return m_vEvents.size(); }
+	// events that weren't created because there were too many in one tick
+	int64_t NumDropped() const { return m_NumDropped; }
+	// events that didn't fit into a client's snapshot anymore
+	int64_t NumOverflows() const { return m_NumOverflows; }
 };
 
 #endif
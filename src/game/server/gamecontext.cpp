@@ -13,7 +13,7 @@
 #include <engine/shared/config.h>
 #include <engine/shared/datafile.h>
 #include <engine/shared/linereader.h>
-#include <engine/shared/memheap.h>
+#include <engine/shared/profiler.h>
 #include <engine/storage.h>
 #include <game/collision.h>
 #include <game/gamecore.h>
@@ -46,9 +46,6 @@ void CGameContext::Construct(int Resetting)
 	m_aVoteCommand[0] = 0;
 	m_VoteType = VOTE_TYPE_UNKNOWN;
 	m_VoteCloseTime = 0;
-	m_pVoteOptionFirst = 0;
-	m_pVoteOptionLast = 0;
-	m_NumVoteOptions = 0;
 	m_LastMapVote = 0;
 
 	m_SqlRandomMapResult = nullptr;
@@ -58,7 +55,7 @@ void CGameContext::Construct(int Resetting)
 	m_NumVoteMutes = 0;
 
 	if(Resetting == NO_RESET)
-		m_pVoteOptionHeap = new CHeap();
+		m_pVoteOptions = new CVoteOptions();
 
 	m_ChatResponseTargetID = -1;
 	m_aDeleteTempfile[0] = 0;
@@ -71,7 +68,7 @@ void CGameContext::Destruct(int Resetting)
 		delete pPlayer;
 
 	if(Resetting == NO_RESET)
-		delete m_pVoteOptionHeap;
+		delete m_pVoteOptions;
 
 	if(m_pScore)
 	{
@@ -97,20 +94,14 @@ CGameContext::~CGameContext()
 
 void CGameContext::Clear()
 {
-	CHeap *pVoteOptionHeap = m_pVoteOptionHeap;
-	CVoteOptionServer *pVoteOptionFirst = m_pVoteOptionFirst;
-	CVoteOptionServer *pVoteOptionLast = m_pVoteOptionLast;
-	int NumVoteOptions = m_NumVoteOptions;
+	CVoteOptions *pVoteOptions = m_pVoteOptions;
 	CTuningParams Tuning = m_Tuning;
 
 	m_Resetting = true;
 	this->~CGameContext();
 	new(this) CGameContext(RESET);
 
-	m_pVoteOptionHeap = pVoteOptionHeap;
-	m_pVoteOptionFirst = pVoteOptionFirst;
-	m_pVoteOptionLast = pVoteOptionLast;
-	m_NumVoteOptions = NumVoteOptions;
+	m_pVoteOptions = pVoteOptions;
 	m_Tuning = Tuning;
 }
 
@@ -183,6 +174,21 @@ void CGameContext::FillAntibot(CAntibotRoundData *pData)
 	}
 }
 
+bool CGameContext::SeedPrng(const char *pDescription)
+{
+	return m_Prng.Seed(pDescription);
+}
+
+bool CGameContext::CharacterCore(int ClientID, CNetObj_CharacterCore *pCore, int *pSpawnTick)
+{
+	CCharacter *pChr = GetPlayerChar(ClientID);
+	if(!pChr)
+		return false;
+	pChr->GetCore().Write(pCore);
+	*pSpawnTick = pChr->m_SpawnTick;
+	return true;
+}
+
 void CGameContext::CreateDamageInd(vec2 Pos, float Angle, int Amount, int64_t Mask)
 {
 	float a = 3 * 3.14159f / 2 + Angle;
@@ -800,10 +806,16 @@ void CGameContext::OnTick()
 
 	// copy tuning
 	m_World.m_Core.m_Tuning[0] = m_Tuning;
-	m_World.Tick();
+	{
+		CProfileScope Scope(Profiler(), m_aProfileZones[PROFILE_WORLD]);
+		m_World.Tick();
+	}
 
 	//if(world.paused) // make sure that the game object always updates
-	m_pController->Tick();
+	{
+		CProfileScope Scope(Profiler(), m_aProfileZones[PROFILE_CONTROLLER]);
+		m_pController->Tick();
+	}
 
 	if(m_TeeHistorianActive)
 	{
@@ -824,27 +836,32 @@ void CGameContext::OnTick()
 		m_TeeHistorian.BeginInputs();
 	}
 
-	for(int i = 0; i < MAX_CLIENTS; i++)
 	{
-		if(m_apPlayers[i])
+		CProfileScope Scope(Profiler(), m_aProfileZones[PROFILE_PLAYERS]);
+		for(int i = 0; i < MAX_CLIENTS; i++)
 		{
-			// send vote options
-			ProgressVoteOptions(i);
+			if(m_apPlayers[i])
+			{
+				// send vote options
+				ProgressVoteOptions(i);
 
-			m_apPlayers[i]->Tick();
-			m_apPlayers[i]->PostTick();
+				m_apPlayers[i]->Tick();
+				m_apPlayers[i]->PostTick();
+			}
 		}
-	}
 
-	for(auto &pPlayer : m_apPlayers)
-	{
-		if(pPlayer)
-			pPlayer->PostPostTick();
+		for(auto &pPlayer : m_apPlayers)
+		{
+			if(pPlayer)
+				pPlayer->PostPostTick();
+		}
 	}
 
 	// update voting
 	if(m_VoteCloseTime)
 	{
+		CProfileScope Scope(Profiler(), m_aProfileZones[PROFILE_VOTES]);
+
 		// abort the kick-vote on player-leave
 		if(m_VoteEnforce == VOTE_ENFORCE_ABORT)
 		{
@@ -1061,6 +1078,7 @@ void CGameContext::OnTick()
 
 	if(m_SqlRandomMapResult != nullptr && m_SqlRandomMapResult->m_Completed)
 	{
+		CProfileScope Scope(Profiler(), m_aProfileZones[PROFILE_SCORE]);
 		if(m_SqlRandomMapResult->m_Success)
 		{
 			if(PlayerExists(m_SqlRandomMapResult->m_ClientID) && m_SqlRandomMapResult->m_aMessage[0] != '\0')
@@ -1116,19 +1134,6 @@ void CGameContext::OnClientPredictedEarlyInput(int ClientID, void *pInput)
 	}
 }
 
-struct CVoteOptionServer *CGameContext::GetVoteOption(int Index)
-{
-	CVoteOptionServer *pCurrent;
-	for(pCurrent = m_pVoteOptionFirst;
-		Index > 0 && pCurrent;
-		Index--, pCurrent = pCurrent->m_pNext)
-		;
-
-	if(Index > 0)
-		return 0;
-	return pCurrent;
-}
-
 void CGameContext::ProgressVoteOptions(int ClientID)
 {
 	CPlayer *pPl = m_apPlayers[ClientID];
@@ -1136,75 +1141,29 @@ void CGameContext::ProgressVoteOptions(int ClientID)
 	if(pPl->m_SendVoteIndex == -1)
 		return; // we didn't start sending options yet
 
-	if(pPl->m_SendVoteIndex > m_NumVoteOptions)
-		return; // shouldn't happen / fail silently
-
-	int VotesLeft = m_NumVoteOptions - pPl->m_SendVoteIndex;
-	int NumVotesToSend = minimum(g_Config.m_SvSendVotesPerTick, VotesLeft);
+	if(pPl->m_SendVoteIndex >= m_pVoteOptions->Num())
+		return; // player has up to date vote option list
 
-	if(!VotesLeft)
-	{
-		// player has up to date vote option list
+	const unsigned char *pData;
+	int Size;
+	int NumVotesToSend = m_pVoteOptions->Pack(pPl->m_SendVoteIndex, g_Config.m_SvSendVotesPerTick, &pData, &Size);
+	if(!NumVotesToSend)
 		return;
-	}
 
-	// build vote option list msg
-	int CurIndex = 0;
-
-	CNetMsg_Sv_VoteOptionListAdd OptionMsg;
-	OptionMsg.m_pDescription0 = "";
-	OptionMsg.m_pDescription1 = "";
-	OptionMsg.m_pDescription2 = "";
-	OptionMsg.m_pDescription3 = "";
-	OptionMsg.m_pDescription4 = "";
-	OptionMsg.m_pDescription5 = "";
-	OptionMsg.m_pDescription6 = "";
-	OptionMsg.m_pDescription7 = "";
-	OptionMsg.m_pDescription8 = "";
-	OptionMsg.m_pDescription9 = "";
-	OptionMsg.m_pDescription10 = "";
-	OptionMsg.m_pDescription11 = "";
-	OptionMsg.m_pDescription12 = "";
-	OptionMsg.m_pDescription13 = "";
-	OptionMsg.m_pDescription14 = "";
-
-	// get current vote option by index
-	CVoteOptionServer *pCurrent = GetVoteOption(pPl->m_SendVoteIndex);
-
-	while(CurIndex < NumVotesToSend && pCurrent != NULL)
-	{
-		switch(CurIndex)
-		{
-		case 0: OptionMsg.m_pDescription0 = pCurrent->m_aDescription; break;
-		case 1: OptionMsg.m_pDescription1 = pCurrent->m_aDescription; break;
-		case 2: OptionMsg.m_pDescription2 = pCurrent->m_aDescription; break;
-		case 3: OptionMsg.m_pDescription3 = pCurrent->m_aDescription; break;
-		case 4: OptionMsg.m_pDescription4 = pCurrent->m_aDescription; break;
-		case 5: OptionMsg.m_pDescription5 = pCurrent->m_aDescription; break;
-		case 6: OptionMsg.m_pDescription6 = pCurrent->m_aDescription; break;
-		case 7: OptionMsg.m_pDescription7 = pCurrent->m_aDescription; break;
-		case 8: OptionMsg.m_pDescription8 = pCurrent->m_aDescription; break;
-		case 9: OptionMsg.m_pDescription9 = pCurrent->m_aDescription; break;
-		case 10: OptionMsg.m_pDescription10 = pCurrent->m_aDescription; break;
-		case 11: OptionMsg.m_pDescription11 = pCurrent->m_aDescription; break;
-		case 12: OptionMsg.m_pDescription12 = pCurrent->m_aDescription; break;
-		case 13: OptionMsg.m_pDescription13 = pCurrent->m_aDescription; break;
-		case 14: OptionMsg.m_pDescription14 = pCurrent->m_aDescription; break;
-		}
-
-		CurIndex++;
-		pCurrent = pCurrent->m_pNext;
-	}
-
-	// send msg
-	OptionMsg.m_NumOptions = NumVotesToSend;
-	Server()->SendPackMsg(&OptionMsg, MSGFLAG_VITAL, ClientID);
+	CMsgPacker Msg(NETMSGTYPE_SV_VOTEOPTIONLISTADD, false);
+	Msg.AddRaw(pData, Size);
+	Server()->SendMsg(&Msg, MSGFLAG_VITAL, ClientID);
 
 	pPl->m_SendVoteIndex += NumVotesToSend;
 }
 
 void CGameContext::OnClientEnter(int ClientID)
 {
+	if(m_TeeHistorianActive)
+	{
+		m_TeeHistorian.RecordPlayerReady(ClientID);
+	}
+
 	m_pController->OnPlayerConnect(m_apPlayers[ClientID]);
 
 	if(Server()->IsSixup(ClientID))
@@ -1856,40 +1815,34 @@ void CGameContext::OnMessage(int MsgID, CUnpacker *pUnpacker, int ClientID)
 			if(str_comp_nocase(pMsg->m_Type, "option") == 0)
 			{
 				int Authed = Server()->GetAuthedState(ClientID);
-				CVoteOptionServer *pOption = m_pVoteOptionFirst;
-				while(pOption)
+				const CVoteOptionServer *pOption = m_pVoteOptions->Find(pMsg->m_Value);
+				if(pOption)
 				{
-					if(str_comp_nocase(pMsg->m_Value, pOption->m_aDescription) == 0)
+					if(!Console()->LineIsValid(pOption->m_aCommand))
 					{
-						if(!Console()->LineIsValid(pOption->m_aCommand))
-						{
-							SendChatTarget(ClientID, "Invalid option");
-							return;
-						}
-						if((str_find(pOption->m_aCommand, "sv_map ") != 0 || str_find(pOption->m_aCommand, "change_map ") != 0 || str_find(pOption->m_aCommand, "random_map") != 0 || str_find(pOption->m_aCommand, "random_unfinished_map") != 0) && RateLimitPlayerMapVote(ClientID))
-						{
-							return;
-						}
-
-						str_format(aChatmsg, sizeof(aChatmsg), "'%s' called vote to change server option '%s' (%s)", Server()->ClientName(ClientID),
-							pOption->m_aDescription, aReason);
-						str_format(aDesc, sizeof(aDesc), "%s", pOption->m_aDescription);
+						SendChatTarget(ClientID, "Invalid option");
+						return;
+					}
+					if((str_find(pOption->m_aCommand, "sv_map ") != 0 || str_find(pOption->m_aCommand, "change_map ") != 0 || str_find(pOption->m_aCommand, "random_map") != 0 || str_find(pOption->m_aCommand, "random_unfinished_map") != 0) && RateLimitPlayerMapVote(ClientID))
+					{
+						return;
+					}
 
-						if((str_endswith(pOption->m_aCommand, "random_map") || str_endswith(pOption->m_aCommand, "random_unfinished_map")) && str_length(aReason) == 1 && aReason[0] >= '0' && aReason[0] <= '5')
-						{
-							int Stars = aReason[0] - '0';
-							str_format(aCmd, sizeof(aCmd), "%s %d", pOption->m_aCommand, Stars);
-						}
-						else
-						{
-							str_format(aCmd, sizeof(aCmd), "%s", pOption->m_aCommand);
-						}
+					str_format(aChatmsg, sizeof(aChatmsg), "'%s' called vote to change server option '%s' (%s)", Server()->ClientName(ClientID),
+						pOption->m_aDescription, aReason);
+					str_format(aDesc, sizeof(aDesc), "%s", pOption->m_aDescription);
 
-						m_LastMapVote = time_get();
-						break;
+					if((str_endswith(pOption->m_aCommand, "random_map") || str_endswith(pOption->m_aCommand, "random_unfinished_map")) && str_length(aReason) == 1 && aReason[0] >= '0' && aReason[0] <= '5')
+					{
+						int Stars = aReason[0] - '0';
+						str_format(aCmd, sizeof(aCmd), "%s %d", pOption->m_aCommand, Stars);
+					}
+					else
+					{
+						str_format(aCmd, sizeof(aCmd), "%s", pOption->m_aCommand);
 					}
 
-					pOption = pOption->m_pNext;
+					m_LastMapVote = time_get();
 				}
 
 				if(!pOption)
@@ -2761,7 +2714,7 @@ void CGameContext::ConAddVote(IConsole::IResult *pResult, void *pUserData)
 
 void CGameContext::AddVote(const char *pDescription, const char *pCommand)
 {
-	if(m_NumVoteOptions == MAX_VOTE_OPTIONS)
+	if(m_pVoteOptions->Num() == MAX_VOTE_OPTIONS)
 	{
 		Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "server", "maximum number of vote options reached");
 		return;
@@ -2785,35 +2738,13 @@ void CGameContext::AddVote(const char *pDescription, const char *pCommand)
 		return;
 	}
 
-	// check for duplicate entry
-	CVoteOptionServer *pOption = m_pVoteOptionFirst;
-	while(pOption)
+	// add the option, unless it's a duplicate
+	if(!m_pVoteOptions->Add(pDescription, pCommand))
 	{
-		if(str_comp_nocase(pDescription, pOption->m_aDescription) == 0)
-		{
-			char aBuf[256];
-			str_format(aBuf, sizeof(aBuf), "option '%s' already exists", pDescription);
-			Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "server", aBuf);
-			return;
-		}
-		pOption = pOption->m_pNext;
+		char aBuf[256];
+		str_format(aBuf, sizeof(aBuf), "option '%s' already exists", pDescription);
+		Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "server", aBuf);
 	}
-
-	// add the option
-	++m_NumVoteOptions;
-	int Len = str_length(pCommand);
-
-	pOption = (CVoteOptionServer *)m_pVoteOptionHeap->Allocate(sizeof(CVoteOptionServer) + Len, alignof(CVoteOptionServer));
-	pOption->m_pNext = 0;
-	pOption->m_pPrev = m_pVoteOptionLast;
-	if(pOption->m_pPrev)
-		pOption->m_pPrev->m_pNext = pOption;
-	m_pVoteOptionLast = pOption;
-	if(!m_pVoteOptionFirst)
-		m_pVoteOptionFirst = pOption;
-
-	str_copy(pOption->m_aDescription, pDescription, sizeof(pOption->m_aDescription));
-	mem_copy(pOption->m_aCommand, pCommand, Len + 1);
 }
 
 void CGameContext::ConRemoveVote(IConsole::IResult *pResult, void *pUserData)
@@ -2821,15 +2752,8 @@ void CGameContext::ConRemoveVote(IConsole::IResult *pResult, void *pUserData)
 	CGameContext *pSelf = (CGameContext *)pUserData;
 	const char *pDescription = pResult->GetString(0);
 
-	// check for valid option
-	CVoteOptionServer *pOption = pSelf->m_pVoteOptionFirst;
-	while(pOption)
-	{
-		if(str_comp_nocase(pDescription, pOption->m_aDescription) == 0)
-			break;
-		pOption = pOption->m_pNext;
-	}
-	if(!pOption)
+	// remove the option
+	if(!pSelf->m_pVoteOptions->Remove(pDescription))
 	{
 		char aBuf[256];
 		str_format(aBuf, sizeof(aBuf), "option '%s' does not exist", pDescription);
@@ -2848,41 +2772,6 @@ void CGameContext::ConRemoveVote(IConsole::IResult *pResult, void *pUserData)
 		if(pPlayer)
 			pPlayer->m_SendVoteIndex = 0;
 	}
-
-	// TODO: improve this
-	// remove the option
-	--pSelf->m_NumVoteOptions;
-
-	CHeap *pVoteOptionHeap = new CHeap();
-	CVoteOptionServer *pVoteOptionFirst = 0;
-	CVoteOptionServer *pVoteOptionLast = 0;
-	int NumVoteOptions = pSelf->m_NumVoteOptions;
-	for(CVoteOptionServer *pSrc = pSelf->m_pVoteOptionFirst; pSrc; pSrc = pSrc->m_pNext)
-	{
-		if(pSrc == pOption)
-			continue;
-
-		// copy option
-		int Len = str_length(pSrc->m_aCommand);
-		CVoteOptionServer *pDst = (CVoteOptionServer *)pVoteOptionHeap->Allocate(sizeof(CVoteOptionServer) + Len);
-		pDst->m_pNext = 0;
-		pDst->m_pPrev = pVoteOptionLast;
-		if(pDst->m_pPrev)
-			pDst->m_pPrev->m_pNext = pDst;
-		pVoteOptionLast = pDst;
-		if(!pVoteOptionFirst)
-			pVoteOptionFirst = pDst;
-
-		str_copy(pDst->m_aDescription, pSrc->m_aDescription, sizeof(pDst->m_aDescription));
-		mem_copy(pDst->m_aCommand, pSrc->m_aCommand, Len + 1);
-	}
-
-	// clean up
-	delete pSelf->m_pVoteOptionHeap;
-	pSelf->m_pVoteOptionHeap = pVoteOptionHeap;
-	pSelf->m_pVoteOptionFirst = pVoteOptionFirst;
-	pSelf->m_pVoteOptionLast = pVoteOptionLast;
-	pSelf->m_NumVoteOptions = NumVoteOptions;
 }
 
 void CGameContext::ConForceVote(IConsole::IResult *pResult, void *pUserData)
@@ -2895,26 +2784,20 @@ void CGameContext::ConForceVote(IConsole::IResult *pResult, void *pUserData)
 
 	if(str_comp_nocase(pType, "option") == 0)
 	{
-		CVoteOptionServer *pOption = pSelf->m_pVoteOptionFirst;
-		while(pOption)
-		{
-			if(str_comp_nocase(pValue, pOption->m_aDescription) == 0)
-			{
-				str_format(aBuf, sizeof(aBuf), "authorized player forced server option '%s' (%s)", pValue, pReason);
-				pSelf->SendChatTarget(-1, aBuf, CHAT_SIX);
-				pSelf->Console()->ExecuteLine(pOption->m_aCommand);
-				break;
-			}
-
-			pOption = pOption->m_pNext;
-		}
-
+		const CVoteOptionServer *pOption = pSelf->m_pVoteOptions->Find(pValue);
 		if(!pOption)
 		{
 			str_format(aBuf, sizeof(aBuf), "'%s' isn't an option on this server", pValue);
 			pSelf->Console()->Print(IConsole::OUTPUT_LEVEL_STANDARD, "server", aBuf);
 			return;
 		}
+
+		str_format(aBuf, sizeof(aBuf), "authorized player forced server option '%s' (%s)", pValue, pReason);
+		pSelf->SendChatTarget(-1, aBuf, CHAT_SIX);
+		// the command may modify the vote options
+		char aCommand[VOTE_CMD_LENGTH];
+		str_copy(aCommand, pOption->m_aCommand, sizeof(aCommand));
+		pSelf->Console()->ExecuteLine(aCommand);
 	}
 	else if(str_comp_nocase(pType, "kick") == 0)
 	{
@@ -2960,10 +2843,7 @@ void CGameContext::ConClearVotes(IConsole::IResult *pResult, void *pUserData)
 
 	CNetMsg_Sv_VoteClearOptions VoteClearOptionsMsg;
 	pSelf->Server()->SendPackMsg(&VoteClearOptionsMsg, MSGFLAG_VITAL, -1);
-	pSelf->m_pVoteOptionHeap->Reset();
-	pSelf->m_pVoteOptionFirst = 0;
-	pSelf->m_pVoteOptionLast = 0;
-	pSelf->m_NumVoteOptions = 0;
+	pSelf->m_pVoteOptions->Clear();
 
 	// reset sending of vote options
 	for(auto &pPlayer : pSelf->m_apPlayers)
@@ -3098,6 +2978,10 @@ void CGameContext::OnInit(/*class IKernel *pKernel*/)
 	m_World.SetGameServer(this);
 	m_Events.SetGameServer(this);
 
+	static const char *s_apProfileZoneNames[NUM_PROFILE_ZONES] = {"game.world", "game.controller", "game.teams", "game.players", "game.votes", "game.score"};
+	for(int i = 0; i < NUM_PROFILE_ZONES; i++)
+		m_aProfileZones[i] = Profiler()->AddZone(s_apProfileZoneNames[i]);
+
 	m_GameUuid = RandomUuid();
 	Console()->SetTeeHistorianCommandCallback(CommandCallback, this);
 
@@ -18,6 +18,7 @@
 //#include "gamecontroller.h"
 #include "gameworld.h"
 #include "teehistorian.h"
+#include "vote_options.h"
 
 #include <memory>
 
@@ -49,7 +50,6 @@ enum
 };
 
 class CConfig;
-class CHeap;
 class CPlayer;
 class CScore;
 class IConsole;
@@ -140,6 +140,20 @@ public:
 	IAntibot *Antibot() { return m_pAntibot; }
 	CTeeHistorian *TeeHistorian() { return &m_TeeHistorian; }
 	bool TeeHistorianActive() const { return m_TeeHistorianActive; }
+	class CProfiler *Profiler() { return m_pServer->Profiler(); }
+
+	// parts of a game tick measured by the server profiler
+	enum
+	{
+		PROFILE_WORLD,
+		PROFILE_CONTROLLER,
+		PROFILE_TEAMS,
+		PROFILE_PLAYERS,
+		PROFILE_VOTES,
+		PROFILE_SCORE,
+		NUM_PROFILE_ZONES
+	};
+	int m_aProfileZones[NUM_PROFILE_ZONES];
 
 	CGameContext();
 	CGameContext(int Reset);
@@ -173,7 +187,6 @@ public:
 	char m_aSixupVoteDescription[VOTE_DESC_LENGTH];
 	char m_aVoteCommand[VOTE_CMD_LENGTH];
 	char m_aVoteReason[VOTE_REASON_LENGTH];
-	int m_NumVoteOptions;
 	int m_VoteEnforce;
 	char m_aaZoneEnterMsg[NUM_TUNEZONES][256]; // 0 is used for switching from or to area without tunings
 	char m_aaZoneLeaveMsg[NUM_TUNEZONES][256];
@@ -188,9 +201,7 @@ public:
 		VOTE_ENFORCE_YES,
 		VOTE_ENFORCE_ABORT,
 	};
-	CHeap *m_pVoteOptionHeap;
-	CVoteOptionServer *m_pVoteOptionFirst;
-	CVoteOptionServer *m_pVoteOptionLast;
+	CVoteOptions *m_pVoteOptions;
 
 	// helper functions
 	void CreateDamageInd(vec2 Pos, float AngleMod, int Amount, int64_t Mask = -1);
@@ -232,7 +243,6 @@ public:
 	void CheckPureTuning();
 	void SendTuningParams(int ClientID, int Zone = 0);
 
-	struct CVoteOptionServer *GetVoteOption(int Index);
 	void ProgressVoteOptions(int ClientID);
 
 	//
@@ -277,6 +287,8 @@ public:
 	void OnPreTickTeehistorian();
 	bool OnClientDDNetVersionKnown(int ClientID);
 	virtual void FillAntibot(CAntibotRoundData *pData);
+	virtual bool SeedPrng(const char *pDescription);
+	virtual bool CharacterCore(int ClientID, CNetObj_CharacterCore *pCore, int *pSpawnTick);
 	int ProcessSpamProtection(int ClientID, bool RespectChatInitialDelay = true);
 	int GetDDRaceTeam(int ClientID);
 	// Describes the time when the first player joined the server.
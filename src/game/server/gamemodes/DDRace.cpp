@@ -4,6 +4,7 @@
 
 #include <engine/server.h>
 #include <engine/shared/config.h>
+#include <engine/shared/profiler.h>
 #include <game/mapitems.h>
 #include <game/server/entities/character.h>
 #include <game/server/gamecontext.h>
@@ -162,8 +163,11 @@ void CGameControllerDDRace::OnPlayerDisconnect(CPlayer *pPlayer, const char *pRe
 void CGameControllerDDRace::Tick()
 {
 	IGameController::Tick();
-	m_Teams.ProcessSaveTeam();
-	m_Teams.Tick();
+	{
+		CProfileScope Scope(GameServer()->Profiler(), GameServer()->m_aProfileZones[CGameContext::PROFILE_TEAMS]);
+		m_Teams.ProcessSaveTeam();
+		m_Teams.Tick();
+	}
 
 	if(m_pInitResult != nullptr && m_pInitResult->m_Completed)
 	{
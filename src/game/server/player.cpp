@@ -2,6 +2,7 @@
 /* If you are missing that file, acquire a complete release at teeworlds.com.                */
 #include "player.h"
 #include <engine/shared/config.h>
+#include <engine/shared/profiler.h>
 
 #include "entities/character.h"
 #include "gamecontext.h"
@@ -903,6 +904,7 @@ void CPlayer::SpectatePlayerName(const char *pName)
 
 void CPlayer::ProcessScoreResult(CScorePlayerResult &Result)
 {
+	CProfileScope Scope(GameServer()->Profiler(), GameServer()->m_aProfileZones[CGameContext::PROFILE_SCORE]);
 	if(Result.m_Success) // SQL request was successful
 	{
 		switch(Result.m_MessageKind)
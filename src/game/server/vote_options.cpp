@@ -0,0 +1,174 @@
+#include "vote_options.h"
+
+#include <base/math.h>
+#include <base/system.h>
+
+#include <engine/message.h>
+
+#include <game/generated/protocol.h>
+
+#include <ctype.h>
+
+CVoteOptions::CVoteOptions()
+{
+	m_BatchSize = 0;
+	RebuildHash();
+}
+
+unsigned CVoteOptions::Hash(const char *pDescription)
+{
+	// fnv-1a over the lower case bytes, consistent with str_comp_nocase
+	unsigned Hash = 2166136261u;
+	for(; *pDescription; pDescription++)
+	{
+		Hash ^= (unsigned char)tolower((unsigned char)*pDescription);
+		Hash *= 16777619u;
+	}
+	return Hash % HASH_SIZE;
+}
+
+void CVoteOptions::RebuildHash()
+{
+	for(int &First : m_aHashFirst)
+		First = -1;
+	m_vHashNext.resize(m_vOptions.size());
+	for(int i = 0; i < (int)m_vOptions.size(); i++)
+	{
+		unsigned Bucket = Hash(m_vOptions[i].m_aDescription);
+		m_vHashNext[i] = m_aHashFirst[Bucket];
+		m_aHashFirst[Bucket] = i;
+	}
+}
+
+int CVoteOptions::FindIndex(const char *pDescription) const
+{
+	for(int i = m_aHashFirst[Hash(pDescription)]; i >= 0; i = m_vHashNext[i])
+		if(str_comp_nocase(pDescription, m_vOptions[i].m_aDescription) == 0)
+			return i;
+	return -1;
+}
+
+const CVoteOptionServer *CVoteOptions::Find(const char *pDescription) const
+{
+	int Index = FindIndex(pDescription);
+	return Index >= 0 ? &m_vOptions[Index] : 0;
+}
+
+bool CVoteOptions::Add(const char *pDescription, const char *pCommand)
+{
+	if(FindIndex(pDescription) >= 0)
+		return false;
+
+	CVoteOptionServer Option;
+	str_copy(Option.m_aDescription, pDescription, sizeof(Option.m_aDescription));
+	str_copy(Option.m_aCommand, pCommand, sizeof(Option.m_aCommand));
+	m_vOptions.push_back(Option);
+
+	unsigned Bucket = Hash(Option.m_aDescription);
+	m_vHashNext.push_back(m_aHashFirst[Bucket]);
+	m_aHashFirst[Bucket] = m_vOptions.size() - 1;
+
+	// the new option only changes a trailing partial batch
+	if(!m_vBatches.empty() && m_vBatches.back().m_NumOptions < m_BatchSize)
+	{
+		m_vBatchData.resize(m_vBatches.back().m_Offset);
+		m_vBatches.pop_back();
+	}
+	return true;
+}
+
+bool CVoteOptions::Remove(const char *pDescription)
+{
+	int Index = FindIndex(pDescription);
+	if(Index < 0)
+		return false;
+
+	m_vOptions.erase(m_vOptions.begin() + Index);
+	RebuildHash();
+	ClearBatches();
+	return true;
+}
+
+void CVoteOptions::Clear()
+{
+	m_vOptions.clear();
+	RebuildHash();
+	ClearBatches();
+}
+
+void CVoteOptions::ClearBatches()
+{
+	m_vBatches.clear();
+	m_vBatchData.clear();
+}
+
+void CVoteOptions::PackBatch(int Index, int NumOptions, std::vector<unsigned char> *pvOut) const
+{
+	const char *apDescriptions[15];
+	for(int i = 0; i < 15; i++)
+		apDescriptions[i] = i < NumOptions ? m_vOptions[Index + i].m_aDescription : "";
+
+	CNetMsg_Sv_VoteOptionListAdd OptionMsg;
+	OptionMsg.m_NumOptions = NumOptions;
+	OptionMsg.m_pDescription0 = apDescriptions[0];
+	OptionMsg.m_pDescription1 = apDescriptions[1];
+	OptionMsg.m_pDescription2 = apDescriptions[2];
+	OptionMsg.m_pDescription3 = apDescriptions[3];
+	OptionMsg.m_pDescription4 = apDescriptions[4];
+	OptionMsg.m_pDescription5 = apDescriptions[5];
+	OptionMsg.m_pDescription6 = apDescriptions[6];
+	OptionMsg.m_pDescription7 = apDescriptions[7];
+	OptionMsg.m_pDescription8 = apDescriptions[8];
+	OptionMsg.m_pDescription9 = apDescriptions[9];
+	OptionMsg.m_pDescription10 = apDescriptions[10];
+	OptionMsg.m_pDescription11 = apDescriptions[11];
+	OptionMsg.m_pDescription12 = apDescriptions[12];
+	OptionMsg.m_pDescription13 = apDescriptions[13];
+	OptionMsg.m_pDescription14 = apDescriptions[14];
+
+	CMsgPacker Packer(OptionMsg.MsgID(), false);
+	OptionMsg.Pack(&Packer);
+	dbg_assert(!Packer.Error(), "vote option batch too large");
+	pvOut->insert(pvOut->end(), Packer.Data(), Packer.Data() + Packer.Size());
+}
+
+int CVoteOptions::Pack(int Index, int BatchSize, const unsigned char **ppData, int *pSize)
+{
+	BatchSize = clamp(BatchSize, 1, 15);
+	int NumOptions = minimum(BatchSize, Num() - Index);
+	if(Index < 0 || NumOptions <= 0)
+		return 0;
+
+	if(BatchSize != m_BatchSize)
+	{
+		ClearBatches();
+		m_BatchSize = BatchSize;
+	}
+
+	// clients start at 0 and advance by whole batches, only options added
+	// after a client caught up lead to unaligned requests
+	if(Index % BatchSize != 0)
+	{
+		m_vScratch.clear();
+		PackBatch(Index, NumOptions, &m_vScratch);
+		*ppData = m_vScratch.data();
+		*pSize = m_vScratch.size();
+		return NumOptions;
+	}
+
+	int Batch = Index / BatchSize;
+	while((int)m_vBatches.size() <= Batch)
+	{
+		CBatch NewBatch;
+		NewBatch.m_Offset = m_vBatchData.size();
+		NewBatch.m_NumOptions = minimum(BatchSize, Num() - (int)m_vBatches.size() * BatchSize);
+		PackBatch(m_vBatches.size() * BatchSize, NewBatch.m_NumOptions, &m_vBatchData);
+		NewBatch.m_Size = m_vBatchData.size() - NewBatch.m_Offset;
+		m_vBatches.push_back(NewBatch);
+	}
+
+	const CBatch &Cached = m_vBatches[Batch];
+	*ppData = &m_vBatchData[Cached.m_Offset];
+	*pSize = Cached.m_Size;
+	return Cached.m_NumOptions;
+}
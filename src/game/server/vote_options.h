@@ -0,0 +1,61 @@
+#ifndef GAME_SERVER_VOTE_OPTIONS_H
+#define GAME_SERVER_VOTE_OPTIONS_H
+
+#include <game/voting.h>
+
+#include <vector>
+
+// server vote options in list order
+//
+// Options are kept in a contiguous array so joining clients can be sent the
+// list by index, descriptions are hashed case insensitively for the
+// duplicate and remove lookups. The Sv_VoteOptionListAdd messages are packed
+// once per batch and shared by all clients downloading the list.
+class CVoteOptions
+{
+	enum
+	{
+		HASH_SIZE = 4096,
+	};
+
+	struct CBatch
+	{
+		int m_Offset;
+		int m_Size;
+		int m_NumOptions;
+	};
+
+	std::vector<CVoteOptionServer> m_vOptions;
+	std::vector<int> m_vHashNext;
+	int m_aHashFirst[HASH_SIZE];
+
+	int m_BatchSize;
+	std::vector<CBatch> m_vBatches;
+	std::vector<unsigned char> m_vBatchData;
+	std::vector<unsigned char> m_vScratch;
+
+	static unsigned Hash(const char *pDescription);
+	void RebuildHash();
+	void ClearBatches();
+	void PackBatch(int Index, int NumOptions, std::vector<unsigned char> *pvOut) const;
+
+public:
+	CVoteOptions();
+
+	int Num() const { return m_vOptions.size(); }
+	const CVoteOptionServer *Get(int Index) const { return &m_vOptions[Index]; }
+	// option with the given description ignoring case, 0 if there is none
+	const CVoteOptionServer *Find(const char *pDescription) const;
+	int FindIndex(const char *pDescription) const;
+
+	// description and command must be valid and fit into the option
+	bool Add(const char *pDescription, const char *pCommand);
+	bool Remove(const char *pDescription);
+	void Clear();
+
+	// packed Sv_VoteOptionListAdd message body with up to BatchSize options
+	// starting at Index, returns the number of options in it
+	int Pack(int Index, int BatchSize, const unsigned char **ppData, int *pSize);
+};
+
+#endif
@@ -0,0 +1,925 @@
+#include <base/math.h>
+#include <base/system.h>
+
+#include <engine/shared/compression.h>
+#include <engine/shared/config.h>
+#include <engine/shared/linereader.h>
+#include <engine/shared/network.h>
+#include <engine/shared/packer.h>
+#include <engine/shared/profiler.h>
+#include <engine/shared/protocol.h>
+#include <engine/shared/protocol_ex.h>
+#include <engine/shared/snapshot.h>
+#include <engine/shared/uuid_manager.h>
+
+#include <game/generated/protocol.h>
+#include <game/prng.h>
+#include <game/version.h>
+
+#include <zlib.h>
+
+#include <cstdio>
+
+#include <string>
+#include <vector>
+
+// Connects synthetic clients to a server, lets them download the map,
+// join and play scripted or recorded inputs while acknowledging
+// snapshots like the real client does, then reports what the clients
+// saw. With access to the econ, the server's own profile is fetched too.
+
+static const char *const LOADGEN_VERSION_STR = "DDNet " GAME_RELEASE_VERSION " (loadgen)";
+
+enum
+{
+	PATTERN_IDLE = 0,
+	PATTERN_WALK,
+	PATTERN_RANDOM,
+	PATTERN_FILE,
+};
+
+struct COptions
+{
+	NETADDR m_ServerAddr;
+	int m_NumClients;
+	int m_Duration;
+	int m_ConnectRate;
+	int m_Pattern;
+	int m_EconPort;
+	const char *m_pEconPassword;
+	const char *m_pPassword;
+};
+
+static COptions g_Options;
+static std::vector<CNetObj_PlayerInput> g_vRecordedInputs;
+static CSnapshotDelta g_SnapshotDelta;
+
+static int64_t Ms(int64_t Time)
+{
+	return Time * 1000 / time_freq();
+}
+
+class CLoadClient
+{
+public:
+	enum
+	{
+		STATE_WAITING = 0,
+		STATE_CONNECTING,
+		STATE_LOADING,
+		STATE_DOWNLOADING,
+		STATE_READY,
+		STATE_INGAME,
+		STATE_DONE,
+		STATE_ERROR,
+
+		PREDICTION_MARGIN = 2,
+	};
+
+	int m_Index;
+	int m_State;
+	char m_aError[128];
+
+	CNetClient m_Net;
+	bool m_SocketOpen;
+	CPrng m_Prng;
+	CUuid m_ConnectionID;
+
+	int64_t m_ConnectTime;
+	int64_t m_JoinTime;
+	int64_t m_DownloadStart;
+	int64_t m_DownloadTime;
+
+	unsigned m_MapCrc;
+	int m_MapSize;
+	int m_MapChunk;
+	int m_MapReceived;
+	unsigned m_MapDataCrc;
+
+	CSnapshotStorage m_SnapshotStorage;
+	unsigned char m_aSnapshotIncomingData[CSnapshot::MAX_SIZE];
+	unsigned m_SnapshotParts;
+	int m_CurrentRecvTick;
+	int m_AckGameTick;
+	int m_LastSnapTick;
+	int64_t m_FirstSnapTime;
+	int64_t m_LastSnapTime;
+
+	int m_InputTick;
+	int m_InputMargin;
+	CNetObj_PlayerInput m_Input;
+
+	// statistics
+	int64_t m_SnapBytes;
+	int m_NumSnaps;
+	int m_MissedSnaps;
+	int m_LateSnaps;
+	int m_CrcErrors;
+	int m_NumInputs;
+	int m_LateInputs;
+	int m_SnapStride;
+	CProfileHistogram m_SnapInterval;
+
+	CLoadClient(int Index)
+	{
+		m_Index = Index;
+		m_State = STATE_WAITING;
+		m_aError[0] = 0;
+		m_SocketOpen = false;
+		uint64_t aSeed[2];
+		secure_random_fill(aSeed, sizeof(aSeed));
+		m_Prng.Seed(aSeed);
+		m_ConnectionID = RandomUuid();
+		m_ConnectTime = 0;
+		m_JoinTime = 0;
+		m_DownloadStart = 0;
+		m_DownloadTime = 0;
+		m_SnapshotParts = 0;
+		m_CurrentRecvTick = 0;
+		m_AckGameTick = -1;
+		m_LastSnapTick = -1;
+		m_FirstSnapTime = 0;
+		m_LastSnapTime = 0;
+		m_InputTick = 0;
+		m_InputMargin = PREDICTION_MARGIN;
+		mem_zero(&m_Input, sizeof(m_Input));
+		m_SnapBytes = 0;
+		m_NumSnaps = 0;
+		m_MissedSnaps = 0;
+		m_LateSnaps = 0;
+		m_CrcErrors = 0;
+		m_NumInputs = 0;
+		m_LateInputs = 0;
+		m_SnapStride = 0;
+	}
+
+	void Fail(const char *pReason)
+	{
+		str_copy(m_aError, pReason, sizeof(m_aError));
+		dbg_msg("loadgen", "client %d: %s", m_Index, pReason);
+		m_Net.Disconnect(pReason);
+		m_State = STATE_ERROR;
+	}
+
+	void SendMsg(CMsgPacker *pMsg, int Flags)
+	{
+		CPacker Packer;
+		Packer.Reset();
+		if(pMsg->m_MsgID < OFFSET_UUID)
+		{
+			Packer.AddInt((pMsg->m_MsgID << 1) | (pMsg->m_System ? 1 : 0));
+		}
+		else
+		{
+			Packer.AddInt((0 << 1) | (pMsg->m_System ? 1 : 0)); // NETMSG_EX, NETMSGTYPE_EX
+			g_UuidManager.PackUuid(pMsg->m_MsgID, &Packer);
+		}
+		Packer.AddRaw(pMsg->Data(), pMsg->Size());
+
+		CNetChunk Packet;
+		mem_zero(&Packet, sizeof(Packet));
+		Packet.m_ClientID = 0;
+		Packet.m_pData = Packer.Data();
+		Packet.m_DataSize = Packer.Size();
+		if(Flags & MSGFLAG_VITAL)
+			Packet.m_Flags |= NETSENDFLAG_VITAL;
+		if(Flags & MSGFLAG_FLUSH)
+			Packet.m_Flags |= NETSENDFLAG_FLUSH;
+		m_Net.Send(&Packet);
+	}
+
+	void Connect()
+	{
+		NETADDR BindAddr;
+		mem_zero(&BindAddr, sizeof(BindAddr));
+		BindAddr.type = g_Options.m_ServerAddr.type;
+		if(!m_Net.Open(BindAddr, 0))
+		{
+			Fail("couldn't open socket");
+			return;
+		}
+		m_SocketOpen = true;
+		m_Net.Connect(&g_Options.m_ServerAddr);
+		m_ConnectTime = time_get();
+		m_State = STATE_CONNECTING;
+	}
+
+	void SendInfo()
+	{
+		CMsgPacker MsgVer(NETMSG_CLIENTVER, true);
+		MsgVer.AddRaw(&m_ConnectionID, sizeof(m_ConnectionID));
+		MsgVer.AddInt(CLIENT_VERSIONNR);
+		MsgVer.AddString(LOADGEN_VERSION_STR, 0);
+		SendMsg(&MsgVer, MSGFLAG_VITAL);
+
+		CMsgPacker Msg(NETMSG_INFO, true);
+		Msg.AddString(GAME_NETVERSION, 128);
+		Msg.AddString(g_Options.m_pPassword, 128);
+		SendMsg(&Msg, MSGFLAG_VITAL | MSGFLAG_FLUSH);
+		m_State = STATE_LOADING;
+	}
+
+	void RequestMapChunk()
+	{
+		CMsgPacker Msg(NETMSG_REQUEST_MAP_DATA, true);
+		Msg.AddInt(m_MapChunk);
+		SendMsg(&Msg, MSGFLAG_VITAL | MSGFLAG_FLUSH);
+	}
+
+	void SendReady()
+	{
+		CMsgPacker Msg(NETMSG_READY, true);
+		SendMsg(&Msg, MSGFLAG_VITAL | MSGFLAG_FLUSH);
+		m_State = STATE_READY;
+	}
+
+	void EnterGame()
+	{
+		CNetMsg_Cl_StartInfo Info;
+		char aName[16];
+		str_format(aName, sizeof(aName), "loadgen%d", m_Index);
+		Info.m_pName = aName;
+		Info.m_pClan = "";
+		Info.m_Country = -1;
+		Info.m_pSkin = "default";
+		Info.m_UseCustomColor = 0;
+		Info.m_ColorBody = 0;
+		Info.m_ColorFeet = 0;
+		CMsgPacker Packer(Info.MsgID(), false);
+		Info.Pack(&Packer);
+		SendMsg(&Packer, MSGFLAG_VITAL);
+
+		CMsgPacker Msg(NETMSG_ENTERGAME, true);
+		SendMsg(&Msg, MSGFLAG_VITAL | MSGFLAG_FLUSH);
+		m_State = STATE_INGAME;
+	}
+
+	void OnMapChange(CUnpacker *pUnpacker)
+	{
+		pUnpacker->GetString(CUnpacker::SANITIZE_CC);
+		m_MapCrc = pUnpacker->GetInt();
+		m_MapSize = pUnpacker->GetInt();
+		if(pUnpacker->Error() || m_MapSize < 0)
+		{
+			Fail("invalid map change");
+			return;
+		}
+
+		// always download the map, that is the expensive part for the server
+		m_MapChunk = 0;
+		m_MapReceived = 0;
+		m_MapDataCrc = crc32(0L, 0x0, 0);
+		m_DownloadStart = time_get();
+		m_State = STATE_DOWNLOADING;
+		RequestMapChunk();
+	}
+
+	void OnMapData(CUnpacker *pUnpacker)
+	{
+		int Last = pUnpacker->GetInt();
+		unsigned MapCrc = pUnpacker->GetInt();
+		int Chunk = pUnpacker->GetInt();
+		int Size = pUnpacker->GetInt();
+		const unsigned char *pData = pUnpacker->GetRaw(Size);
+		if(m_State != STATE_DOWNLOADING || pUnpacker->Error() || Size <= 0 || MapCrc != m_MapCrc || Chunk != m_MapChunk)
+			return;
+
+		m_MapDataCrc = crc32(m_MapDataCrc, pData, Size);
+		m_MapReceived += Size;
+		if(!Last)
+		{
+			m_MapChunk++;
+			RequestMapChunk();
+			return;
+		}
+
+		m_DownloadTime = time_get() - m_DownloadStart;
+		if(m_MapReceived != m_MapSize || m_MapDataCrc != m_MapCrc)
+		{
+			char aBuf[128];
+			str_format(aBuf, sizeof(aBuf), "map download corrupt, got %d of %d bytes, crc=%08x wanted=%08x", m_MapReceived, m_MapSize, m_MapDataCrc, m_MapCrc);
+			Fail(aBuf);
+			return;
+		}
+		SendReady();
+	}
+
+	void OnSnapshot(int Msg, CUnpacker *pUnpacker)
+	{
+		int NumParts = 1;
+		int Part = 0;
+		int GameTick = pUnpacker->GetInt();
+		int DeltaTick = GameTick - pUnpacker->GetInt();
+		int PartSize = 0;
+		unsigned Crc = 0;
+
+		if(Msg == NETMSG_SNAP)
+		{
+			NumParts = pUnpacker->GetInt();
+			Part = pUnpacker->GetInt();
+		}
+		if(Msg != NETMSG_SNAPEMPTY)
+		{
+			Crc = pUnpacker->GetInt();
+			PartSize = pUnpacker->GetInt();
+		}
+		const char *pData = (const char *)pUnpacker->GetRaw(PartSize);
+
+		if(pUnpacker->Error() || NumParts < 1 || NumParts > CSnapshot::MAX_PARTS || Part < 0 || Part >= NumParts || PartSize < 0 || PartSize > MAX_SNAPSHOT_PACKSIZE)
+			return;
+		m_SnapBytes += PartSize;
+		if(GameTick < m_CurrentRecvTick)
+			return;
+		if(GameTick != m_CurrentRecvTick)
+		{
+			m_SnapshotParts = 0;
+			m_CurrentRecvTick = GameTick;
+		}
+
+		mem_copy(m_aSnapshotIncomingData + Part * MAX_SNAPSHOT_PACKSIZE, pData, clamp(PartSize, 0, (int)sizeof(m_aSnapshotIncomingData) - Part * MAX_SNAPSHOT_PACKSIZE));
+		m_SnapshotParts |= 1 << Part;
+		if(m_SnapshotParts != (unsigned)((1 << NumParts) - 1))
+			return;
+		m_SnapshotParts = 0;
+
+		CSnapshot EmptySnap;
+		EmptySnap.Clear();
+		CSnapshot *pDeltaShot = &EmptySnap;
+		if(DeltaTick >= 0 && m_SnapshotStorage.Get(DeltaTick, 0, &pDeltaShot, 0) < 0)
+		{
+			// the server used a snapshot we don't have, make it resync
+			m_AckGameTick = -1;
+			return;
+		}
+
+		unsigned char aDeltaData[CSnapshot::MAX_SIZE];
+		unsigned char aSnapData[CSnapshot::MAX_SIZE];
+		void *pDeltaData = g_SnapshotDelta.EmptyDelta();
+		int DeltaSize = sizeof(int) * 3;
+		int CompleteSize = (NumParts - 1) * MAX_SNAPSHOT_PACKSIZE + PartSize;
+		if(CompleteSize)
+		{
+			DeltaSize = CVariableInt::Decompress(m_aSnapshotIncomingData, CompleteSize, aDeltaData, sizeof(aDeltaData));
+			if(DeltaSize < 0)
+				return;
+			pDeltaData = aDeltaData;
+		}
+
+		CSnapshot *pSnap = (CSnapshot *)aSnapData;
+		int SnapSize = g_SnapshotDelta.UnpackDelta(pDeltaShot, pSnap, pDeltaData, DeltaSize);
+		if(SnapSize < 0 || (Msg != NETMSG_SNAPEMPTY && pSnap->Crc() != Crc))
+		{
+			m_CrcErrors++;
+			m_AckGameTick = -1;
+			return;
+		}
+
+		// the server never goes back to snapshots older than its delta
+		if(DeltaTick >= 0)
+			m_SnapshotStorage.PurgeUntil(DeltaTick);
+		m_SnapshotStorage.Add(GameTick, time_get(), SnapSize, pSnap, 0);
+		m_AckGameTick = GameTick;
+
+		int64_t Now = time_get();
+		if(m_LastSnapTick >= 0)
+		{
+			int Ticks = GameTick - m_LastSnapTick;
+			if(Ticks > 0 && (m_SnapStride == 0 || Ticks < m_SnapStride))
+				m_SnapStride = Ticks;
+			if(m_SnapStride)
+				m_MissedSnaps += maximum(Ticks / m_SnapStride - 1, 0);
+
+			int64_t Interval = Now - m_LastSnapTime;
+			m_SnapInterval.Add(Interval * 1000000 / time_freq());
+			if(m_SnapStride && Interval > time_freq() * m_SnapStride * 3 / (SERVER_TICK_SPEED * 2))
+				m_LateSnaps++;
+		}
+		else
+		{
+			m_JoinTime = Now - m_ConnectTime;
+			m_FirstSnapTime = Now;
+		}
+		m_NumSnaps++;
+		m_LastSnapTick = GameTick;
+		m_LastSnapTime = Now;
+	}
+
+	void OnInputTiming(CUnpacker *pUnpacker)
+	{
+		pUnpacker->GetInt();
+		int TimeLeft = pUnpacker->GetInt();
+		if(pUnpacker->Error())
+			return;
+
+		// the server answers every new input with the milliseconds until it is used
+		if(TimeLeft < 0)
+		{
+			m_LateInputs++;
+			m_InputMargin++;
+		}
+		else if(TimeLeft > 1000 / SERVER_TICK_SPEED * (PREDICTION_MARGIN + 1) && m_InputMargin > 1)
+			m_InputMargin--;
+	}
+
+	void OnPacket(CNetChunk *pPacket)
+	{
+		CUnpacker Unpacker;
+		Unpacker.Reset(pPacket->m_pData, pPacket->m_DataSize);
+		CMsgPacker Packer(NETMSG_EX, true);
+
+		int Msg;
+		bool Sys;
+		CUuid Uuid;
+		int Result = UnpackMessageID(&Msg, &Sys, &Uuid, &Unpacker, &Packer);
+		if(Result == UNPACKMESSAGE_ERROR)
+			return;
+		else if(Result == UNPACKMESSAGE_ANSWER)
+			SendMsg(&Packer, MSGFLAG_VITAL);
+
+		// game messages are of no interest
+		if(!Sys)
+			return;
+
+		bool Vital = (pPacket->m_Flags & NET_CHUNKFLAG_VITAL) != 0;
+		if(Vital && Msg == NETMSG_MAP_CHANGE)
+			OnMapChange(&Unpacker);
+		else if(Msg == NETMSG_MAP_DATA)
+			OnMapData(&Unpacker);
+		else if(Vital && Msg == NETMSG_CON_READY && m_State == STATE_READY)
+			EnterGame();
+		else if(Msg == NETMSG_PING)
+		{
+			CMsgPacker Reply(NETMSG_PING_REPLY, true);
+			SendMsg(&Reply, 0);
+		}
+		else if(Msg == NETMSG_PINGEX)
+		{
+			CUuid *pID = (CUuid *)Unpacker.GetRaw(sizeof(*pID));
+			if(Unpacker.Error())
+				return;
+			CMsgPacker Reply(NETMSG_PONGEX, true);
+			Reply.AddRaw(pID, sizeof(*pID));
+			SendMsg(&Reply, MSGFLAG_FLUSH);
+		}
+		else if(Msg == NETMSG_INPUTTIMING)
+			OnInputTiming(&Unpacker);
+		else if(Msg == NETMSG_SNAP || Msg == NETMSG_SNAPSINGLE || Msg == NETMSG_SNAPEMPTY)
+		{
+			if(m_State == STATE_INGAME)
+				OnSnapshot(Msg, &Unpacker);
+		}
+	}
+
+	void UpdateInput(int Tick)
+	{
+		CNetObj_PlayerInput *pInput = &m_Input;
+		pInput->m_PlayerFlags = PLAYERFLAG_PLAYING;
+		switch(g_Options.m_Pattern)
+		{
+		case PATTERN_IDLE:
+			pInput->m_TargetX = 0;
+			pInput->m_TargetY = -64;
+			break;
+		case PATTERN_WALK:
+			// turn around every second, spread over the clients
+			pInput->m_Direction = ((Tick + m_Index * 7) / SERVER_TICK_SPEED) % 2 ? 1 : -1;
+			pInput->m_Jump = (Tick + m_Index) % (SERVER_TICK_SPEED / 2) == 0;
+			pInput->m_TargetX = pInput->m_Direction * 100;
+			pInput->m_TargetY = -50;
+			break;
+		case PATTERN_RANDOM:
+			// change a random part of the input a few times a second
+			if(m_Prng.RandomBits() % 8 == 0)
+			{
+				switch(m_Prng.RandomBits() % 4)
+				{
+				case 0: pInput->m_Direction = (int)(m_Prng.RandomBits() % 3) - 1; break;
+				case 1: pInput->m_Jump ^= 1; break;
+				case 2: pInput->m_Hook ^= 1; break;
+				case 3:
+					pInput->m_Fire++;
+					pInput->m_TargetX = (int)(m_Prng.RandomBits() % 513) - 256;
+					pInput->m_TargetY = (int)(m_Prng.RandomBits() % 513) - 256;
+					break;
+				}
+			}
+			break;
+		case PATTERN_FILE:
+			*pInput = g_vRecordedInputs[(Tick + m_Index * 17) % g_vRecordedInputs.size()];
+			pInput->m_PlayerFlags = PLAYERFLAG_PLAYING;
+			break;
+		}
+	}
+
+	void SendInput()
+	{
+		// the server tick we expect to be current, plus some margin
+		int64_t Now = time_get();
+		int PredTick = m_LastSnapTick + (int)((Now - m_LastSnapTime) * SERVER_TICK_SPEED / time_freq()) + m_InputMargin;
+		if(PredTick <= m_InputTick)
+			return;
+		m_InputTick = PredTick;
+		UpdateInput(PredTick);
+
+		CMsgPacker Msg(NETMSG_INPUT, true);
+		Msg.AddInt(m_AckGameTick);
+		Msg.AddInt(PredTick);
+		Msg.AddInt(sizeof(m_Input));
+		const int *pData = (const int *)&m_Input;
+		for(unsigned i = 0; i < sizeof(m_Input) / sizeof(int); i++)
+			Msg.AddInt(pData[i]);
+		SendMsg(&Msg, MSGFLAG_FLUSH);
+		m_NumInputs++;
+	}
+
+	void Update()
+	{
+		if(m_State == STATE_WAITING || m_State >= STATE_DONE)
+			return;
+
+		m_Net.Update();
+		if(m_State == STATE_CONNECTING && m_Net.State() == NETSTATE_ONLINE)
+			SendInfo();
+		if(m_Net.State() == NETSTATE_OFFLINE)
+		{
+			Fail(m_Net.ErrorString()[0] ? m_Net.ErrorString() : "connection lost");
+			return;
+		}
+
+		CNetChunk Packet;
+		while(m_State < STATE_DONE && m_Net.Recv(&Packet))
+		{
+			if(Packet.m_ClientID != -1)
+				OnPacket(&Packet);
+		}
+
+		if(m_State == STATE_INGAME && m_LastSnapTick >= 0)
+			SendInput();
+	}
+
+	void Disconnect()
+	{
+		if(m_State > STATE_WAITING && m_State < STATE_DONE)
+		{
+			m_Net.Disconnect("loadgen done");
+			m_State = STATE_DONE;
+		}
+		// CNetClient::Close doesn't release the socket
+		if(m_SocketOpen)
+			net_udp_close(m_Net.m_Socket);
+		m_SocketOpen = false;
+	}
+};
+
+class CEconControl
+{
+	NETSOCKET m_Socket;
+	bool m_Connected;
+	std::string m_Buffer;
+
+public:
+	CEconControl() :
+		m_Connected(false) {}
+
+	bool Connect(const NETADDR *pServerAddr, int Port, const char *pPassword)
+	{
+		NETADDR Addr = *pServerAddr;
+		Addr.port = Port;
+		NETADDR BindAddr;
+		mem_zero(&BindAddr, sizeof(BindAddr));
+		BindAddr.type = Addr.type;
+		m_Socket = net_tcp_create(BindAddr);
+		if(m_Socket.type == NETTYPE_INVALID || net_tcp_connect(m_Socket, &Addr) != 0)
+		{
+			dbg_msg("loadgen", "couldn't connect to the econ");
+			return false;
+		}
+		m_Connected = true;
+		if(ReadUntil("Enter password:", 2000).empty())
+			return false;
+		Send(pPassword);
+		if(ReadUntil("Authentication successful", 2000).empty())
+		{
+			dbg_msg("loadgen", "econ authentication failed");
+			return false;
+		}
+		return true;
+	}
+
+	void Send(const char *pLine)
+	{
+		if(!m_Connected)
+			return;
+		net_tcp_send(m_Socket, pLine, str_length(pLine));
+		net_tcp_send(m_Socket, "\n", 1);
+	}
+
+	// everything read until the marker was seen or the time ran out
+	std::string ReadUntil(const char *pMarker, int TimeoutMs)
+	{
+		std::string Data;
+		int64_t End = time_get() + time_freq() * TimeoutMs / 1000;
+		while(m_Connected && time_get() < End)
+		{
+			if(net_socket_read_wait(m_Socket, 50000) <= 0)
+				continue;
+			char aBuf[1024];
+			int Bytes = net_tcp_recv(m_Socket, aBuf, sizeof(aBuf));
+			if(Bytes <= 0)
+			{
+				m_Connected = false;
+				break;
+			}
+			Data.append(aBuf, Bytes);
+			if(pMarker && Data.find(pMarker) != std::string::npos)
+				return Data;
+		}
+		return pMarker ? std::string() : Data;
+	}
+
+	// the current value of an integer variable, -1 if it couldn't be read
+	int GetInt(const char *pVariable)
+	{
+		Send(pVariable);
+		std::string Data = ReadUntil("Value: ", 2000);
+		size_t Pos = Data.find("Value: ");
+		if(Pos == std::string::npos || Pos + 7 >= Data.size())
+			return -1;
+		return str_toint(Data.c_str() + Pos + 7);
+	}
+
+	void Close()
+	{
+		if(m_Connected)
+			net_tcp_close(m_Socket);
+		m_Connected = false;
+	}
+};
+
+static bool LoadInputs(const char *pFilename)
+{
+	IOHANDLE File = io_open(pFilename, IOFLAG_READ);
+	if(!File)
+	{
+		dbg_msg("loadgen", "couldn't open input file '%s'", pFilename);
+		return false;
+	}
+
+	// one input per tick and line: direction target_x target_y jump fire hook
+	CLineReader LineReader;
+	LineReader.Init(File);
+	while(char *pLine = LineReader.Get())
+	{
+		if(pLine[0] == '#')
+			continue;
+		CNetObj_PlayerInput Input;
+		mem_zero(&Input, sizeof(Input));
+		if(sscanf(pLine, "%d %d %d %d %d %d", &Input.m_Direction, &Input.m_TargetX, &Input.m_TargetY, &Input.m_Jump, &Input.m_Fire, &Input.m_Hook) == 6)
+			g_vRecordedInputs.push_back(Input);
+	}
+	io_close(File);
+
+	if(g_vRecordedInputs.empty())
+	{
+		dbg_msg("loadgen", "no inputs in '%s'", pFilename);
+		return false;
+	}
+	return true;
+}
+
+static void Report(const std::vector<CLoadClient *> &vpClients, int64_t Duration)
+{
+	int NumJoined = 0;
+	int64_t IngameTime = 0;
+	int NumFailed = 0;
+	int64_t SnapBytes = 0;
+	int64_t NumSnaps = 0;
+	int64_t MissedSnaps = 0;
+	int64_t LateSnaps = 0;
+	int64_t CrcErrors = 0;
+	int64_t NumInputs = 0;
+	int64_t LateInputs = 0;
+	CProfileHistogram JoinTime;
+	CProfileHistogram DownloadTime;
+	CProfileHistogram SnapInterval;
+	int64_t MaxInterval = 0;
+
+	for(const CLoadClient *pClient : vpClients)
+	{
+		if(pClient->m_State == CLoadClient::STATE_ERROR)
+			NumFailed++;
+		if(pClient->m_JoinTime == 0)
+			continue;
+		NumJoined++;
+		IngameTime += pClient->m_LastSnapTime - pClient->m_FirstSnapTime;
+		SnapBytes += pClient->m_SnapBytes;
+		NumSnaps += pClient->m_NumSnaps;
+		MissedSnaps += pClient->m_MissedSnaps;
+		LateSnaps += pClient->m_LateSnaps;
+		CrcErrors += pClient->m_CrcErrors;
+		NumInputs += pClient->m_NumInputs;
+		LateInputs += pClient->m_LateInputs;
+		JoinTime.Add(Ms(pClient->m_JoinTime));
+		DownloadTime.Add(Ms(pClient->m_DownloadTime));
+		SnapInterval.Add(pClient->m_SnapInterval.Percentile(0.99));
+		MaxInterval = maximum(MaxInterval, pClient->m_SnapInterval.Max());
+	}
+
+	double Seconds = Duration / (double)time_freq();
+	dbg_msg("loadgen", "%d of %d clients joined, %d failed, ran for %.1fs", NumJoined, (int)vpClients.size(), NumFailed, Seconds);
+	if(!NumJoined)
+		return;
+	dbg_msg("loadgen", "join time: p50=%dms max=%dms, map download: p50=%dms max=%dms",
+		(int)JoinTime.Percentile(0.5), (int)JoinTime.Max(), (int)DownloadTime.Percentile(0.5), (int)DownloadTime.Max());
+	double IngameSeconds = maximum(IngameTime / (double)time_freq(), 0.001);
+	dbg_msg("loadgen", "snapshots: %.1f/s per client, %.0f bytes/s per client, %.0f bytes per snapshot",
+		NumSnaps / IngameSeconds, SnapBytes / IngameSeconds, NumSnaps ? SnapBytes / (double)NumSnaps : 0.0);
+	dbg_msg("loadgen", "snapshot interval: worst client p99=%.1fms, max=%.1fms",
+		SnapInterval.Max() / 1000.0, MaxInterval / 1000.0);
+	dbg_msg("loadgen", "missed snapshots: %lld, late snapshots: %lld, crc errors: %lld",
+		(long long)MissedSnaps, (long long)LateSnaps, (long long)CrcErrors);
+	dbg_msg("loadgen", "inputs: %lld sent, %lld arrived too late for their tick",
+		(long long)NumInputs, (long long)LateInputs);
+}
+
+static void Usage(const char *pProgram)
+{
+	dbg_msg("usage", "%s [options] [server[:port]]", pProgram);
+	dbg_msg("usage", "  -n <clients>   number of clients (default 16)");
+	dbg_msg("usage", "  -d <seconds>   duration after the last client connected (default 30)");
+	dbg_msg("usage", "  -r <clients>   clients connecting per second (default 8)");
+	dbg_msg("usage", "  -m <pattern>   input pattern: idle, walk, random (default random)");
+	dbg_msg("usage", "  -i <file>      play inputs from a file instead, one tick per line:");
+	dbg_msg("usage", "                 direction target_x target_y jump fire hook");
+	dbg_msg("usage", "  -p <password>  server password");
+	dbg_msg("usage", "  -e <port> <password>  fetch the server profile through the econ");
+	dbg_msg("usage", "the server needs sv_max_clients and sv_max_clients_per_ip set high enough");
+}
+
+int main(int argc, const char **argv) // ignore_convention
+{
+	dbg_logger_stdout();
+
+	g_Options.m_NumClients = 16;
+	g_Options.m_Duration = 30;
+	g_Options.m_ConnectRate = 8;
+	g_Options.m_Pattern = PATTERN_RANDOM;
+	g_Options.m_EconPort = 0;
+	g_Options.m_pEconPassword = "";
+	g_Options.m_pPassword = "";
+	const char *pServer = "localhost";
+
+	for(int i = 1; i < argc; i++)
+	{
+		bool HasValue = i + 1 < argc;
+		if(str_comp(argv[i], "-n") == 0 && HasValue)
+			g_Options.m_NumClients = maximum(str_toint(argv[++i]), 1);
+		else if(str_comp(argv[i], "-d") == 0 && HasValue)
+			g_Options.m_Duration = maximum(str_toint(argv[++i]), 1);
+		else if(str_comp(argv[i], "-r") == 0 && HasValue)
+			g_Options.m_ConnectRate = maximum(str_toint(argv[++i]), 1);
+		else if(str_comp(argv[i], "-m") == 0 && HasValue)
+		{
+			i++;
+			if(str_comp(argv[i], "idle") == 0)
+				g_Options.m_Pattern = PATTERN_IDLE;
+			else if(str_comp(argv[i], "walk") == 0)
+				g_Options.m_Pattern = PATTERN_WALK;
+			else if(str_comp(argv[i], "random") == 0)
+				g_Options.m_Pattern = PATTERN_RANDOM;
+			else
+			{
+				Usage(argv[0]);
+				return -1;
+			}
+		}
+		else if(str_comp(argv[i], "-i") == 0 && HasValue)
+		{
+			if(!LoadInputs(argv[++i]))
+				return -1;
+			g_Options.m_Pattern = PATTERN_FILE;
+		}
+		else if(str_comp(argv[i], "-p") == 0 && HasValue)
+			g_Options.m_pPassword = argv[++i];
+		else if(str_comp(argv[i], "-e") == 0 && i + 2 < argc)
+		{
+			g_Options.m_EconPort = str_toint(argv[++i]);
+			g_Options.m_pEconPassword = argv[++i];
+		}
+		else if(argv[i][0] != '-')
+			pServer = argv[i];
+		else
+		{
+			Usage(argv[0]);
+			return -1;
+		}
+	}
+
+	net_init();
+	CNetBase::Init();
+	if(secure_random_init() != 0)
+	{
+		dbg_msg("loadgen", "could not initialize secure RNG");
+		return -1;
+	}
+
+	if(net_host_lookup(pServer, &g_Options.m_ServerAddr, NETTYPE_ALL) != 0)
+	{
+		dbg_msg("loadgen", "host lookup for '%s' failed", pServer);
+		return -1;
+	}
+	if(g_Options.m_ServerAddr.port == 0)
+		g_Options.m_ServerAddr.port = 8303;
+
+	// the network code reads its timeouts from the config
+	CConfigManager ConfigManager;
+	ConfigManager.Reset();
+
+	CNetObjHandler NetObjHandler;
+	for(int i = 0; i < NUM_NETOBJTYPES; i++)
+		g_SnapshotDelta.SetStaticsize(i, NetObjHandler.GetObjSize(i));
+
+	CEconControl Econ;
+	bool HasEcon = false;
+	int PrevProfile = 0;
+	if(g_Options.m_EconPort)
+	{
+		HasEcon = Econ.Connect(&g_Options.m_ServerAddr, g_Options.m_EconPort, g_Options.m_pEconPassword);
+		if(HasEcon)
+		{
+			// restored after the run, profiling is turned off if the old
+			// value couldn't be read
+			PrevProfile = maximum(Econ.GetInt("sv_profile"), 0);
+			Econ.Send("sv_profile 1");
+			Econ.Send("profile_reset");
+		}
+	}
+
+	std::vector<CLoadClient *> vpClients;
+	for(int i = 0; i < g_Options.m_NumClients; i++)
+		vpClients.push_back(new CLoadClient(i));
+
+	dbg_msg("loadgen", "connecting %d clients to %s", g_Options.m_NumClients, pServer);
+	int64_t Start = time_get();
+	int64_t End = Start + time_freq() * (g_Options.m_NumClients / g_Options.m_ConnectRate + g_Options.m_Duration);
+	int64_t LastStatus = Start;
+	int NumStarted = 0;
+	while(time_get() < End)
+	{
+		int64_t Now = time_get();
+		int ShouldHaveStarted = minimum((int)((Now - Start) * g_Options.m_ConnectRate / time_freq()) + 1, g_Options.m_NumClients);
+		while(NumStarted < ShouldHaveStarted)
+			vpClients[NumStarted++]->Connect();
+
+		for(CLoadClient *pClient : vpClients)
+			pClient->Update();
+
+		if(Now - LastStatus > time_freq() * 5)
+		{
+			int NumIngame = 0;
+			for(CLoadClient *pClient : vpClients)
+				NumIngame += pClient->m_State == CLoadClient::STATE_INGAME;
+			dbg_msg("loadgen", "%d clients ingame", NumIngame);
+			LastStatus = Now;
+		}
+
+		thread_sleep(1000);
+	}
+	int64_t Duration = time_get() - Start;
+
+	if(HasEcon)
+	{
+		// the profile still covers the time with all clients connected
+		Econ.ReadUntil(0, 100);
+		Econ.Send("profile");
+		std::string Profile = Econ.ReadUntil(0, 500);
+		dbg_msg("loadgen", "server profile (microseconds):");
+		// econ lines end with "\r\n\0"
+		for(size_t Pos = 0; Pos < Profile.size();)
+		{
+			size_t LineEnd = Profile.find_first_of(std::string("\r\n\0", 3), Pos);
+			if(LineEnd == std::string::npos)
+				LineEnd = Profile.size();
+			std::string Line = Profile.substr(Pos, LineEnd - Pos);
+			if(Line.find("[profile]") != std::string::npos)
+				dbg_msg("loadgen", "%s", Line.c_str());
+			Pos = LineEnd + 1;
+		}
+		char aBuf[32];
+		str_format(aBuf, sizeof(aBuf), "sv_profile %d", PrevProfile);
+		Econ.Send(aBuf);
+		// wait for the answer, lines still queued when the connection
+		// closes are dropped by the server
+		if(Econ.GetInt("sv_profile") != PrevProfile)
+			dbg_msg("loadgen", "couldn't restore sv_profile %d on the server", PrevProfile);
+		Econ.Close();
+	}
+
+	for(CLoadClient *pClient : vpClients)
+		pClient->Disconnect();
+	Report(vpClients, Duration);
+
+	for(CLoadClient *pClient : vpClients)
+		delete pClient;
+	return 0;
+}
@@ -0,0 +1,195 @@
+#include "test.h"
+#include <gtest/gtest.h>
+
+#include <base/system.h>
+#include <engine/config.h>
+#include <engine/console.h>
+#include <engine/kernel.h>
+#include <engine/shared/console.h>
+#include <engine/shared/config.h>
+#include <engine/storage.h>
+
+class Console : public ::testing::Test
+{
+protected:
+	CTestInfo m_Info;
+	IKernel *m_pKernel;
+	IConsole *m_pConsole;
+	IStorage *m_pStorage;
+	IConfigManager *m_pConfigManager;
+	CConfig m_SavedConfig;
+
+	int m_NumCalls;
+	char m_aLastArgs[256];
+
+	Console()
+	{
+		m_SavedConfig = g_Config;
+		m_pKernel = IKernel::Create();
+		m_pConsole = CreateConsole(CFGFLAG_SERVER);
+		m_pStorage = m_Info.CreateTestStorage();
+		m_pConfigManager = CreateConfigManager();
+		m_pKernel->RegisterInterface(m_pConsole);
+		m_pKernel->RegisterInterface(m_pStorage);
+		m_pKernel->RegisterInterface(m_pConfigManager);
+		m_pConfigManager->Init();
+		m_pConsole->Init();
+
+		m_NumCalls = 0;
+		m_aLastArgs[0] = 0;
+		m_pConsole->Register("test_cmd", "i[number] s[word] ?r[rest]", CFGFLAG_SERVER, ConTest, this, "");
+	}
+
+	~Console()
+	{
+		// the kernel owns the registered interfaces
+		delete m_pKernel;
+		g_Config = m_SavedConfig;
+		m_Info.DeleteTestStorageFilesOnSuccess();
+	}
+
+	static void ConTest(IConsole::IResult *pResult, void *pUserData)
+	{
+		Console *pSelf = (Console *)pUserData;
+		pSelf->m_NumCalls++;
+		str_format(pSelf->m_aLastArgs, sizeof(pSelf->m_aLastArgs), "%d|%s|%s", pResult->GetInteger(0), pResult->GetString(1), pResult->GetString(2));
+	}
+};
+
+TEST_F(Console, Execute)
+{
+	m_pConsole->ExecuteLine("test_cmd 5 word the rest");
+	EXPECT_EQ(m_NumCalls, 1);
+	EXPECT_STREQ(m_aLastArgs, "5|word|the rest");
+
+	m_pConsole->ExecuteLine("TEST_Cmd 6 \"two words\"; test_cmd 7 x # comment");
+	EXPECT_EQ(m_NumCalls, 3);
+	EXPECT_STREQ(m_aLastArgs, "7|x|");
+
+	m_pConsole->ExecuteLine("test_cmd");
+	m_pConsole->ExecuteLine("test_cmd_unknown 1 a");
+	EXPECT_EQ(m_NumCalls, 3);
+
+	m_pConsole->ExecuteLine("sv_max_clients 12");
+	EXPECT_EQ(g_Config.m_SvMaxClients, 12);
+	m_pConsole->ExecuteLine("SV_NAME \"hashed lookup\"");
+	EXPECT_STREQ(g_Config.m_SvName, "hashed lookup");
+
+	EXPECT_TRUE(m_pConsole->LineIsValid("test_cmd 1 a; sv_max_clients 3"));
+	EXPECT_FALSE(m_pConsole->LineIsValid("test_cmd a"));
+	EXPECT_FALSE(m_pConsole->LineIsValid("test_cmd 1 a; no_such_command"));
+}
+
+TEST_F(Console, TempCommands)
+{
+	m_pConsole->RegisterTemp("tmp_b", "", CFGFLAG_SERVER, "");
+	m_pConsole->RegisterTemp("tmp_a", "", CFGFLAG_SERVER, "");
+	m_pConsole->RegisterTemp("test_cmd", "", CFGFLAG_SERVER, "");
+	EXPECT_TRUE(m_pConsole->GetCommandInfo("TMP_A", CFGFLAG_SERVER, true));
+	EXPECT_FALSE(m_pConsole->GetCommandInfo("tmp_a", CFGFLAG_SERVER, false));
+	EXPECT_TRUE(m_pConsole->GetCommandInfo("test_cmd", CFGFLAG_SERVER, true));
+	EXPECT_TRUE(m_pConsole->GetCommandInfo("test_cmd", CFGFLAG_SERVER, false));
+
+	m_pConsole->DeregisterTemp("tmp_a");
+	EXPECT_FALSE(m_pConsole->GetCommandInfo("tmp_a", CFGFLAG_SERVER, true));
+	EXPECT_TRUE(m_pConsole->GetCommandInfo("tmp_b", CFGFLAG_SERVER, true));
+
+	// recycled entries are found under their new name
+	m_pConsole->RegisterTemp("tmp_c", "", CFGFLAG_SERVER, "");
+	EXPECT_TRUE(m_pConsole->GetCommandInfo("tmp_c", CFGFLAG_SERVER, true));
+
+	m_pConsole->DeregisterTempAll();
+	EXPECT_FALSE(m_pConsole->GetCommandInfo("tmp_b", CFGFLAG_SERVER, true));
+	EXPECT_FALSE(m_pConsole->GetCommandInfo("tmp_c", CFGFLAG_SERVER, true));
+	EXPECT_FALSE(m_pConsole->GetCommandInfo("test_cmd", CFGFLAG_SERVER, true));
+	EXPECT_TRUE(m_pConsole->GetCommandInfo("test_cmd", CFGFLAG_SERVER, false));
+	m_pConsole->ExecuteLine("test_cmd 1 a");
+	EXPECT_EQ(m_NumCalls, 1);
+}
+
+// not run by default, use --gtest_also_run_disabled_tests to measure
+TEST_F(Console, DISABLED_ExecBenchmark)
+{
+	// a large config with settings and vote-like commands
+	const int NumLines = 50000;
+	IOHANDLE File = m_pStorage->OpenFile("bench.cfg", IOFLAG_WRITE, IStorage::TYPE_SAVE);
+	ASSERT_TRUE(File);
+	for(int i = 0; i < NumLines; i++)
+	{
+		char aLine[256];
+		switch(i % 4)
+		{
+		case 0: str_format(aLine, sizeof(aLine), "test_cmd %d map%d \"sv_map map%d\"\n", i, i, i); break;
+		case 1: str_format(aLine, sizeof(aLine), "sv_max_clients %d\n", 1 + i % 64); break;
+		case 2: str_format(aLine, sizeof(aLine), "sv_name \"Server %d\" # comment\n", i); break;
+		case 3: str_format(aLine, sizeof(aLine), "sv_vote_kick_min %d; sv_vote_spectate %d\n", i % 8, i % 2); break;
+		}
+		io_write(File, aLine, str_length(aLine));
+	}
+	io_close(File);
+
+	int64_t Start = time_get();
+	m_pConsole->ExecuteFile("bench.cfg", -1, true, IStorage::TYPE_SAVE);
+	double Seconds = (time_get() - Start) / (double)time_freq();
+	printf("executed %d lines in %.3fs (%.0f lines/s)\n", NumLines, Seconds, NumLines / Seconds);
+	EXPECT_EQ(m_NumCalls, NumLines / 4);
+}
+
+static void CountLogLines(const char *pFrom, const char *pStr, void *pUser)
+{
+	(*(int *)pUser)++;
+}
+
+static void CountPrintLines(const char *pLine, void *pUser, ColorRGBA PrintColor)
+{
+	(*(int *)pUser)++;
+}
+
+TEST_F(Console, LogFilter)
+{
+	int NumLines = 0;
+	m_pConsole->RegisterPrintCallback(IConsole::OUTPUT_LEVEL_DEBUG, CountPrintLines, &NumLines);
+
+	m_pConsole->ExecuteLine("log_filter noisy 0 5; log_filter muted -1");
+	NumLines = 0;
+	for(int i = 0; i < 20; i++)
+		m_pConsole->Print(IConsole::OUTPUT_LEVEL_STANDARD, "noisy", "line");
+	EXPECT_EQ(NumLines, 5);
+
+	NumLines = 0;
+	m_pConsole->Print(IConsole::OUTPUT_LEVEL_ADDINFO, "noisy", "too verbose");
+	m_pConsole->Print(IConsole::OUTPUT_LEVEL_STANDARD, "muted", "line");
+	m_pConsole->Print(IConsole::OUTPUT_LEVEL_DEBUG, "other", "line");
+	EXPECT_EQ(NumLines, 1);
+
+	// level 2 without a rate removes the limit
+	m_pConsole->ExecuteLine("log_filter noisy 2");
+	NumLines = 0;
+	for(int i = 0; i < 20; i++)
+		m_pConsole->Print(IConsole::OUTPUT_LEVEL_DEBUG, "noisy", "line");
+	EXPECT_EQ(NumLines, 20);
+}
+
+TEST(ConsoleSink, WritesEverything)
+{
+	int NumLines = 0;
+	CConsole *pConsole = new CConsole(CFGFLAG_SERVER);
+	pConsole->SetLogWriter(CountLogLines, &NumLines);
+	for(int i = 0; i < 20000; i++)
+		pConsole->Print(IConsole::OUTPUT_LEVEL_STANDARD, "sink_test", "captured line");
+	// the sink drains the queue before the console is gone
+	delete pConsole;
+	EXPECT_EQ(NumLines, 20000);
+}
+
+TEST(ConsoleSink, WritesQueuedLinesBeforeDirectMessages)
+{
+	int NumLines = 0;
+	CConsole *pConsole = new CConsole(CFGFLAG_SERVER);
+	pConsole->SetLogWriter(CountLogLines, &NumLines);
+	for(int i = 0; i < 100; i++)
+		pConsole->Print(IConsole::OUTPUT_LEVEL_STANDARD, "sink_test", "captured line");
+	dbg_msg("sink_test", "direct line");
+	EXPECT_EQ(NumLines, 100);
+	delete pConsole;
+}
@@ -0,0 +1,194 @@
+#include <gtest/gtest.h>
+
+#include <game/client/prediction/entities/character.h>
+#include <game/client/prediction/entities/laser.h>
+#include <game/client/prediction/entities/pickup.h>
+#include <game/client/prediction/entities/projectile.h>
+#include <game/client/projectile_data.h>
+
+class GameWorld : public ::testing::Test
+{
+protected:
+	CTuningParams m_aTuningList[256];
+	CGameWorld m_Source;
+
+	GameWorld()
+	{
+		mem_zero(&m_Source.m_WorldConfig, sizeof(m_Source.m_WorldConfig));
+		m_Source.m_WorldConfig.m_PredictWeapons = true;
+		m_Source.m_GameTick = 100;
+		m_Source.m_GameTickSpeed = SERVER_TICK_SPEED;
+		m_Source.m_pTuningList = m_aTuningList;
+	}
+
+	void AddCharacter(int ID, int X, int Y)
+	{
+		CNetObj_Character Char;
+		mem_zero(&Char, sizeof(Char));
+		Char.m_X = X;
+		Char.m_Y = Y;
+		Char.m_VelX = ID * 10;
+		Char.m_HookedPlayer = -1;
+		Char.m_Weapon = WEAPON_GUN;
+		m_Source.NetCharAdd(ID, &Char, 0, 0, false);
+	}
+
+	void AddProjectile(int ID, int X, int Y)
+	{
+		CProjectileData Data;
+		mem_zero(&Data, sizeof(Data));
+		Data.m_StartPos = vec2(X, Y);
+		Data.m_StartVel = vec2(1, 0);
+		Data.m_Type = ID % 2 ? WEAPON_GUN : WEAPON_GRENADE;
+		Data.m_StartTick = m_Source.GameTick() - ID;
+		Data.m_ExtraInfo = true;
+		Data.m_Owner = ID % MAX_CLIENTS;
+		m_Source.InsertEntity(new CProjectile(&m_Source, ID, &Data));
+	}
+
+	void AddLaser(int ID, int X, int Y)
+	{
+		CNetObj_Laser Laser;
+		Laser.m_X = X;
+		Laser.m_Y = Y;
+		Laser.m_FromX = X - 100;
+		Laser.m_FromY = Y;
+		Laser.m_StartTick = m_Source.GameTick() - ID;
+		m_Source.InsertEntity(new CLaser(&m_Source, ID, &Laser));
+	}
+
+	void AddPickup(int ID, int X, int Y)
+	{
+		CNetObj_Pickup Pickup;
+		Pickup.m_X = X;
+		Pickup.m_Y = Y;
+		Pickup.m_Type = POWERUP_WEAPON;
+		Pickup.m_Subtype = ID % NUM_WEAPONS;
+		m_Source.InsertEntity(new CPickup(&m_Source, ID, &Pickup), true);
+	}
+
+	void Remove(int ID, int Type)
+	{
+		CEntity *pEnt = m_Source.GetEntity(ID, Type);
+		ASSERT_TRUE(pEnt);
+		delete pEnt;
+	}
+
+	void ExpectEqualCopies(CGameWorld *pCopy, CGameWorld *pExpected)
+	{
+		for(int Type = 0; Type < CGameWorld::NUM_ENTTYPES; Type++)
+		{
+			CEntity *pEnt = pCopy->FindFirst(Type);
+			CEntity *pExp = pExpected->FindFirst(Type);
+			CEntity *pPrev = 0;
+			for(; pEnt && pExp; pPrev = pEnt, pEnt = pEnt->TypeNext(), pExp = pExp->TypeNext())
+			{
+				EXPECT_EQ(pEnt->GameWorld(), pCopy);
+				EXPECT_EQ(pEnt->TypePrev(), pPrev);
+				EXPECT_EQ(pEnt->m_pParent, pExp->m_pParent);
+				EXPECT_EQ(pEnt->ID(), pExp->ID());
+				EXPECT_EQ(pEnt->m_Pos, pExp->m_Pos);
+				if(Type == CGameWorld::ENTTYPE_CHARACTER)
+				{
+					CCharacter *pChar = (CCharacter *)pEnt;
+					CCharacter *pExpChar = (CCharacter *)pExp;
+					EXPECT_EQ(pCopy->GetCharacterByID(pChar->GetCID()), pChar);
+					EXPECT_EQ(pCopy->m_Core.m_apCharacters[pChar->GetCID()], pChar->Core());
+					EXPECT_EQ(pChar->Core()->m_Pos, pExpChar->Core()->m_Pos);
+					EXPECT_EQ(pChar->Core()->m_Vel, pExpChar->Core()->m_Vel);
+					EXPECT_EQ(pChar->GetActiveWeapon(), pExpChar->GetActiveWeapon());
+				}
+				else if(Type == CGameWorld::ENTTYPE_PROJECTILE)
+				{
+					CProjectileData Data = ((CProjectile *)pEnt)->GetData();
+					CProjectileData ExpData = ((CProjectile *)pExp)->GetData();
+					EXPECT_EQ(Data.m_StartVel, ExpData.m_StartVel);
+					EXPECT_EQ(Data.m_Type, ExpData.m_Type);
+					EXPECT_EQ(Data.m_StartTick, ExpData.m_StartTick);
+					EXPECT_EQ(Data.m_Owner, ExpData.m_Owner);
+					EXPECT_EQ(Data.m_Explosive, ExpData.m_Explosive);
+				}
+				else if(Type == CGameWorld::ENTTYPE_LASER)
+				{
+					CLaser *pLaser = (CLaser *)pEnt;
+					CLaser *pExpLaser = (CLaser *)pExp;
+					EXPECT_EQ(pLaser->GetFrom(), pExpLaser->GetFrom());
+					EXPECT_EQ(pLaser->GetEvalTick(), pExpLaser->GetEvalTick());
+					EXPECT_EQ(pLaser->GetOwner(), pExpLaser->GetOwner());
+				}
+				else if(Type == CGameWorld::ENTTYPE_PICKUP)
+				{
+					CNetObj_Pickup Pickup, ExpPickup;
+					((CPickup *)pEnt)->FillInfo(&Pickup);
+					((CPickup *)pExp)->FillInfo(&ExpPickup);
+					EXPECT_EQ(Pickup.m_Type, ExpPickup.m_Type);
+					EXPECT_EQ(Pickup.m_Subtype, ExpPickup.m_Subtype);
+				}
+			}
+			EXPECT_FALSE(pEnt) << "more entities of type " << Type << " than expected";
+			EXPECT_FALSE(pExp) << "fewer entities of type " << Type << " than expected";
+		}
+		for(int i = 0; i < MAX_CLIENTS; i++)
+		{
+			EXPECT_EQ(pCopy->GetCharacterByID(i) != 0, pExpected->GetCharacterByID(i) != 0);
+		}
+	}
+
+	// copies the source into a fresh world and compares it against pCopy
+	void ExpectEqualToFreshCopy(CGameWorld *pCopy)
+	{
+		ASSERT_TRUE(pCopy->m_IsValidCopy);
+		CGameWorld Fresh;
+		Fresh.CopyWorld(&m_Source);
+		ExpectEqualCopies(pCopy, &Fresh);
+	}
+};
+
+TEST_F(GameWorld, CopyWorldReusesEntities)
+{
+	AddCharacter(0, 100, 100);
+	AddCharacter(1, 200, 100);
+	AddCharacter(5, 300, 100);
+	for(int i = 0; i < 4; i++)
+		AddProjectile(10 + i, 100 + 50 * i, 200);
+	AddLaser(20, 500, 300);
+	AddLaser(21, 600, 300);
+	for(int i = 0; i < 3; i++)
+		AddPickup(30 + i, 100 + 50 * i, 400);
+
+	CGameWorld Copy;
+	Copy.CopyWorld(&m_Source);
+	ExpectEqualToFreshCopy(&Copy);
+
+	// fewer and more entities of every type than the previous copy
+	Remove(1, CGameWorld::ENTTYPE_CHARACTER);
+	Remove(10, CGameWorld::ENTTYPE_PROJECTILE);
+	Remove(12, CGameWorld::ENTTYPE_PROJECTILE);
+	Remove(20, CGameWorld::ENTTYPE_LASER);
+	AddCharacter(7, 400, 100);
+	AddCharacter(8, 500, 100);
+	for(int i = 0; i < 3; i++)
+		AddProjectile(40 + i, 100 + 50 * i, 250);
+	AddPickup(50, 300, 450);
+	AddPickup(51, 350, 450);
+	m_Source.GetEntity(0, CGameWorld::ENTTYPE_CHARACTER)->m_Pos = vec2(123, 456);
+	Copy.CopyWorld(&m_Source);
+	ExpectEqualToFreshCopy(&Copy);
+
+	// no entities left of some types
+	Remove(0, CGameWorld::ENTTYPE_CHARACTER);
+	Remove(5, CGameWorld::ENTTYPE_CHARACTER);
+	Remove(21, CGameWorld::ENTTYPE_LASER);
+	for(int i = 0; i < 3; i++)
+		Remove(30 + i, CGameWorld::ENTTYPE_PICKUP);
+	Copy.CopyWorld(&m_Source);
+	ExpectEqualToFreshCopy(&Copy);
+	EXPECT_FALSE(Copy.GetCharacterByID(0));
+	EXPECT_FALSE(Copy.FindFirst(CGameWorld::ENTTYPE_LASER));
+
+	// and back from empty
+	AddCharacter(3, 100, 100);
+	AddLaser(22, 500, 300);
+	Copy.CopyWorld(&m_Source);
+	ExpectEqualToFreshCopy(&Copy);
+}
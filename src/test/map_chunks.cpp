@@ -0,0 +1,129 @@
+#include <gtest/gtest.h>
+
+#include <engine/server/map_chunks.h>
+#include <engine/shared/network.h>
+#include <engine/shared/packer.h>
+#include <engine/shared/protocol.h>
+
+#include <vector>
+
+static std::vector<unsigned char> TestMap(int Size)
+{
+	std::vector<unsigned char> vMap(Size);
+	for(int i = 0; i < Size; i++)
+		vMap[i] = (i * 31 + 7) & 0xff;
+	return vMap;
+}
+
+TEST(MapChunks, Six)
+{
+	std::vector<unsigned char> vMap = TestMap(3000);
+	CMapChunks Chunks;
+	Chunks.Init(vMap.data(), vMap.size(), 0x12345678, 1024, false);
+	ASSERT_EQ(Chunks.NumChunks(), 3);
+	EXPECT_EQ(Chunks.ChunkDataSize(2), 3000 - 2048);
+	EXPECT_EQ(Chunks.ChunkDataSize(3), 0);
+
+	std::vector<unsigned char> vReceived;
+	for(int Chunk = 0; Chunk < Chunks.NumChunks(); Chunk++)
+	{
+		int Size;
+		const unsigned char *pMsg = Chunks.Msg(Chunk, &Size);
+		ASSERT_TRUE(pMsg);
+
+		CUnpacker Unpacker;
+		Unpacker.Reset(pMsg, Size);
+		EXPECT_EQ(Unpacker.GetInt(), (NETMSG_MAP_DATA << 1) | 1);
+		EXPECT_EQ(Unpacker.GetInt(), Chunk == 2);
+		EXPECT_EQ(Unpacker.GetInt(), 0x12345678);
+		EXPECT_EQ(Unpacker.GetInt(), Chunk);
+		int DataSize = Unpacker.GetInt();
+		EXPECT_EQ(DataSize, Chunks.ChunkDataSize(Chunk));
+		const unsigned char *pData = Unpacker.GetRaw(DataSize);
+		ASSERT_FALSE(Unpacker.Error());
+		vReceived.insert(vReceived.end(), pData, pData + DataSize);
+	}
+	EXPECT_EQ(vReceived, vMap);
+
+	int Size;
+	EXPECT_FALSE(Chunks.Msg(-1, &Size));
+	EXPECT_FALSE(Chunks.Msg(3, &Size));
+}
+
+TEST(MapChunks, DDNetFitsChunkHeader)
+{
+	std::vector<unsigned char> vMap = TestMap(MAP_CHUNK_SIZE_DDNET * 3000);
+	CMapChunks Chunks;
+	Chunks.Init(vMap.data(), vMap.size(), 0xffffffff, MAP_CHUNK_SIZE_DDNET, false);
+	for(int Chunk = 0; Chunk < Chunks.NumChunks(); Chunk++)
+	{
+		// 0.6 chunk headers can't describe more than 1023 bytes
+		int Size;
+		ASSERT_TRUE(Chunks.Msg(Chunk, &Size));
+		EXPECT_LT(Size, 1024);
+	}
+}
+
+TEST(MapChunks, Sixup)
+{
+	std::vector<unsigned char> vMap = TestMap(MAP_CHUNK_SIZE_LARGE * 2);
+	CMapChunks Chunks;
+	Chunks.Init(vMap.data(), vMap.size(), 0, MAP_CHUNK_SIZE_LARGE, true);
+	ASSERT_EQ(Chunks.NumChunks(), 2);
+
+	int Size;
+	const unsigned char *pMsg = Chunks.Msg(1, &Size);
+	ASSERT_TRUE(pMsg);
+	CUnpacker Unpacker;
+	Unpacker.Reset(pMsg, Size);
+	EXPECT_EQ(Unpacker.GetInt(), (NETMSG_MAP_DATA << 1) | 1);
+	const unsigned char *pData = Unpacker.GetRaw(MAP_CHUNK_SIZE_LARGE);
+	ASSERT_FALSE(Unpacker.Error());
+	EXPECT_EQ(mem_comp(pData, vMap.data() + MAP_CHUNK_SIZE_LARGE, MAP_CHUNK_SIZE_LARGE), 0);
+	EXPECT_LE(Size, NET_MAX_PAYLOAD - NET_MAX_CHUNKHEADERSIZE - 4);
+}
+
+TEST(MapChunks, Window)
+{
+	const int64_t Ms = time_freq() / 1000;
+	CMapDownloadWindow Window;
+	Window.Init(4, 8);
+	EXPECT_EQ(Window.Window(), 4);
+	EXPECT_EQ(Window.Rtt(), -1);
+
+	// constant RTT, the window grows up to its maximum
+	int Chunk = 0;
+	for(; Chunk < 60; Chunk++)
+	{
+		Window.OnSend(Chunk, Chunk * 10 * Ms);
+		Window.OnAck(Chunk, Chunk * 10 * Ms + 50 * Ms);
+	}
+	EXPECT_EQ(Window.Window(), 8);
+	EXPECT_EQ(Window.Rtt(), 50 * Ms);
+
+	// queueing delay builds up, the window shrinks
+	for(; Chunk < 120; Chunk++)
+	{
+		Window.OnSend(Chunk, Chunk * 10 * Ms);
+		Window.OnAck(Chunk, Chunk * 10 * Ms + 300 * Ms);
+	}
+	EXPECT_LT(Window.Window(), 8);
+	EXPECT_GE(Window.Window(), 1);
+
+	// acks of unknown chunks are ignored
+	int64_t Rtt = Window.Rtt();
+	Window.OnAck(1000, 0);
+	EXPECT_EQ(Window.Rtt(), Rtt);
+}
+
+TEST(MapChunks, WindowDisabled)
+{
+	CMapDownloadWindow Window;
+	Window.Init(0, 0);
+	for(int Chunk = 0; Chunk < 10; Chunk++)
+	{
+		Window.OnSend(Chunk, 0);
+		Window.OnAck(Chunk, time_freq());
+	}
+	EXPECT_EQ(Window.Window(), 0);
+}
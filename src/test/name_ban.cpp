@@ -1,7 +1,10 @@
 #include <gtest/gtest.h>
 
+#include <base/system.h>
 #include <engine/server/name_ban.h>
 
+#include <vector>
+
 TEST(NameBan, Empty)
 {
 	EXPECT_FALSE(IsNameBanned("", 0, 0));
@@ -27,3 +30,139 @@ TEST(NameBan, Substring)
 	EXPECT_TRUE(IsNameBanned("abcxyzdef", &Xyz, 1));
 	EXPECT_FALSE(IsNameBanned("abcdef", &Xyz, 1));
 }
+
+TEST(NameBan, Skeleton)
+{
+	EXPECT_TRUE(CNameSkeleton("abc").IsConfusable(CNameSkeleton("abc")));
+	EXPECT_TRUE(CNameSkeleton("abc").IsConfusable(CNameSkeleton("äbc")));
+	EXPECT_FALSE(CNameSkeleton("abc").IsConfusable(CNameSkeleton("abd")));
+	EXPECT_FALSE(CNameSkeleton("abc").IsConfusable(CNameSkeleton("abcd")));
+
+	CNameSkeleton Skeleton("abc");
+	Skeleton.Update("def");
+	EXPECT_TRUE(Skeleton.IsConfusable(CNameSkeleton("def")));
+	EXPECT_FALSE(Skeleton.IsConfusable(CNameSkeleton("abc")));
+}
+
+TEST(NameBan, Indexed)
+{
+	CNameBans Bans;
+	EXPECT_FALSE(Bans.IsBanned("abc"));
+
+	Bans.Add(CNameBan("abc", 0, 0));
+	Bans.Add(CNameBan("xyz", 0, 1));
+	Bans.Add(CNameBan("nameless", 2, 0));
+	EXPECT_EQ(Bans.IsBanned("abc"), &Bans.Get(0));
+	EXPECT_EQ(Bans.IsBanned("  äbc "), &Bans.Get(0));
+	EXPECT_FALSE(Bans.IsBanned("abcdef"));
+	EXPECT_EQ(Bans.IsBanned("abcxyzdef"), &Bans.Get(1));
+	EXPECT_EQ(Bans.IsBanned("namelss"), &Bans.Get(2));
+	EXPECT_EQ(Bans.IsBanned("nam"), nullptr);
+
+	Bans.Update(2, 0, 0, "");
+	EXPECT_FALSE(Bans.IsBanned("namelss"));
+	Bans.Update(1, 0, 0, "");
+	EXPECT_FALSE(Bans.IsBanned("abcxyzdef"));
+
+	EXPECT_EQ(Bans.Find("xyz"), 1);
+	Bans.Remove(0);
+	EXPECT_EQ(Bans.Find("xyz"), 0);
+	EXPECT_FALSE(Bans.IsBanned("abc"));
+	EXPECT_EQ(Bans.IsBanned("xyz"), &Bans.Get(0));
+}
+
+static int Random(unsigned *pSeed, int Max)
+{
+	*pSeed = *pSeed * 1103515245 + 12345;
+	return (int)((*pSeed >> 16) % Max);
+}
+
+static void RandomName(unsigned *pSeed, char *pBuf, int BufSize)
+{
+	static const int s_aAlphabet[] = {'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h', 'i', 'l', 'n', 'o', 'r', 's', 't', 'x', 'y', 'z', '0', '1', ' ', 0xe4, 0xf6, 0x430, 0x3bf};
+	int Length = 3 + Random(pSeed, 10);
+	int Used = 0;
+	for(int i = 0; i < Length; i++)
+	{
+		char aChar[8];
+		int CharLength = str_utf8_encode(aChar, s_aAlphabet[Random(pSeed, sizeof(s_aAlphabet) / sizeof(s_aAlphabet[0]))]);
+		if(Used + CharLength >= BufSize)
+			break;
+		mem_copy(pBuf + Used, aChar, CharLength);
+		Used += CharLength;
+	}
+	pBuf[Used] = 0;
+}
+
+static void AddRandomBans(unsigned *pSeed, int NumBans, std::vector<CNameBan> *pLinear, CNameBans *pIndexed)
+{
+	for(int i = 0; i < NumBans; i++)
+	{
+		char aName[MAX_NAME_LENGTH];
+		RandomName(pSeed, aName, sizeof(aName));
+		// mostly the default distance of `name_ban`
+		CNameBan Ban(aName, Random(pSeed, 4) ? str_length(aName) / 3 : Random(pSeed, 5), Random(pSeed, 50) == 0);
+		pLinear->push_back(Ban);
+		pIndexed->Add(Ban);
+	}
+}
+
+static void RandomQuery(unsigned *pSeed, int i, const std::vector<CNameBan> &vLinear, char *pBuf, int BufSize)
+{
+	// also query banned names, so there are positive results
+	if(i % 2)
+		str_copy(pBuf, vLinear[Random(pSeed, vLinear.size())].m_aName, BufSize);
+	else
+		RandomName(pSeed, pBuf, BufSize);
+}
+
+TEST(NameBan, IndexedMatchesLinear)
+{
+	unsigned Seed = 1;
+	std::vector<CNameBan> vLinear;
+	CNameBans Indexed;
+	AddRandomBans(&Seed, 1000, &vLinear, &Indexed);
+
+	for(int i = 0; i < 200; i++)
+	{
+		char aName[MAX_NAME_LENGTH];
+		RandomQuery(&Seed, i, vLinear, aName, sizeof(aName));
+
+		CNameBan *pLinear = IsNameBanned(aName, vLinear.data(), vLinear.size());
+		CNameBan *pIndexed = Indexed.IsBanned(aName);
+
+		ASSERT_EQ(pLinear == nullptr, pIndexed == nullptr) << aName;
+		if(pLinear)
+		{
+			EXPECT_EQ(pLinear - vLinear.data(), pIndexed - &Indexed.Get(0)) << aName;
+		}
+	}
+}
+
+// not run by default, use --gtest_also_run_disabled_tests to measure
+TEST(NameBan, DISABLED_LookupBenchmark)
+{
+	unsigned Seed = 1;
+	std::vector<CNameBan> vLinear;
+	CNameBans Indexed;
+	AddRandomBans(&Seed, 10000, &vLinear, &Indexed);
+
+	const int NumLookups = 200;
+	int64_t LinearTime = 0;
+	int64_t IndexedTime = 0;
+	for(int i = 0; i < NumLookups; i++)
+	{
+		char aName[MAX_NAME_LENGTH];
+		RandomQuery(&Seed, i, vLinear, aName, sizeof(aName));
+
+		int64_t Start = time_get();
+		CNameBan *pLinear = IsNameBanned(aName, vLinear.data(), vLinear.size());
+		int64_t Mid = time_get();
+		CNameBan *pIndexed = Indexed.IsBanned(aName);
+		IndexedTime += time_get() - Mid;
+		LinearTime += Mid - Start;
+
+		ASSERT_EQ(pLinear == nullptr, pIndexed == nullptr) << aName;
+	}
+	printf("10000 bans, %d lookups: linear %.2fms, indexed %.2fms\n", NumLookups, LinearTime * 1000.0 / time_freq(), IndexedTime * 1000.0 / time_freq());
+}
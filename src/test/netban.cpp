@@ -0,0 +1,256 @@
+#include "test.h"
+#include <gtest/gtest.h>
+
+#include <base/system.h>
+#include <engine/console.h>
+#include <engine/shared/config.h>
+#include <engine/shared/netban.h>
+#include <engine/storage.h>
+
+#include <vector>
+
+class NetBan : public ::testing::Test
+{
+protected:
+	CTestInfo m_Info;
+	IConsole *m_pConsole;
+	IStorage *m_pStorage;
+	CNetBan m_NetBan;
+
+	NetBan()
+	{
+		m_pConsole = CreateConsole(CFGFLAG_SERVER);
+		m_pStorage = m_Info.CreateTestStorage();
+		m_NetBan.Init(m_pConsole, m_pStorage);
+	}
+
+	~NetBan()
+	{
+		delete m_pStorage;
+		delete m_pConsole;
+		m_Info.DeleteTestStorageFilesOnSuccess();
+	}
+
+	bool IsBanned(const char *pAddr)
+	{
+		NETADDR Addr;
+		EXPECT_FALSE(net_addr_from_str(&Addr, pAddr)) << pAddr;
+		char aBuf[128];
+		return m_NetBan.IsBanned(&Addr, aBuf, sizeof(aBuf));
+	}
+
+	int BanRange(const char *pFirst, const char *pLast, int Seconds = 0)
+	{
+		CNetRange Range;
+		EXPECT_FALSE(net_addr_from_str(&Range.m_LB, pFirst));
+		EXPECT_FALSE(net_addr_from_str(&Range.m_UB, pLast));
+		return m_NetBan.BanRange(&Range, Seconds, "test");
+	}
+
+	int UnbanRange(const char *pFirst, const char *pLast)
+	{
+		CNetRange Range;
+		EXPECT_FALSE(net_addr_from_str(&Range.m_LB, pFirst));
+		EXPECT_FALSE(net_addr_from_str(&Range.m_UB, pLast));
+		return m_NetBan.UnbanByRange(&Range);
+	}
+};
+
+static unsigned NextRandom(unsigned *pSeed)
+{
+	*pSeed = *pSeed * 1103515245 + 12345;
+	return *pSeed >> 8;
+}
+
+TEST_F(NetBan, Addr)
+{
+	NETADDR Addr;
+	ASSERT_FALSE(net_addr_from_str(&Addr, "1.2.3.4"));
+	EXPECT_FALSE(IsBanned("1.2.3.4"));
+	EXPECT_EQ(m_NetBan.BanAddr(&Addr, 0, "test"), 0);
+	EXPECT_EQ(m_NetBan.BanAddr(&Addr, 60, "test"), 1);
+	EXPECT_TRUE(IsBanned("1.2.3.4"));
+	EXPECT_FALSE(IsBanned("1.2.3.5"));
+	EXPECT_FALSE(IsBanned("[::1:2:3:4]"));
+
+	char aBuf[128];
+	Addr.type = NETTYPE_WEBSOCKET_IPV4;
+	EXPECT_TRUE(m_NetBan.IsBanned(&Addr, aBuf, sizeof(aBuf)));
+
+	Addr.type = NETTYPE_IPV4;
+	EXPECT_EQ(m_NetBan.UnbanByAddr(&Addr), 0);
+	EXPECT_FALSE(IsBanned("1.2.3.4"));
+	EXPECT_EQ(m_NetBan.UnbanByAddr(&Addr), -1);
+}
+
+TEST_F(NetBan, Range)
+{
+	EXPECT_EQ(BanRange("1.2.3.5", "1.2.4.10"), 0);
+	EXPECT_FALSE(IsBanned("1.2.3.4"));
+	EXPECT_TRUE(IsBanned("1.2.3.5"));
+	EXPECT_TRUE(IsBanned("1.2.3.255"));
+	EXPECT_TRUE(IsBanned("1.2.4.0"));
+	EXPECT_TRUE(IsBanned("1.2.4.10"));
+	EXPECT_FALSE(IsBanned("1.2.4.11"));
+
+	EXPECT_EQ(BanRange("[2001:db8::]", "[2001:db8::ffff:ffff]"), 0);
+	EXPECT_TRUE(IsBanned("[2001:db8::1:2]"));
+	EXPECT_FALSE(IsBanned("[2001:db8::1:0:0]"));
+
+	EXPECT_EQ(BanRange("128.0.0.0", "255.255.255.255"), 0);
+	EXPECT_TRUE(IsBanned("200.1.1.1"));
+	EXPECT_FALSE(IsBanned("[2001:db9::]"));
+	EXPECT_EQ(BanRange("0.0.0.0", "255.255.255.255"), -1); // contains localhost
+
+	EXPECT_EQ(UnbanRange("128.0.0.0", "255.255.255.255"), 0);
+	EXPECT_FALSE(IsBanned("200.1.1.1"));
+	EXPECT_TRUE(IsBanned("1.2.3.5"));
+	EXPECT_EQ(BanRange("1.2.3.4", "1.2.3.4"), -1);
+}
+
+TEST_F(NetBan, Overlapping)
+{
+	EXPECT_EQ(BanRange("10.0.0.0", "10.0.255.255"), 0);
+	EXPECT_EQ(BanRange("10.0.0.0", "10.0.1.255"), 0);
+	EXPECT_EQ(BanRange("9.255.255.0", "10.0.0.255"), 0);
+	NETADDR Addr;
+	ASSERT_FALSE(net_addr_from_str(&Addr, "10.0.0.7"));
+	EXPECT_EQ(m_NetBan.BanAddr(&Addr, 0, "test"), 0);
+	EXPECT_TRUE(IsBanned("10.0.0.7"));
+
+	EXPECT_EQ(UnbanRange("10.0.0.0", "10.0.1.255"), 0);
+	EXPECT_TRUE(IsBanned("10.0.1.1"));
+	EXPECT_EQ(UnbanRange("10.0.0.0", "10.0.255.255"), 0);
+	EXPECT_FALSE(IsBanned("10.0.1.1"));
+	EXPECT_TRUE(IsBanned("10.0.0.1"));
+	EXPECT_EQ(m_NetBan.UnbanByIndex(0), 0);
+	EXPECT_TRUE(IsBanned("10.0.0.7"));
+	EXPECT_EQ(UnbanRange("9.255.255.0", "10.0.0.255"), 0);
+	EXPECT_FALSE(IsBanned("10.0.0.7"));
+	EXPECT_FALSE(IsBanned("9.255.255.1"));
+}
+
+TEST_F(NetBan, Import)
+{
+	IOHANDLE File = m_pStorage->OpenFile("bans.txt", IOFLAG_WRITE, IStorage::TYPE_SAVE);
+	ASSERT_TRUE(File);
+	const char aList[] =
+		"# vpn ranges\n"
+		"1.2.3.4\n"
+		"5.6.0.0/16\n"
+		"  7.8.9.0 - 7.8.9.99  # comment\n"
+		"11.0.0.1 11.0.0.3\n"
+		"[2001:db8::]/32\n"
+		"12.0.0.0/33\n"
+		"not an address\n"
+		"\n";
+	io_write(File, aList, str_length(aList));
+	io_close(File);
+
+	EXPECT_EQ(m_NetBan.ImportBans("bans.txt", 0, "imported"), 5);
+	EXPECT_TRUE(IsBanned("1.2.3.4"));
+	EXPECT_TRUE(IsBanned("5.6.255.255"));
+	EXPECT_FALSE(IsBanned("5.7.0.0"));
+	EXPECT_TRUE(IsBanned("7.8.9.99"));
+	EXPECT_FALSE(IsBanned("7.8.9.100"));
+	EXPECT_TRUE(IsBanned("11.0.0.2"));
+	EXPECT_TRUE(IsBanned("[2001:db8:ffff::1]"));
+	EXPECT_FALSE(IsBanned("12.0.0.0"));
+	EXPECT_EQ(m_NetBan.ImportBans("missing.txt", 0, "imported"), -1);
+
+	m_NetBan.UnbanAll();
+	EXPECT_FALSE(IsBanned("1.2.3.4"));
+	EXPECT_FALSE(IsBanned("5.6.0.1"));
+}
+
+static bool InRange(const CNetRange &Range, const NETADDR &Addr)
+{
+	return Range.m_LB.type == Addr.type && mem_comp(Range.m_LB.ip, Addr.ip, 4) <= 0 && mem_comp(Range.m_UB.ip, Addr.ip, 4) >= 0;
+}
+
+static CNetRange RandomRange(unsigned *pSeed)
+{
+	CNetRange Range;
+	mem_zero(&Range, sizeof(Range));
+	Range.m_LB.type = Range.m_UB.type = NETTYPE_IPV4;
+	unsigned First = (NextRandom(pSeed) << 8) | (NextRandom(pSeed) & 0xff);
+	First = (First % 200 + 1) << 24 | (First & 0xffffff);
+	unsigned Last = First + 1 + NextRandom(pSeed) % (1 << (NextRandom(pSeed) % 20));
+	for(int i = 0; i < 4; i++)
+	{
+		Range.m_LB.ip[i] = First >> (24 - i * 8);
+		Range.m_UB.ip[i] = Last >> (24 - i * 8);
+	}
+	return Range;
+}
+
+TEST_F(NetBan, MatchesLinear)
+{
+	unsigned Seed = 7;
+	std::vector<CNetRange> vRanges;
+	for(int i = 0; i < 500; i++)
+	{
+		CNetRange Range = RandomRange(&Seed);
+		if(m_NetBan.BanRange(&Range, 0, "test") == 0)
+			vRanges.push_back(Range);
+	}
+	// remove every third range again
+	for(unsigned i = 0; i < vRanges.size(); i += 3)
+	{
+		EXPECT_EQ(m_NetBan.UnbanByRange(&vRanges[i]), 0);
+		vRanges[i] = vRanges.back();
+		vRanges.pop_back();
+	}
+
+	for(int i = 0; i < 5000; i++)
+	{
+		NETADDR Addr;
+		mem_zero(&Addr, sizeof(Addr));
+		Addr.type = NETTYPE_IPV4;
+		// half of the probes close to a ban boundary
+		const CNetRange &Near = vRanges[NextRandom(&Seed) % vRanges.size()];
+		mem_copy(Addr.ip, (i % 2 ? Near.m_LB : Near.m_UB).ip, 4);
+		if(i % 4 < 2)
+			Addr.ip[3] += (int)(NextRandom(&Seed) % 3) - 1;
+		else
+			for(int j = 0; j < 4; j++)
+				Addr.ip[j] = NextRandom(&Seed);
+
+		bool Expected = false;
+		for(const auto &Range : vRanges)
+			Expected = Expected || InRange(Range, Addr);
+
+		char aBuf[128];
+		ASSERT_EQ(m_NetBan.IsBanned(&Addr, aBuf, sizeof(aBuf)), Expected) << (int)Addr.ip[0] << "." << (int)Addr.ip[1] << "." << (int)Addr.ip[2] << "." << (int)Addr.ip[3];
+	}
+}
+
+// not run by default, use --gtest_also_run_disabled_tests to measure
+TEST_F(NetBan, DISABLED_LookupBenchmark)
+{
+	// a large imported VPN list
+	unsigned Seed = 1;
+	for(int i = 0; i < 50000; i++)
+	{
+		CNetRange Range = RandomRange(&Seed);
+		m_NetBan.BanRange(&Range, 0, "test");
+	}
+
+	const int NumLookups = 1000000;
+	int NumBanned = 0;
+	int64_t Start = time_get();
+	for(int i = 0; i < NumLookups; i++)
+	{
+		NETADDR Addr;
+		mem_zero(&Addr, sizeof(Addr));
+		Addr.type = NETTYPE_IPV4;
+		unsigned Random = NextRandom(&Seed) << 8 | (i & 0xff);
+		for(int j = 0; j < 4; j++)
+			Addr.ip[j] = Random >> (24 - j * 8);
+		char aBuf[128];
+		NumBanned += m_NetBan.IsBanned(&Addr, aBuf, sizeof(aBuf));
+	}
+	double Seconds = (time_get() - Start) / (double)time_freq();
+	printf("%d lookups against 50000 ranges in %.3fs (%.0f lookups/s), %d banned\n", NumLookups, Seconds, NumLookups / Seconds, NumBanned);
+	EXPECT_GT(NumBanned, 0);
+}
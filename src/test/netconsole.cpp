@@ -0,0 +1,207 @@
+#include <gtest/gtest.h>
+
+#include <base/system.h>
+#include <engine/shared/network.h>
+
+#include <string>
+
+class NetConsole : public ::testing::Test
+{
+protected:
+	CNetConsole m_NetConsole;
+	int m_NumNew;
+	int m_NumDel;
+	int m_LastClientID;
+	std::string m_LastReason;
+	int m_Port;
+
+	NetConsole()
+	{
+		m_NumNew = 0;
+		m_NumDel = 0;
+		m_LastClientID = -1;
+
+		NETADDR BindAddr;
+		net_addr_from_str(&BindAddr, "127.0.0.1");
+		// let the system pick a free port
+		BindAddr.port = 0;
+		m_NetConsole.SetCallbacks(NewClient, DelClient, this);
+		EXPECT_TRUE(m_NetConsole.Open(BindAddr, 0, 2, 4096));
+		NETADDR LocalAddr;
+		EXPECT_EQ(net_tcp_local_addr(m_NetConsole.Socket(), &LocalAddr), 0);
+		m_Port = LocalAddr.port;
+	}
+
+	static int NewClient(int ClientID, void *pUser)
+	{
+		NetConsole *pSelf = (NetConsole *)pUser;
+		pSelf->m_NumNew++;
+		pSelf->m_LastClientID = ClientID;
+		return 0;
+	}
+
+	static int DelClient(int ClientID, const char *pReason, void *pUser)
+	{
+		NetConsole *pSelf = (NetConsole *)pUser;
+		pSelf->m_NumDel++;
+		pSelf->m_LastClientID = ClientID;
+		pSelf->m_LastReason = pReason;
+		return 0;
+	}
+
+	NETSOCKET Connect()
+	{
+		NETADDR Addr;
+		net_addr_from_str(&Addr, "127.0.0.1");
+		NETADDR BindAddr = Addr;
+		BindAddr.port = 0;
+		NETSOCKET Socket = net_tcp_create(BindAddr);
+		Addr.port = m_Port;
+		EXPECT_EQ(net_tcp_connect(Socket, &Addr), 0);
+		return Socket;
+	}
+
+	// runs the game thread side until a line arrives or a second passed
+	bool Recv(char *pLine, int MaxLength, int *pClientID)
+	{
+		for(int i = 0; i < 1000; i++)
+		{
+			m_NetConsole.Update();
+			if(m_NetConsole.Recv(pLine, MaxLength, pClientID))
+				return true;
+			thread_sleep(1000);
+		}
+		return false;
+	}
+
+	void Pump()
+	{
+		char aLine[256];
+		int ClientID;
+		m_NetConsole.Update();
+		while(m_NetConsole.Recv(aLine, sizeof(aLine), &ClientID))
+		{
+		}
+	}
+
+	void WaitFor(const int *pCounter, int Value)
+	{
+		for(int i = 0; i < 1000 && *pCounter < Value; i++)
+		{
+			Pump();
+			thread_sleep(1000);
+		}
+	}
+
+	// everything the client gets until the data contains pUntil
+	std::string Read(NETSOCKET Socket, const char *pUntil)
+	{
+		std::string Data;
+		while(Data.find(pUntil) == std::string::npos && net_socket_read_wait(Socket, 1000000) > 0)
+		{
+			char aBuf[512];
+			int Bytes = net_tcp_recv(Socket, aBuf, sizeof(aBuf));
+			if(Bytes <= 0)
+				break;
+			Data.append(aBuf, Bytes);
+		}
+		return Data;
+	}
+};
+
+TEST_F(NetConsole, SendRecv)
+{
+	NETSOCKET Socket = Connect();
+	net_tcp_send(Socket, "first line\nsecond", 17);
+
+	char aLine[256];
+	int ClientID = -1;
+	ASSERT_TRUE(Recv(aLine, sizeof(aLine), &ClientID));
+	EXPECT_EQ(m_NumNew, 1);
+	EXPECT_EQ(ClientID, m_LastClientID);
+	EXPECT_STREQ(aLine, "first line");
+	EXPECT_FALSE(m_NetConsole.Recv(aLine, sizeof(aLine), &ClientID));
+	net_tcp_send(Socket, " half\n", 6);
+	ASSERT_TRUE(Recv(aLine, sizeof(aLine), &ClientID));
+	EXPECT_STREQ(aLine, "second half");
+
+	m_NetConsole.Send(ClientID, "reply");
+	m_NetConsole.Send(-1, "not subscribed");
+	m_NetConsole.SetBroadcast(ClientID, true);
+	m_NetConsole.Send(-1, "broadcast");
+	m_NetConsole.Update();
+	std::string Data = Read(Socket, "broadcast");
+	EXPECT_NE(Data.find("reply"), std::string::npos);
+	EXPECT_EQ(Data.find("not subscribed"), std::string::npos);
+	EXPECT_NE(Data.find("broadcast"), std::string::npos);
+
+	m_NetConsole.Drop(ClientID, "bye");
+	EXPECT_EQ(m_NumDel, 1);
+	EXPECT_EQ(m_LastReason, "bye");
+	m_NetConsole.Update();
+	EXPECT_NE(Read(Socket, "bye").find("bye"), std::string::npos);
+	net_tcp_close(Socket);
+}
+
+TEST_F(NetConsole, LongLine)
+{
+	NETSOCKET Socket = Connect();
+	WaitFor(&m_NumNew, 1);
+	ASSERT_EQ(m_NumNew, 1);
+
+	// longer than any fixed line buffer on the way
+	std::string Line(2000, 'x');
+	Line += "end";
+	m_NetConsole.SetBroadcast(m_LastClientID, true);
+	m_NetConsole.Send(-1, Line.c_str());
+	m_NetConsole.Update();
+	EXPECT_NE(Read(Socket, "end").find(Line), std::string::npos);
+	net_tcp_close(Socket);
+}
+
+TEST_F(NetConsole, RemoteClose)
+{
+	NETSOCKET Socket = Connect();
+	WaitFor(&m_NumNew, 1);
+	ASSERT_EQ(m_NumNew, 1);
+	int ClientID = m_LastClientID;
+
+	net_tcp_close(Socket);
+	WaitFor(&m_NumDel, 1);
+	EXPECT_EQ(m_NumDel, 1);
+	EXPECT_EQ(m_LastClientID, ClientID);
+	EXPECT_EQ(m_NetConsole.Send(ClientID, "gone"), -1);
+
+	// the slot is usable again once the drop was acknowledged
+	Socket = Connect();
+	WaitFor(&m_NumNew, 2);
+	EXPECT_EQ(m_NumNew, 2);
+	net_tcp_close(Socket);
+}
+
+TEST_F(NetConsole, SlowReader)
+{
+	NETSOCKET Socket = Connect();
+	WaitFor(&m_NumNew, 1);
+	ASSERT_EQ(m_NumNew, 1);
+
+	// never read, the output queue overflows and the client is dropped
+	// instead of the game thread stalling
+	char aLine[1000];
+	mem_zero(aLine, sizeof(aLine));
+	for(int i = 0; i < (int)sizeof(aLine) - 1; i++)
+		aLine[i] = 'a' + i % 26;
+	for(int i = 0; i < 20000 && m_NumDel == 0; i++)
+	{
+		m_NetConsole.Send(m_LastClientID, aLine);
+		if(i % 100 == 0)
+		{
+			Pump();
+			thread_sleep(1000);
+		}
+	}
+	WaitFor(&m_NumDel, 1);
+	EXPECT_EQ(m_NumDel, 1);
+	EXPECT_EQ(m_LastReason, "too weak connection (output queue full)");
+	net_tcp_close(Socket);
+}
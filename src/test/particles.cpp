@@ -0,0 +1,144 @@
+#include <gtest/gtest.h>
+
+#include <base/math.h>
+#include <base/system.h>
+#include <engine/map.h>
+#include <game/client/particle_group.h>
+#include <game/collision.h>
+#include <game/layers.h>
+#include <game/mapitems.h>
+
+#include <vector>
+
+// a map with only a game layer, solid around the border
+class CBoxMap : public IMap
+{
+	CMapItemGroup m_Group;
+	CMapItemLayerTilemap m_Layer;
+	std::vector<CTile> m_aTiles;
+
+public:
+	CBoxMap(int Width, int Height)
+	{
+		mem_zero(&m_Group, sizeof(m_Group));
+		m_Group.m_NumLayers = 1;
+		mem_zero(&m_Layer, sizeof(m_Layer));
+		m_Layer.m_Layer.m_Type = LAYERTYPE_TILES;
+		m_Layer.m_Width = Width;
+		m_Layer.m_Height = Height;
+		m_Layer.m_Flags = TILESLAYERFLAG_GAME;
+		m_aTiles.resize(Width * Height);
+		for(int y = 0; y < Height; y++)
+		{
+			for(int x = 0; x < Width; x++)
+			{
+				CTile *pTile = &m_aTiles[y * Width + x];
+				mem_zero(pTile, sizeof(*pTile));
+				if(x == 0 || y == 0 || x == Width - 1 || y == Height - 1)
+					pTile->m_Index = TILE_SOLID;
+			}
+		}
+	}
+
+	void *GetData(int Index) { return m_aTiles.data(); }
+	int GetDataSize(int Index) { return m_aTiles.size() * sizeof(CTile); }
+	void *GetDataSwapped(int Index) { return GetData(Index); }
+	void UnloadData(int Index) {}
+	void *GetItem(int Index, int *pType, int *pID) { return Index == 0 ? (void *)&m_Group : (void *)&m_Layer; }
+	int GetItemSize(int Index) { return Index == 0 ? sizeof(m_Group) : sizeof(m_Layer); }
+	void GetType(int Type, int *pStart, int *pNum)
+	{
+		*pStart = Type == MAPITEMTYPE_GROUP ? 0 : 1;
+		*pNum = Type == MAPITEMTYPE_GROUP || Type == MAPITEMTYPE_LAYER ? 1 : 0;
+	}
+	void *FindItem(int Type, int ID) { return 0; }
+	int NumItems() { return 2; }
+};
+
+class Particles : public ::testing::Test
+{
+protected:
+	CBoxMap m_Map;
+	CLayers m_Layers;
+	CCollision m_Collision;
+	CParticleGroup m_Group;
+
+	Particles() :
+		m_Map(100, 100)
+	{
+		m_Layers.InitBackground(&m_Map);
+		m_Collision.Init(&m_Layers);
+	}
+
+	void Add(vec2 Pos, vec2 Vel, float LifeSpan, int Spr = 0)
+	{
+		CParticle Part;
+		Part.SetDefault();
+		Part.m_Pos = Pos;
+		Part.m_Vel = Vel;
+		Part.m_LifeSpan = LifeSpan;
+		Part.m_Spr = Spr;
+		m_Group.Add(&Part, 0.0f);
+	}
+
+	void AddRandom()
+	{
+		CParticle Part;
+		Part.SetDefault();
+		Part.m_Pos = vec2(32 + random_float() * 98 * 32, 32 + random_float() * 98 * 32);
+		Part.m_Vel = vec2(random_float() - 0.5f, random_float() - 0.5f) * 1000.0f;
+		Part.m_LifeSpan = 0.5f + random_float() * 1.5f;
+		Part.m_Rotspeed = random_float() * 10.0f;
+		Part.m_Gravity = 500.0f;
+		Part.m_Friction = 0.9f;
+		m_Group.Add(&Part, 0.0f);
+	}
+};
+
+TEST_F(Particles, RemoveDeadInOrder)
+{
+	for(int i = 0; i < 1000; i++)
+		Add(vec2(1600, 1600), vec2(0, 0), i % 3 ? 1.0f : 0.1f, i);
+	EXPECT_EQ(m_Group.Update(&m_Collision, 0.5f, 0), 334);
+	ASSERT_EQ(m_Group.m_Num, 666);
+	for(int i = 0; i < m_Group.m_Num; i++)
+		EXPECT_EQ(m_Group.m_aSpr[i], i / 2 * 3 + i % 2 + 1);
+	EXPECT_EQ(m_Group.Update(&m_Collision, 1.0f, 0), 666);
+	EXPECT_EQ(m_Group.m_Num, 0);
+}
+
+TEST_F(Particles, BounceOffSolid)
+{
+	// right above the floor, falling into it
+	Add(vec2(1600, 98 * 32 + 16), vec2(100, 1000), 10.0f);
+	m_Group.Update(&m_Collision, 0.02f, 0);
+	EXPECT_EQ(m_Group.m_aPosX[0], 1600);
+	EXPECT_EQ(m_Group.m_aPosY[0], 98 * 32 + 16);
+	EXPECT_EQ(m_Group.m_aVelX[0], 100);
+	EXPECT_LT(m_Group.m_aVelY[0], 0);
+
+	for(int i = 0; i < 1000; i++)
+		m_Group.Update(&m_Collision, 0.02f, 0);
+	EXPECT_GT(m_Group.m_aPosY[0], 32);
+	EXPECT_LT(m_Group.m_aPosY[0], 99 * 32);
+}
+
+// not run by default, use --gtest_also_run_disabled_tests to measure
+TEST_F(Particles, DISABLED_UpdateBenchmark)
+{
+	const int NumFrames = 2000;
+	const float TimePassed = 1.0f / 120;
+	int64_t NumUpdated = 0;
+	int64_t Time = 0;
+	for(int f = 0; f < NumFrames; f++)
+	{
+		while(m_Group.m_Num < CParticleGroup::MAX_PARTICLES)
+			AddRandom();
+		NumUpdated += m_Group.m_Num;
+		int64_t Start = time_get();
+		m_Group.Update(&m_Collision, TimePassed, f % 6 == 0);
+		Time += time_get() - Start;
+	}
+	printf("%d frames of %d particles: %.2fns per particle\n",
+		NumFrames, (int)CParticleGroup::MAX_PARTICLES, Time * 1000000000.0 / time_freq() / NumUpdated);
+}
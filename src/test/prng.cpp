@@ -78,3 +78,23 @@ TEST(Prng, Description)
 	Prng.Seed(aSeed2);
 	EXPECT_STREQ(Prng.Description(), "pcg-xsh-rr:0000000000000000:0000000000000000");
 }
+
+TEST(Prng, SeedFromDescription)
+{
+	uint64_t aSeed[2] = {0xfedbca9876543210, 0x0123456789abcdef};
+	CPrng Prng;
+	Prng.Seed(aSeed);
+
+	CPrng Restored;
+	ASSERT_TRUE(Restored.Seed(Prng.Description()));
+	EXPECT_STREQ(Restored.Description(), Prng.Description());
+	for(int i = 0; i < 16; i++)
+	{
+		EXPECT_EQ(Restored.RandomBits(), Prng.RandomBits());
+	}
+
+	EXPECT_FALSE(Restored.Seed("pcg-xsh-rr:unseeded"));
+	EXPECT_FALSE(Restored.Seed("pcg-xsh-rr:fedbca9876543210-0123456789abcdef"));
+	EXPECT_FALSE(Restored.Seed("pcg-xsh-rr:fedbca987654321g:0123456789abcdef"));
+	EXPECT_FALSE(Restored.Seed("xorshift:fedbca9876543210:0123456789abcdef"));
+}
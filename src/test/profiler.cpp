@@ -0,0 +1,68 @@
+#include <gtest/gtest.h>
+
+#include <engine/shared/profiler.h>
+
+TEST(Profiler, BucketBounds)
+{
+	for(int i = 0; i < CProfileHistogram::NUM_BUCKETS - 1; i++)
+	{
+		int64_t Start = CProfileHistogram::BucketStart(i);
+		EXPECT_LT(Start, CProfileHistogram::BucketStart(i + 1));
+		EXPECT_EQ(CProfileHistogram::BucketIndex(Start), i);
+		EXPECT_EQ(CProfileHistogram::BucketIndex(CProfileHistogram::BucketStart(i + 1) - 1), i);
+	}
+	EXPECT_EQ(CProfileHistogram::BucketIndex(-5), 0);
+	EXPECT_EQ(CProfileHistogram::BucketIndex((int64_t)1 << 50), CProfileHistogram::NUM_BUCKETS - 1);
+}
+
+TEST(Profiler, Percentiles)
+{
+	CProfileHistogram Histogram;
+	EXPECT_EQ(Histogram.Percentile(0.5), 0);
+
+	for(int i = 1; i <= 1000; i++)
+		Histogram.Add(i * 1000);
+	EXPECT_EQ(Histogram.Count(), 1000);
+	EXPECT_EQ(Histogram.Max(), 1000000);
+	EXPECT_EQ(Histogram.Total(), 500500000);
+
+	// within the resolution of the sub buckets
+	EXPECT_NEAR(Histogram.Percentile(0.5), 500000, 500000 / 16);
+	EXPECT_NEAR(Histogram.Percentile(0.99), 990000, 990000 / 16);
+	EXPECT_EQ(Histogram.Percentile(1.0), 1000000);
+
+	Histogram.Reset();
+	EXPECT_EQ(Histogram.Count(), 0);
+	EXPECT_EQ(Histogram.Max(), 0);
+}
+
+TEST(Profiler, Zones)
+{
+	CProfiler Profiler;
+	int Zone = Profiler.AddZone("zone");
+	EXPECT_EQ(Profiler.AddZone("other"), Zone + 1);
+	EXPECT_EQ(Profiler.AddZone("zone"), Zone);
+	EXPECT_STREQ(Profiler.ZoneName(Zone), "zone");
+
+	{
+		CProfileScope Scope(&Profiler, Zone);
+	}
+	EXPECT_EQ(Profiler.Histogram(Zone).Count(), 0);
+
+	Profiler.SetEnabled(true);
+	for(int i = 0; i < 3; i++)
+	{
+		CProfileScope Scope(&Profiler, Zone);
+	}
+	EXPECT_EQ(Profiler.Histogram(Zone).Count(), 3);
+	Profiler.Reset();
+	EXPECT_EQ(Profiler.Histogram(Zone).Count(), 0);
+
+	// tracing measures even if the profiler is disabled
+	Profiler.SetEnabled(false);
+	Profiler.StartTrace(2);
+	EXPECT_TRUE(Profiler.Active());
+	EXPECT_FALSE(Profiler.EndTick());
+	EXPECT_TRUE(Profiler.EndTick());
+	EXPECT_FALSE(Profiler.Active());
+}
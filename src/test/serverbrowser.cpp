@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 
+#include <engine/client/serverbrowser_http.h>
 #include <engine/client/serverbrowser_ping_cache.h>
 #include <engine/console.h>
 #include <engine/engine.h>
@@ -7,6 +8,8 @@
 #include <engine/storage.h>
 #include <test/test.h>
 
+#include <stdlib.h>
+
 TEST(ServerBrowser, PingCache)
 {
 	CTestInfo Info;
@@ -104,3 +107,36 @@ TEST(ServerBrowser, PingCache)
 
 	Info.DeleteTestStorageFilesOnSuccess();
 }
+
+// not run by default, use --gtest_also_run_disabled_tests to measure
+// parses a saved master server list, e.g. from
+// `curl -o servers.json https://master1.ddnet.tw/ddnet/15/servers.json`,
+// the path can be set with DDNET_SERVERS_JSON
+TEST(ServerBrowser, DISABLED_ParseBenchmark)
+{
+	const char *pPath = getenv("DDNET_SERVERS_JSON");
+	if(!pPath)
+	{
+		pPath = "servers.json";
+	}
+	IOHANDLE File = io_open(pPath, IOFLAG_READ);
+	ASSERT_TRUE(File) << "couldn't open " << pPath;
+	int Size = io_length(File);
+	char *pData = (char *)malloc(Size);
+	ASSERT_EQ(io_read(File, pData, Size), (unsigned)Size);
+	io_close(File);
+
+	const int NumRuns = 20;
+	int NumServers = 0;
+	int NumLegacyServers = 0;
+	int64_t Start = time_get();
+	for(int i = 0; i < NumRuns; i++)
+	{
+		ASSERT_FALSE(ServerbrowserParseList(pData, Size, &NumServers, &NumLegacyServers));
+	}
+	int64_t Time = time_get() - Start;
+	free(pData);
+
+	printf("%d servers and %d legacy servers from %d bytes: %.2fms per parse\n",
+		NumServers, NumLegacyServers, Size, Time * 1000.0 / time_freq() / NumRuns);
+}
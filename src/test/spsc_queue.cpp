@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+
+#include <base/system.h>
+#include <engine/shared/spsc_queue.h>
+
+TEST(SpscQueue, PushPop)
+{
+	CSpscQueue Queue(256);
+	int Type, ID, Size;
+	char aBuf[64];
+	EXPECT_FALSE(Queue.Pop(&Type, &ID, aBuf, sizeof(aBuf), &Size));
+
+	EXPECT_TRUE(Queue.Push(1, 2, "hello", 6));
+	EXPECT_TRUE(Queue.Push(3, -1, 0, 0));
+	ASSERT_TRUE(Queue.Pop(&Type, &ID, aBuf, sizeof(aBuf), &Size));
+	EXPECT_EQ(Type, 1);
+	EXPECT_EQ(ID, 2);
+	EXPECT_EQ(Size, 6);
+	EXPECT_STREQ(aBuf, "hello");
+	ASSERT_TRUE(Queue.Pop(&Type, &ID, aBuf, sizeof(aBuf), &Size));
+	EXPECT_EQ(Type, 3);
+	EXPECT_EQ(ID, -1);
+	EXPECT_EQ(Size, 0);
+	EXPECT_FALSE(Queue.Pop(&Type, &ID, aBuf, sizeof(aBuf), &Size));
+	EXPECT_EQ(Queue.Used(), 0);
+}
+
+TEST(SpscQueue, FullAndWrap)
+{
+	CSpscQueue Queue(256);
+	char aData[40] = "wrap";
+	int Type, ID, Size;
+	char aBuf[64];
+
+	// messages of 64 bytes, four fit
+	int Pushed = 0;
+	while(Queue.Push(0, Pushed, aData, sizeof(aData)))
+		Pushed++;
+	EXPECT_EQ(Pushed, 4);
+
+	// messages that don't fit the tail are padded to the front
+	int Popped = 0;
+	for(int i = 0; i < 1000; i++)
+	{
+		ASSERT_TRUE(Queue.Pop(&Type, &ID, aBuf, sizeof(aBuf), &Size));
+		EXPECT_EQ(ID, Popped);
+		EXPECT_STREQ(aBuf, "wrap");
+		Popped++;
+		while(Queue.Push(0, Pushed, aData, 8 + (Pushed * 7) % 32))
+			Pushed++;
+	}
+	EXPECT_GT(Pushed, 1000);
+
+	// truncated to the buffer, the full size is reported
+	while(Queue.Pop(&Type, &ID, aBuf, sizeof(aBuf), &Size))
+	{
+	}
+	ASSERT_TRUE(Queue.Push(0, 0, aData, sizeof(aData)));
+	ASSERT_TRUE(Queue.Pop(&Type, &ID, aBuf, 4, &Size));
+	EXPECT_EQ(Size, (int)sizeof(aData));
+	EXPECT_EQ(mem_comp(aBuf, "wrap", 4), 0);
+}
+
+struct CProducerData
+{
+	CSpscQueue *m_pQueue;
+	int m_Num;
+};
+
+static void Produce(void *pUser)
+{
+	CProducerData *pData = (CProducerData *)pUser;
+	for(int i = 0; i < pData->m_Num; i++)
+	{
+		char aBuf[32];
+		str_format(aBuf, sizeof(aBuf), "%d", i);
+		while(!pData->m_pQueue->Push(i % 7, i, aBuf, str_length(aBuf) + 1))
+			thread_yield();
+	}
+}
+
+TEST(SpscQueue, Threads)
+{
+	CSpscQueue Queue(1024);
+	CProducerData Data = {&Queue, 200000};
+	void *pThread = thread_init(Produce, &Data, "spsc producer");
+
+	int Next = 0;
+	while(Next < Data.m_Num)
+	{
+		int Type, ID, Size;
+		char aBuf[32];
+		if(!Queue.Pop(&Type, &ID, aBuf, sizeof(aBuf), &Size))
+		{
+			thread_yield();
+			continue;
+		}
+		ASSERT_EQ(ID, Next);
+		ASSERT_EQ(Type, Next % 7);
+		ASSERT_EQ(str_toint(aBuf), Next);
+		Next++;
+	}
+	thread_wait(pThread);
+}
@@ -95,6 +95,24 @@ TEST(Str, Utf8ToLower)
 	EXPECT_TRUE(str_utf8_find_nocase(str, "z") == NULL);
 }
 
+TEST(Str, Utf8Lowercase)
+{
+	char aBuf[16];
+	str_utf8_lowercase("ÖlÜ Abc", aBuf, sizeof(aBuf));
+	EXPECT_STREQ(aBuf, "ölü abc");
+	EXPECT_TRUE(str_find(aBuf, "ü a"));
+
+	// 'Ⱥ' is two bytes long, its lowercase variant 'ⱥ' is three bytes long
+	str_utf8_lowercase("ȺȺ", aBuf, 6);
+	EXPECT_STREQ(aBuf, "ⱥ");
+	str_utf8_lowercase("abc", aBuf, 1);
+	EXPECT_STREQ(aBuf, "");
+
+	const char aInvalid[] = {'A', (char)0xff, 'B', 0};
+	str_utf8_lowercase(aInvalid, aBuf, sizeof(aBuf));
+	EXPECT_STREQ(aBuf, "a�b"); // U+FFFD REPLACEMENT CHARACTER
+}
+
 TEST(Str, Startswith)
 {
 	EXPECT_TRUE(str_startswith("abcdef", "abc"));
@@ -3,6 +3,8 @@
 #include <base/detect.h>
 #include <engine/server.h>
 #include <engine/shared/config.h>
+#include <engine/shared/teehistorian_ex.h>
+#include <engine/shared/teehistorian_reader.h>
 #include <game/gamecore.h>
 #include <game/server/teehistorian.h>
 
@@ -532,3 +534,90 @@ TEST_F(TeeHistorian, LoadFailed)
 	Finish();
 	Expect(EXPECTED, sizeof(EXPECTED));
 }
+
+TEST_F(TeeHistorian, Read)
+{
+	CNetObj_PlayerInput Input;
+	mem_zero(&Input, sizeof(Input));
+
+	m_TH.RecordPlayerJoin(3, CTeeHistorian::PROTOCOL_6);
+	Tick(1);
+	Player(3, 10, 20);
+	Inputs();
+	Input.m_Direction = 1;
+	m_TH.RecordPlayerInput(3, &Input);
+	m_TH.RecordPlayerReady(3);
+	Tick(2);
+	Player(3, 12, 20);
+	Inputs();
+	Input.m_Jump = 1;
+	m_TH.RecordPlayerInput(3, &Input);
+	Tick(3);
+	Tick(4);
+	Player(3, 12, 25);
+	Tick(5);
+	DeadPlayer(3);
+	Inputs();
+	m_TH.RecordPlayerDrop(3, "bye");
+	Finish();
+
+	CTeeHistorianReader Reader;
+	ASSERT_TRUE(Reader.Reset(m_Buffer.Data(), m_Buffer.Size()));
+	EXPECT_TRUE(str_startswith(Reader.Header(), "{\"comment\":\"teehistorian@ddnet.tw\""));
+
+	CTeeHistorianReader::CItem Item;
+	ASSERT_TRUE(Reader.Next(&Item));
+	EXPECT_EQ(Item.m_Type, CTeeHistorianReader::ITEM_EX);
+	EXPECT_EQ(Item.m_ExID, TEEHISTORIAN_JOINVER6);
+	EXPECT_EQ(Item.m_Tick, 0);
+	ASSERT_TRUE(Reader.Next(&Item));
+	EXPECT_EQ(Item.m_Type, CTeeHistorianReader::ITEM_JOIN);
+	EXPECT_EQ(Item.m_ClientID, 3);
+
+	ASSERT_TRUE(Reader.Next(&Item));
+	EXPECT_EQ(Item.m_Type, CTeeHistorianReader::ITEM_PLAYER);
+	EXPECT_EQ(Item.m_Tick, 1);
+	EXPECT_EQ(Item.m_ClientID, 3);
+	EXPECT_EQ(Item.m_X, 10);
+	EXPECT_EQ(Item.m_Y, 20);
+	ASSERT_TRUE(Reader.Next(&Item));
+	EXPECT_EQ(Item.m_Type, CTeeHistorianReader::ITEM_INPUT);
+	EXPECT_EQ(Item.m_Tick, 1);
+	EXPECT_EQ(Item.m_Input.m_Direction, 1);
+	ASSERT_TRUE(Reader.Next(&Item));
+	EXPECT_EQ(Item.m_Type, CTeeHistorianReader::ITEM_EX);
+	EXPECT_EQ(Item.m_ExID, TEEHISTORIAN_PLAYER_READY);
+	EXPECT_EQ(Item.m_ClientID, 3);
+
+	ASSERT_TRUE(Reader.Next(&Item));
+	EXPECT_EQ(Item.m_Type, CTeeHistorianReader::ITEM_PLAYER);
+	EXPECT_EQ(Item.m_Tick, 2);
+	EXPECT_EQ(Item.m_X, 12);
+	EXPECT_EQ(Item.m_Y, 20);
+	ASSERT_TRUE(Reader.Next(&Item));
+	EXPECT_EQ(Item.m_Type, CTeeHistorianReader::ITEM_INPUT);
+	EXPECT_EQ(Item.m_Input.m_Direction, 1);
+	EXPECT_EQ(Item.m_Input.m_Jump, 1);
+
+	// nothing changed in tick 3
+	ASSERT_TRUE(Reader.Next(&Item));
+	EXPECT_EQ(Item.m_Type, CTeeHistorianReader::ITEM_PLAYER);
+	EXPECT_EQ(Item.m_Tick, 4);
+	EXPECT_EQ(Item.m_X, 12);
+	EXPECT_EQ(Item.m_Y, 25);
+
+	ASSERT_TRUE(Reader.Next(&Item));
+	EXPECT_EQ(Item.m_Type, CTeeHistorianReader::ITEM_PLAYER_OLD);
+	EXPECT_EQ(Item.m_Tick, 5);
+	ASSERT_TRUE(Reader.Next(&Item));
+	EXPECT_EQ(Item.m_Type, CTeeHistorianReader::ITEM_DROP);
+	EXPECT_STREQ(Item.m_pReason, "bye");
+
+	ASSERT_TRUE(Reader.Next(&Item));
+	EXPECT_EQ(Item.m_Type, CTeeHistorianReader::ITEM_FINISH);
+	EXPECT_FALSE(Reader.Next(&Item));
+	EXPECT_FALSE(Reader.Error());
+
+	unsigned char aGarbage[sizeof(CUuid)] = {0};
+	EXPECT_FALSE(Reader.Reset(aGarbage, sizeof(aGarbage)));
+}
@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+
+#include <base/system.h>
+#include <engine/shared/packer.h>
+#include <game/generated/protocol.h>
+#include <game/server/vote_options.h>
+
+#include <string>
+#include <vector>
+
+static std::vector<std::string> Unpack(const unsigned char *pData, int Size, int NumOptions)
+{
+	CUnpacker Unpacker;
+	Unpacker.Reset(pData, Size);
+	EXPECT_EQ(Unpacker.GetInt(), NumOptions);
+	std::vector<std::string> vDescriptions;
+	for(int i = 0; i < 15; i++)
+	{
+		const char *pDescription = Unpacker.GetString();
+		if(i < NumOptions)
+			vDescriptions.push_back(pDescription);
+		else
+			EXPECT_STREQ(pDescription, "");
+	}
+	EXPECT_FALSE(Unpacker.Error());
+	return vDescriptions;
+}
+
+TEST(VoteOptions, AddFindRemove)
+{
+	CVoteOptions Options;
+	EXPECT_TRUE(Options.Add("Map A", "sv_map a"));
+	EXPECT_TRUE(Options.Add("Map B", "sv_map b"));
+	EXPECT_FALSE(Options.Add("map a", "sv_map c"));
+	EXPECT_EQ(Options.Num(), 2);
+
+	ASSERT_TRUE(Options.Find("MAP B"));
+	EXPECT_STREQ(Options.Find("MAP B")->m_aCommand, "sv_map b");
+	EXPECT_FALSE(Options.Find("Map C"));
+
+	EXPECT_TRUE(Options.Remove("map a"));
+	EXPECT_FALSE(Options.Remove("map a"));
+	EXPECT_EQ(Options.Num(), 1);
+	EXPECT_STREQ(Options.Get(0)->m_aDescription, "Map B");
+	EXPECT_EQ(Options.FindIndex("Map B"), 0);
+
+	Options.Clear();
+	EXPECT_EQ(Options.Num(), 0);
+	EXPECT_FALSE(Options.Find("Map B"));
+	EXPECT_TRUE(Options.Add("Map B", "sv_map b"));
+}
+
+TEST(VoteOptions, Pack)
+{
+	CVoteOptions Options;
+	char aDescription[VOTE_DESC_LENGTH];
+	char aCommand[VOTE_CMD_LENGTH];
+	for(int i = 0; i < 1000; i++)
+	{
+		str_format(aDescription, sizeof(aDescription), "Map %d", i);
+		str_format(aCommand, sizeof(aCommand), "sv_map map%d", i);
+		ASSERT_TRUE(Options.Add(aDescription, aCommand));
+	}
+
+	// stream the whole list like a joining client does
+	int Index = 0;
+	const unsigned char *pData;
+	int Size;
+	while(Index < Options.Num())
+	{
+		int NumOptions = Options.Pack(Index, 7, &pData, &Size);
+		ASSERT_GT(NumOptions, 0);
+		std::vector<std::string> vDescriptions = Unpack(pData, Size, NumOptions);
+		for(int i = 0; i < NumOptions; i++)
+			EXPECT_EQ(vDescriptions[i], Options.Get(Index + i)->m_aDescription);
+		Index += NumOptions;
+	}
+	EXPECT_EQ(Index, 1000);
+	EXPECT_EQ(Options.Pack(Index, 7, &pData, &Size), 0);
+
+	// the trailing partial batch is repacked after an option was added
+	ASSERT_TRUE(Options.Add("Last", "sv_map last"));
+	EXPECT_EQ(Options.Pack(994, 7, &pData, &Size), 7);
+	EXPECT_EQ(Unpack(pData, Size, 7)[6], "Last");
+	// clients that already had the list get the new option only
+	EXPECT_EQ(Options.Pack(1000, 7, &pData, &Size), 1);
+	EXPECT_EQ(Unpack(pData, Size, 1)[0], "Last");
+
+	// removing an option shifts the remaining ones
+	ASSERT_TRUE(Options.Remove("Map 0"));
+	EXPECT_EQ(Options.Pack(0, 15, &pData, &Size), 15);
+	std::vector<std::string> vDescriptions = Unpack(pData, Size, 15);
+	EXPECT_EQ(vDescriptions[0], "Map 1");
+	EXPECT_EQ(vDescriptions[14], "Map 15");
+}
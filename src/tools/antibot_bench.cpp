@@ -0,0 +1,157 @@
+#ifndef CONF_ANTIBOT
+// without the antibot library the null module is linked in statically
+#define ANTIBOTAPI
+#endif
+#include <antibot/antibot_interface.h>
+
+#include <base/system.h>
+
+#include <stdio.h>
+
+// Drives the antibot module like a full server would, once with one call
+// per game hook and once with a batch per tick, and compares the time
+// spent per tick.
+
+enum
+{
+	NUM_PLAYERS = ANTIBOT_MAX_CLIENTS,
+	NUM_TICKS = 20000,
+};
+
+static CAntibotData g_Data;
+static CAntibotRoundData g_RoundData;
+static CAntibotEvent g_aEvents[ANTIBOT_MAX_EVENTS];
+static int g_NumEvents;
+static char g_aaNames[NUM_PLAYERS][16];
+
+static void Log(const char *pMessage, void *pUser)
+{
+	dbg_msg("antibot", "%s", pMessage);
+}
+
+static void Report(int ClientID, const char *pMessage, void *pUser)
+{
+	dbg_msg("antibot", "%d: %s", ClientID, pMessage);
+}
+
+static void Send(int ClientID, const void *pData, int DataSize, int Flags, void *pUser)
+{
+}
+
+// what CGameContext::FillAntibot does before every hand-over
+static void Update(int Tick)
+{
+	g_Data.m_Now = time_get();
+	g_RoundData.m_Tick = Tick;
+	mem_zero(g_RoundData.m_aCharacters, sizeof(g_RoundData.m_aCharacters));
+	for(int i = 0; i < NUM_PLAYERS; i++)
+	{
+		CAntibotCharacterData *pChar = &g_RoundData.m_aCharacters[i];
+		str_copy(pChar->m_aName, g_aaNames[i], sizeof(pChar->m_aName));
+		pChar->m_Alive = true;
+		pChar->m_Pos = vec2(i * 32.0f, Tick % 1000);
+		pChar->m_Vel = vec2(1.0f, 0.0f);
+		pChar->m_HookedPlayer = -1;
+	}
+	AntibotUpdateData();
+}
+
+static void AddEvent(int Type, int ClientID, int Tick, int Arg)
+{
+	if(g_NumEvents == ANTIBOT_MAX_EVENTS)
+	{
+		Update(Tick);
+		AntibotOnEvents(g_aEvents, g_NumEvents);
+		g_NumEvents = 0;
+	}
+	CAntibotEvent *pEvent = &g_aEvents[g_NumEvents++];
+	pEvent->m_Type = Type;
+	pEvent->m_ClientID = ClientID;
+	pEvent->m_Tick = Tick;
+	pEvent->m_Arg = Arg;
+}
+
+static double Run(bool Batched)
+{
+	int64_t Start = time_get();
+	for(int Tick = 0; Tick < NUM_TICKS; Tick++)
+	{
+		// each player sends an input and ticks, some of them hook or hammer
+		for(int i = 0; i < NUM_PLAYERS; i++)
+		{
+			bool Hook = (Tick + i) % 10 == 0;
+			bool Hammer = (Tick + i) % 25 == 0;
+			if(Batched)
+			{
+				AddEvent(ANTIBOT_EVENT_DIRECT_INPUT, i, Tick, 0);
+				AddEvent(ANTIBOT_EVENT_CHARACTER_TICK, i, Tick, 0);
+				if(Hook)
+					AddEvent(ANTIBOT_EVENT_HOOK_ATTACH, i, Tick, 1);
+				if(Hammer)
+					AddEvent(ANTIBOT_EVENT_HAMMER_FIRE, i, Tick, 0);
+			}
+			else
+			{
+				Update(Tick);
+				AntibotOnDirectInput(i);
+				Update(Tick);
+				AntibotOnCharacterTick(i);
+				if(Hook)
+				{
+					Update(Tick);
+					AntibotOnHookAttach(i, true);
+				}
+				if(Hammer)
+				{
+					Update(Tick);
+					AntibotOnHammerFire(i);
+				}
+			}
+		}
+
+		Update(Tick);
+		if(Batched && g_NumEvents)
+		{
+			AntibotOnEvents(g_aEvents, g_NumEvents);
+			g_NumEvents = 0;
+		}
+		AntibotOnEngineTick();
+	}
+	return (time_get() - Start) / (double)time_freq();
+}
+
+int main(int argc, const char **argv) // ignore_convention
+{
+	dbg_logger_stdout();
+	for(int i = 0; i < NUM_PLAYERS; i++)
+		str_format(g_aaNames[i], sizeof(g_aaNames[i]), "player%d", i);
+
+	CAntibotVersion Version = ANTIBOT_VERSION;
+	g_Data.m_Version = Version;
+	g_Data.m_Now = time_get();
+	g_Data.m_Freq = time_freq();
+	g_Data.m_pfnLog = Log;
+	g_Data.m_pfnReport = Report;
+	g_Data.m_pfnSend = Send;
+	g_Data.m_pUser = 0;
+	AntibotInit(&g_Data);
+	if(AntibotAbiVersion() != ANTIBOT_ABI_VERSION)
+	{
+		dbg_msg("antibot_bench", "abi version mismatch, module %d, expected %d", AntibotAbiVersion(), ANTIBOT_ABI_VERSION);
+		return 1;
+	}
+	AntibotRoundStart(&g_RoundData);
+
+	double PerEvent = Run(false);
+	double Batched = Run(true);
+	dbg_msg("antibot_bench", "%d players, %d ticks", NUM_PLAYERS, NUM_TICKS);
+	dbg_msg("antibot_bench", "per-event calls: %.3fs (%.2fus per tick)", PerEvent, PerEvent * 1e6 / NUM_TICKS);
+	dbg_msg("antibot_bench", "batched:         %.3fs (%.2fus per tick)", Batched, Batched * 1e6 / NUM_TICKS);
+	if(!(g_Data.m_ModuleFlags & ANTIBOT_MODULEFLAG_BATCH_EVENTS))
+		dbg_msg("antibot_bench", "note: the module doesn't request batched events");
+
+	AntibotDump();
+	AntibotRoundEnd();
+	AntibotDestroy();
+	return 0;
+}
@@ -0,0 +1,114 @@
+#include <base/math.h>
+#include <base/system.h>
+#include <engine/shared/network.h>
+#include <mastersrv/mastersrv.h>
+
+#include <stdio.h>
+
+// Measures how many serverinfo requests per second a server answers. Run
+// the server pinned to a single core (e.g. `taskset -c 0 DDNet-Server`) and
+// this tool on another one.
+
+enum
+{
+	IN_FLIGHT = 256,
+};
+
+static CNetClient g_NetClient;
+
+static void SendRequest(const NETADDR &Addr, bool Extended, int Token)
+{
+	unsigned char aBuffer[sizeof(SERVERBROWSE_GETINFO) + 1];
+	mem_copy(aBuffer, SERVERBROWSE_GETINFO, sizeof(SERVERBROWSE_GETINFO));
+	aBuffer[sizeof(SERVERBROWSE_GETINFO)] = Token & 0xff;
+
+	CNetChunk Packet;
+	mem_zero(&Packet, sizeof(Packet));
+	Packet.m_ClientID = -1;
+	Packet.m_Address = Addr;
+	Packet.m_Flags = NETSENDFLAG_CONNLESS;
+	Packet.m_pData = aBuffer;
+	Packet.m_DataSize = sizeof(aBuffer);
+	if(Extended)
+	{
+		Packet.m_Flags |= NETSENDFLAG_EXTENDED;
+		Packet.m_aExtraData[0] = (Token >> 16) & 0xff;
+		Packet.m_aExtraData[1] = (Token >> 8) & 0xff;
+	}
+	g_NetClient.Send(&Packet);
+}
+
+static bool IsResponse(const CNetChunk &Packet)
+{
+	static const unsigned char *s_apMagics[] = {SERVERBROWSE_INFO, SERVERBROWSE_INFO_EXTENDED, SERVERBROWSE_INFO_EXTENDED_MORE};
+	for(const unsigned char *pMagic : s_apMagics)
+		if(Packet.m_DataSize >= 8 && mem_comp(Packet.m_pData, pMagic, 8) == 0)
+			return true;
+	return false;
+}
+
+int main(int argc, char **argv) // ignore_convention
+{
+	dbg_logger_stdout();
+
+	if(argc < 2 || argc > 4)
+	{
+		fprintf(stderr, "usage: %s server[:port] [seconds] [vanilla|extended]\n", argv[0]);
+		return 1;
+	}
+
+	NETADDR Addr;
+	if(net_host_lookup(argv[1], &Addr, NETTYPE_ALL))
+	{
+		fprintf(stderr, "host lookup failed\n");
+		return 1;
+	}
+	if(Addr.port == 0)
+		Addr.port = 8303;
+	int Seconds = argc >= 3 ? maximum(str_toint(argv[2]), 1) : 5;
+	bool Extended = argc >= 4 && str_comp(argv[3], "extended") == 0;
+
+	NETADDR BindAddr;
+	mem_zero(&BindAddr, sizeof(BindAddr));
+	BindAddr.type = NETTYPE_ALL;
+	g_NetClient.Open(BindAddr, 0);
+
+	int Token = 0;
+	int Sent = 0;
+	int Received = 0;
+	int InFlight = 0;
+	int64_t Start = time_get();
+	int64_t End = Start + Seconds * time_freq();
+	int64_t LastReceive = Start;
+	while(time_get() < End)
+	{
+		// keep a fixed number of requests in flight, assume lost ones are gone after a second
+		if(time_get() - LastReceive > time_freq())
+			InFlight = 0;
+		for(; InFlight < IN_FLIGHT; InFlight++, Sent++)
+			SendRequest(Addr, Extended, Token++);
+
+		net_socket_read_wait(g_NetClient.m_Socket, 1000);
+		g_NetClient.Update();
+
+		CNetChunk Packet;
+		while(g_NetClient.Recv(&Packet))
+		{
+			if(!IsResponse(Packet))
+				continue;
+			// extended responses with many players span several packets, count the first one
+			if(mem_comp(Packet.m_pData, SERVERBROWSE_INFO_EXTENDED_MORE, 8) == 0)
+				continue;
+			Received++;
+			InFlight = maximum(InFlight - 1, 0);
+			LastReceive = time_get();
+		}
+	}
+
+	float Duration = (time_get() - Start) / (float)time_freq();
+	printf("sent %d requests, received %d responses in %.2fs\n", Sent, Received, Duration);
+	printf("%.0f requests/s, %.0f responses/s\n", Sent / Duration, Received / Duration);
+
+	g_NetClient.Close();
+	return 0;
+}